@@ -0,0 +1,271 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Receive and transmit conversion kernels of the USB backends. The
+ * backends keep them in headers of their own, so what is measured here
+ * is the code their work() functions run.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "airspy_fifo.h"
+#include "file_convert.h"
+#include "iqz_codec.h"
+#include "hackrf_convert.h"
+#include "rtl_convert.h"
+
+typedef std::complex<float> gr_complex;
+
+/* rtl_source_c::work(): u8 I/Q through a 256 entry lookup table */
+static void BM_rtl_u8_lut(benchmark::State &state)
+{
+  const int n = state.range(0);
+  std::vector<unsigned char> in(2 * n);
+  std::vector<gr_complex> out(n);
+  std::vector<float> lut;
+
+  rtl_make_lut(lut);
+  for (size_t i = 0; i < in.size(); i++)
+    in[i] = (unsigned char)(i * 7);
+
+  for (auto _ : state) {
+    rtl_convert(lut.data(), in.data(), out.data(), n);
+    benchmark::DoNotOptimize(out.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+/* hackrf_source_c::work(): s8 I/Q through a lookup table */
+static void BM_hackrf_s8_lut(benchmark::State &state)
+{
+  const int n = state.range(0);
+  std::vector<uint8_t> in(2 * n);
+  std::vector<gr_complex> out(n);
+  std::vector<float> lut;
+
+  hackrf_make_lut(lut);
+  for (size_t i = 0; i < in.size(); i++)
+    in[i] = (uint8_t)(i * 7);
+
+  for (auto _ : state) {
+    hackrf_lut_convert(lut.data(), in.data(), out.data(), n);
+    benchmark::DoNotOptimize(out.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+/* hackrf_sink_c::work(): fc32 -> s8 with the compiled-in SIMD kernel */
+static void BM_hackrf_sink_convert(benchmark::State &state)
+{
+  const unsigned int count = state.range(0);
+  std::vector<gr_complex> in(count, gr_complex(0.25f, -0.75f));
+  std::vector<int8_t> out(2 * count);
+
+  for (auto _ : state) {
+    float *f = (float *)in.data();
+    int8_t *buf = out.data();
+    unsigned int sse_rem = count/8;
+    unsigned int nosse_rem = count%8;
+
+#ifdef USE_AVX
+    convert_avx(f, buf, sse_rem);
+    convert_default(f + sse_rem*16, buf + sse_rem*16, nosse_rem*2);
+#elif USE_SSE2
+    convert_sse2(f, buf, sse_rem);
+    convert_default(f + sse_rem*16, buf + sse_rem*16, nosse_rem*2);
+#else
+    (void)sse_rem; (void)nosse_rem;
+    convert_default(f, buf, count*2);
+#endif
+
+    benchmark::DoNotOptimize(out.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+/* the scalar fallback, as the baseline for the SIMD kernels */
+static void BM_hackrf_sink_convert_default(benchmark::State &state)
+{
+  const unsigned int count = state.range(0);
+  std::vector<gr_complex> in(count, gr_complex(0.25f, -0.75f));
+  std::vector<int8_t> out(2 * count);
+
+  for (auto _ : state) {
+    convert_default((float *)in.data(), out.data(), count*2);
+    benchmark::DoNotOptimize(out.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+/* file_source_c: raw recordings converted straight out of the mapping */
+static void BM_file_source_convert(benchmark::State &state)
+{
+  const file_format_t format = (file_format_t)state.range(0);
+  const size_t n = state.range(1);
+  std::vector<unsigned char> in(n * file_format_size(format));
+  std::vector<gr_complex> out(n);
+
+  for (size_t i = 0; i < in.size(); i++)
+    in[i] = (unsigned char)(i * 7);
+
+  for (auto _ : state) {
+    convert_to_complex(format, in.data(), out.data(), n);
+    benchmark::DoNotOptimize(out.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+/* file_sink_c: fc32 quantised with saturation for the compact formats */
+static void BM_file_sink_convert(benchmark::State &state)
+{
+  const file_format_t format = (file_format_t)state.range(0);
+  const size_t n = state.range(1);
+  std::vector<gr_complex> in(n, gr_complex(0.25f, -0.75f));
+  std::vector<unsigned char> out(n * file_format_size(format));
+
+  for (auto _ : state) {
+    convert_from_complex(format, in.data(), out.data(), n, 1.0f);
+    benchmark::DoNotOptimize(out.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+/* file_source_c nchan=: interleaved frames split into one buffer per channel */
+static void BM_file_deinterleave(benchmark::State &state)
+{
+  const size_t nchan = state.range(0);
+  const size_t n = state.range(1);
+  std::vector<gr_complex> in(n * nchan, gr_complex(0.25f, -0.75f));
+  std::vector< std::vector<gr_complex> > out(nchan, std::vector<gr_complex>(n));
+  std::vector<gr_complex *> dst(nchan);
+
+  for (size_t c = 0; c < nchan; c++)
+    dst[c] = out[c].data();
+
+  for (auto _ : state) {
+    deinterleave_complex(in.data(), dst.data(), nchan, n);
+    benchmark::DoNotOptimize(dst.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * n * nchan);
+}
+
+/* file_sink_c compress=1: one block of a band limited cs16 capture */
+static std::vector<unsigned char> iqz_test_block(size_t n)
+{
+  std::vector<gr_complex> in(n);
+  std::vector<unsigned char> raw(n * file_format_size(FILE_CS16));
+
+  for (size_t i = 0; i < n; i++)
+    in[i] = gr_complex(0.3f * std::sin(0.01f * i) + 0.001f * (i * 7919 % 13),
+                       0.3f * std::cos(0.01f * i) - 0.001f * (i * 104729 % 11));
+
+  convert_from_complex(FILE_CS16, in.data(), raw.data(), n, 1.0f);
+
+  return raw;
+}
+
+static void BM_iqz_encode(benchmark::State &state)
+{
+  const size_t n = state.range(0);
+  std::vector<unsigned char> raw = iqz_test_block(n), coded;
+
+  for (auto _ : state) {
+    iqz_encode(FILE_CS16, raw.data(), n, coded);
+    benchmark::DoNotOptimize(coded.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * n);
+  state.counters["ratio"] = double(raw.size()) / coded.size();
+}
+
+static void BM_iqz_decode(benchmark::State &state)
+{
+  const size_t n = state.range(0);
+  std::vector<unsigned char> raw = iqz_test_block(n), coded, out(raw.size());
+  uint32_t crc = iqz_encode(FILE_CS16, raw.data(), n, coded);
+
+  for (auto _ : state) {
+    iqz_decode(FILE_CS16, coded.data(), coded.size(), crc, n, out.data());
+    benchmark::DoNotOptimize(out.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+/*
+ * airspy_source_c: the callback pushes each sample into a locked
+ * circular_buffer<gr_complex> on the device's allocator, work() pops
+ * them one by one.
+ */
+static void BM_airspy_fifo(benchmark::State &state)
+{
+  const size_t n = state.range(0);
+  std::vector<float> transfer(2 * n, 0.5f);
+  std::vector<gr_complex> out(n);
+  airspy_fifo_t fifo(5000000, buffer_allocator_adaptor<gr_complex>(buffer_allocator()));
+  std::mutex fifo_lock;
+
+  for (auto _ : state) {
+    {
+      std::lock_guard<std::mutex> lock(fifo_lock);
+      airspy_fifo_push(fifo, transfer.data(), n);
+    }
+    {
+      std::lock_guard<std::mutex> lock(fifo_lock);
+      airspy_fifo_pop(fifo, out.data(), n);
+    }
+    benchmark::DoNotOptimize(out.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+/* typical work() request sizes and the default USB transfer sizes */
+BENCHMARK(BM_rtl_u8_lut)->Arg(8192)->Arg(131072);
+BENCHMARK(BM_hackrf_s8_lut)->Arg(8192)->Arg(131072);
+BENCHMARK(BM_hackrf_sink_convert)->Arg(8191)->Arg(131072);
+BENCHMARK(BM_hackrf_sink_convert_default)->Arg(8191)->Arg(131072);
+BENCHMARK(BM_file_source_convert)
+    ->Args({FILE_CU8, 131072})->Args({FILE_CS8, 131072})
+    ->Args({FILE_CS16, 131072})->Args({FILE_CF32, 131072});
+BENCHMARK(BM_file_sink_convert)
+    ->Args({FILE_CU8, 131072})->Args({FILE_CS8, 131072})
+    ->Args({FILE_CS16, 131072});
+BENCHMARK(BM_file_deinterleave)
+    ->Args({2, 8192})->Args({3, 8192})->Args({4, 8192});
+BENCHMARK(BM_iqz_encode)->Arg(65536);
+BENCHMARK(BM_iqz_decode)->Arg(65536);
+BENCHMARK(BM_airspy_fifo)->Arg(8192)->Arg(65536);
+
+BENCHMARK_MAIN();
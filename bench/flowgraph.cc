@@ -0,0 +1,180 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * End to end runs of osmosdr::source / osmosdr::sink against the
+ * simulated device. Reports throughput per wall clock second and per
+ * CPU second of the whole process, and for the source the latency from
+ * the simulated transfer callback to the samples reaching the sink block
+ * (percentiles over all transfers).
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gnuradio/blocks/null_sink.h>
+#include <gnuradio/blocks/null_source.h>
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_block.h>
+#include <gnuradio/top_block.h>
+
+#include <osmosdr/sink.h>
+#include <osmosdr/source.h>
+
+static const std::chrono::seconds RUN_TIME(2);
+static const char *FORMATS[] = { "u8", "s8", "s16" };
+
+static double cpu_seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* sink recording the age of every "sim_time" tag as it arrives */
+class latency_probe : public gr::sync_block
+{
+public:
+  latency_probe() :
+    gr::sync_block("latency_probe",
+                   gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                   gr::io_signature::make(0, 0, 0)),
+    _key(pmt::string_to_symbol("sim_time"))
+  {
+  }
+
+  int work(int noutput_items,
+           gr_vector_const_void_star &input_items,
+           gr_vector_void_star &output_items)
+  {
+    uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch()).count();
+    std::vector<gr::tag_t> tags;
+
+    get_tags_in_range(tags, 0, nitems_read(0), nitems_read(0) + noutput_items, _key);
+    for (const gr::tag_t &tag : tags)
+      latency.push_back(now - pmt::to_uint64(tag.value));
+
+    return noutput_items;
+  }
+
+  std::vector<uint64_t> latency;
+
+private:
+  pmt::pmt_t _key;
+};
+
+static double percentile_us(std::vector<uint64_t> &v, double p)
+{
+  if (v.empty())
+    return 0;
+
+  size_t idx = std::min(v.size() - 1, size_t(p * v.size()));
+  std::nth_element(v.begin(), v.begin() + idx, v.end());
+
+  return v[idx] / 1e3;
+}
+
+static void BM_source_sim(benchmark::State &state)
+{
+  const std::string args = "sim=0,timestamps=1,rate=" +
+                           std::to_string(state.range(0)) +
+                           ",format=" + FORMATS[state.range(1)];
+
+  for (auto _ : state) {
+    gr::top_block_sptr tb = gr::make_top_block("bench_source");
+    osmosdr::source::sptr src = osmosdr::source::make(args);
+    std::shared_ptr<latency_probe> probe =
+      gnuradio::get_initial_sptr(new latency_probe());
+
+    src->set_sample_rate(state.range(0));
+    tb->connect(src, 0, probe, 0);
+
+    double cpu = cpu_seconds();
+    auto t0 = std::chrono::steady_clock::now();
+
+    tb->start();
+    std::this_thread::sleep_for(RUN_TIME);
+    tb->stop();
+    tb->wait();
+
+    double wall = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - t0).count();
+    cpu = cpu_seconds() - cpu;
+
+    double items = probe->nitems_read(0);
+
+    state.SetIterationTime(wall);
+    state.counters["MSps"] = items / wall / 1e6;
+    state.counters["MSps_per_core"] = items / cpu / 1e6;
+    state.counters["lat_p50_us"] = percentile_us(probe->latency, 0.50);
+    state.counters["lat_p99_us"] = percentile_us(probe->latency, 0.99);
+    state.counters["lat_p999_us"] = percentile_us(probe->latency, 0.999);
+  }
+}
+
+static void BM_sink_sim(benchmark::State &state)
+{
+  const std::string args = "sim=0,rate=" + std::to_string(state.range(0)) +
+                           ",format=" + FORMATS[state.range(1)];
+
+  for (auto _ : state) {
+    gr::top_block_sptr tb = gr::make_top_block("bench_sink");
+    gr::blocks::null_source::sptr src = gr::blocks::null_source::make(sizeof(gr_complex));
+    osmosdr::sink::sptr snk = osmosdr::sink::make(args);
+
+    snk->set_sample_rate(state.range(0));
+    tb->connect(src, 0, snk, 0);
+
+    double cpu = cpu_seconds();
+    auto t0 = std::chrono::steady_clock::now();
+
+    tb->start();
+    std::this_thread::sleep_for(RUN_TIME);
+    tb->stop();
+    tb->wait();
+
+    double wall = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - t0).count();
+    cpu = cpu_seconds() - cpu;
+
+    double items = src->nitems_written(0);
+
+    state.SetIterationTime(wall);
+    state.counters["MSps"] = items / wall / 1e6;
+    state.counters["MSps_per_core"] = items / cpu / 1e6;
+  }
+}
+
+/* {sample rate, format index} */
+BENCHMARK(BM_source_sim)
+  ->Args({2048000, 0})->Args({10000000, 1})->Args({20000000, 2})->Args({61440000, 2})
+  ->Iterations(1)->UseManualTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_sink_sim)
+  ->Args({10000000, 1})->Args({20000000, 2})
+  ->Iterations(1)->UseManualTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
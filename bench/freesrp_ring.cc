@@ -0,0 +1,176 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * FreeSRP buffering: the former per-sample ReaderWriterQueue path under a
+ * mutex against spsc_sample_ring with bulk volk conversion. Each iteration
+ * moves one USB transfer through the buffer, the way the driver callback
+ * and work() do, without threads so only the buffering cost is measured.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <complex>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <volk/volk.h>
+
+#include "readerwriterqueue/readerwriterqueue.h"
+#include "spsc_ring.h"
+
+typedef std::complex<float> gr_complex;
+
+/* layout of FreeSRP::sample, without pulling in libfreesrp */
+struct sample
+{
+  int16_t i;
+  int16_t q;
+};
+
+static const size_t QUEUE_SIZE = 16384;
+
+static std::vector<sample> make_transfer(size_t n)
+{
+  std::vector<sample> v(n);
+  for (size_t k = 0; k < n; ++k) {
+    v[k].i = int16_t(k % 4096 - 2048);
+    v[k].q = int16_t(2047 - k % 4096);
+  }
+  return v;
+}
+
+static void BM_rx_rwqueue(benchmark::State &state)
+{
+  const size_t n = state.range(0);
+  std::vector<sample> transfer = make_transfer(n);
+  std::vector<gr_complex> out(n);
+  moodycamel::ReaderWriterQueue<sample> queue(QUEUE_SIZE);
+  std::mutex mut;
+
+  for (auto _ : state) {
+    {
+      std::unique_lock<std::mutex> lk(mut);
+      for (const sample &s : transfer)
+        queue.try_enqueue(s);
+    }
+    {
+      std::unique_lock<std::mutex> lk(mut);
+      for (size_t k = 0; k < n; ++k) {
+        sample s;
+        queue.try_dequeue(s);
+        out[k] = gr_complex(float(s.i) / 2048.0f, float(s.q) / 2048.0f);
+      }
+    }
+    benchmark::DoNotOptimize(out.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+static void BM_rx_sample_ring(benchmark::State &state)
+{
+  const size_t n = state.range(0);
+  std::vector<sample> transfer = make_transfer(n);
+  std::vector<gr_complex> out(n);
+  spsc_sample_ring<sample> ring(QUEUE_SIZE);
+
+  for (auto _ : state) {
+    ring.write(transfer.data(), n);
+
+    size_t produced = 0;
+    while (produced < n) {
+      const sample *in;
+      size_t cnt = std::min(ring.read_span(in), n - produced);
+      volk_16i_s32f_convert_32f(reinterpret_cast<float *>(&out[produced]),
+                                reinterpret_cast<const int16_t *>(in),
+                                2048.0f, 2 * cnt);
+      ring.consume(cnt);
+      produced += cnt;
+    }
+    benchmark::DoNotOptimize(out.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+static void BM_tx_rwqueue(benchmark::State &state)
+{
+  const size_t n = state.range(0);
+  std::vector<gr_complex> in(n, gr_complex(0.5f, -0.5f));
+  std::vector<sample> transfer(n);
+  moodycamel::ReaderWriterQueue<sample> queue(QUEUE_SIZE);
+  std::mutex mut;
+
+  for (auto _ : state) {
+    {
+      std::unique_lock<std::mutex> lk(mut);
+      for (size_t k = 0; k < n; ++k) {
+        sample s;
+        s.i = int16_t(in[k].real() * 2047.0f);
+        s.q = int16_t(in[k].imag() * 2047.0f);
+        queue.try_enqueue(s);
+      }
+    }
+    {
+      std::unique_lock<std::mutex> lk(mut);
+      for (sample &s : transfer)
+        queue.try_dequeue(s);
+    }
+    benchmark::DoNotOptimize(transfer.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+static void BM_tx_sample_ring(benchmark::State &state)
+{
+  const size_t n = state.range(0);
+  std::vector<gr_complex> in(n, gr_complex(0.5f, -0.5f));
+  std::vector<sample> transfer(n);
+  spsc_sample_ring<sample> ring(QUEUE_SIZE);
+
+  for (auto _ : state) {
+    size_t consumed = 0;
+    while (consumed < n) {
+      sample *out;
+      size_t cnt = std::min(ring.write_span(out), n - consumed);
+      volk_32f_s32f_convert_16i(reinterpret_cast<int16_t *>(out),
+                                reinterpret_cast<const float *>(&in[consumed]),
+                                2047.0f, 2 * cnt);
+      ring.commit(cnt);
+      consumed += cnt;
+    }
+
+    ring.read(transfer.data(), n);
+    benchmark::DoNotOptimize(transfer.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+/* odd transfer sizes make the ring wrap at varying offsets */
+BENCHMARK(BM_rx_rwqueue)->Arg(1016)->Arg(4096);
+BENCHMARK(BM_rx_sample_ring)->Arg(1016)->Arg(4096);
+BENCHMARK(BM_tx_rwqueue)->Arg(1016)->Arg(4096);
+BENCHMARK(BM_tx_sample_ring)->Arg(1016)->Arg(4096);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,26 @@
+if(NOT PKG_CONFIG_FOUND)
+    INCLUDE(FindPkgConfig)
+endif()
+PKG_CHECK_MODULES(PC_LIBURING liburing)
+
+FIND_PATH(
+    LIBURING_INCLUDE_DIRS
+    NAMES liburing.h
+    HINTS $ENV{LIBURING_DIR}/include
+        ${PC_LIBURING_INCLUDEDIR}
+    PATHS /usr/local/include
+          /usr/include
+)
+
+FIND_LIBRARY(
+    LIBURING_LIBRARIES
+    NAMES uring
+    HINTS $ENV{LIBURING_DIR}/lib
+        ${PC_LIBURING_LIBDIR}
+    PATHS /usr/local/lib
+          /usr/lib
+)
+
+INCLUDE(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(LibURING DEFAULT_MSG LIBURING_LIBRARIES LIBURING_INCLUDE_DIRS)
+MARK_AS_ADVANCED(LIBURING_LIBRARIES LIBURING_INCLUDE_DIRS)
@@ -79,6 +79,11 @@ inputs:
 - domain: message
   id: command
   optional: true
+% if sourk == 'sink':
+- domain: message
+  id: trigger
+  optional: true
+% endif
 % if sourk == 'source':
 
 outputs:
@@ -160,12 +165,21 @@ documentation: |-
    * RTL2832U based DVB-T dongles through librtlsdr
    * RTL-TCP spectrum server (see librtlsdr project)
    * SDRplay RSP devices through SDRplay library
-   * gnuradio .cfile input through libgnuradio-blocks
+   * gnuradio .cfile and raw cu8/cs8/cs16 I/Q recordings (memory mapped)
+   * SigMF recordings, seekable by timestamp
+   * Losslessly compressed recordings (iqz), decoded in parallel
+   * Multi-channel recordings, interleaved or one file per channel
+   * Real-time replay in device sized bursts (throttle=true)
    * RFSPACE SDR-IQ, SDR-IP, NetSDR (incl. X2 option)
    * AirSpy Wideband Receiver through libairspy
   % endif
   % if sourk == 'sink':
-   * gnuradio .cfile output through libgnuradio-blocks
+   * gnuradio .cfile and compact cu8/cs8/cs16 I/Q recordings
+   * SigMF recordings with retunes and dropouts as capture segments
+   * Triggered recording of the seconds around an event from a RAM ring
+   * Gapless rotation into time stamped segments by size or duration
+   * Lossless compression (iqz) on a pool of encoder threads
+   * Multi-channel recordings, interleaved or one file per channel
   % endif
    * CCCamp 2015 rad1o Badge through libhackrf
    * Great Scott Gadgets HackRF through libhackrf
@@ -175,6 +189,8 @@ documentation: |-
    * Fairwaves UmTRX through Fairwaves' module for UHD
    * Red Pitaya SDR transceiver (http://bazaar.redpitaya.com)
    * FreeSRP through libfreesrp library
+   * Simulated device for testing without hardware
+   * Samples shared by another process through POSIX shared memory
 
   By using the osmocom $sourk block you can take advantage of a common software api in your application(s) independent of the underlying radio hardware.
 
@@ -196,15 +212,34 @@ documentation: |-
     rtl=1[,buffers=32][,buflen=N*512] ...
     rtl=2[,direct_samp=0|1|2][,offset_tune=0|1][,bias=0|1] ...
     rtl_tcp=127.0.0.1:1234[,psize=16384][,direct_samp=0|1|2][,offset_tune=0|1][,bias=0|1] ...
-    file='/path/to/your file',rate=1e6[,freq=100e6][,repeat=true][,throttle=true] ...
+    file='/path/to/your file',rate=1e6[,freq=100e6][,repeat=true][,throttle=true][,format=cu8|cs8|cs16|cf32] ...
+    file='/path/to/recording.sigmf-meta'[,repeat=true][,throttle=true] ...
+    file='/path/to/recording.iqz'[,decode_threads=4][,readahead=8] ...
+    file='/path/to/interleaved file'|file=...,file1=...[,file2=...],nchan=2 ...
+    file=...,rate=1e6,throttle=true[,transfer=131072][,pace_stats=10] ...
     netsdr=127.0.0.1[:50000][,nchan=2]
     sdr-ip=127.0.0.1[:50000]
     cloudiq=127.0.0.1[:50000]
     sdr-iq=/dev/ttyUSB0
     airspy=0[,bias=0|1][,linearity][,sensitivity]
+    sim=0[,tone=100.1e6][,tone_level=-20][,noise=-50]
+    rtl|hackrf|airspy|airspyhf|sdr-iq=...[,record='/path/to/capture']
+    rtl|hackrf|airspy|airspyhf|sdr-iq[,replay='/path/to/capture'][,replay_speed=1.0|0][,replay_loop=0|1]
+    rtl|hackrf|airspy[,replay='/path/to/capture'][,replay_unplug_after=10][,replay_unplug_for=1.0] (exercise reattach)
+    rtl|hackrf|airspy|airspyhf=...[,publish=name][,publish_slots=64][,publish_slot_size=262144] (see osmocom_shm_broker)
+    shm=name (attach to samples published by another process)
+    rtl|hackrf|airspy|...=...,timeshift=300[,timeshift_file='/path/to/ring'][,timeshift_format=cu8|cs8|cs16|cf32]
+    rewind='/path/to/ring'[,nchan=2][,start=-30][,throttle=true] (see source.time_shift())
   % endif
+    rtl|hackrf|airspy|file|...=...,timed_cmds=1 (emulate set_command_time() in the sample stream)
   % if sourk == 'sink':
-    file='/path/to/your file',rate=1e6[,freq=100e6][,append=true][,throttle=true] ...
+    file='/path/to/your file',rate=1e6[,freq=100e6][,append=true][,throttle=true][,format=cu8|cs8|cs16|cf32][,full_scale=1.0][,sigmf=1] ...
+    file=...[,writer=sync|async][,io_buffers=3][,io_buffer_size=4e6][,direct=1][,prealloc=1e9][,io_uring=0][,io_stats=10]
+    file=...,rate=1e6,pretrigger=5[,posttrigger=10][,trigger_tag=trigger][,hugepages=1] ...
+    file=...,rate=1e6[,rotate_size=1e9][,rotate_time=3600] ...
+    file=...,format=cu8|cs8|cs16,compress=1[,compress_threads=4][,compress_block=65536] ...
+    file='/path/to/interleaved file'|file=...,file1=...[,file2=...],nchan=2 ...
+    file=...,rate=1e6,throttle=true[,transfer=131072][,pace_stats=10] ...
   % endif
     redpitaya=192.168.1.100[:1001]
     freesrp=0[,fx3='path/to/fx3.img',fpga='path/to/fpga.bin',loopback]
@@ -212,6 +247,12 @@ documentation: |-
     bladerf=0[,tamer=internal|external|external_1pps][,smb=25e6]
     uhd[,serial=...][,lo_offset=0][,mcr=52e6][,nchan=2][,subdev='\\\\'B:0 A:0\\\\''] ...
     xtrx
+    sim=0[,rate=2.048e6][,format=u8|s8|s16][,transfer=131072][,buffers=15][,jitter=us][,retune_latency=us] ...
+    any device[,trace='/path/to/trace.json'] (builds with ENABLE_TRACE only, or set OSMOSDR_TRACE)
+    rtl|hackrf|airspy|airspyhf|rfspace|sdrplay|freesrp|bladerf|sim=...[,cpu=2|2-3|1:5][,rt_prio=1..99][,sched=fifo|rr|other]
+    rtl|hackrf|airspy|airspyhf|sdr-iq|sim=...[,hugepages=1][,mlock=1][,numa=0]
+    rtl|airspy|airspyhf=...[,watchdog=10] (stall timeout in transfer intervals, 0 disables; restarts are tagged rx_gap)
+    rtl|hackrf|airspy=...[,reconnect=30] (seconds to wait for an unplugged device to return by serial, 0 disables)
 
   Num Channels:
   Selects the total number of channels in this multi-device configuration. Required when specifying multiple device arguments.
@@ -371,6 +371,25 @@ public:
    * \param time_spec the new time
    */
   virtual void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec) = 0;
+
+  /*!
+   * Set the time at which subsequent frequency and gain changes take
+   * effect. Commands issued until clear_command_time() is called form one
+   * batch which is applied to all addressed channels at the same time.
+   * Devices without hardware support opened with timed_cmds=1 have the
+   * batch applied in their sample stream, before the first sample at or
+   * after the given time. Without it they apply the commands immediately.
+   * \param time_spec the time at which the commands take effect
+   * \param mboard the motherboard index 0 to M-1
+   */
+  virtual void set_command_time(const ::osmosdr::time_spec_t &time_spec,
+                                size_t mboard = osmosdr::ALL_MBOARDS) = 0;
+
+  /*!
+   * Clear the command time so subsequent commands are applied immediately.
+   * \param mboard the motherboard index 0 to M-1
+   */
+  virtual void clear_command_time(size_t mboard = osmosdr::ALL_MBOARDS) = 0;
 };
 
 } /* namespace osmosdr */
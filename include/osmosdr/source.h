@@ -68,6 +68,18 @@ public:
    */
   virtual bool seek( long seek_point, int whence, size_t chan = 0 ) = 0;
 
+  /*!
+   * \brief seek file to the sample taken at \p time
+   *
+   * Recordings with timestamps (SigMF captures) are searched for the
+   * absolute time, for all others \p time counts from the first sample.
+   *
+   * \param time	the time to seek to
+   * \param chan	the channel index 0 to N-1
+   * \return true on success
+   */
+  virtual bool seek_time( const ::osmosdr::time_spec_t &time, size_t chan = 0 ) = 0;
+
   /*!
    * Get the possible sample rates for the underlying radio hardware.
    * \return a range of rates in Sps
@@ -416,6 +428,40 @@ public:
    * \param time_spec the new time
    */
   virtual void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec) = 0;
+
+  /*!
+   * Set the time at which subsequent frequency and gain changes take
+   * effect. Commands issued until clear_command_time() is called form one
+   * batch which is applied to all addressed channels at the same time.
+   * Devices without hardware support opened with timed_cmds=1 have the
+   * batch applied in their sample stream, at the first sample at or after
+   * the given time, which is tagged rx_time and, on retuned channels,
+   * rx_freq. Without it they apply the commands immediately.
+   * \param time_spec the time at which the commands take effect
+   * \param mboard the motherboard index 0 to M-1
+   */
+  virtual void set_command_time(const ::osmosdr::time_spec_t &time_spec,
+                                size_t mboard = osmosdr::ALL_MBOARDS) = 0;
+
+  /*!
+   * Clear the command time so subsequent commands are applied immediately.
+   * \param mboard the motherboard index 0 to M-1
+   */
+  virtual void clear_command_time(size_t mboard = osmosdr::ALL_MBOARDS) = 0;
+
+  /*!
+   * \brief play back the time-shift buffer from \p time on
+   *
+   * A device opened with timeshift=<seconds> keeps that many seconds of
+   * its channels in a ring file on disk. This returns a new source that
+   * streams them from the sample taken at \p time on, at the capture
+   * rate and that far behind the live stream, while capture goes on.
+   *
+   * \param time	UTC time of the first sample to play
+   * \param chan	any channel index 0 to N-1 of the device
+   * \return the playback source, with one output per device channel
+   */
+  virtual sptr time_shift( const ::osmosdr::time_spec_t &time, size_t chan = 0 ) = 0;
 };
 
 } /* namespace osmosdr */
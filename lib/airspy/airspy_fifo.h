@@ -0,0 +1,66 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_AIRSPY_FIFO_H
+#define INCLUDED_AIRSPY_FIFO_H
+
+/*
+ * The sample FIFO between the airspy callback and work(), kept apart
+ * from the block so that bench/ can measure it without libairspy. The
+ * caller holds the lock around both sides.
+ */
+
+#include <complex>
+
+#include <boost/circular_buffer.hpp>
+
+#include "buffer_allocator.h"
+
+typedef boost::circular_buffer< std::complex<float>,
+                                buffer_allocator_adaptor< std::complex<float> > > airspy_fifo_t;
+
+/* takes as many interleaved float I/Q samples as fit, returns the count */
+static inline size_t airspy_fifo_push(airspy_fifo_t &fifo, const float *sample,
+                                      size_t num_samples)
+{
+  size_t n_avail = fifo.capacity() - fifo.size();
+  size_t to_copy = (n_avail < num_samples ? n_avail : num_samples);
+
+  for (size_t i = 0; i < to_copy; i++)
+  {
+    fifo.push_back( std::complex<float>( *sample, *(sample+1) ) );
+
+    /* offset to the next I+Q sample */
+    sample += 2;
+  }
+
+  return to_copy;
+}
+
+/* the caller has made sure that n samples are there */
+static inline void airspy_fifo_pop(airspy_fifo_t &fifo, std::complex<float> *out,
+                                   size_t n)
+{
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = fifo.at(0);
+    fifo.pop_front();
+  }
+}
+
+#endif /* INCLUDED_AIRSPY_FIFO_H */
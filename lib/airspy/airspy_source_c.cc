@@ -42,6 +42,7 @@
 #include "airspy_fir_kernels.h"
 
 #include "arg_helpers.h"
+#include "trace.h"
 
 using namespace boost::assign;
 
@@ -85,6 +86,9 @@ airspy_source_c::airspy_source_c (const std::string &args)
         gr::io_signature::make(MIN_IN, MAX_IN, sizeof (gr_complex)),
         gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof (gr_complex))),
     _dev(NULL),
+    _serial(0),
+    _bias(-1),
+    _pack(-1),
     _sample_rate(0),
     _center_freq(0),
     _freq_corr(0),
@@ -99,6 +103,23 @@ airspy_source_c::airspy_source_c (const std::string &args)
 
   dict_t dict = params_to_dict(args);
 
+  if ( dict.count( "record" ) )
+    _record_path = dict["record"];
+
+  _sched = thread_sched( dict );
+  _watchdog.configure( dict );
+
+  _publisher = shm_publisher::make( args, "airspy" );
+
+  _replay = transfer_player::make( args, "airspy" );
+  if ( _replay ) {
+    /* replaying a capture, no device is opened */
+    _sample_rate = _replay->sample_rate();
+    _sample_rates.push_back( std::pair<double, uint32_t>( _sample_rate, 0 ) );
+    _fifo = new fifo_t(5000000, buffer_allocator_adaptor<gr_complex>(buffer_allocator(dict)));
+    return;
+  }
+
   _dev = NULL;
   ret = airspy_open( &_dev );
   AIRSPY_THROW_ON_ERROR(ret, "Failed to open AirSpy device")
@@ -111,11 +132,12 @@ airspy_source_c::airspy_source_c (const std::string &args)
   memset(version, 0, sizeof(version));
   ret = airspy_version_string_read( _dev, version, sizeof(version));
   AIRSPY_THROW_ON_ERROR(ret, "Failed to read version string")
-#if 0
+
+  /* only needed to find the same board again after a replug */
   airspy_read_partid_serialno_t part_serial;
-  ret = airspy_board_partid_serialno_read( _dev, &part_serial );
-  AIRSPY_THROW_ON_ERROR(ret, "Failed to read serial number")
-#endif
+  if ( airspy_board_partid_serialno_read( _dev, &part_serial ) == AIRSPY_SUCCESS )
+    _serial = (uint64_t(part_serial.serial_no[2]) << 32) | part_serial.serial_no[3];
+
   uint32_t num_rates;
   airspy_get_samplerates(_dev, &num_rates, 0);
   uint32_t *samplerates = (uint32_t *) malloc(num_rates * sizeof(uint32_t));
@@ -155,6 +177,7 @@ airspy_source_c::airspy_source_c (const std::string &args)
   {
     bool bias = boost::lexical_cast<bool>( dict["bias"] );
     int ret = airspy_set_rf_bias(_dev, (uint8_t)bias);
+    _bias = bias;
     AIRSPY_THROW_ON_ERROR(ret, "Failed to enable DC bias")
   }
 
@@ -165,10 +188,11 @@ airspy_source_c::airspy_source_c (const std::string &args)
   {
     bool pack = boost::lexical_cast<bool>( dict["pack"] );
     int ret = airspy_set_packing(_dev, (uint8_t)pack);
+    _pack = pack;
     AIRSPY_THROW_ON_ERROR(ret, "Failed to set USB bit packing")
   }
 
-  _fifo = new boost::circular_buffer<gr_complex>(5000000);
+  _fifo = new fifo_t(5000000, buffer_allocator_adaptor<gr_complex>(buffer_allocator(dict)));
   if (!_fifo) {
     throw std::runtime_error( std::string(__FUNCTION__) + " " +
                               "Failed to allocate a sample FIFO!" );
@@ -200,6 +224,9 @@ airspy_source_c::~airspy_source_c ()
     _dev = NULL;
   }
 
+  if (_replay)
+    _replay->stop();
+
   if (_fifo)
   {
     delete _fifo;
@@ -211,27 +238,32 @@ int airspy_source_c::_airspy_rx_callback(airspy_transfer *transfer)
 {
   airspy_source_c *obj = (airspy_source_c *)transfer->ctx;
 
+  obj->_sched.apply_once( "airspy rx" );
+
+  if (obj->_recorder)
+    obj->_recorder->record( transfer->samples,
+                            transfer->sample_count * 2 * sizeof(float) );
+
+  if (obj->_publisher)
+    obj->_publisher->publish( transfer->samples,
+                              transfer->sample_count * 2 * sizeof(float),
+                              obj->_sample_rate, obj->_center_freq );
+
   return obj->airspy_rx_callback((float *)transfer->samples, transfer->sample_count);
 }
 
 int airspy_source_c::airspy_rx_callback(void *samples, int sample_count)
 {
-  size_t i, n_avail, to_copy, num_samples = sample_count;
-  float *sample = (float *)samples;
+  OSMOSDR_TRACE_SCOPE( "airspy", "callback" );
+  _watchdog.transfer( sample_count, _sample_rate );
+
+  size_t to_copy;
 
   _fifo_lock.lock();
 
-  n_avail = _fifo->capacity() - _fifo->size();
-  to_copy = (n_avail < num_samples ? n_avail : num_samples);
+  to_copy = airspy_fifo_push( *_fifo, (const float *)samples, sample_count );
 
-  for (i = 0; i < to_copy; i++ )
-  {
-    /* Push sample to the fifo */
-    _fifo->push_back( gr_complex( *sample, *(sample+1) ) );
-
-    /* offset to the next I+Q sample */
-    sample += 2;
-  }
+  OSMOSDR_TRACE_COUNTER( "airspy", "fifo samples", this, _fifo->size() );
 
   _fifo_lock.unlock();
 
@@ -242,7 +274,7 @@ int airspy_source_c::airspy_rx_callback(void *samples, int sample_count)
   }
 
   /* Indicate overrun, if neccesary */
-  if (to_copy < num_samples)
+  if (to_copy < (size_t)sample_count)
     std::cerr << "O" << std::flush;
 
   return 0; // TODO: return -1 on error/stop
@@ -250,6 +282,30 @@ int airspy_source_c::airspy_rx_callback(void *samples, int sample_count)
 
 bool airspy_source_c::start()
 {
+  _sched.reset();
+  _watchdog.reset();
+
+  if ( ! _record_path.empty() && ! _recorder )
+    _recorder.reset( new transfer_recorder( _record_path, "airspy",
+                                            get_sample_rate() ) );
+
+  if ( _replay ) {
+    _replay->start(
+      [this](unsigned char *buf, size_t len) {
+        airspy_transfer transfer = {};
+        transfer.ctx = this;
+        transfer.samples = buf;
+        transfer.sample_count = len / (2 * sizeof(float));
+        transfer.sample_type = AIRSPY_SAMPLE_FLOAT32_IQ;
+        _airspy_rx_callback( &transfer );
+      },
+      [this]() {
+        { std::lock_guard<std::mutex> lock( _fifo_lock ); }
+        _samp_avail.notify_one();
+      } );
+    return true;
+  }
+
   if ( ! _dev )
     return false;
 
@@ -264,6 +320,11 @@ bool airspy_source_c::start()
 
 bool airspy_source_c::stop()
 {
+  if ( _replay ) {
+    _replay->stop();
+    return true;
+  }
+
   if ( ! _dev )
     return false;
 
@@ -280,15 +341,22 @@ int airspy_source_c::work( int noutput_items,
                         gr_vector_const_void_star &input_items,
                         gr_vector_void_star &output_items )
 {
+  OSMOSDR_TRACE_SCOPE( "airspy", "work" );
   gr_complex *out = (gr_complex *)output_items[0];
 
   bool running = false;
 
   if ( _dev )
     running = (airspy_is_streaming( _dev ) == AIRSPY_TRUE);
-
-  if ( ! running )
-    return WORK_DONE;
+  else if ( _replay )
+    running = _replay->running();
+
+  if ( ! running ) {
+    bool lost = _replay ? _replay->unplugged() : _dev != NULL;
+    if ( ! lost || ! reattach() )
+      return WORK_DONE;
+    return 0;
+  }
 
   std::unique_lock<std::mutex> lock(_fifo_lock);
 
@@ -296,20 +364,152 @@ int airspy_source_c::work( int noutput_items,
   int n_samples_avail = _fifo->size();
 
   while (n_samples_avail < noutput_items) {
-    _samp_avail.wait(lock);
+    if ( _replay && ! _replay->running() )
+      return _replay->unplugged() ? 0 : WORK_DONE;
+
+    if ( _replay || ! _watchdog.enabled() ) {
+      _samp_avail.wait(lock);
+    } else {
+      _samp_avail.wait_for( lock, _watchdog.timeout( _sample_rate ) / 4 );
+
+      /* let the next call drain the fifo and look for the device */
+      if ( airspy_is_streaming( _dev ) != AIRSPY_TRUE )
+        return 0;
+
+      if ( _fifo->size() < (size_t)noutput_items &&
+           _watchdog.stalled( _sample_rate ) ) {
+        lock.unlock();
+        bool restarted = restart_stream();
+        lock.lock();
+
+        if ( ! restarted )
+          return WORK_DONE;
+      }
+    }
+
     n_samples_avail = _fifo->size();
   }
 
-  for(int i = 0; i < noutput_items; ++i) {
-    out[i] = _fifo->at(0);
-    _fifo->pop_front();
-  }
+  airspy_fifo_pop( *_fifo, out, noutput_items );
+
+  int64_t gap = _watchdog.gap_offset( noutput_items );
+  if ( gap >= 0 )
+    add_item_tag( 0, nitems_written(0) + gap, stream_watchdog::gap_key(),
+                  pmt::from_uint64( _watchdog.lost() ) );
+
+  OSMOSDR_TRACE_COUNTER( "airspy", "fifo samples", this, _fifo->size() );
 
   //std::cerr << "-" << std::flush;
 
   return noutput_items;
 }
 
+/* the device is streaming but no transfers arrive, start over in place */
+bool airspy_source_c::restart_stream()
+{
+  std::cerr << "airspy: no samples for " << _watchdog.stall_seconds()
+            << " s, restarting stream" << std::endl;
+
+  airspy_stop_rx( _dev );
+
+  /* whatever is still buffered predates the stall */
+  {
+    std::lock_guard<std::mutex> lock( _fifo_lock );
+    _watchdog.restarted( _fifo->size() );
+  }
+
+  /* reapply the cached settings, the device may have been reset */
+  try {
+    restore_settings();
+  } catch ( std::exception &ex ) {
+    std::cerr << ex.what() << std::endl;
+    return false;
+  }
+
+  int ret = airspy_start_rx( _dev, _airspy_rx_callback, (void *)this );
+  if ( ret != AIRSPY_SUCCESS ) {
+    std::cerr << "Failed to restart RX streaming (" << ret << ")" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+/* streaming ended on its own, the board most likely went off the bus.
+ * A replay with replay_unplug_after= takes the same path. */
+bool airspy_source_c::reattach()
+{
+  if ( ( ! _serial && ! _replay ) || ! _watchdog.may_reattach() )
+    return false;
+
+  if ( _replay )
+    std::cerr << "airspy: replay device lost, waiting for it to return"
+              << std::endl;
+  else
+    std::cerr << boost::format( "airspy: device %016x lost, waiting for it to return" )
+                 % _serial << std::endl;
+
+  if ( _dev ) {
+    airspy_close( _dev );
+    _dev = NULL;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock( _fifo_lock );
+    _watchdog.restarted( _fifo->size() );
+  }
+
+  bool found = _watchdog.reattach( [this]() {
+    if ( _replay )
+      return _replay->replugged();
+    return airspy_open_sn( &_dev, _serial ) == AIRSPY_SUCCESS;
+  } );
+
+  if ( ! found ) {
+    std::cerr << "airspy: device did not return" << std::endl;
+    return false;
+  }
+
+  if ( _replay ) {
+    _replay->resume();
+    std::cerr << "airspy: device is back" << std::endl;
+    return true;
+  }
+
+  try {
+    if ( _pack >= 0 )
+      airspy_set_packing( _dev, (uint8_t)_pack );
+    if ( _bias >= 0 )
+      airspy_set_rf_bias( _dev, (uint8_t)_bias );
+
+    restore_settings();
+    set_lna_gain( _lna_gain );
+    set_mix_gain( _mix_gain );
+    set_bandwidth( _bandwidth );
+  } catch ( std::exception &ex ) {
+    std::cerr << ex.what() << std::endl;
+  }
+
+  int ret = airspy_start_rx( _dev, _airspy_rx_callback, (void *)this );
+  if ( ret != AIRSPY_SUCCESS ) {
+    std::cerr << "Failed to restart RX streaming (" << ret << ")" << std::endl;
+    return false;
+  }
+
+  std::cerr << "airspy: device is back" << std::endl;
+
+  return true;
+}
+
+void airspy_source_c::restore_settings()
+{
+  set_sample_rate( _sample_rate );
+  set_center_freq( _center_freq );
+  set_gain_mode( _auto_gain );
+  if ( ! _auto_gain )
+    set_if_gain( _vga_gain );
+}
+
 std::vector<std::string> airspy_source_c::get_devices()
 {
   std::vector<std::string> devices;
@@ -480,11 +680,15 @@ osmosdr::gain_range_t airspy_source_c::get_gain_range( const std::string & name,
 bool airspy_source_c::set_gain_mode( bool automatic, size_t chan )
 {
   if ( automatic ) {
+    if ( _dev ) {
       airspy_set_lna_agc( _dev, 1 );
       airspy_set_mixer_agc( _dev, 1 );
+    }
   } else {
+    if ( _dev ) {
       airspy_set_lna_agc( _dev, 0 );
       airspy_set_mixer_agc( _dev, 0 );
+    }
 
       set_lna_gain( _lna_gain );
       set_mix_gain( _mix_gain );
@@ -686,7 +890,7 @@ double airspy_source_c::set_bandwidth( double bandwidth, size_t chan )
       size = KERNEL_16_110_LEN;
     }
 
-    if (size)
+    if (size && _dev)
     {
       std::cerr << "  Airspy decim:" << decim
                 << "  kernel size:" << size << std::endl;
@@ -22,8 +22,7 @@
 #ifndef INCLUDED_AIRSPY_SOURCE_C_H
 #define INCLUDED_AIRSPY_SOURCE_C_H
 
-#include <boost/circular_buffer.hpp>
-
+#include <memory>
 #include <mutex>
 #include <condition_variable>
 
@@ -32,6 +31,12 @@
 #include <libairspy/airspy.h>
 
 #include "source_iface.h"
+#include "airspy_fifo.h"
+#include "buffer_allocator.h"
+#include "stream_watchdog.h"
+#include "thread_sched.h"
+#include "shm_ring.h"
+#include "transfer_capture.h"
 
 class airspy_source_c;
 
@@ -124,11 +129,25 @@ public:
 
 private:
   static int _airspy_rx_callback(airspy_transfer* transfer);
+  bool restart_stream();
+  bool reattach();
+  void restore_settings();
   int airspy_rx_callback(void *samples, int sample_count);
 
   airspy_device *_dev;
-
-  boost::circular_buffer<gr_complex> *_fifo;
+  uint64_t _serial; /* 0 if it could not be read */
+  int _bias;
+  int _pack;
+
+  thread_sched _sched;
+  stream_watchdog _watchdog;
+  std::string _record_path;
+  std::unique_ptr<transfer_recorder> _recorder;
+  std::unique_ptr<shm_publisher> _publisher;
+  std::unique_ptr<transfer_player> _replay;
+
+  typedef airspy_fifo_t fifo_t;
+  fifo_t *_fifo;
   std::mutex _fifo_lock;
   std::condition_variable _samp_avail;
 
@@ -40,6 +40,7 @@
 
 #include "airspyhf_source_c.h"
 #include "arg_helpers.h"
+#include "trace.h"
 
 using namespace boost::assign;
 
@@ -90,6 +91,23 @@ airspyhf_source_c::airspyhf_source_c (const std::string &args)
 
   dict_t dict = params_to_dict(args);
 
+  if ( dict.count( "record" ) )
+    _record_path = dict["record"];
+
+  _sched = thread_sched( dict );
+  _watchdog.configure( dict );
+
+  _publisher = shm_publisher::make( args, "airspyhf" );
+
+  _replay = transfer_player::make( args, "airspyhf" );
+  if ( _replay ) {
+    /* replaying a capture, no device is opened */
+    _sample_rate = _replay->sample_rate();
+    _sample_rates.push_back( std::pair<double, uint32_t>( _sample_rate, 0 ) );
+    _fifo = new fifo_t(5000000, buffer_allocator_adaptor<gr_complex>(buffer_allocator(dict)));
+    return;
+  }
+
   _dev = NULL;
   ret = airspyhf_open( &_dev );
   AIRSPYHF_THROW_ON_ERROR(ret, "Failed to open Airspy HF+ device")
@@ -116,7 +134,7 @@ airspyhf_source_c::airspyhf_source_c (const std::string &args)
   set_center_freq( (get_freq_range().start() + get_freq_range().stop()) / 2.0 );
   set_sample_rate( get_sample_rates().start() );
 
-  _fifo = new boost::circular_buffer<gr_complex>(5000000);
+  _fifo = new fifo_t(5000000, buffer_allocator_adaptor<gr_complex>(buffer_allocator(dict)));
   if (!_fifo) {
     throw std::runtime_error( std::string(__FUNCTION__) + " " +
                               "Failed to allocate a sample FIFO!" );
@@ -148,6 +166,9 @@ airspyhf_source_c::~airspyhf_source_c ()
     _dev = NULL;
   }
 
+  if (_replay)
+    _replay->stop();
+
   if (_fifo)
   {
     delete _fifo;
@@ -159,11 +180,25 @@ int airspyhf_source_c::_airspyhf_rx_callback(airspyhf_transfer_t *transfer)
 {
   airspyhf_source_c *obj = (airspyhf_source_c *)transfer->ctx;
 
+  obj->_sched.apply_once( "airspyhf rx" );
+
+  if (obj->_recorder)
+    obj->_recorder->record( transfer->samples,
+                            transfer->sample_count * 2 * sizeof(float) );
+
+  if (obj->_publisher)
+    obj->_publisher->publish( transfer->samples,
+                              transfer->sample_count * 2 * sizeof(float),
+                              obj->_sample_rate, obj->_center_freq );
+
   return obj->airspyhf_rx_callback((float *)transfer->samples, transfer->sample_count);
 }
 
 int airspyhf_source_c::airspyhf_rx_callback(void *samples, int sample_count)
 {
+  OSMOSDR_TRACE_SCOPE( "airspyhf", "callback" );
+  _watchdog.transfer( sample_count, _sample_rate );
+
   size_t i, n_avail, to_copy, num_samples = sample_count;
   float *sample = (float *)samples;
 
@@ -181,6 +216,8 @@ int airspyhf_source_c::airspyhf_rx_callback(void *samples, int sample_count)
     sample += 2;
   }
 
+  OSMOSDR_TRACE_COUNTER( "airspyhf", "fifo samples", this, _fifo->size() );
+
   _fifo_lock.unlock();
 
   /* We have made some new samples available to the consumer in work() */
@@ -198,6 +235,29 @@ int airspyhf_source_c::airspyhf_rx_callback(void *samples, int sample_count)
 
 bool airspyhf_source_c::start()
 {
+  _sched.reset();
+  _watchdog.reset();
+
+  if ( ! _record_path.empty() && ! _recorder )
+    _recorder.reset( new transfer_recorder( _record_path, "airspyhf",
+                                            get_sample_rate() ) );
+
+  if ( _replay ) {
+    _replay->start(
+      [this](unsigned char *buf, size_t len) {
+        airspyhf_transfer_t transfer = {};
+        transfer.ctx = this;
+        transfer.samples = (airspyhf_complex_float_t *)buf;
+        transfer.sample_count = len / (2 * sizeof(float));
+        _airspyhf_rx_callback( &transfer );
+      },
+      [this]() {
+        { std::lock_guard<std::mutex> lock( _fifo_lock ); }
+        _samp_avail.notify_one();
+      } );
+    return true;
+  }
+
   if ( ! _dev )
     return false;
 
@@ -212,6 +272,11 @@ bool airspyhf_source_c::start()
 
 bool airspyhf_source_c::stop()
 {
+  if ( _replay ) {
+    _replay->stop();
+    return true;
+  }
+
   if ( ! _dev )
     return false;
 
@@ -228,12 +293,15 @@ int airspyhf_source_c::work( int noutput_items,
                         gr_vector_const_void_star &input_items,
                         gr_vector_void_star &output_items )
 {
+  OSMOSDR_TRACE_SCOPE( "airspyhf", "work" );
   gr_complex *out = (gr_complex *)output_items[0];
 
   bool running = false;
 
   if ( _dev )
     running = airspyhf_is_streaming( _dev );
+  else if ( _replay )
+    running = _replay->running();
 
   if ( ! running )
     return WORK_DONE;
@@ -244,7 +312,25 @@ int airspyhf_source_c::work( int noutput_items,
   int n_samples_avail = _fifo->size();
 
   while (n_samples_avail < noutput_items) {
-    _samp_avail.wait(lock);
+    if ( _replay && ! _replay->running() )
+      return WORK_DONE;
+
+    if ( _replay || ! _watchdog.enabled() ) {
+      _samp_avail.wait(lock);
+    } else {
+      _samp_avail.wait_for( lock, _watchdog.timeout( _sample_rate ) / 4 );
+
+      if ( _fifo->size() < (size_t)noutput_items &&
+           _watchdog.stalled( _sample_rate ) ) {
+        lock.unlock();
+        bool restarted = restart_stream();
+        lock.lock();
+
+        if ( ! restarted )
+          return WORK_DONE;
+      }
+    }
+
     n_samples_avail = _fifo->size();
   }
 
@@ -253,9 +339,49 @@ int airspyhf_source_c::work( int noutput_items,
     _fifo->pop_front();
   }
 
+  int64_t gap = _watchdog.gap_offset( noutput_items );
+  if ( gap >= 0 )
+    add_item_tag( 0, nitems_written(0) + gap, stream_watchdog::gap_key(),
+                  pmt::from_uint64( _watchdog.lost() ) );
+
+  OSMOSDR_TRACE_COUNTER( "airspyhf", "fifo samples", this, _fifo->size() );
+
   return noutput_items;
 }
 
+/* the device is streaming but no transfers arrive, start over in place */
+bool airspyhf_source_c::restart_stream()
+{
+  std::cerr << "airspyhf: no samples for " << _watchdog.stall_seconds()
+            << " s, restarting stream" << std::endl;
+
+  airspyhf_stop( _dev );
+
+  /* whatever is still buffered predates the stall */
+  {
+    std::lock_guard<std::mutex> lock( _fifo_lock );
+    _watchdog.restarted( _fifo->size() );
+  }
+
+  /* reapply the cached settings, the device may have been reset */
+  try {
+    set_sample_rate( _sample_rate );
+    set_freq_corr( _freq_corr );
+    set_center_freq( _center_freq );
+  } catch ( std::exception &ex ) {
+    std::cerr << ex.what() << std::endl;
+    return false;
+  }
+
+  int ret = airspyhf_start( _dev, _airspyhf_rx_callback, (void *)this );
+  if ( ret != AIRSPYHF_SUCCESS ) {
+    std::cerr << "Failed to restart RX streaming (" << ret << ")" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
 std::vector<std::string> airspyhf_source_c::get_devices()
 {
   std::vector<std::string> devices;
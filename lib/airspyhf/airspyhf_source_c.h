@@ -24,6 +24,7 @@
 
 #include <boost/circular_buffer.hpp>
 
+#include <memory>
 #include <mutex>
 #include <condition_variable>
 
@@ -32,6 +33,11 @@
 #include <libairspyhf/airspyhf.h>
 
 #include "source_iface.h"
+#include "buffer_allocator.h"
+#include "stream_watchdog.h"
+#include "thread_sched.h"
+#include "shm_ring.h"
+#include "transfer_capture.h"
 
 class airspyhf_source_c;
 
@@ -101,11 +107,20 @@ public:
 
 private:
   static int _airspyhf_rx_callback(airspyhf_transfer_t* transfer);
+  bool restart_stream();
   int airspyhf_rx_callback(void *samples, int sample_count);
 
   airspyhf_device *_dev;
 
-  boost::circular_buffer<gr_complex> *_fifo;
+  thread_sched _sched;
+  stream_watchdog _watchdog;
+  std::string _record_path;
+  std::unique_ptr<transfer_recorder> _recorder;
+  std::unique_ptr<shm_publisher> _publisher;
+  std::unique_ptr<transfer_player> _replay;
+
+  typedef boost::circular_buffer< gr_complex, buffer_allocator_adaptor< gr_complex > > fifo_t;
+  fifo_t *_fifo;
   std::mutex _fifo_lock;
   std::condition_variable _samp_avail;
 
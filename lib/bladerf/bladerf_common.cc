@@ -28,6 +28,8 @@
 #include "config.h"
 #endif
 
+#include <algorithm>
+#include <cmath>
 #include <iomanip>
 #include <iostream>
 #include <map>
@@ -38,6 +40,10 @@
 #include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
 
+#if defined(USE_AVX) || defined(USE_SSE2)
+#include <emmintrin.h>
+#endif
+
 #include "bladerf_common.h"
 
 /* Defaults for these values. */
@@ -129,6 +135,86 @@ size_t num_streams(bladerf_channel_layout layout)
 #endif
 }
 
+void sc16_to_fc32_deinterleave(gr_complex **out, int16_t const *in,
+                               size_t nitems, size_t nstreams, float scale)
+{
+  float const mult = 1.0f / scale;
+  size_t i = 0;
+
+#if defined(USE_AVX) || defined(USE_SSE2)
+  if (2 == nstreams) {
+    /* Each 128 bit load holds two frames of [I_a Q_a I_b Q_b], i.e. two
+     * samples for each of both channels */
+    __m128 const mulme = _mm_set1_ps(mult);
+    float *out_a = reinterpret_cast<float *>(out[0]);
+    float *out_b = reinterpret_cast<float *>(out[1]);
+
+    for (; i + 2 <= nitems; i += 2) {
+      __m128i raw = _mm_loadu_si128(reinterpret_cast<__m128i const *>(&in[4*i]));
+
+      /* sign-extend int16 to int32 by unpacking into the upper halves */
+      __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(raw, raw), 16);
+      __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(raw, raw), 16);
+
+      __m128 f0 = _mm_mul_ps(_mm_cvtepi32_ps(lo), mulme); /* a0 b0 */
+      __m128 f1 = _mm_mul_ps(_mm_cvtepi32_ps(hi), mulme); /* a1 b1 */
+
+      _mm_storeu_ps(&out_a[2*i], _mm_movelh_ps(f0, f1));
+      _mm_storeu_ps(&out_b[2*i], _mm_movehl_ps(f1, f0));
+    }
+  }
+#endif
+
+  for (; i < nitems; ++i) {
+    for (size_t n = 0; n < nstreams; ++n) {
+      int16_t const *s = &in[2*(i*nstreams + n)];
+      out[n][i] = gr_complex(s[0] * mult, s[1] * mult);
+    }
+  }
+}
+
+static inline int16_t _float_to_sc16(float v)
+{
+  v = std::max(-32768.0f, std::min(32767.0f, v));
+  return static_cast<int16_t>(std::lrint(v));
+}
+
+void fc32_to_sc16_interleave(int16_t *out, gr_complex const **in,
+                             size_t nitems, size_t nstreams, float scale)
+{
+  size_t i = 0;
+
+#if defined(USE_AVX) || defined(USE_SSE2)
+  if (2 == nstreams) {
+    /* Two samples from each channel yield one 128 bit store of
+     * [I_a0 Q_a0 I_b0 Q_b0 I_a1 Q_a1 I_b1 Q_b1] */
+    __m128 const mulme = _mm_set1_ps(scale);
+    float const *in_a = reinterpret_cast<float const *>(in[0]);
+    float const *in_b = reinterpret_cast<float const *>(in[1]);
+
+    for (; i + 2 <= nitems; i += 2) {
+      __m128 a = _mm_loadu_ps(&in_a[2*i]); /* a0 a1 */
+      __m128 b = _mm_loadu_ps(&in_b[2*i]); /* b0 b1 */
+
+      __m128i f0 = _mm_cvtps_epi32(_mm_mul_ps(_mm_movelh_ps(a, b), mulme));
+      __m128i f1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_movehl_ps(b, a), mulme));
+
+      /* packs saturates to the int16 range, as volk does */
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(&out[4*i]),
+                       _mm_packs_epi32(f0, f1));
+    }
+  }
+#endif
+
+  for (; i < nitems; ++i) {
+    for (size_t n = 0; n < nstreams; ++n) {
+      int16_t *d = &out[2*(i*nstreams + n)];
+      d[0] = _float_to_sc16(in[n][i].real() * scale);
+      d[1] = _float_to_sc16(in[n][i].imag() * scale);
+    }
+  }
+}
+
 /******************************************************************************
  * Public methods
  ******************************************************************************/
@@ -140,7 +226,9 @@ bladerf_common::bladerf_common() :
   _samples_per_buffer(NUM_SAMPLES_PER_BUFFER),
   _num_transfers(NUM_TRANSFERS),
   _stream_timeout(STREAM_TIMEOUT_MS),
-  _format(BLADERF_FORMAT_SC16_Q11)
+  _format(BLADERF_FORMAT_SC16_Q11),
+  _cmd_timed(false),
+  _cmd_timestamp(0)
 {
 }
 
@@ -317,6 +405,9 @@ void bladerf_common::init(dict_t const &dict, bladerf_direction direction)
     _format = BLADERF_FORMAT_SC16_Q11_META;
   }
 
+  /* cpu=, rt_prio=, sched= for the stream=async thread */
+  _sched = thread_sched(dict);
+
   /* Require value to be >= 2 so we can ensure we have twice as many
    * buffers as transfers */
   if (_num_buffers <= 1) {
@@ -607,6 +698,18 @@ double bladerf_common::set_center_freq(double freq, bladerf_channel ch)
   if (freqint < freq_range(ch).start() || freqint > freq_range(ch).stop()) {
     BLADERF_WARNING(boost::str(boost::format("Frequency %d Hz is outside "
                     "range, ignoring") % freqint));
+#ifndef BLADERF_COMPATIBILITY
+  } else if (_cmd_timed) {
+    status = bladerf_schedule_retune(_dev.get(), ch, _cmd_timestamp, freqint,
+                                     NULL);
+    if (status != 0) {
+      BLADERF_THROW_STATUS(status, boost::str(boost::format("Failed to "
+                    "schedule retune to %d Hz") % freqint));
+    }
+
+    /* the device reports the new frequency only once the retune happened */
+    return freq;
+#endif
   } else {
     status = bladerf_set_frequency(_dev.get(), ch, freqint);
     if (status != 0) {
@@ -618,6 +721,40 @@ double bladerf_common::set_center_freq(double freq, bladerf_channel ch)
   return get_center_freq(ch);
 }
 
+bool bladerf_common::set_command_time(osmosdr::time_spec_t const &time_spec,
+                                     bladerf_channel ch)
+{
+#ifdef BLADERF_COMPATIBILITY
+  return false;
+#else
+  int status;
+  bladerf_timestamp now;
+
+  status = bladerf_get_timestamp(_dev.get(),
+                                 _is_tx(ch) ? BLADERF_TX : BLADERF_RX, &now);
+  if (status != 0) {
+    BLADERF_WARN_STATUS(status, "Failed to read device timestamp");
+    return false;
+  }
+
+  /* The bladeRF has no absolute time base, so get_time_now() is the host
+   * clock. Map the command time onto the sample counter from there. */
+  double delta = (time_spec - osmosdr::time_spec_t::get_system_time())
+                  .get_real_secs();
+
+  _cmd_timestamp = now + static_cast<uint64_t>(std::max(0.0, delta) *
+                                               get_sample_rate(ch));
+  _cmd_timed = true;
+
+  return true;
+#endif
+}
+
+void bladerf_common::clear_command_time()
+{
+  _cmd_timed = false;
+}
+
 double bladerf_common::get_center_freq(bladerf_channel ch)
 {
   int status;
@@ -805,6 +942,10 @@ double bladerf_common::set_gain(double gain,
 {
   int status;
 
+  if (_cmd_timed) {
+    BLADERF_WARNING("Gain changes cannot be scheduled, applying immediately");
+  }
+
 #ifdef BLADERF_COMPATIBILITY
   if( name == "LNA" ) {
     bladerf_lna_gain g;
@@ -30,8 +30,12 @@
 
 #include <libbladeRF.h>
 
+#include <gnuradio/gr_complex.h>
+
 #include "osmosdr/ranges.h"
+#include "osmosdr/time_spec.h"
 #include "arg_helpers.h"
+#include "thread_sched.h"
 
 #include "bladerf_compat.h"
 
@@ -97,6 +101,16 @@ typedef std::map<bladerf_channel, int> bladerf_channel_map;
 /* Given a bladerf_channel_layout, calculate the number of streams */
 size_t num_streams(bladerf_channel_layout layout);
 
+/* Convert nitems interleaved SC16 samples per stream from in into the
+ * per-stream gr_complex buffers out[0..nstreams-1] in a single pass */
+void sc16_to_fc32_deinterleave(gr_complex **out, int16_t const *in,
+                               size_t nitems, size_t nstreams, float scale);
+
+/* Convert nitems gr_complex samples per stream from in[0..nstreams-1] into
+ * one saturated, interleaved SC16 buffer in a single pass */
+void fc32_to_sc16_interleave(int16_t *out, gr_complex const **in,
+                             size_t nitems, size_t nstreams, float scale);
+
 /**
  * Common class for bladeRF interaction
  */
@@ -127,8 +141,12 @@ protected:
    * USB INTERFACE CONTROL:
    *  buffers         (default: NUM_BUFFERS)
    *  buflen          (default: NUM_SAMPLES_PER_BUFFER)
+   *  stream          sync, async (default: sync)
+   *                    ** Note: valid on receive channels only
    *  stream_timeout  valid time in milliseconds (default: 3000)
    *  transfers       (default: NUM_TRANSFERS)
+   *  cpu, rt_prio,   affinity and scheduling of the stream thread, see
+   *  sched           thread_sched (stream=async only)
    * FPGA CONTROL:
    *  enable_metadata 1 to enable metadata
    *  fpga            a path to a valid .rbf file
@@ -189,6 +207,12 @@ protected:
   /* Get the center RF frequency of channel ch */
   double get_center_freq(bladerf_channel ch);
 
+  /* Schedule subsequent retunes for time_spec, false if unsupported */
+  bool set_command_time(osmosdr::time_spec_t const &time_spec,
+                        bladerf_channel ch);
+  /* Return to retuning immediately */
+  void clear_command_time();
+
   /* Get range of supported bandwidths for channel ch */
   osmosdr::freq_range_t filter_bandwidths(bladerf_channel ch);
   /* Set the bandwidth on channel ch to bandwidth */
@@ -254,9 +278,14 @@ protected:
 
   bladerf_format _format;       /**< sample format to use */
 
+  bool _cmd_timed;              /**< retunes are scheduled at _cmd_timestamp */
+  uint64_t _cmd_timestamp;      /**< device timestamp for scheduled retunes */
+
   bladerf_channel_map _chanmap; /**< map of antennas to channels */
   bladerf_channel_enable_map _enables;  /**< enabled channels */
 
+  thread_sched _sched;          /**< settings for the stream thread */
+
   /*****************************************************************************
    * Protected constants
    ****************************************************************************/
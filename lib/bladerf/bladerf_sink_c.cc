@@ -69,7 +69,6 @@ bladerf_sink_c::bladerf_sink_c(const std::string &args) :
                   args_to_io_signature(args),
                   gr::io_signature::make(0, 0, 0)),
   _16icbuf(NULL),
-  _32fcbuf(NULL),
   _in_burst(false),
   _running(false)
 {
@@ -186,7 +185,6 @@ bool bladerf_sink_c::start()
   size_t alignment = volk_get_alignment();
 
   _16icbuf = reinterpret_cast<int16_t *>(volk_malloc(2*_samples_per_buffer*sizeof(int16_t), alignment));
-  _32fcbuf = reinterpret_cast<gr_complex *>(volk_malloc(_samples_per_buffer*sizeof(gr_complex), alignment));
 
   _running = true;
 
@@ -220,9 +218,7 @@ bool bladerf_sink_c::stop()
 
   /* Deallocate conversion memory */
   volk_free(_16icbuf);
-  volk_free(_32fcbuf);
   _16icbuf = NULL;
-  _32fcbuf = NULL;
 
   return true;
 }
@@ -241,28 +237,19 @@ int bladerf_sink_c::work(int noutput_items,
     return 0;
   }
 
-  // copy the samples from input_items
+  // convert floating point to fixed point and scale
   gr_complex const **in = reinterpret_cast<gr_complex const **>(&input_items[0]);
 
   if (nstreams > 1) {
-    // we need to interleave the streams as we copy
-    gr_complex *intl_out = _32fcbuf;
-
-    for (size_t i = 0; i < (noutput_items/nstreams); ++i) {
-      for (size_t n = 0; n < nstreams; ++n) {
-        memcpy(intl_out++, in[n]++, sizeof(gr_complex));
-      }
-    }
+    // interleave the streams as we convert
+    fc32_to_sc16_interleave(_16icbuf, in, noutput_items/nstreams,
+                            nstreams, SCALING_FACTOR);
   } else {
-    // no interleaving to do: simply copy everything
-    memcpy(_32fcbuf, in[0], noutput_items * sizeof(gr_complex));
+    // input_items is gr_complex (2x float), so num_points is 2*noutput_items
+    volk_32f_s32f_convert_16i(_16icbuf, reinterpret_cast<float const *>(in[0]),
+                              SCALING_FACTOR, 2*noutput_items);
   }
 
-  // convert floating point to fixed point and scale
-  // input_items is gr_complex (2x float), so num_points is 2*noutput_items
-  volk_32f_s32f_convert_16i(_16icbuf, reinterpret_cast<float const *>(_32fcbuf),
-                            SCALING_FACTOR, 2*noutput_items);
-
   // transmit the samples from the temp buffer
   if (BLADERF_FORMAT_SC16_Q11_META == _format) {
     status = transmit_with_tags(_16icbuf, noutput_items);
@@ -588,6 +575,27 @@ std::string bladerf_sink_c::get_clock_source(size_t mboard)
   return bladerf_common::get_clock_source(mboard);
 }
 
+bool bladerf_sink_c::has_timed_commands()
+{
+#ifdef BLADERF_COMPATIBILITY
+  return false;
+#else
+  return true;
+#endif
+}
+
+bool bladerf_sink_c::set_command_time(const osmosdr::time_spec_t &time_spec,
+                                       size_t mboard)
+{
+  return bladerf_common::set_command_time(time_spec,
+                                          chan2channel(BLADERF_TX, 0));
+}
+
+void bladerf_sink_c::clear_command_time(size_t mboard)
+{
+  bladerf_common::clear_command_time();
+}
+
 void bladerf_sink_c::set_biastee_mode(const std::string &mode)
 {
   int status;
@@ -117,6 +117,11 @@ public:
   void set_clock_source(const std::string &source, size_t mboard = 0);
   std::string get_clock_source(size_t mboard);
 
+  bool has_timed_commands();
+  bool set_command_time(const osmosdr::time_spec_t &time_spec,
+                        size_t mboard = 0);
+  void clear_command_time(size_t mboard = 0);
+
   void set_biastee_mode(const std::string &mode);
 
 private:
@@ -124,7 +129,6 @@ private:
 
   // Sample-handling buffers
   int16_t *_16icbuf;              /**< raw samples to bladeRF */
-  gr_complex *_32fcbuf;           /**< intermediate buffer for conversions */
 
   bool _in_burst;                 /**< are we currently in a burst? */
   bool _running;                  /**< is the sink running? */
@@ -28,6 +28,8 @@
 #include "config.h"
 #endif
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 
 #include <boost/assign.hpp>
@@ -69,7 +71,12 @@ bladerf_source_c::bladerf_source_c(const std::string &args) :
                   gr::io_signature::make(0, 0, 0),
                   args_to_io_signature(args)),
   _16icbuf(NULL),
-  _32fcbuf(NULL),
+  _async(false),
+  _stream(NULL),
+  _stream_bufs(NULL),
+  _streaming(false),
+  _cur_buf(NULL),
+  _cur_offset(0),
   _running(false),
   _agcmode(BLADERF_GAIN_DEFAULT)
 {
@@ -101,6 +108,21 @@ bladerf_source_c::bladerf_source_c(const std::string &args) :
     }
   }
 
+  /* Handle selection of the streaming interface */
+  if (dict.count("stream")) {
+    if (dict["stream"] == "async") {
+      _async = true;
+    } else if (dict["stream"] != "sync") {
+      BLADERF_WARNING("Invalid stream mode: " + dict["stream"]);
+    }
+  }
+
+  if (_async && BLADERF_FORMAT_SC16_Q11_META == _format) {
+    BLADERF_WARNING("Metadata is not supported with stream=async, "
+                    "falling back to the synchronous interface");
+    _async = false;
+  }
+
   /* Bias tee */
   if (dict.count("biastee")) {
     set_biastee_mode(dict["biastee"]);
@@ -221,6 +243,10 @@ bool bladerf_source_c::start()
 
   gr::thread::scoped_lock guard(d_mutex);
 
+  if (_async) {
+    return start_async();
+  }
+
   status = bladerf_sync_config(_dev.get(), _layout, _format, _num_buffers,
                                _samples_per_buffer, _num_transfers,
                                _stream_timeout);
@@ -242,7 +268,6 @@ bool bladerf_source_c::start()
   size_t alignment = volk_get_alignment();
 
   _16icbuf = reinterpret_cast<int16_t *>(volk_malloc(2*_samples_per_buffer*sizeof(int16_t), alignment));
-  _32fcbuf = reinterpret_cast<gr_complex *>(volk_malloc(_samples_per_buffer*sizeof(gr_complex), alignment));
 
   _running = true;
 
@@ -264,6 +289,10 @@ bool bladerf_source_c::stop()
 
   _running = false;
 
+  if (_async) {
+    return stop_async();
+  }
+
   for (size_t ch = 0; ch < get_max_channels(); ++ch) {
     bladerf_channel brfch = BLADERF_CHANNEL_RX(ch);
     if (get_channel_enable(brfch)) {
@@ -276,9 +305,7 @@ bool bladerf_source_c::stop()
 
   /* Deallocate conversion memory */
   volk_free(_16icbuf);
-  volk_free(_32fcbuf);
   _16icbuf = NULL;
-  _32fcbuf = NULL;
 
   return true;
 }
@@ -299,6 +326,11 @@ int bladerf_source_c::work(int noutput_items,
     return 0;
   }
 
+  if (_async) {
+    return work_async(noutput_items,
+                      reinterpret_cast<gr_complex **>(&output_items[0]));
+  }
+
   // set up metadata
   if (BLADERF_FORMAT_SC16_Q11_META == _format) {
     memset(&meta, 0, sizeof(meta));
@@ -322,29 +354,247 @@ int bladerf_source_c::work(int noutput_items,
     _failures = 0;
   }
 
-  // convert from int16_t to float
-  // output_items is gr_complex (2x float), so num_points is 2*noutput_items
-  volk_16i_s32f_convert_32f(reinterpret_cast<float *>(_32fcbuf), _16icbuf,
-                            SCALING_FACTOR, 2*noutput_items);
-
-  // copy the samples into output_items
+  // convert from int16_t to float directly into output_items
   gr_complex **out = reinterpret_cast<gr_complex **>(&output_items[0]);
 
   if (nstreams > 1) {
-    // we need to deinterleave the multiplex as we copy
-    gr_complex const *deint_in = _32fcbuf;
+    // deinterleave the multiplex as we convert
+    sc16_to_fc32_deinterleave(out, _16icbuf, noutput_items/nstreams,
+                              nstreams, SCALING_FACTOR);
+  } else {
+    // output_items is gr_complex (2x float), so num_points is 2*noutput_items
+    volk_16i_s32f_convert_32f(reinterpret_cast<float *>(out[0]), _16icbuf,
+                              SCALING_FACTOR, 2*noutput_items);
+  }
+
+  return noutput_items;
+}
+
+/*
+ * Asynchronous streaming: libbladeRF owns _num_buffers buffers and keeps
+ * _num_transfers of them in flight. The callback hands every completed
+ * buffer to work() through _filled and resubmits one taken from _free,
+ * which work() refills once a buffer has been converted. Neither side
+ * takes a lock on the data path.
+ *
+ * When work() holds every other buffer the callback, as the producer,
+ * cannot take one back from the consumer side of _filled. It therefore
+ * drops the transfer that just completed, i.e. the newest samples, and
+ * resubmits its buffer.
+ */
+bool bladerf_source_c::start_async()
+{
+  int status;
+
+  status = bladerf_init_stream(&_stream, _dev.get(), _stream_callback,
+                               &_stream_bufs, _num_buffers, _format,
+                               _samples_per_buffer, _num_transfers, this);
+  if (status != 0) {
+    BLADERF_THROW_STATUS(status, "bladerf_init_stream failed");
+  }
+
+  status = bladerf_set_stream_timeout(_dev.get(), BLADERF_RX, _stream_timeout);
+  if (status != 0) {
+    BLADERF_WARN_STATUS(status, "bladerf_set_stream_timeout failed");
+  }
+
+  for (size_t ch = 0; ch < get_max_channels(); ++ch) {
+    bladerf_channel brfch = BLADERF_CHANNEL_RX(ch);
+    if (get_channel_enable(brfch)) {
+      status = bladerf_enable_module(_dev.get(), brfch, true);
+      if (status != 0) {
+        bladerf_deinit_stream(_stream);
+        _stream = NULL;
+        BLADERF_THROW_STATUS(status, "bladerf_enable_module failed");
+      }
+    }
+  }
+
+  /* The first _num_transfers buffers are submitted by bladerf_stream() */
+  _filled.reset(_num_buffers);
+  _free.reset(_num_buffers);
+  for (size_t i = _num_transfers; i < _num_buffers; ++i) {
+    _free.push(static_cast<int16_t *>(_stream_bufs[i]));
+  }
+
+  _cur_buf = NULL;
+  _cur_offset = 0;
+  _failures = 0;
+
+  _streaming = true;
+  _running = true;
+  _sched.reset();
+  _stream_thread = gr::thread::thread(_stream_wait, this);
+
+  return true;
+}
+
+bool bladerf_source_c::stop_async()
+{
+  int status;
 
-    for (size_t i = 0; i < (noutput_items/nstreams); ++i) {
-      for (size_t n = 0; n < nstreams; ++n) {
-        memcpy(out[n]++, deint_in++, sizeof(gr_complex));
+  /* the callback returns BLADERF_STREAM_SHUTDOWN on its next invocation */
+  _streaming = false;
+  _stream_cond.notify_one();
+
+  if (_stream_thread.joinable()) {
+    _stream_thread.join();
+  }
+
+  for (size_t ch = 0; ch < get_max_channels(); ++ch) {
+    bladerf_channel brfch = BLADERF_CHANNEL_RX(ch);
+    if (get_channel_enable(brfch)) {
+      status = bladerf_enable_module(_dev.get(), brfch, false);
+      if (status != 0) {
+        BLADERF_WARN_STATUS(status, "bladerf_enable_module failed");
       }
     }
-  } else {
-    // no deinterleaving to do: simply copy everything
-    memcpy(out[0], _32fcbuf, sizeof(gr_complex) * noutput_items);
   }
 
-  return noutput_items;
+  if (_stream) {
+    bladerf_deinit_stream(_stream);
+  }
+
+  _stream = NULL;
+  _stream_bufs = NULL;
+  _cur_buf = NULL;
+
+  return true;
+}
+
+void *bladerf_source_c::_stream_callback(struct bladerf *dev,
+                                         struct bladerf_stream *stream,
+                                         struct bladerf_metadata *meta,
+                                         void *samples, size_t num_samples,
+                                         void *user_data)
+{
+  bladerf_source_c *obj = static_cast<bladerf_source_c *>(user_data);
+  return obj->stream_callback(samples, num_samples);
+}
+
+void *bladerf_source_c::stream_callback(void *samples, size_t num_samples)
+{
+  int16_t *next;
+
+  /* libbladeRF may run callbacks on a thread of its own */
+  _sched.apply_once("bladerf rx");
+
+  if (!_streaming) {
+    return BLADERF_STREAM_SHUTDOWN;
+  }
+
+  if (NULL == samples) {
+    /* nothing was handed to us, keep the transfer going */
+    return _free.pop(next) ? next : BLADERF_STREAM_SHUTDOWN;
+  }
+
+  if (!_free.pop(next)) {
+    /* work() holds every other buffer: drop the newest transfer */
+    std::cerr << "O" << std::flush;
+    return samples;
+  }
+
+  /* _filled has room for all buffers, so this cannot fail */
+  _filled.push(static_cast<int16_t *>(samples));
+
+  /* an empty critical section orders us against a sleeping work() */
+  { std::lock_guard<std::mutex> lock(_stream_mutex); }
+  _stream_cond.notify_one();
+
+  return next;
+}
+
+void bladerf_source_c::_stream_wait(bladerf_source_c *obj)
+{
+  obj->stream_wait();
+}
+
+void bladerf_source_c::stream_wait()
+{
+  int status;
+
+  _sched.apply("bladerf stream");
+
+  status = bladerf_stream(_stream, _layout);
+
+  if (status != 0) {
+    BLADERF_WARNING("bladerf_stream returned with: " << bladerf_strerror(status));
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(_stream_mutex);
+    _streaming = false;
+  }
+
+  _stream_cond.notify_one();
+}
+
+int bladerf_source_c::work_async(int noutput_items, gr_complex **out)
+{
+  size_t nstreams = num_streams(_layout);
+  size_t items_per_buffer = _samples_per_buffer / nstreams;
+  int produced = 0;
+
+  /* output_multiple is get_num_channels(), keep the per-stream count even */
+  noutput_items /= nstreams;
+
+  while (produced < noutput_items) {
+    if (NULL == _cur_buf) {
+      if (!_filled.pop(_cur_buf)) {
+        if (produced > 0) {
+          break;
+        }
+
+        std::unique_lock<std::mutex> lock(_stream_mutex);
+
+        bool ready = _stream_cond.wait_for(lock,
+                      std::chrono::milliseconds(_stream_timeout),
+                      [this] { return !_filled.empty() || !_streaming; });
+
+        if (!_filled.empty()) {
+          continue;
+        }
+
+        if (!_streaming) {
+          BLADERF_WARNING("Asynchronous stream terminated. Shutting down.");
+          return WORK_DONE;
+        }
+
+        if (!ready && ++_failures >= MAX_CONSECUTIVE_FAILURES) {
+          BLADERF_WARNING("Consecutive error limit hit. Shutting down.");
+          return WORK_DONE;
+        }
+
+        return 0;
+      }
+
+      _cur_offset = 0;
+      _failures = 0;
+    }
+
+    size_t n = std::min(static_cast<size_t>(noutput_items - produced),
+                        items_per_buffer - _cur_offset);
+    int16_t const *in = _cur_buf + 2 * nstreams * _cur_offset;
+
+    // convert straight out of the libbladeRF buffer into output_items
+    if (nstreams > 1) {
+      gr_complex *dst[2] = { out[0] + produced, out[1] + produced };
+      sc16_to_fc32_deinterleave(dst, in, n, nstreams, SCALING_FACTOR);
+    } else {
+      volk_16i_s32f_convert_32f(reinterpret_cast<float *>(out[0] + produced),
+                                in, SCALING_FACTOR, 2*n);
+    }
+
+    produced += n;
+    _cur_offset += n;
+
+    if (_cur_offset == items_per_buffer) {
+      _free.push(_cur_buf);
+      _cur_buf = NULL;
+    }
+  }
+
+  return produced;
 }
 
 osmosdr::meta_range_t bladerf_source_c::get_sample_rates()
@@ -553,6 +803,27 @@ std::string bladerf_source_c::get_clock_source(size_t mboard)
   return bladerf_common::get_clock_source(mboard);
 }
 
+bool bladerf_source_c::has_timed_commands()
+{
+#ifdef BLADERF_COMPATIBILITY
+  return false;
+#else
+  return true;
+#endif
+}
+
+bool bladerf_source_c::set_command_time(const osmosdr::time_spec_t &time_spec,
+                                       size_t mboard)
+{
+  return bladerf_common::set_command_time(time_spec,
+                                          chan2channel(BLADERF_RX, 0));
+}
+
+void bladerf_source_c::clear_command_time(size_t mboard)
+{
+  bladerf_common::clear_command_time();
+}
+
 void bladerf_source_c::set_biastee_mode(const std::string &mode)
 {
   int status;
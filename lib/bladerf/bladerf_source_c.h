@@ -22,7 +22,14 @@
 #define INCLUDED_BLADERF_SOURCE_C_H
 
 #include <gnuradio/sync_block.h>
+#include <gnuradio/thread/thread.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
 #include "source_iface.h"
+#include "spsc_ring.h"
 #include "bladerf_common.h"
 
 #include "osmosdr/ranges.h"
@@ -120,6 +127,11 @@ public:
   void set_clock_source(const std::string &source, size_t mboard = 0);
   std::string get_clock_source(size_t mboard);
 
+  bool has_timed_commands();
+  bool set_command_time(const osmosdr::time_spec_t &time_spec,
+                        size_t mboard = 0);
+  void clear_command_time(size_t mboard = 0);
+
   void set_biastee_mode(const std::string &mode);
 
   void set_loopback_mode(const std::string &loopback);
@@ -127,9 +139,34 @@ public:
   void set_agc_mode(const std::string &agcmode);
 
 private:
+  /* Asynchronous stream mode (stream=async) */
+  bool start_async();
+  bool stop_async();
+  int work_async(int noutput_items, gr_complex **out);
+
+  static void *_stream_callback(struct bladerf *dev,
+                                struct bladerf_stream *stream,
+                                struct bladerf_metadata *meta,
+                                void *samples, size_t num_samples,
+                                void *user_data);
+  void *stream_callback(void *samples, size_t num_samples);
+  static void _stream_wait(bladerf_source_c *obj);
+  void stream_wait();
+
   // Sample-handling buffers
   int16_t *_16icbuf;              /**< raw samples from bladeRF */
-  gr_complex *_32fcbuf;           /**< intermediate buffer to gnuradio */
+
+  bool _async;                    /**< use the asynchronous stream API */
+  struct bladerf_stream *_stream; /**< async stream handle */
+  void **_stream_bufs;            /**< buffers owned by libbladeRF */
+  gr::thread::thread _stream_thread; /**< runs bladerf_stream() */
+  std::atomic<bool> _streaming;   /**< async stream is alive */
+  spsc_ring<int16_t *> _filled;   /**< callback -> work(): full buffers */
+  spsc_ring<int16_t *> _free;     /**< work() -> callback: empty buffers */
+  int16_t *_cur_buf;              /**< buffer currently being converted */
+  size_t _cur_offset;             /**< items per stream consumed from it */
+  std::mutex _stream_mutex;       /**< only used to sleep on _stream_cond */
+  std::condition_variable _stream_cond; /**< signalled on new buffers */
 
   bool _running;                  /**< is the source running? */
   bladerf_channel_layout _layout; /**< channel layout */
@@ -0,0 +1,165 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#include "buffer_allocator.h"
+
+#define CACHE_LINE      64
+#define HUGE_PAGE_SIZE  (2 * 1024 * 1024)
+#define MPOL_BIND_      2 /* from numaif.h, spares us the libnuma dependency */
+
+buffer_allocator::buffer_allocator() :
+  _hugepages(false), _lock(false), _numa_node(-1)
+{
+}
+
+buffer_allocator::buffer_allocator( const dict_t &dict ) :
+  _hugepages(false), _lock(false), _numa_node(-1)
+{
+  dict_t::const_iterator it;
+
+  if ( (it = dict.find( "hugepages" )) != dict.end() )
+    _hugepages = (it->second != "0");
+
+  if ( (it = dict.find( "mlock" )) != dict.end() )
+    _lock = (it->second != "0");
+
+  if ( (it = dict.find( "numa" )) != dict.end() )
+    _numa_node = atoi( it->second.c_str() );
+
+#ifndef __linux__
+  if ( _hugepages || _lock || _numa_node >= 0 )
+    std::cerr << "hugepages=, mlock= and numa= are not supported on this platform"
+              << std::endl;
+  _hugepages = _lock = false;
+  _numa_node = -1;
+#endif
+}
+
+size_t buffer_allocator::mapped_size( size_t len ) const
+{
+#if defined(_WIN32)
+  return len;
+#else
+  size_t page = _hugepages ? HUGE_PAGE_SIZE : sysconf( _SC_PAGESIZE );
+  return (len + page - 1) / page * page;
+#endif
+}
+
+void *buffer_allocator::allocate( size_t len ) const
+{
+  if ( ! len )
+    len = 1;
+
+#if defined(_WIN32)
+  void *ptr = _aligned_malloc( len, CACHE_LINE );
+  if ( ! ptr )
+    throw std::bad_alloc();
+  memset( ptr, 0, len );
+  return ptr;
+#else
+  size_t size = mapped_size( len );
+  void *ptr = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+  if ( _hugepages ) {
+    ptr = mmap( NULL, size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+
+    if ( MAP_FAILED == ptr )
+      std::cerr << "No huge pages reserved (vm.nr_hugepages), "
+                << "using transparent huge pages" << std::endl;
+  }
+#endif
+
+  if ( MAP_FAILED == ptr ) {
+    ptr = mmap( NULL, size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+
+    if ( MAP_FAILED == ptr )
+      throw std::bad_alloc();
+
+#ifdef MADV_HUGEPAGE
+    if ( _hugepages )
+      madvise( ptr, size, MADV_HUGEPAGE );
+#endif
+  }
+
+#if defined(__linux__) && defined(SYS_mbind)
+  if ( _numa_node >= 0 ) {
+    unsigned long mask[16] = { 0 };
+    const unsigned long bits = sizeof(mask) * 8;
+
+    if ( (unsigned long)_numa_node < bits ) {
+      mask[_numa_node / (sizeof(long) * 8)] |= 1UL << (_numa_node % (sizeof(long) * 8));
+
+      if ( syscall( SYS_mbind, ptr, size, MPOL_BIND_, mask, bits, 0 ) != 0 )
+        std::cerr << "Failed to bind buffer to NUMA node " << _numa_node
+                  << ": " << strerror( errno ) << std::endl;
+    } else {
+      std::cerr << "Invalid NUMA node " << _numa_node << std::endl;
+    }
+  }
+#endif
+
+  /* fault every page in now, on the right node, rather than while streaming */
+  memset( ptr, 0, size );
+
+  if ( _lock && mlock( ptr, size ) != 0 )
+    std::cerr << "Failed to lock " << size << " bytes of sample buffer: "
+              << strerror( errno ) << " (check ulimit -l)" << std::endl;
+
+  return ptr;
+#endif
+}
+
+void buffer_allocator::deallocate( void *ptr, size_t len ) const
+{
+  if ( ! ptr )
+    return;
+
+#if defined(_WIN32)
+  _aligned_free( ptr );
+#else
+  if ( ! len )
+    len = 1;
+
+  munmap( ptr, mapped_size( len ) ); /* implies munlock */
+#endif
+}
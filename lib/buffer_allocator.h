@@ -0,0 +1,128 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_BUFFER_ALLOCATOR_H
+#define INCLUDED_OSMOSDR_BUFFER_ALLOCATOR_H
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "arg_helpers.h"
+
+/*!
+ * \brief Allocator for the per-device sample rings.
+ *
+ * Memory is at least cache-line aligned and every page is touched when
+ * it is handed out, so streaming never runs into first-touch faults.
+ * The common device arguments add
+ *
+ *   hugepages=1   back the ring with 2 MB pages (MAP_HUGETLB, falling
+ *                 back to transparent huge pages)
+ *   mlock=1       lock the ring into RAM so it is never swapped out
+ *   numa=N        bind the ring to NUMA node N before it is touched
+ *
+ * Options that cannot be honoured are reported and otherwise ignored.
+ */
+class buffer_allocator
+{
+public:
+  buffer_allocator();
+  explicit buffer_allocator( const dict_t &dict );
+
+  /* throws std::bad_alloc */
+  void *allocate( size_t len ) const;
+  void deallocate( void *ptr, size_t len ) const;
+
+  bool operator==( const buffer_allocator &o ) const
+  {
+    return _hugepages == o._hugepages && _lock == o._lock &&
+           _numa_node == o._numa_node;
+  }
+
+private:
+  size_t mapped_size( size_t len ) const;
+
+  bool _hugepages;
+  bool _lock;
+  int _numa_node;
+};
+
+/*!
+ * \brief Standard allocator interface on top of buffer_allocator, for
+ * containers like boost::circular_buffer.
+ */
+template <typename T>
+class buffer_allocator_adaptor
+{
+public:
+  typedef T value_type;
+  typedef T *pointer;
+  typedef const T *const_pointer;
+  typedef T &reference;
+  typedef const T &const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  template <typename U> struct rebind { typedef buffer_allocator_adaptor<U> other; };
+
+  /* stateful: containers that are reassigned take the new options along */
+  typedef std::true_type propagate_on_container_copy_assignment;
+  typedef std::true_type propagate_on_container_move_assignment;
+  typedef std::true_type propagate_on_container_swap;
+
+  buffer_allocator_adaptor() {}
+  explicit buffer_allocator_adaptor( const buffer_allocator &alloc ) : _alloc(alloc) {}
+
+  template <typename U>
+  buffer_allocator_adaptor( const buffer_allocator_adaptor<U> &o ) : _alloc(o.get()) {}
+
+  T *allocate( size_t n, const void * = 0 )
+  {
+    return static_cast<T *>( _alloc.allocate( n * sizeof(T) ) );
+  }
+
+  void deallocate( T *ptr, size_t n )
+  {
+    _alloc.deallocate( ptr, n * sizeof(T) );
+  }
+
+  size_t max_size() const { return std::numeric_limits<size_t>::max() / sizeof(T); }
+
+  template <typename U, typename... Args>
+  void construct( U *ptr, Args&&... args ) { ::new((void *)ptr) U( std::forward<Args>(args)... ); }
+
+  template <typename U>
+  void destroy( U *ptr ) { ptr->~U(); }
+
+  const buffer_allocator &get() const { return _alloc; }
+
+  template <typename U>
+  bool operator==( const buffer_allocator_adaptor<U> &o ) const { return _alloc == o.get(); }
+
+  template <typename U>
+  bool operator!=( const buffer_allocator_adaptor<U> &o ) const { return !(*this == o); }
+
+private:
+  buffer_allocator _alloc;
+};
+
+#endif /* INCLUDED_OSMOSDR_BUFFER_ALLOCATOR_H */
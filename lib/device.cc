@@ -37,6 +37,10 @@
 #include <file_source_c.h>
 #endif
 
+#ifdef ENABLE_SIM
+#include <sim_source_c.h>
+#endif
+
 #ifdef ENABLE_RTL
 #include <rtl_source_c.h>
 #endif
@@ -202,6 +206,10 @@ devices_t device::find(const device_t &hint)
   for (std::string dev : file_source_c::get_devices( fake ))
     devices.push_back( device_t(dev) );
 #endif
+#ifdef ENABLE_SIM
+  for (std::string dev : sim_source_c::get_devices( fake ))
+    devices.push_back( device_t(dev) );
+#endif
 
   return devices;
 }
@@ -0,0 +1,331 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_FILE_CONVERT_H
+#define INCLUDED_FILE_CONVERT_H
+
+/*
+ * Sample formats of the file backend and the kernels converting them from
+ * and to gr_complex, kept apart from the blocks so that bench/ can measure
+ * them.
+ */
+
+#include <complex>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <stdint.h>
+
+#include <volk/volk.h>
+
+#if defined(USE_AVX) || defined(USE_SSE2)
+#include <emmintrin.h>
+#endif
+
+enum file_format_t {
+  FILE_CU8,   /* rtl_sdr, offset binary */
+  FILE_CS8,   /* hackrf_transfer */
+  FILE_CS16,  /* host order, full scale 32768 */
+  FILE_CF32   /* gr_complex, the historical default */
+};
+
+static inline file_format_t file_format_from_string(const std::string &name)
+{
+  if (name == "cu8")
+    return FILE_CU8;
+  if (name == "cs8")
+    return FILE_CS8;
+  if (name == "cs16")
+    return FILE_CS16;
+  if (name == "cf32" || name == "fc32")
+    return FILE_CF32;
+
+  throw std::runtime_error("Unsupported file format '" + name +
+                           "', use one of cu8, cs8, cs16 or cf32.");
+}
+
+/* bytes per complex sample */
+static inline size_t file_format_size(file_format_t format)
+{
+  switch (format) {
+  case FILE_CU8:  return 2;
+  case FILE_CS8:  return 2;
+  case FILE_CS16: return 4;
+  default:        return 2 * sizeof(float);
+  }
+}
+
+/*
+ * Same scaling as the rtl lookup table, (x - 127.4) / 128, so that cu8
+ * recordings come back exactly as rtl_source_c would have produced them.
+ */
+#if defined(USE_AVX) || defined(USE_SSE2)
+static inline void cu8_to_float_sse2(const uint8_t *in, float *out, size_t count)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128 offset = _mm_set1_ps(127.4f);
+  const __m128 scale = _mm_set1_ps(1.0f / 128.0f);
+
+  for (size_t i = 0; i < count; i++) {
+    __m128i bytes = _mm_loadu_si128((const __m128i *)&in[i * 16]);
+    __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+    __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+
+    __m128 f0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero));
+    __m128 f1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero));
+    __m128 f2 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero));
+    __m128 f3 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero));
+
+    _mm_storeu_ps(&out[i * 16 +  0], _mm_mul_ps(_mm_sub_ps(f0, offset), scale));
+    _mm_storeu_ps(&out[i * 16 +  4], _mm_mul_ps(_mm_sub_ps(f1, offset), scale));
+    _mm_storeu_ps(&out[i * 16 +  8], _mm_mul_ps(_mm_sub_ps(f2, offset), scale));
+    _mm_storeu_ps(&out[i * 16 + 12], _mm_mul_ps(_mm_sub_ps(f3, offset), scale));
+  }
+}
+#endif
+
+static inline void cu8_to_float_default(const uint8_t *in, float *out, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+    out[i] = (in[i] - 127.4f) * (1.0f / 128.0f);
+}
+
+/* converts n complex samples in the given format, src and dst must not overlap */
+static inline void convert_to_complex(file_format_t format, const void *src,
+                                      std::complex<float> *dst, size_t n)
+{
+  float *out = (float *)dst;
+
+  switch (format) {
+  case FILE_CU8: {
+    const uint8_t *in = (const uint8_t *)src;
+    size_t done = 0;
+#if defined(USE_AVX) || defined(USE_SSE2)
+    done = (2 * n) & ~size_t(15);
+    cu8_to_float_sse2(in, out, done / 16);
+#endif
+    cu8_to_float_default(in + done, out + done, 2 * n - done);
+    break;
+  }
+  case FILE_CS8:
+    volk_8i_s32f_convert_32f(out, (const int8_t *)src, 128.0f, 2 * n);
+    break;
+  case FILE_CS16:
+    volk_16i_s32f_convert_32f(out, (const int16_t *)src, 32768.0f, 2 * n);
+    break;
+  default:
+    memcpy(dst, src, n * sizeof(std::complex<float>));
+    break;
+  }
+}
+
+/*
+ * The inverse direction, float -> integer with saturation. Samples are
+ * scaled and offset, clamped in float (so that huge values do not wrap in
+ * the integer conversion) and rounded to nearest like lrintf(). Each
+ * iteration of the SSE2 kernels handles 16 floats, i.e. 8 complex samples.
+ */
+#if defined(USE_AVX) || defined(USE_SSE2)
+static inline void float_to_cs16_sse2(const float *in, int16_t *out, size_t count,
+                                       float scale)
+{
+  const __m128 mulme = _mm_set1_ps(scale);
+  const __m128 lo = _mm_set1_ps(-32768.0f);
+  const __m128 hi = _mm_set1_ps(32767.0f);
+  __m128i otmp1, otmp2, otmp3, otmp4;
+
+  for (size_t i = 0; i < count; i++) {
+    otmp1 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(&in[i * 16 +  0]), mulme), lo), hi));
+    otmp2 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(&in[i * 16 +  4]), mulme), lo), hi));
+    otmp3 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(&in[i * 16 +  8]), mulme), lo), hi));
+    otmp4 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(&in[i * 16 + 12]), mulme), lo), hi));
+
+    _mm_storeu_si128((__m128i *)&out[i * 16 + 0], _mm_packs_epi32(otmp1, otmp2));
+    _mm_storeu_si128((__m128i *)&out[i * 16 + 8], _mm_packs_epi32(otmp3, otmp4));
+  }
+}
+
+static inline void float_to_cs8_sse2(const float *in, int8_t *out, size_t count,
+                                      float scale)
+{
+  const __m128 mulme = _mm_set1_ps(scale);
+  const __m128 lo = _mm_set1_ps(-128.0f);
+  const __m128 hi = _mm_set1_ps(127.0f);
+  __m128i otmp1, otmp2, otmp3, otmp4;
+
+  for (size_t i = 0; i < count; i++) {
+    otmp1 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(&in[i * 16 +  0]), mulme), lo), hi));
+    otmp2 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(&in[i * 16 +  4]), mulme), lo), hi));
+    otmp3 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(&in[i * 16 +  8]), mulme), lo), hi));
+    otmp4 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(&in[i * 16 + 12]), mulme), lo), hi));
+
+    __m128i outshorts1 = _mm_packs_epi32(otmp1, otmp2);
+    __m128i outshorts2 = _mm_packs_epi32(otmp3, otmp4);
+
+    _mm_storeu_si128((__m128i *)&out[i * 16], _mm_packs_epi16(outshorts1, outshorts2));
+  }
+}
+
+static inline void float_to_cu8_sse2(const float *in, uint8_t *out, size_t count,
+                                      float scale)
+{
+  const __m128 mulme = _mm_set1_ps(scale);
+  const __m128 offset = _mm_set1_ps(127.4f);
+  const __m128 lo = _mm_set1_ps(0.0f);
+  const __m128 hi = _mm_set1_ps(255.0f);
+  __m128i otmp1, otmp2, otmp3, otmp4;
+
+  for (size_t i = 0; i < count; i++) {
+    otmp1 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&in[i * 16 +  0]), mulme), offset), lo), hi));
+    otmp2 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&in[i * 16 +  4]), mulme), offset), lo), hi));
+    otmp3 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&in[i * 16 +  8]), mulme), offset), lo), hi));
+    otmp4 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&in[i * 16 + 12]), mulme), offset), lo), hi));
+
+    __m128i outshorts1 = _mm_packs_epi32(otmp1, otmp2);
+    __m128i outshorts2 = _mm_packs_epi32(otmp3, otmp4);
+
+    _mm_storeu_si128((__m128i *)&out[i * 16], _mm_packus_epi16(outshorts1, outshorts2));
+  }
+}
+#endif
+
+template <typename T>
+static inline void float_to_int_default(const float *in, T *out, size_t count,
+                                        float scale, float offset,
+                                        float lo, float hi)
+{
+  for (size_t i = 0; i < count; i++) {
+    float v = in[i] * scale + offset;
+    out[i] = (T)lrintf(v < lo ? lo : (v > hi ? hi : v));
+  }
+}
+
+/*
+ * Converts n complex samples into the given format. full_scale is the
+ * amplitude that maps to the largest code; the scaling mirrors
+ * convert_to_complex() so that a recording reads back at its original
+ * level.
+ */
+static inline void convert_from_complex(file_format_t format,
+                                        const std::complex<float> *src,
+                                        void *dst, size_t n, float full_scale)
+{
+  const float *in = (const float *)src;
+  size_t done = 0;
+
+  switch (format) {
+  case FILE_CU8: {
+    const float scale = 128.0f / full_scale;
+#if defined(USE_AVX) || defined(USE_SSE2)
+    done = (2 * n) & ~size_t(15);
+    float_to_cu8_sse2(in, (uint8_t *)dst, done / 16, scale);
+#endif
+    float_to_int_default(in + done, (uint8_t *)dst + done, 2 * n - done,
+                         scale, 127.4f, 0.0f, 255.0f);
+    break;
+  }
+  case FILE_CS8: {
+    const float scale = 128.0f / full_scale;
+#if defined(USE_AVX) || defined(USE_SSE2)
+    done = (2 * n) & ~size_t(15);
+    float_to_cs8_sse2(in, (int8_t *)dst, done / 16, scale);
+#endif
+    float_to_int_default(in + done, (int8_t *)dst + done, 2 * n - done,
+                         scale, 0.0f, -128.0f, 127.0f);
+    break;
+  }
+  case FILE_CS16: {
+    const float scale = 32768.0f / full_scale;
+#if defined(USE_AVX) || defined(USE_SSE2)
+    done = (2 * n) & ~size_t(15);
+    float_to_cs16_sse2(in, (int16_t *)dst, done / 16, scale);
+#endif
+    float_to_int_default(in + done, (int16_t *)dst + done, 2 * n - done,
+                         scale, 0.0f, -32768.0f, 32767.0f);
+    break;
+  }
+  default:
+    memcpy(dst, src, n * sizeof(std::complex<float>));
+    break;
+  }
+}
+
+/*
+ * Multi-channel recordings store frames of nchan samples, channel after
+ * channel. A complex float is 64 bits, so the SSE2 kernels treat samples
+ * as doubles and split two frames at a time, one channel pair per load.
+ * That covers every even channel count; odd ones take the scalar path.
+ */
+static inline void deinterleave_complex(const std::complex<float> *src,
+                                        std::complex<float> *const *dst,
+                                        size_t nchan, size_t n)
+{
+  size_t done = 0;
+
+#if defined(USE_AVX) || defined(USE_SSE2)
+  if (0 == nchan % 2) {
+    const double *in = (const double *)src;
+
+    for (; done + 2 <= n; done += 2) {
+      for (size_t c = 0; c < nchan; c += 2) {
+        __m128d x = _mm_loadu_pd(&in[done * nchan + c]);
+        __m128d y = _mm_loadu_pd(&in[(done + 1) * nchan + c]);
+
+        _mm_storeu_pd((double *)(dst[c] + done), _mm_unpacklo_pd(x, y));
+        _mm_storeu_pd((double *)(dst[c + 1] + done), _mm_unpackhi_pd(x, y));
+      }
+    }
+  }
+#endif
+
+  for (; done < n; done++)
+    for (size_t c = 0; c < nchan; c++)
+      dst[c][done] = src[done * nchan + c];
+}
+
+static inline void interleave_complex(const std::complex<float> *const *src,
+                                      std::complex<float> *dst,
+                                      size_t nchan, size_t n)
+{
+  size_t done = 0;
+
+#if defined(USE_AVX) || defined(USE_SSE2)
+  if (0 == nchan % 2) {
+    double *out = (double *)dst;
+
+    for (; done + 2 <= n; done += 2) {
+      for (size_t c = 0; c < nchan; c += 2) {
+        __m128d a = _mm_loadu_pd((const double *)(src[c] + done));
+        __m128d b = _mm_loadu_pd((const double *)(src[c + 1] + done));
+
+        _mm_storeu_pd(&out[done * nchan + c], _mm_unpacklo_pd(a, b));
+        _mm_storeu_pd(&out[(done + 1) * nchan + c], _mm_unpackhi_pd(a, b));
+      }
+    }
+  }
+#endif
+
+  for (; done < n; done++)
+    for (size_t c = 0; c < nchan; c++)
+      dst[done * nchan + c] = src[c][done];
+}
+
+#endif /* INCLUDED_FILE_CONVERT_H */
@@ -0,0 +1,312 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/lexical_cast.hpp>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+#include <gnuradio/io_signature.h>
+
+#include "file_iqz_sink.h"
+
+file_iqz_sink_sptr make_file_iqz_sink( const std::string &filename,
+                                       file_format_t format,
+                                       float full_scale,
+                                       bool append,
+                                       const dict_t &dict )
+{
+  return gnuradio::get_initial_sptr(new file_iqz_sink(filename, format,
+                                                      full_scale, append, dict));
+}
+
+file_iqz_sink::file_iqz_sink( const std::string &filename,
+                              file_format_t format,
+                              float full_scale,
+                              bool append,
+                              const dict_t &dict ) :
+  gr::sync_block("file_iqz_sink",
+                 gr::io_signature::make(1, 1, sizeof (gr_complex)),
+                 gr::io_signature::make(0, 0, 0)),
+  _format(format),
+  _item_size(file_format_size(format)),
+  _full_scale(full_scale),
+  _block_samples(65536),
+  _writer(dict),
+  _samples(0),
+  _cur(NULL),
+  _quit(false)
+{
+  dict_t args = dict;
+  size_t threads = std::max( 1u, std::thread::hardware_concurrency() / 2 );
+
+  if ( FILE_CF32 == format )
+    throw std::runtime_error("Compression needs format=cu8, cs8 or cs16.");
+
+  if ( ! (_full_scale > 0) )
+    throw std::runtime_error("Parameter 'full_scale' must be positive.");
+
+  if ( args.count("compress_threads") )
+    threads = std::max( 1, boost::lexical_cast< int >( args["compress_threads"] ) );
+
+  if ( args.count("compress_block") )
+    _block_samples = boost::lexical_cast< size_t >( args["compress_block"] );
+
+  if ( _block_samples < 1024 || _block_samples > 16 * 1024 * 1024 )
+    throw std::runtime_error("Parameter 'compress_block' must be between 1024 and 16M.");
+
+  /* continue an existing recording behind its last block */
+  struct stat st;
+  bool resume = append && 0 == stat( filename.c_str(), &st ) && st.st_size > 0;
+
+  if ( resume ) {
+    iqz_file_header header;
+    uint64_t end;
+    int fd = ::open( filename.c_str(), O_RDWR | O_BINARY );
+
+    if ( fd < 0 )
+      throw std::runtime_error("Failed to open " + filename + ": " + strerror(errno));
+
+    try {
+      iqz_read_index( fd, filename, header, _index, end, _samples );
+
+      if ( header.format != uint32_t( format ) )
+        throw std::runtime_error("Cannot append to " + filename + " in another format.");
+
+#if defined(_WIN32)
+      if ( _chsize_s( fd, end ) != 0 )
+#else
+      if ( ftruncate( fd, end ) < 0 )
+#endif
+        throw std::runtime_error("Failed to truncate " + filename + ": " + strerror(errno));
+    } catch ( ... ) {
+      ::close( fd );
+      throw;
+    }
+
+    ::close( fd );
+  }
+
+  _writer.open( filename, resume );
+
+  if ( ! resume ) {
+    iqz_file_header header;
+
+    memset( &header, 0, sizeof(header) );
+    memcpy( header.magic, IQZ_MAGIC, 8 );
+    header.format = format;
+    header.block_samples = _block_samples;
+
+    _writer.write( &header, sizeof(header) );
+  }
+
+  /* two blocks per encoder keep all of them busy while work() fills one */
+  _jobs.resize( 2 * threads + 1 );
+  for ( size_t i = 0; i < _jobs.size(); i++ ) {
+    _jobs[i].raw.resize( _block_samples * _item_size );
+    _free.push_back( &_jobs[i] );
+  }
+
+  for ( size_t i = 0; i < threads; i++ )
+    _threads.push_back( std::thread( &file_iqz_sink::run, this ) );
+}
+
+file_iqz_sink::~file_iqz_sink()
+{
+  try {
+    stop();
+  } catch ( std::exception &ex ) {
+    std::cerr << ex.what() << std::endl;
+  }
+
+  {
+    std::lock_guard< std::mutex > lock( _lock );
+    _quit = true;
+    _cond.notify_all();
+  }
+
+  for ( size_t i = 0; i < _threads.size(); i++ )
+    _threads[i].join();
+
+  try {
+    write_index();
+  } catch ( std::exception &ex ) {
+    std::cerr << ex.what() << std::endl;
+  }
+
+  _writer.close();
+}
+
+/* hands the partial block over and writes everything out */
+bool file_iqz_sink::stop()
+{
+  submit();
+  write_done( true );
+  _writer.flush();
+
+  return true;
+}
+
+void file_iqz_sink::submit()
+{
+  if ( ! _cur || ! _cur->samples )
+    return;
+
+  std::lock_guard< std::mutex > lock( _lock );
+
+  _cur->done = false;
+  _todo.push_back( _cur );
+  _order.push_back( _cur );
+  _cur = NULL;
+
+  _cond.notify_all();
+}
+
+/* writes finished blocks in order, all submitted ones if wait_all */
+void file_iqz_sink::write_done( bool wait_all )
+{
+  std::unique_lock< std::mutex > lock( _lock );
+
+  while ( ! _order.empty() ) {
+    job_t *job = _order.front();
+
+    if ( ! job->done ) {
+      if ( ! wait_all && ! _free.empty() )
+        break;
+
+      _cond.wait( lock, [job] { return job->done; } );
+    }
+
+    _order.pop_front();
+    lock.unlock();
+
+    iqz_block_header header;
+    header.magic = IQZ_BLOCK_MAGIC;
+    header.samples = job->samples;
+    header.bytes = job->coded.size();
+    header.crc = job->crc;
+
+    iqz_index_entry entry;
+    entry.offset = _writer.position();
+    entry.sample = _samples;
+    _index.push_back( entry );
+
+    _writer.write( &header, sizeof(header) );
+    _writer.write( job->coded.data(), job->coded.size() );
+    _samples += job->samples;
+
+    lock.lock();
+    _free.push_back( job );
+  }
+}
+
+void file_iqz_sink::write_index()
+{
+  iqz_trailer trailer;
+
+  trailer.index_offset = _writer.position();
+  trailer.blocks = _index.size();
+  trailer.samples = _samples;
+  memcpy( trailer.magic, IQZ_TRAILER_MAGIC, 8 );
+
+  _writer.write( _index.data(), _index.size() * sizeof(iqz_index_entry) );
+  _writer.write( &trailer, sizeof(trailer) );
+}
+
+void file_iqz_sink::run()
+{
+  std::unique_lock< std::mutex > lock( _lock );
+
+  while ( true ) {
+    _cond.wait( lock, [this] { return _quit || ! _todo.empty(); } );
+
+    if ( _todo.empty() )
+      return;
+
+    job_t *job = _todo.front();
+    _todo.pop_front();
+
+    lock.unlock();
+    job->crc = iqz_encode( _format, job->raw.data(), job->samples, job->coded );
+    lock.lock();
+
+    job->done = true;
+    _cond.notify_all();
+  }
+}
+
+int file_iqz_sink::work( int noutput_items,
+                         gr_vector_const_void_star &input_items,
+                         gr_vector_void_star &output_items )
+{
+  if ( _pacer )
+    noutput_items = _pacer->pace( noutput_items );
+
+  const gr_complex *in = (const gr_complex *)input_items[0];
+
+  for ( int done = 0; done < noutput_items; ) {
+    if ( ! _cur ) {
+      /* only blocks here if every encoder is behind */
+      write_done( false );
+
+      std::lock_guard< std::mutex > lock( _lock );
+      _cur = _free.back();
+      _free.pop_back();
+      _cur->samples = 0;
+    }
+
+    size_t n = std::min< size_t >( noutput_items - done,
+                                   _block_samples - _cur->samples );
+
+    convert_from_complex( _format, in + done,
+                          _cur->raw.data() + _cur->samples * _item_size,
+                          n, _full_scale );
+
+    _cur->samples += n;
+    done += n;
+
+    if ( _cur->samples == _block_samples )
+      submit();
+  }
+
+  write_done( false );
+
+  return noutput_items;
+}
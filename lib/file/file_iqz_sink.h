@@ -0,0 +1,120 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_FILE_IQZ_SINK_H
+#define INCLUDED_FILE_IQZ_SINK_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gnuradio/sync_block.h>
+
+#include "arg_helpers.h"
+#include "file_writer.h"
+#include "file_pacer.h"
+#include "iqz_codec.h"
+
+class file_iqz_sink;
+
+typedef std::shared_ptr< file_iqz_sink > file_iqz_sink_sptr;
+
+file_iqz_sink_sptr make_file_iqz_sink( const std::string &filename,
+                                       file_format_t format,
+                                       float full_scale,
+                                       bool append,
+                                       const dict_t &dict = dict_t() );
+
+/*!
+ * \brief Losslessly compressed I/Q recording, see iqz_codec.h.
+ *
+ * Samples are quantised to \p format and cut into blocks, which a pool
+ * of encoder threads compresses in parallel. Finished blocks are written
+ * in order through a file_writer, whose options apply as for raw files.
+ *
+ *   compress_threads=N   encoder threads, half the cores by default
+ *   compress_block=65536 samples per block
+ *
+ * The seek index is written when the sink is destroyed.
+ */
+class file_iqz_sink : public gr::sync_block
+{
+private:
+  friend file_iqz_sink_sptr make_file_iqz_sink( const std::string &filename,
+                                                file_format_t format,
+                                                float full_scale,
+                                                bool append,
+                                                const dict_t &dict );
+
+  file_iqz_sink( const std::string &filename, file_format_t format,
+                 float full_scale, bool append, const dict_t &dict );
+
+public:
+  ~file_iqz_sink();
+
+  bool stop();
+
+  void set_pacer( const file_pacer_sptr &pacer ) { _pacer = pacer; }
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+private:
+  struct job_t
+  {
+    std::vector< unsigned char > raw;
+    std::vector< unsigned char > coded;
+    size_t samples;
+    uint32_t crc;
+    bool done;
+  };
+
+  void submit();
+  void write_done( bool wait_all );
+  void write_index();
+  void run();
+
+  file_format_t _format;
+  size_t _item_size;
+  float _full_scale;
+  size_t _block_samples;
+
+  file_writer _writer;
+  std::vector< iqz_index_entry > _index;
+  uint64_t _samples;
+
+  std::vector< job_t > _jobs;
+  std::vector< job_t * > _free;
+  job_t *_cur;              /* block being filled by work() */
+
+  std::vector< std::thread > _threads;
+  std::mutex _lock;
+  std::condition_variable _cond;
+  std::deque< job_t * > _todo;  /* for the encoders */
+  std::deque< job_t * > _order; /* submitted, in file order */
+  bool _quit;
+
+  file_pacer_sptr _pacer;
+};
+
+#endif /* INCLUDED_FILE_IQZ_SINK_H */
@@ -0,0 +1,331 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/lexical_cast.hpp>
+
+#include <fcntl.h>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+#include <gnuradio/io_signature.h>
+
+#include "file_iqz_source.h"
+
+file_iqz_source_sptr make_file_iqz_source( const std::string &filename,
+                                           bool repeat,
+                                           const dict_t &dict )
+{
+  return gnuradio::get_initial_sptr(new file_iqz_source(filename, repeat, dict));
+}
+
+file_iqz_source::file_iqz_source( const std::string &filename, bool repeat,
+                                  const dict_t &dict ) :
+  gr::sync_block("file_iqz_source",
+                 gr::io_signature::make(0, 0, 0),
+                 gr::io_signature::make(1, 1, sizeof (gr_complex))),
+  _filename(filename),
+  _fd(-1),
+  _repeat(repeat),
+  _end(0),
+  _samples(0),
+  _pos(0),
+  _quit(false)
+{
+  dict_t args = dict;
+  size_t threads = std::max( 1u, std::thread::hardware_concurrency() / 2 );
+  size_t readahead = 0;
+
+  if ( args.count("decode_threads") )
+    threads = std::max( 1, boost::lexical_cast< int >( args["decode_threads"] ) );
+
+  if ( args.count("readahead") )
+    readahead = boost::lexical_cast< size_t >( args["readahead"] );
+
+  _fd = ::open( filename.c_str(), O_RDONLY | O_BINARY );
+  if ( _fd < 0 )
+    throw std::runtime_error("Failed to open " + filename + ": " + strerror(errno));
+
+  iqz_file_header header;
+
+  try {
+    iqz_read_index( _fd, filename, header, _index, _end, _samples );
+  } catch ( ... ) {
+    ::close( _fd );
+    throw;
+  }
+
+  _format = file_format_t( header.format );
+
+  _slots.resize( std::max< size_t >( 2, readahead ? readahead : 2 * threads ) );
+  for ( size_t i = 0; i < _slots.size(); i++ ) {
+    _slots[i].block = SIZE_MAX;
+    _slots[i].state = SLOT_EMPTY;
+  }
+
+  for ( size_t i = 0; i < threads; i++ )
+    _threads.push_back( std::thread( &file_iqz_source::run, this ) );
+
+  std::cerr << "Playing " << filename << ": " << _samples << " samples in "
+            << _index.size() << " compressed blocks" << std::endl;
+}
+
+file_iqz_source::~file_iqz_source()
+{
+  {
+    std::lock_guard< std::mutex > lock( _lock );
+    _quit = true;
+    _cond.notify_all();
+  }
+
+  for ( size_t i = 0; i < _threads.size(); i++ )
+    _threads[i].join();
+
+  ::close( _fd );
+}
+
+/* index entry holding \p sample, a binary search */
+size_t file_iqz_source::block_of( uint64_t sample ) const
+{
+  std::vector< iqz_index_entry >::const_iterator it =
+    std::upper_bound( _index.begin(), _index.end(), sample,
+                      []( uint64_t s, const iqz_index_entry &e ) {
+                        return s < e.sample;
+                      } );
+
+  return (it - _index.begin()) - 1;
+}
+
+/* called with the lock held: queue \p block and the ones after it */
+void file_iqz_source::schedule( size_t block )
+{
+  const size_t window = std::min( _slots.size(), _index.size() );
+
+  for ( size_t i = 0; i < window; i++ ) {
+    size_t b = block + i;
+
+    if ( b >= _index.size() ) {
+      if ( ! _repeat )
+        break;
+      b -= _index.size();
+    }
+
+    slot_t &s = _slots[b % _slots.size()];
+
+    if ( (s.block == b && s.state != SLOT_EMPTY) || s.state == SLOT_BUSY )
+      continue;
+
+    /*
+     * Across the wrap of a repeated file two blocks of the window can
+     * share a slot, the one needed first keeps it.
+     */
+    if ( s.state != SLOT_EMPTY && s.block < _index.size() &&
+         (s.block + _index.size() - block) % _index.size() < i )
+      continue;
+
+    s.block = b;
+    s.state = SLOT_QUEUED;
+    _todo.push_back( b );
+  }
+
+  _cond.notify_all();
+}
+
+/* runs unlocked, the slot is ours while it is SLOT_BUSY */
+void file_iqz_source::decode( size_t block, slot_t &slot )
+{
+  const uint64_t offset = _index[block].offset;
+  const uint64_t next = block + 1 < _index.size() ? _index[block + 1].offset : _end;
+  iqz_block_header header;
+
+  slot.error.clear();
+  slot.coded.resize( next - offset );
+
+  if ( next - offset < sizeof(header) ||
+       ! iqz_pread( _fd, slot.coded.data(), slot.coded.size(), offset ) ) {
+    slot.error = "Failed to read " + _filename;
+    return;
+  }
+
+  memcpy( &header, slot.coded.data(), sizeof(header) );
+
+  if ( IQZ_BLOCK_MAGIC != header.magic ||
+       sizeof(header) + header.bytes != slot.coded.size() ) {
+    slot.error = "Damaged block header in " + _filename;
+    return;
+  }
+
+  slot.raw.resize( header.samples * file_format_size( _format ) );
+  slot.samples.resize( header.samples );
+
+  if ( ! iqz_decode( _format, slot.coded.data() + sizeof(header), header.bytes,
+                     header.crc, header.samples, slot.raw.data() ) ) {
+    slot.error = "Damaged block " + boost::lexical_cast< std::string >( block ) +
+                 " in " + _filename;
+    return;
+  }
+
+  convert_to_complex( _format, slot.raw.data(), slot.samples.data(), header.samples );
+}
+
+void file_iqz_source::run()
+{
+  std::unique_lock< std::mutex > lock( _lock );
+
+  while ( true ) {
+    _cond.wait( lock, [this] { return _quit || ! _todo.empty(); } );
+
+    if ( _quit )
+      return;
+
+    size_t block = _todo.front();
+    _todo.pop_front();
+
+    slot_t &s = _slots[block % _slots.size()];
+
+    /* superseded by a seek */
+    if ( s.block != block || s.state != SLOT_QUEUED )
+      continue;
+
+    s.state = SLOT_BUSY;
+    lock.unlock();
+
+    decode( block, s );
+
+    lock.lock();
+    s.state = SLOT_READY;
+    _cond.notify_all();
+  }
+}
+
+bool file_iqz_source::seek( long seek_point, int whence )
+{
+  int64_t target;
+
+  {
+    std::lock_guard< std::mutex > lock( _lock );
+
+    switch ( whence ) {
+    case SEEK_SET: target = seek_point; break;
+    case SEEK_CUR: target = (int64_t)_pos + seek_point; break;
+    case SEEK_END: target = (int64_t)_samples + seek_point; break;
+    default: return false;
+    }
+  }
+
+  if ( target < 0 )
+    return false;
+
+  return seek_to( target );
+}
+
+bool file_iqz_source::seek_to( uint64_t sample )
+{
+  std::lock_guard< std::mutex > lock( _lock );
+
+  if ( sample > _samples )
+    return false;
+
+  _pos = sample;
+
+  /* drop the readahead that is not running yet, then restart it here */
+  _todo.clear();
+  for ( size_t i = 0; i < _slots.size(); i++ )
+    if ( SLOT_QUEUED == _slots[i].state )
+      _slots[i].state = SLOT_EMPTY;
+
+  if ( _pos < _samples )
+    schedule( block_of( _pos ) );
+
+  return true;
+}
+
+uint64_t file_iqz_source::position()
+{
+  std::lock_guard< std::mutex > lock( _lock );
+
+  return _pos;
+}
+
+int file_iqz_source::work( int noutput_items,
+                           gr_vector_const_void_star &input_items,
+                           gr_vector_void_star &output_items )
+{
+  if ( _pacer )
+    noutput_items = _pacer->pace( noutput_items );
+
+  gr_complex *out = (gr_complex *)output_items[0];
+  int produced = 0;
+
+  std::unique_lock< std::mutex > lock( _lock );
+
+  while ( produced < noutput_items ) {
+    if ( _pos >= _samples ) {
+      if ( ! _repeat || 0 == _samples )
+        break;
+      _pos = 0;
+    }
+
+    const size_t block = block_of( _pos );
+    slot_t &s = _slots[block % _slots.size()];
+
+    schedule( block );
+
+    /* only waits if the decoders fell behind or after a seek */
+    while ( ! (s.block == block && SLOT_READY == s.state) ) {
+      _cond.wait( lock );
+      schedule( block );
+    }
+
+    if ( ! s.error.empty() )
+      throw std::runtime_error( s.error );
+
+    const uint64_t offset = _pos - _index[block].sample;
+    const size_t n = std::min< uint64_t >( noutput_items - produced,
+                                           s.samples.size() - offset );
+
+    memcpy( out + produced, s.samples.data() + offset, n * sizeof(gr_complex) );
+
+    produced += n;
+    _pos += n;
+  }
+
+  if ( 0 == produced )
+    return WORK_DONE;
+
+  return produced;
+}
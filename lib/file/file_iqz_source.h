@@ -0,0 +1,118 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_FILE_IQZ_SOURCE_H
+#define INCLUDED_FILE_IQZ_SOURCE_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gnuradio/sync_block.h>
+
+#include "arg_helpers.h"
+#include "file_pacer.h"
+#include "iqz_codec.h"
+
+class file_iqz_source;
+
+typedef std::shared_ptr< file_iqz_source > file_iqz_source_sptr;
+
+file_iqz_source_sptr make_file_iqz_source( const std::string &filename,
+                                           bool repeat,
+                                           const dict_t &dict = dict_t() );
+
+/*!
+ * \brief Player for iqz compressed recordings, see iqz_codec.h.
+ *
+ * A pool of decoder threads works through the blocks ahead of the read
+ * position, each straight into a buffer of output samples, so work()
+ * only copies. Seeking looks the block up in the index and restarts the
+ * readahead from there.
+ *
+ *   decode_threads=N     decoder threads, half the cores by default
+ *   readahead=M          blocks decoded ahead, twice the threads by default
+ */
+class file_iqz_source : public gr::sync_block
+{
+private:
+  friend file_iqz_source_sptr make_file_iqz_source( const std::string &filename,
+                                                    bool repeat,
+                                                    const dict_t &dict );
+
+  file_iqz_source( const std::string &filename, bool repeat, const dict_t &dict );
+
+public:
+  ~file_iqz_source();
+
+  /* seek_point is in samples, whence is SEEK_SET, SEEK_CUR or SEEK_END */
+  bool seek( long seek_point, int whence );
+  bool seek_to( uint64_t sample );
+
+  uint64_t nitems() const { return _samples; }
+  uint64_t position();
+
+  void set_pacer( const file_pacer_sptr &pacer ) { _pacer = pacer; }
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+private:
+  enum slot_state { SLOT_EMPTY, SLOT_QUEUED, SLOT_BUSY, SLOT_READY };
+
+  struct slot_t
+  {
+    size_t block;
+    slot_state state;
+    std::vector< unsigned char > coded;
+    std::vector< unsigned char > raw;
+    std::vector< gr_complex > samples;
+    std::string error;
+  };
+
+  size_t block_of( uint64_t sample ) const;
+  void schedule( size_t block );
+  void decode( size_t block, slot_t &slot );
+  void run();
+
+  std::string _filename;
+  int _fd;
+  bool _repeat;
+  file_format_t _format;
+  std::vector< iqz_index_entry > _index;
+  uint64_t _end;
+  uint64_t _samples;
+
+  uint64_t _pos;
+  std::vector< slot_t > _slots;  /* block b decodes into slot b % size */
+
+  std::vector< std::thread > _threads;
+  std::mutex _lock;
+  std::condition_variable _cond;
+  std::deque< size_t > _todo;
+  bool _quit;
+
+  file_pacer_sptr _pacer;
+};
+
+#endif /* INCLUDED_FILE_IQZ_SOURCE_H */
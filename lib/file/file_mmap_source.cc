@@ -0,0 +1,361 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <gnuradio/io_signature.h>
+
+#include "file_mmap_source.h"
+
+/* granularity of the readahead / drop-behind hints */
+#define READAHEAD_BYTES (16 * 1024 * 1024)
+
+/* interleaved frames are converted and split up in chunks this size */
+#define DEINTERLEAVE_SAMPLES 8192
+
+file_mmap_source_sptr make_file_mmap_source( const std::vector< std::string > &filenames,
+                                             file_format_t format,
+                                             bool repeat,
+                                             size_t nchan )
+{
+  return gnuradio::get_initial_sptr(new file_mmap_source(filenames, format, repeat, nchan));
+}
+
+file_mmap_source::file_mmap_source( const std::vector< std::string > &filenames,
+                                    file_format_t format,
+                                    bool repeat,
+                                    size_t nchan ) :
+  gr::sync_block("file_mmap_source",
+                 gr::io_signature::make(0, 0, 0),
+                 gr::io_signature::make(nchan, nchan, sizeof (gr_complex))),
+  _format(format),
+  _nchan(nchan),
+  _item_size(file_format_size(format)),
+  _repeat(repeat),
+  _nitems(UINT64_MAX),
+  _pos(0)
+{
+  if ( filenames.size() != 1 && filenames.size() != nchan )
+    throw std::runtime_error("Expected a single interleaved file or one file per channel.");
+
+  /* a single file holds frames of all channels */
+  if ( filenames.size() < nchan ) {
+    _item_size *= nchan;
+    _frames.resize( std::max< size_t >( 1, DEINTERLEAVE_SAMPLES / nchan ) * nchan );
+  }
+
+  try {
+    for ( size_t i = 0; i < filenames.size(); i++ ) {
+      const std::string &filename = filenames[i];
+      mapping_t m;
+
+      map( filename, m );
+      _maps.push_back( m );
+
+      const uint64_t nitems = m.size / _item_size;
+
+      if ( ! nitems )
+        throw std::runtime_error("File " + filename + " contains no samples.");
+
+      if ( ! m.base )
+        throw std::runtime_error("Failed to map " + filename + " into memory.");
+
+      if ( m.size % _item_size )
+        fprintf(stderr, "File size is not a multiple of the %s size, "
+                        "ignoring the last %u bytes\n",
+                _item_size > file_format_size(format) ? "frame" : "sample",
+                (unsigned int)(m.size % _item_size));
+
+      if ( i && nitems != _nitems )
+        fprintf(stderr, "%s differs in length from the other channels, "
+                        "playback stops at the end of the shortest\n",
+                filename.c_str());
+
+      _nitems = std::min( _nitems, nitems );
+    }
+  } catch ( ... ) {
+    unmap();
+    throw;
+  }
+
+  advise( 0 );
+}
+
+file_mmap_source::~file_mmap_source()
+{
+  unmap();
+}
+
+void file_mmap_source::map( const std::string &filename, mapping_t &m )
+{
+  m.base = NULL;
+  m.size = 0;
+  m.advised = UINT64_MAX;
+
+#if defined(_WIN32)
+  m.file = CreateFileA( filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                        NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+  if ( INVALID_HANDLE_VALUE == m.file )
+    throw std::runtime_error("Failed to open " + filename);
+
+  LARGE_INTEGER size;
+  if ( ! GetFileSizeEx( (HANDLE)m.file, &size ) ) {
+    CloseHandle( (HANDLE)m.file );
+    throw std::runtime_error("Failed to stat " + filename);
+  }
+  m.size = size.QuadPart;
+
+  m.mapping = NULL;
+  if ( m.size ) {
+    m.mapping = CreateFileMappingA( (HANDLE)m.file, NULL, PAGE_READONLY, 0, 0, NULL );
+    if ( m.mapping )
+      m.base = (const unsigned char *)MapViewOfFile( (HANDLE)m.mapping,
+                                                     FILE_MAP_READ, 0, 0, 0 );
+  }
+#else
+  int fd = ::open( filename.c_str(), O_RDONLY );
+  if ( fd < 0 )
+    throw std::runtime_error("Failed to open " + filename + ": " + strerror(errno));
+
+  struct stat st;
+  if ( fstat( fd, &st ) < 0 ) {
+    ::close( fd );
+    throw std::runtime_error("Failed to stat " + filename + ": " + strerror(errno));
+  }
+  m.size = st.st_size;
+
+  if ( m.size ) {
+    void *ptr = mmap( NULL, m.size, PROT_READ, MAP_SHARED, fd, 0 );
+    if ( MAP_FAILED != ptr )
+      m.base = (const unsigned char *)ptr;
+  }
+
+  /* the mapping keeps its own reference to the file */
+  ::close( fd );
+
+#ifdef MADV_SEQUENTIAL
+  if ( m.base )
+    madvise( (void *)m.base, m.size, MADV_SEQUENTIAL );
+#endif
+#endif
+}
+
+void file_mmap_source::unmap( mapping_t &m )
+{
+#if defined(_WIN32)
+  if ( m.base )
+    UnmapViewOfFile( m.base );
+  if ( m.mapping )
+    CloseHandle( (HANDLE)m.mapping );
+  if ( INVALID_HANDLE_VALUE != m.file )
+    CloseHandle( (HANDLE)m.file );
+  m.mapping = NULL;
+  m.file = INVALID_HANDLE_VALUE;
+#else
+  if ( m.base )
+    munmap( (void *)m.base, m.size );
+#endif
+  m.base = NULL;
+}
+
+void file_mmap_source::unmap()
+{
+  for ( size_t i = 0; i < _maps.size(); i++ )
+    unmap( _maps[i] );
+
+  _maps.clear();
+}
+
+/*
+ * Ask for the window the read position is in and the one after it, and
+ * give back the one we just left. The file pages stay in the page cache,
+ * only our mapping of them is dropped, so repeat=true rereads are cheap.
+ */
+void file_mmap_source::advise( uint64_t offset )
+{
+#if !defined(_WIN32)
+  const uint64_t start = offset - offset % READAHEAD_BYTES;
+
+  for ( size_t i = 0; i < _maps.size(); i++ ) {
+    mapping_t &m = _maps[i];
+
+    if ( start == m.advised )
+      continue;
+
+    if ( m.advised < m.size )
+      madvise( (void *)(m.base + m.advised),
+               std::min< uint64_t >( READAHEAD_BYTES, m.size - m.advised ),
+               MADV_DONTNEED );
+
+    if ( start < m.size )
+      madvise( (void *)(m.base + start),
+               std::min< uint64_t >( 2 * READAHEAD_BYTES, m.size - start ),
+               MADV_WILLNEED );
+
+    m.advised = start;
+  }
+#endif
+}
+
+bool file_mmap_source::seek( long seek_point, int whence )
+{
+  std::lock_guard< std::mutex > lock( _lock );
+
+  int64_t target;
+
+  switch ( whence ) {
+  case SEEK_SET: target = seek_point; break;
+  case SEEK_CUR: target = (int64_t)_pos + seek_point; break;
+  case SEEK_END: target = (int64_t)_nitems + seek_point; break;
+  default: return false;
+  }
+
+  if ( target < 0 || (uint64_t)target > _nitems )
+    return false;
+
+  _pos = target;
+  advise( _pos * _item_size );
+
+  return true;
+}
+
+bool file_mmap_source::seek_to( uint64_t sample )
+{
+  std::lock_guard< std::mutex > lock( _lock );
+
+  if ( sample > _nitems )
+    return false;
+
+  _pos = sample;
+  advise( _pos * _item_size );
+
+  return true;
+}
+
+void file_mmap_source::set_file_tags( const std::vector< gr::tag_t > &tags )
+{
+  std::lock_guard< std::mutex > lock( _lock );
+
+  _file_tags = tags;
+}
+
+/* called with the lock held */
+void file_mmap_source::tag_range( uint64_t from, uint64_t count, uint64_t out_offset )
+{
+  std::vector< gr::tag_t >::const_iterator it =
+    std::lower_bound( _file_tags.begin(), _file_tags.end(), from,
+                      []( const gr::tag_t &tag, uint64_t sample ) {
+                        return tag.offset < sample;
+                      } );
+
+  for ( ; it != _file_tags.end() && it->offset < from + count; ++it )
+    add_item_tag( 0, out_offset + (it->offset - from), it->key, it->value );
+}
+
+uint64_t file_mmap_source::position()
+{
+  std::lock_guard< std::mutex > lock( _lock );
+
+  return _pos;
+}
+
+int file_mmap_source::work( int noutput_items,
+                            gr_vector_const_void_star &input_items,
+                            gr_vector_void_star &output_items )
+{
+  if ( _pacer )
+    noutput_items = _pacer->pace( noutput_items );
+
+  int produced = 0;
+
+  std::lock_guard< std::mutex > lock( _lock );
+
+  while ( produced < noutput_items ) {
+    if ( _pos == _nitems ) {
+      if ( ! _repeat )
+        break;
+      _pos = 0;
+    }
+
+    size_t count = std::min< uint64_t >( noutput_items - produced, _nitems - _pos );
+
+    if ( _maps.size() == _nchan ) {
+      for ( size_t c = 0; c < _nchan; c++ )
+        convert_to_complex( _format, _maps[c].base + _pos * _item_size,
+                            (gr_complex *)output_items[c] + produced, count );
+    } else {
+      deinterleave( _maps[0].base + _pos * _item_size, output_items, produced, count );
+    }
+
+    if ( ! _file_tags.empty() )
+      tag_range( _pos, count, nitems_written(0) + produced );
+
+    _pos += count;
+    produced += count;
+  }
+
+  advise( _pos * _item_size );
+
+  return produced ? produced : WORK_DONE;
+}
+
+/* called with the lock held */
+void file_mmap_source::deinterleave( const unsigned char *in,
+                                     gr_vector_void_star &out,
+                                     size_t offset, size_t count )
+{
+  const size_t chunk = _frames.size() / _nchan;
+  std::vector< gr_complex * > dst( _nchan );
+
+  for ( size_t done = 0; done < count; ) {
+    const size_t n = std::min( count - done, chunk );
+
+    for ( size_t c = 0; c < _nchan; c++ )
+      dst[c] = (gr_complex *)out[c] + offset + done;
+
+    if ( FILE_CF32 == _format ) {
+      deinterleave_complex( (const gr_complex *)(in + done * _item_size),
+                            &dst[0], _nchan, n );
+    } else {
+      convert_to_complex( _format, in + done * _item_size, &_frames[0], n * _nchan );
+      deinterleave_complex( &_frames[0], &dst[0], _nchan, n );
+    }
+
+    done += n;
+  }
+}
@@ -0,0 +1,125 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_FILE_MMAP_SOURCE_H
+#define INCLUDED_FILE_MMAP_SOURCE_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <gnuradio/sync_block.h>
+
+#include "file_convert.h"
+#include "file_pacer.h"
+
+class file_mmap_source;
+
+typedef std::shared_ptr< file_mmap_source > file_mmap_source_sptr;
+
+file_mmap_source_sptr make_file_mmap_source( const std::vector< std::string > &filenames,
+                                             file_format_t format,
+                                             bool repeat,
+                                             size_t nchan = 1 );
+
+/*!
+ * \brief Memory mapped I/Q file reader.
+ *
+ * Maps the whole recording read-only and converts the samples straight
+ * from the page cache into the output buffer, so there is no intermediate
+ * read() copy and the kernel's sequential readahead keeps the pages coming.
+ * Pages behind the read position are dropped again to keep the resident
+ * size bounded on multi-gigabyte captures.
+ *
+ * With \p nchan > 1 there is an output per channel, read in lockstep from
+ * either one file of interleaved frames or one file per channel (as many
+ * \p filenames as channels). Playback stops at the end of the shortest.
+ */
+class file_mmap_source : public gr::sync_block
+{
+private:
+  friend file_mmap_source_sptr make_file_mmap_source( const std::vector< std::string > &filenames,
+                                                      file_format_t format,
+                                                      bool repeat,
+                                                      size_t nchan );
+
+  file_mmap_source( const std::vector< std::string > &filenames,
+                    file_format_t format, bool repeat, size_t nchan );
+
+public:
+  ~file_mmap_source();
+
+  /* seek_point is in samples, whence is SEEK_SET, SEEK_CUR or SEEK_END */
+  bool seek( long seek_point, int whence );
+  bool seek_to( uint64_t sample );
+
+  /*!
+   * Stream tags to emit whenever playback passes the sample given as their
+   * offset, e.g. the capture segments of a SigMF recording. Must be sorted.
+   */
+  void set_file_tags( const std::vector< gr::tag_t > &tags );
+
+  uint64_t nitems() const { return _nitems; }
+  uint64_t position();
+
+  /* releases the samples in device sized bursts, see file_pacer */
+  void set_pacer( const file_pacer_sptr &pacer ) { _pacer = pacer; }
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+private:
+  struct mapping_t
+  {
+    const unsigned char *base;
+    uint64_t size;
+    uint64_t advised;     /* byte offset the readahead window starts at */
+#if defined(_WIN32)
+    void *file;
+    void *mapping;
+#endif
+  };
+
+  static void map( const std::string &filename, mapping_t &m );
+  static void unmap( mapping_t &m );
+  void unmap();
+  void tag_range( uint64_t from, uint64_t count, uint64_t out_offset );
+  void advise( uint64_t offset );
+  void deinterleave( const unsigned char *in, gr_vector_void_star &out,
+                     size_t offset, size_t count );
+
+  file_format_t _format;
+  size_t _nchan;
+  size_t _item_size;      /* bytes per frame of a mapping */
+  bool _repeat;
+
+  std::vector< mapping_t > _maps;
+  uint64_t _nitems;
+  std::vector< gr_complex > _frames;
+
+  std::vector< gr::tag_t > _file_tags;
+
+  std::mutex _lock;
+  uint64_t _pos;          /* next sample to read */
+
+  file_pacer_sptr _pacer;
+};
+
+#endif /* INCLUDED_FILE_MMAP_SOURCE_H */
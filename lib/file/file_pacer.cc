@@ -0,0 +1,171 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#ifdef HAVE_CLOCK_NANOSLEEP
+#include <time.h>
+#endif
+
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "file_pacer.h"
+
+/* bytes per burst unless transfer= says otherwise */
+#define PACE_TRANSFER_BYTES (256 * 1024)
+
+/* longest uninterrupted sleep, bounds how long stop() and rate changes wait */
+#define PACE_SLICE_SECS 0.05
+
+file_pacer::file_pacer( const dict_t &dict, double rate, size_t item_size ) :
+  _rate(rate),
+  _transfer(std::max< size_t >( 1, PACE_TRANSFER_BYTES / item_size )),
+  _credit(0),
+  _started(false),
+  _stats_interval(0)
+{
+  dict_t::const_iterator it;
+
+  if ( (it = dict.find( "transfer" )) != dict.end() )
+    _transfer = boost::lexical_cast< size_t >( it->second );
+
+  if ( (it = dict.find( "pace_stats" )) != dict.end() )
+    _stats_interval = boost::lexical_cast< double >( it->second );
+
+  if ( ! (rate > 0) )
+    throw std::runtime_error("Parameter 'rate' is missing in arguments.");
+
+  if ( 0 == _transfer )
+    throw std::runtime_error("Parameter 'transfer' must be positive.");
+
+  memset( &_stats, 0, sizeof(_stats) );
+}
+
+file_pacer::~file_pacer()
+{
+  if ( _stats_interval > 0 && _stats.bursts )
+    report( "total" );
+}
+
+void file_pacer::set_rate( double rate )
+{
+  if ( rate > 0 )
+    _rate = rate;
+}
+
+void file_pacer::sleep_until( const osmosdr::time_spec_t &deadline )
+{
+#ifdef HAVE_CLOCK_NANOSLEEP
+  /* time_spec_t::get_system_time() reads CLOCK_MONOTONIC as well */
+  struct timespec ts;
+  ts.tv_sec = deadline.get_full_secs();
+  ts.tv_nsec = std::min( 999999999L, long( deadline.get_frac_secs() * 1e9 ) );
+
+  while ( EINTR == clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL ) )
+    ;
+#else
+  const double secs = (deadline - osmosdr::time_spec_t::get_system_time()).get_real_secs();
+
+  if ( secs > 0 )
+    std::this_thread::sleep_for( std::chrono::duration< double >( secs ) );
+#endif
+}
+
+/*
+ * Waits for the end of the burst that began at \p start. Sleeps in short
+ * slices so that a flowgraph stop interrupts the wait, and picks up a
+ * new rate for the burst in progress.
+ */
+osmosdr::time_spec_t file_pacer::wait_burst( const osmosdr::time_spec_t &start )
+{
+  const osmosdr::time_spec_t slice( PACE_SLICE_SECS );
+
+  for ( ;; ) {
+    const osmosdr::time_spec_t deadline = start + osmosdr::time_spec_t( _transfer / _rate );
+    const osmosdr::time_spec_t now = osmosdr::time_spec_t::get_system_time();
+
+    if ( now >= deadline )
+      return deadline;
+
+    sleep_until( std::min( deadline, now + slice ) );
+    boost::this_thread::interruption_point();
+  }
+}
+
+size_t file_pacer::pace( size_t wanted )
+{
+  if ( ! _credit ) {
+    if ( ! _started ) {
+      _next = osmosdr::time_spec_t::get_system_time();
+      _last_report = _next;
+      _started = true;
+    }
+
+    _next = wait_burst( _next );
+
+    const osmosdr::time_spec_t now = osmosdr::time_spec_t::get_system_time();
+    const double error = (now - _next).get_real_secs();
+
+    _stats.bursts++;
+    _stats.error_sum += error;
+    _stats.error_max = std::max( _stats.error_max, error );
+
+    if ( error > _transfer / _rate ) {
+      _stats.resyncs++;
+      _next = now;
+    }
+
+    if ( _stats_interval > 0 &&
+         (now - _last_report).get_real_secs() >= _stats_interval ) {
+      _last_report = now;
+      report( "pacing" );
+    }
+
+    _credit = _transfer;
+  }
+
+  const size_t n = std::min( wanted, _credit );
+
+  _credit -= n;
+
+  return n;
+}
+
+void file_pacer::report( const char *what )
+{
+  std::cerr << boost::format( "File %s: %u bursts of %u samples, released "
+                              "%.1f us late on average, %.1f us max, %u resyncs" )
+               % what % _stats.bursts % _transfer
+               % (_stats.bursts ? 1e6 * _stats.error_sum / _stats.bursts : 0.0)
+               % (1e6 * _stats.error_max) % _stats.resyncs
+            << std::endl;
+}
@@ -0,0 +1,96 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_FILE_PACER_H
+#define INCLUDED_FILE_PACER_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include <osmosdr/time_spec.h>
+
+#include "arg_helpers.h"
+
+class file_pacer;
+
+typedef std::shared_ptr< file_pacer > file_pacer_sptr;
+
+/*!
+ * \brief Real-time pacing of file playback and recording.
+ *
+ * Hardware hands over samples a USB transfer at a time: nothing for
+ * transfer / rate seconds, then the whole transfer. The file blocks call
+ * pace() from work() to do the same, which makes replay timing match the
+ * device a recording came from. Deadlines are absolute time_spec_t values
+ * advanced by the nominal period, so wakeup latency never adds up to
+ * drift, and the wait is a clock_nanosleep() on the monotonic clock
+ * wherever the platform has it. It is cut into slices of at most 50 ms,
+ * so a long burst period neither delays a flowgraph stop nor a rate
+ * change.
+ *
+ *   transfer=131072   samples per burst, 256 KiB of the file format by
+ *                     default, like an rtl-sdr transfer of cu8 samples
+ *   pace_stats=10     print the pacing error every 10 seconds
+ *
+ * A burst released more than a period late (an overloaded flowgraph, or
+ * one that was stopped) restarts the schedule instead of catching up.
+ */
+class file_pacer
+{
+public:
+  file_pacer( const dict_t &dict, double rate, size_t item_size );
+  ~file_pacer();
+
+  void set_rate( double rate );
+
+  /*!
+   * Number of samples, at most \p wanted, that may be handed over now.
+   * Waits for the next burst when the current one is used up, so the
+   * result is never 0.
+   */
+  size_t pace( size_t wanted );
+
+  struct stats_t
+  {
+    unsigned long bursts;
+    unsigned long resyncs;  /* bursts released more than a period late */
+    double error_sum;       /* seconds after the deadline, summed */
+    double error_max;
+  };
+
+  stats_t stats() const { return _stats; }
+
+private:
+  void sleep_until( const osmosdr::time_spec_t &deadline );
+  osmosdr::time_spec_t wait_burst( const osmosdr::time_spec_t &start );
+  void report( const char *what );
+
+  std::atomic< double > _rate;
+  size_t _transfer;
+  size_t _credit;           /* samples left in the current burst */
+  bool _started;
+  osmosdr::time_spec_t _next;
+
+  double _stats_interval;
+  stats_t _stats;
+  osmosdr::time_spec_t _last_report;
+};
+
+#endif /* INCLUDED_FILE_PACER_H */
@@ -0,0 +1,453 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/lexical_cast.hpp>
+
+#include <gnuradio/io_signature.h>
+
+#include "file_raw_sink.h"
+#include "file_rotate_sink.h"
+#include "file_trigger_sink.h"
+
+/* interleaved frames are assembled in chunks this size */
+#define INTERLEAVE_SAMPLES 8192
+
+static size_t parse_nchan( const dict_t &dict )
+{
+  dict_t::const_iterator it = dict.find( "nchan" );
+  size_t nchan = 1;
+
+  if ( it != dict.end() )
+    nchan = boost::lexical_cast< size_t >( it->second );
+
+  return std::max< size_t >( nchan, 1 );
+}
+
+file_raw_sink_sptr make_file_raw_sink( const std::string &filename,
+                                       file_format_t format,
+                                       float full_scale,
+                                       bool append,
+                                       const dict_t &dict )
+{
+  const bool trigger = dict.count("pretrigger") || dict.count("posttrigger");
+  const bool rotate = dict.count("rotate_size") || dict.count("rotate_time");
+
+  if ( parse_nchan( dict ) > 1 && (trigger || rotate) )
+    throw std::runtime_error("Multi-channel recordings cannot be triggered or rotated.");
+
+  if ( trigger && rotate )
+    throw std::runtime_error("File rotation and triggered recording are exclusive.");
+
+  if ( trigger )
+    return gnuradio::get_initial_sptr(new file_trigger_sink(filename, format,
+                                                            full_scale, dict));
+
+  if ( rotate )
+    return gnuradio::get_initial_sptr(new file_rotate_sink(filename, format,
+                                                           full_scale, dict));
+
+  return gnuradio::get_initial_sptr(new file_raw_sink(filename, format,
+                                                      full_scale, append, dict));
+}
+
+file_raw_sink::file_raw_sink( const std::string &filename,
+                              file_format_t format,
+                              float full_scale,
+                              bool append,
+                              const dict_t &dict ) :
+  gr::sync_block("file_raw_sink",
+                 gr::io_signature::make(parse_nchan(dict), parse_nchan(dict),
+                                        sizeof (gr_complex)),
+                 gr::io_signature::make(0, 0, 0)),
+  _format(format),
+  _item_size(file_format_size(format)),
+  _full_scale(full_scale),
+  _writer(new file_writer(dict)),
+  _sigmf(false),
+  _session(false),
+  _freq(0),
+  _filename(filename),
+  _rate(0),
+  _dict(dict),
+  _segmented(false),
+  _nchan(parse_nchan(dict))
+{
+  if ( ! (_full_scale > 0) )
+    throw std::runtime_error("Parameter 'full_scale' must be positive.");
+
+  dict_t args = dict;
+
+  if ( args.count("rate") )
+    _rate = boost::lexical_cast< double >( args["rate"] );
+
+  if ( _nchan > 1 ) {
+    for ( size_t chan = 1; chan < _nchan; chan++ ) {
+      std::string key = "file" + boost::lexical_cast< std::string >( chan );
+
+      if ( ! args.count(key) )
+        break;
+
+      _channels.push_back( std::unique_ptr< file_writer >( new file_writer( dict ) ) );
+      _channels.back()->open( args[key], append );
+    }
+
+    if ( _channels.empty() )
+      _frames.resize( std::max< size_t >( 1, INTERLEAVE_SAMPLES / _nchan ) * _nchan );
+    else if ( _channels.size() != _nchan - 1 )
+      throw std::runtime_error("Either name one interleaved file or a file for every channel.");
+  }
+
+  _writer->open( filename, append );
+}
+
+file_raw_sink::file_raw_sink( const std::string &name,
+                              const std::string &filename,
+                              file_format_t format,
+                              float full_scale,
+                              const dict_t &dict ) :
+  gr::sync_block(name,
+                 gr::io_signature::make(1, 1, sizeof (gr_complex)),
+                 gr::io_signature::make(0, 0, 0)),
+  _format(format),
+  _item_size(file_format_size(format)),
+  _full_scale(full_scale),
+  _writer(new file_writer(dict)),
+  _sigmf(false),
+  _session(false),
+  _freq(0),
+  _filename(filename),
+  _rate(0),
+  _dict(dict),
+  _segmented(true),
+  _nchan(1)
+{
+  if ( ! (_full_scale > 0) )
+    throw std::runtime_error("Parameter 'full_scale' must be positive.");
+
+  dict_t::const_iterator it = dict.find( "rate" );
+  if ( it != dict.end() )
+    _rate = boost::lexical_cast< double >( it->second );
+}
+
+file_raw_sink::~file_raw_sink()
+{
+  _writer->close();
+
+  for ( size_t i = 0; i < _channels.size(); i++ )
+    _channels[i]->close();
+
+  if ( _sigmf && ! _segmented ) {
+    try {
+      save_meta();
+    } catch ( std::exception &ex ) {
+      std::cerr << ex.what() << std::endl;
+    }
+  }
+}
+
+/*
+ * "/data/rec.cs16" -> "/data/rec_20261019T123456.789Z_1200000.cs16", the
+ * time and stream sample offset of the first sample in the file. A
+ * .sigmf-data extension is kept as a whole.
+ */
+std::string file_raw_sink::segment_filename( const std::string &filename,
+                                             const osmosdr::time_spec_t &start,
+                                             uint64_t sample )
+{
+  static const std::string sigmf_ext = ".sigmf-data";
+  size_t dot = filename.rfind( '.' );
+  size_t slash = filename.find_last_of( "/\\" );
+
+  if ( filename.size() >= sigmf_ext.size() &&
+       0 == filename.compare( filename.size() - sigmf_ext.size(),
+                              sigmf_ext.size(), sigmf_ext ) )
+    dot = filename.size() - sigmf_ext.size();
+  else if ( std::string::npos == dot ||
+            (std::string::npos != slash && dot < slash) )
+    dot = filename.size();
+
+  time_t secs = start.get_full_secs();
+  struct tm tm;
+  char buf[64];
+
+#if defined(_WIN32)
+  gmtime_s( &tm, &secs );
+#else
+  gmtime_r( &secs, &tm );
+#endif
+
+  strftime( buf, sizeof(buf), "_%Y%m%dT%H%M%S", &tm );
+  snprintf( buf + strlen(buf), sizeof(buf) - strlen(buf), ".%03dZ_%llu",
+            std::min( 999, int( start.get_frac_secs() * 1000 ) ),
+            (unsigned long long)sample );
+
+  return filename.substr( 0, dot ) + buf + filename.substr( dot );
+}
+
+void file_raw_sink::enable_sigmf( const std::string &meta_path, double rate,
+                                  double freq, bool append )
+{
+  std::ifstream existing( meta_path.c_str() );
+
+  if ( append && ! _segmented && existing.good() ) {
+    _meta.load( meta_path );
+    if ( _meta.format() != _format )
+      throw std::runtime_error( "Cannot append " + std::string( _meta.datatype ) +
+                                " recording " + meta_path + " in another format." );
+  } else {
+    _meta.set_format( _format );
+  }
+
+  if ( rate > 0 )
+    _meta.sample_rate = rate;
+
+  _meta_path = meta_path;
+  _freq = freq;
+  _sigmf = true;
+}
+
+void file_raw_sink::set_sample_rate( double rate )
+{
+  if ( _sigmf && _meta.sample_rate <= 0 )
+    _meta.sample_rate = rate;
+}
+
+bool file_raw_sink::start()
+{
+  return true;
+}
+
+bool file_raw_sink::stop()
+{
+  _writer->flush();
+
+  for ( size_t i = 0; i < _channels.size(); i++ )
+    _channels[i]->flush();
+
+  if ( _sigmf )
+    save_meta();
+
+  /* a restarted flowgraph continues as a new capture segment */
+  _session = false;
+
+  return true;
+}
+
+void file_raw_sink::save_meta()
+{
+  _meta.save( _meta_path );
+}
+
+/* fresh metadata for a file of its own: event or segment */
+void file_raw_sink::begin_meta( const std::string &filename,
+                                const osmosdr::time_spec_t &start )
+{
+  std::string data_path;
+
+  if ( ! sigmf_meta::locate( filename, false, _meta_path, data_path ) )
+    _meta_path = filename + ".sigmf-meta";
+
+  _meta.captures.clear();
+  _meta.annotations.clear();
+
+  sigmf_capture &c = _meta.capture_at( 0 );
+  c.frequency = _freq;
+  c.time = start;
+  c.has_time = true;
+
+  _session = true;
+}
+
+void file_raw_sink::record_tags( uint64_t from, uint64_t count )
+{
+  record_tags( from, count, _writer->position() / _item_size );
+}
+
+void file_raw_sink::follow_tuning( uint64_t from, uint64_t count )
+{
+  std::vector< gr::tag_t > tags;
+
+  get_tags_in_range( tags, 0, from, from + count, pmt::mp("rx_freq") );
+
+  for ( size_t i = 0; i < tags.size(); i++ )
+    _freq = pmt::to_double( tags[i].value );
+}
+
+void file_raw_sink::record_tags( uint64_t from, uint64_t count,
+                                 uint64_t sample )
+{
+  std::vector< gr::tag_t > tags;
+
+  get_tags_in_range( tags, 0, from, from + count );
+
+  if ( ! _session ) {
+    sigmf_capture &c = _meta.capture_at( sample );
+
+    if ( _freq > 0 )
+      c.frequency = _freq;
+    c.time = sigmf_meta::utc_now();
+    c.has_time = true;
+
+    _session = true;
+    save_meta();
+  }
+
+  std::stable_sort( tags.begin(), tags.end(),
+                    []( const gr::tag_t &a, const gr::tag_t &b ) {
+                      return a.offset < b.offset;
+                    } );
+
+  for ( size_t i = 0; i < tags.size(); i++ ) {
+    const uint64_t s = sample + (tags[i].offset - from);
+    const std::string key = pmt::symbol_to_string( tags[i].key );
+    const pmt::pmt_t &value = tags[i].value;
+
+    if ( "rx_freq" == key ) {
+      double freq = pmt::to_double( value );
+
+      _freq = freq;
+      if ( _meta.captures.back().frequency != freq )
+        _meta.capture_at( s ).frequency = freq;
+    } else if ( "rx_time" == key ) {
+      osmosdr::time_spec_t time( time_t( pmt::to_uint64( pmt::tuple_ref( value, 0 ) ) ),
+                                 pmt::to_double( pmt::tuple_ref( value, 1 ) ) );
+      osmosdr::time_spec_t expected;
+
+      /* only a new segment if the stream is not where the clock says */
+      if ( ! _meta.time_of( s, expected ) ||
+           std::abs( (time - expected).get_real_secs() * _meta.sample_rate ) >= 1 ) {
+        sigmf_capture &c = _meta.capture_at( s );
+        c.time = time;
+        c.has_time = true;
+      }
+    } else if ( "rx_gap" == key ) {
+      uint64_t lost = pmt::to_uint64( value );
+      sigmf_capture &c = _meta.capture_at( s );
+
+      if ( c.has_time && _meta.sample_rate > 0 )
+        c.time += osmosdr::time_spec_t( lost / _meta.sample_rate );
+
+      sigmf_annotation a;
+      a.sample_start = s;
+      a.sample_count = 0;
+      a.label = "rx_gap";
+      a.comment = boost::lexical_cast< std::string >( lost ) + " samples lost";
+      _meta.annotations.push_back( a );
+    } else if ( "rx_rate" == key ) {
+      double rate = pmt::to_double( value );
+
+      if ( _meta.sample_rate <= 0 ) {
+        _meta.sample_rate = rate;
+      } else if ( rate != _meta.sample_rate ) {
+        /* SigMF has a single sample rate per recording */
+        sigmf_annotation a;
+        a.sample_start = s;
+        a.sample_count = 0;
+        a.label = "rx_rate";
+        a.comment = "sample rate changed to " + boost::lexical_cast< std::string >( rate );
+        _meta.annotations.push_back( a );
+      }
+    }
+  }
+}
+
+void file_raw_sink::write_samples( const gr_complex *in, size_t count )
+{
+  write_samples( *_writer, in, count );
+}
+
+void file_raw_sink::write_samples( file_writer &writer, const gr_complex *in,
+                                   size_t count )
+{
+  for ( size_t done = 0; done < count; ) {
+    unsigned char *buf;
+    size_t n = std::min< size_t >( count - done, writer.span( buf ) / _item_size );
+
+    convert_from_complex( _format, in + done, buf, n, _full_scale );
+    writer.commit( n * _item_size );
+
+    done += n;
+  }
+}
+
+/*
+ * The channels of a frame are interleaved in cache sized chunks and then
+ * quantised in one go, or each goes to its own file.
+ */
+void file_raw_sink::channel_work( gr_vector_const_void_star &input_items,
+                                  int noutput_items )
+{
+  if ( ! _channels.empty() ) {
+    write_samples( (const gr_complex *)input_items[0], noutput_items );
+
+    for ( size_t c = 1; c < _nchan; c++ )
+      write_samples( *_channels[c - 1], (const gr_complex *)input_items[c],
+                     noutput_items );
+
+    return;
+  }
+
+  const size_t chunk = _frames.size() / _nchan;
+  std::vector< const gr_complex * > src( _nchan );
+
+  for ( size_t done = 0; done < size_t(noutput_items); ) {
+    const size_t n = std::min( noutput_items - done, chunk );
+
+    for ( size_t c = 0; c < _nchan; c++ )
+      src[c] = (const gr_complex *)input_items[c] + done;
+
+    interleave_complex( &src[0], &_frames[0], _nchan, n );
+    write_samples( &_frames[0], n * _nchan );
+
+    done += n;
+  }
+}
+
+int file_raw_sink::work( int noutput_items,
+                         gr_vector_const_void_star &input_items,
+                         gr_vector_void_star &output_items )
+{
+  if ( _pacer )
+    noutput_items = _pacer->pace( noutput_items );
+
+  if ( _nchan > 1 ) {
+    channel_work( input_items, noutput_items );
+    return noutput_items;
+  }
+
+  if ( _sigmf )
+    record_tags( nitems_read(0), noutput_items );
+
+  write_samples( (const gr_complex *)input_items[0], noutput_items );
+
+  return noutput_items;
+}
@@ -0,0 +1,146 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_FILE_RAW_SINK_H
+#define INCLUDED_FILE_RAW_SINK_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gnuradio/sync_block.h>
+
+#include "arg_helpers.h"
+#include "file_convert.h"
+#include "file_pacer.h"
+#include "file_writer.h"
+#include "sigmf.h"
+
+class file_raw_sink;
+
+typedef std::shared_ptr< file_raw_sink > file_raw_sink_sptr;
+
+file_raw_sink_sptr make_file_raw_sink( const std::string &filename,
+                                       file_format_t format,
+                                       float full_scale,
+                                       bool append,
+                                       const dict_t &dict = dict_t() );
+
+/*!
+ * \brief I/Q file writer quantising to the on-disk sample format.
+ *
+ * Samples are converted with saturation straight into the buffers of a
+ * file_writer, which does the actual I/O; see there for the writer
+ * options taken from \p dict.
+ *
+ * make_file_raw_sink() returns a file_trigger_sink with pretrigger= or
+ * posttrigger= and a file_rotate_sink with rotate_size= or rotate_time=
+ * in \p dict; both build on this class for quantisation and SigMF.
+ *
+ * nchan=2 gives an input per channel. They are written in lockstep as
+ * frames of one sample per channel to \p filename, or, if file1=...
+ * names the second file and so on, each channel to a file of its own.
+ * Neither works with triggers or rotation.
+ */
+class file_raw_sink : public gr::sync_block
+{
+private:
+  friend file_raw_sink_sptr make_file_raw_sink( const std::string &filename,
+                                                file_format_t format,
+                                                float full_scale,
+                                                bool append,
+                                                const dict_t &dict );
+
+  file_raw_sink( const std::string &filename, file_format_t format,
+                 float full_scale, bool append, const dict_t &dict );
+
+protected:
+  /* single channel, the subclass opens and closes the files itself */
+  file_raw_sink( const std::string &name, const std::string &filename,
+                 file_format_t format, float full_scale, const dict_t &dict );
+
+public:
+  ~file_raw_sink();
+
+  /*!
+   * Writes a SigMF .sigmf-meta next to the data, recording retunes
+   * (rx_freq), timestamps (rx_time) and dropouts (rx_gap) from the
+   * incoming stream tags as capture segments.
+   */
+  void enable_sigmf( const std::string &meta_path, double rate, double freq,
+                     bool append );
+  void set_sample_rate( double rate );
+
+  virtual bool triggered() const { return false; }
+
+  bool start();
+  bool stop();
+
+  /* takes samples no faster than a transmitting device would */
+  void set_pacer( const file_pacer_sptr &pacer ) { _pacer = pacer; }
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+protected:
+  static std::string segment_filename( const std::string &filename,
+                                       const osmosdr::time_spec_t &start,
+                                       uint64_t sample );
+
+  /* tags of stream items [from, from + count), the first at file sample
+   * \p sample, or at the current write position */
+  void record_tags( uint64_t from, uint64_t count );
+  void record_tags( uint64_t from, uint64_t count, uint64_t sample );
+  /* keeps track of retunes while no file is being written */
+  void follow_tuning( uint64_t from, uint64_t count );
+
+  void write_samples( const gr_complex *in, size_t count );
+  void write_samples( file_writer &writer, const gr_complex *in, size_t count );
+  void save_meta();
+  void begin_meta( const std::string &filename, const osmosdr::time_spec_t &start );
+
+  file_format_t _format;
+  size_t _item_size;
+  float _full_scale;
+
+  std::unique_ptr< file_writer > _writer;
+
+  bool _sigmf;
+  bool _session;          /* the capture for this run has been started */
+  std::string _meta_path;
+  sigmf_meta _meta;
+  double _freq;
+
+  std::string _filename;
+  double _rate;
+  dict_t _dict;
+  bool _segmented;        /* every event or segment is a file of its own */
+
+  file_pacer_sptr _pacer;
+
+private:
+  void channel_work( gr_vector_const_void_star &input_items, int noutput_items );
+
+  size_t _nchan;
+  std::vector< std::unique_ptr< file_writer > > _channels; /* file1= and on */
+  std::vector< gr_complex > _frames;
+};
+
+#endif /* INCLUDED_FILE_RAW_SINK_H */
@@ -0,0 +1,278 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/lexical_cast.hpp>
+
+#include <gnuradio/io_signature.h>
+
+#include "file_rotate_sink.h"
+
+file_rotate_sink::file_rotate_sink( const std::string &filename,
+                                    file_format_t format,
+                                    float full_scale,
+                                    const dict_t &dict ) :
+  file_raw_sink("file_rotate_sink", filename, format, full_scale, dict),
+  _segment_items(0),
+  _segment_left(0),
+  _total(0),
+  _start_total(0),
+  _rotate_quit(false),
+  _next_first(0)
+{
+  dict_t args = dict;
+
+  if ( ! (_rate > 0) )
+    throw std::runtime_error("Parameter 'rate' is required for file rotation.");
+
+  _segment_items = UINT64_MAX;
+
+  if ( args.count("rotate_size") )
+    _segment_items = uint64_t( boost::lexical_cast< double >( args["rotate_size"] ) ) / _item_size;
+
+  if ( args.count("rotate_time") )
+    _segment_items = std::min( _segment_items, uint64_t(
+      boost::lexical_cast< double >( args["rotate_time"] ) * _rate + 0.5 ) );
+
+  if ( 0 == _segment_items )
+    throw std::runtime_error("File rotation interval is too small.");
+
+  /* the first segment is opened by start() */
+}
+
+file_rotate_sink::~file_rotate_sink()
+{
+  stop_rotation();
+}
+
+bool file_rotate_sink::start()
+{
+  _start_time = sigmf_meta::utc_now();
+  _start_total = _total;
+
+  const std::string filename = segment_filename( _filename, _start_time, _total );
+
+  _writer->open( filename, false );
+  _segment_left = _segment_items;
+
+  if ( _sigmf )
+    begin_meta( filename, _start_time );
+
+  _rotate_quit = false;
+  _rotate_error.clear();
+  _rotate_thread = std::thread( &file_rotate_sink::rotate_run, this );
+
+  prepare_segment();
+
+  return true;
+}
+
+bool file_rotate_sink::stop()
+{
+  stop_rotation();
+
+  _writer->close();
+  if ( _sigmf )
+    save_meta();
+
+  return true;
+}
+
+/*
+ * Segment start times are extrapolated from start() at the nominal rate,
+ * which keeps the names of consecutive segments consistent with each
+ * other and lets the next file be opened ahead of time.
+ */
+osmosdr::time_spec_t file_rotate_sink::segment_time( uint64_t first ) const
+{
+  return _start_time + osmosdr::time_spec_t( (first - _start_total) / _rate );
+}
+
+/* asks the helper thread for the file following the current segment */
+void file_rotate_sink::prepare_segment()
+{
+  const uint64_t first = _total + _segment_left;
+
+  std::lock_guard< std::mutex > lock( _rotate_lock );
+
+  _next_first = first;
+  _next_name = segment_filename( _filename, segment_time( first ), first );
+  _rotate_cond.notify_all();
+}
+
+void file_rotate_sink::next_segment()
+{
+  std::unique_lock< std::mutex > lock( _rotate_lock );
+
+  if ( ! _next && _rotate_error.empty() ) {
+    std::cerr << "Segment " << _next_name << " is not open yet, waiting"
+              << std::endl;
+
+    _rotate_cond.wait( lock, [this] { return _next || ! _rotate_error.empty(); } );
+  }
+
+  if ( ! _rotate_error.empty() )
+    throw std::runtime_error( _rotate_error );
+
+  retired_t r;
+  r.writer = std::move( _writer );
+  r.sigmf = _sigmf;
+  if ( _sigmf ) {
+    r.meta = _meta;
+    r.meta_path = _meta_path;
+  }
+  _retired.push_back( std::move( r ) );
+
+  const std::string filename = _next_name;
+
+  _writer = std::move( _next );
+  _next_name.clear();
+  lock.unlock();
+
+  _segment_left = _segment_items;
+
+  if ( _sigmf )
+    begin_meta( filename, segment_time( _total ) );
+
+  prepare_segment();
+}
+
+int file_rotate_sink::work( int noutput_items,
+                            gr_vector_const_void_star &input_items,
+                            gr_vector_void_star &output_items )
+{
+  if ( _pacer )
+    noutput_items = _pacer->pace( noutput_items );
+
+  const gr_complex *in = (const gr_complex *)input_items[0];
+  const uint64_t read = nitems_read(0);
+
+  for ( uint64_t pos = 0; pos < uint64_t( noutput_items ); ) {
+    if ( 0 == _segment_left )
+      next_segment();
+
+    uint64_t count = std::min( noutput_items - pos, _segment_left );
+
+    if ( _sigmf )
+      record_tags( read + pos, count );
+
+    write_samples( in + pos, count );
+
+    _segment_left -= count;
+    _total += count;
+    pos += count;
+  }
+
+  return noutput_items;
+}
+
+void file_rotate_sink::close_segment( retired_t &r )
+{
+  try {
+    r.writer->close();
+    if ( r.sigmf )
+      r.meta.save( r.meta_path );
+  } catch ( std::exception &ex ) {
+    std::cerr << ex.what() << std::endl;
+  }
+}
+
+/*
+ * Helper thread: opens the next segment as soon as its name is known and
+ * closes retired ones, so the file system metadata work (create, truncate,
+ * the final flush and the SigMF update) stays off the streaming thread.
+ */
+void file_rotate_sink::rotate_run()
+{
+  std::unique_lock< std::mutex > lock( _rotate_lock );
+
+  while ( ! _rotate_quit ) {
+    if ( ! _next && ! _next_name.empty() && _rotate_error.empty() ) {
+      const std::string name = _next_name;
+
+      lock.unlock();
+
+      std::unique_ptr< file_writer > w( new file_writer( _dict ) );
+      std::string error;
+
+      try {
+        w->open( name, false );
+      } catch ( std::exception &ex ) {
+        error = ex.what();
+      }
+
+      lock.lock();
+
+      if ( error.empty() )
+        _next = std::move( w );
+      else
+        _rotate_error = error;
+
+      _rotate_cond.notify_all();
+      continue;
+    }
+
+    if ( ! _retired.empty() ) {
+      retired_t r = std::move( _retired.front() );
+      _retired.pop_front();
+
+      lock.unlock();
+      close_segment( r );
+      lock.lock();
+      continue;
+    }
+
+    _rotate_cond.wait( lock );
+  }
+}
+
+/* finishes the retired segments and removes the one opened in advance */
+void file_rotate_sink::stop_rotation()
+{
+  if ( ! _rotate_thread.joinable() )
+    return;
+
+  {
+    std::lock_guard< std::mutex > lock( _rotate_lock );
+    _rotate_quit = true;
+    _rotate_cond.notify_all();
+  }
+
+  _rotate_thread.join();
+
+  for ( size_t i = 0; i < _retired.size(); i++ )
+    close_segment( _retired[i] );
+  _retired.clear();
+
+  if ( _next ) {
+    _next->close();
+    ::remove( _next_name.c_str() );
+    _next.reset();
+  }
+  _next_name.clear();
+}
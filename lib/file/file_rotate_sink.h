@@ -0,0 +1,98 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_FILE_ROTATE_SINK_H
+#define INCLUDED_FILE_ROTATE_SINK_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "file_raw_sink.h"
+
+/*!
+ * \brief Raw file sink splitting the recording into segments.
+ *
+ * rotate_size=1e9 (bytes) and/or rotate_time=3600 (seconds, rate=
+ * required) start a new file whenever either is reached, named after
+ * \p filename with the UTC start time and stream sample offset of its
+ * first sample inserted.
+ *
+ * Boundaries are sample exact and nothing is lost between segments: the
+ * next file is opened and the previous one closed by a helper thread,
+ * so work() only ever swaps writers.
+ */
+class file_rotate_sink : public file_raw_sink
+{
+private:
+  friend file_raw_sink_sptr make_file_raw_sink( const std::string &filename,
+                                                file_format_t format,
+                                                float full_scale,
+                                                bool append,
+                                                const dict_t &dict );
+
+  file_rotate_sink( const std::string &filename, file_format_t format,
+                    float full_scale, const dict_t &dict );
+
+public:
+  ~file_rotate_sink();
+
+  bool start();
+  bool stop();
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+private:
+  struct retired_t
+  {
+    std::unique_ptr< file_writer > writer;
+    bool sigmf;
+    sigmf_meta meta;
+    std::string meta_path;
+  };
+
+  static void close_segment( retired_t &r );
+
+  void next_segment();
+  void prepare_segment();
+  void rotate_run();
+  void stop_rotation();
+  osmosdr::time_spec_t segment_time( uint64_t first ) const;
+
+  uint64_t _segment_items;
+  uint64_t _segment_left;
+  uint64_t _total;         /* samples written to all segments */
+  uint64_t _start_total;   /* _total at start() */
+  osmosdr::time_spec_t _start_time;
+
+  std::thread _rotate_thread;
+  std::mutex _rotate_lock;
+  std::condition_variable _rotate_cond;
+  bool _rotate_quit;
+  std::string _next_name;  /* segment the helper thread should open */
+  uint64_t _next_first;
+  std::unique_ptr< file_writer > _next;
+  std::deque< retired_t > _retired;
+  std::string _rotate_error;
+};
+
+#endif /* INCLUDED_FILE_ROTATE_SINK_H */
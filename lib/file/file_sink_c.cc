@@ -38,14 +38,37 @@ file_sink_c_sptr make_file_sink_c(const std::string &args)
   return gnuradio::get_initial_sptr(new file_sink_c(args));
 }
 
+static size_t parse_nchan(const std::string &args)
+{
+  size_t nchan = 1;
+
+  dict_t dict = params_to_dict(args);
+
+  if (dict.count("nchan"))
+    nchan = boost::lexical_cast< size_t >( dict["nchan"] );
+
+  if (nchan < 1)
+    nchan = 1;
+
+  return nchan;
+}
+
 file_sink_c::file_sink_c(const std::string &args) :
   gr::hier_block2("file_sink_c",
-                 gr::io_signature::make(1, 1, sizeof (gr_complex)),
-                 gr::io_signature::make(0, 0, 0))
+                 gr::io_signature::make(parse_nchan(args),
+                                        parse_nchan(args),
+                                        sizeof (gr_complex)),
+                 gr::io_signature::make(0, 0, 0)),
+  _nchan(parse_nchan(args))
 {
   std::string filename;
   bool append = false;
   bool throttle = false;
+  file_format_t format = FILE_CF32;
+  float full_scale = 1.0f;
+  bool sigmf = false;
+  bool compress = false;
+  std::string meta_path, data_path;
   _freq = 0;
   _rate = 0;
 
@@ -66,9 +89,29 @@ file_sink_c::file_sink_c(const std::string &args) :
   if (dict.count("append"))
     append = ("true" == dict["append"] ? true : false);
 
+  if (dict.count("format"))
+    format = file_format_from_string( dict["format"] );
+
+  if (dict.count("full_scale"))
+    full_scale = boost::lexical_cast< float >( dict["full_scale"] );
+
+  if (dict.count("compress"))
+    compress = ("1" == dict["compress"] || "true" == dict["compress"]);
+
+  if (dict.count("sigmf"))
+    sigmf = ("1" == dict["sigmf"] || "true" == dict["sigmf"]);
+
   if (!filename.length())
     throw std::runtime_error("No file name specified.");
 
+  /* naming a .sigmf-meta or .sigmf-data file implies sigmf=1 */
+  if (sigmf_meta::locate( filename, false, meta_path, data_path )) {
+    sigmf = true;
+    filename = data_path;
+  } else if (sigmf) {
+    meta_path = filename + ".sigmf-meta";
+  }
+
   if (_freq < 0)
     throw std::runtime_error("Parameter 'freq' may not be negative.");
 
@@ -77,18 +120,42 @@ file_sink_c::file_sink_c(const std::string &args) :
 
   _file_rate = _rate;
 
-  _sink = gr::blocks::file_sink::make( sizeof(gr_complex),
-                                           filename.c_str(),
-                                           append);
+  gr::basic_block_sptr sink;
 
-  _throttle = gr::blocks::throttle::make( sizeof(gr_complex), _file_rate );
+  if (_nchan > 1 && (compress || sigmf))
+    throw std::runtime_error("Multi-channel recordings are written as raw files only.");
 
-  if (throttle) {
-    connect( self(), 0, _throttle, 0 );
-    connect( _throttle, 0, _sink, 0 );
+  if (compress) {
+    if (sigmf || dict.count("pretrigger") || dict.count("posttrigger") ||
+        dict.count("rotate_size") || dict.count("rotate_time"))
+      throw std::runtime_error("compress=1 writes plain iqz files, without SigMF, triggers or rotation.");
+
+    _iqz = make_file_iqz_sink( filename, format, full_scale, append, dict );
+    sink = _iqz;
   } else {
-    connect( self(), 0, _sink, 0 );
+    _sink = make_file_raw_sink( filename, format, full_scale, append, dict );
+    sink = _sink;
+
+    if (sigmf)
+      _sink->enable_sigmf( meta_path, _rate, _freq, append );
+
+    if (_sink->triggered()) {
+      message_port_register_hier_in( pmt::mp("trigger") );
+      msg_connect( self(), pmt::mp("trigger"), _sink, pmt::mp("trigger") );
+    }
   }
+
+  if (throttle) {
+    _pacer = std::make_shared< file_pacer >( dict, _file_rate,
+                                             file_format_size( format ) );
+    if (_iqz)
+      _iqz->set_pacer( _pacer );
+    else
+      _sink->set_pacer( _pacer );
+  }
+
+  for (size_t chan = 0; chan < _nchan; chan++)
+    connect( self(), chan, sink, chan );
 }
 
 file_sink_c::~file_sink_c()
@@ -107,7 +174,7 @@ std::vector<std::string> file_sink_c::get_devices( bool fake )
   if ( fake )
   {
     std::string args = "file='/path/to/your/file'";
-    args += ",rate=1e6,freq=100e6,throttle=true";
+    args += ",rate=1e6,freq=100e6,throttle=true,format=cf32";
     args += ",label='Complex Sampled (IQ) File'";
     devices.push_back( args );
   }
@@ -117,7 +184,7 @@ std::vector<std::string> file_sink_c::get_devices( bool fake )
 
 size_t file_sink_c::get_num_channels( void )
 {
-  return 1;
+  return _nchan;
 }
 
 osmosdr::meta_range_t file_sink_c::get_sample_rates( void )
@@ -138,7 +205,10 @@ double file_sink_c::set_sample_rate( double rate )
               << std::endl;
   }
 
-  _throttle->set_sample_rate( rate );
+  if ( _pacer )
+    _pacer->set_rate( rate );
+  if ( _sink )
+    _sink->set_sample_rate( rate );
 
   _rate = rate;
 
@@ -21,10 +21,11 @@
 #define FILE_SINK_C_H
 
 #include <gnuradio/hier_block2.h>
-#include <gnuradio/blocks/file_sink.h>
-#include <gnuradio/blocks/throttle.h>
 
 #include "sink_iface.h"
+#include "file_raw_sink.h"
+#include "file_iqz_sink.h"
+#include "file_pacer.h"
 
 class file_sink_c;
 
@@ -73,8 +74,10 @@ public:
   std::string get_antenna( size_t chan = 0 );
 
 private:
-  gr::blocks::file_sink::sptr _sink;
-  gr::blocks::throttle::sptr _throttle;
+  file_raw_sink_sptr _sink;
+  file_iqz_sink_sptr _iqz;
+  file_pacer_sptr _pacer;
+  size_t _nchan;
   double _file_rate;
   double _freq, _rate;
 };
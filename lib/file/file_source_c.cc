@@ -18,7 +18,9 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#include <algorithm>
 #include <fstream>
+#include <iostream>
 #include <string>
 #include <sstream>
 
@@ -38,14 +40,33 @@ file_source_c_sptr make_file_source_c(const std::string &args)
   return gnuradio::get_initial_sptr(new file_source_c(args));
 }
 
+static size_t parse_nchan(const std::string &args)
+{
+  size_t nchan = 1;
+
+  dict_t dict = params_to_dict(args);
+
+  if (dict.count("nchan"))
+    nchan = boost::lexical_cast< size_t >( dict["nchan"] );
+
+  if (nchan < 1)
+    nchan = 1;
+
+  return nchan;
+}
+
 file_source_c::file_source_c(const std::string &args) :
   gr::hier_block2("file_source_c",
                  gr::io_signature::make(0, 0, 0),
-                 gr::io_signature::make(1, 1, sizeof (gr_complex)))
+                 gr::io_signature::make(parse_nchan(args),
+                                        parse_nchan(args),
+                                        sizeof (gr_complex))),
+  _nchan(parse_nchan(args))
 {
   std::string filename;
   bool repeat = true;
   bool throttle = true;
+  file_format_t format = FILE_CF32;
   _freq = 0;
   _rate = 0;
 
@@ -54,6 +75,19 @@ file_source_c::file_source_c(const std::string &args) :
   if (dict.count("file"))
     filename = dict["file"];
 
+  /* a SigMF recording supplies the format, rate and frequency itself */
+  std::string meta_path, data_path;
+  bool sigmf = sigmf_meta::locate( filename, true, meta_path, data_path );
+
+  if (sigmf) {
+    _meta.load( meta_path );
+    filename = data_path;
+    format = _meta.format();
+    _rate = _meta.sample_rate;
+    if (_meta.captures.size())
+      _freq = _meta.captures.front().frequency;
+  }
+
   if (dict.count("freq"))
     _freq = boost::lexical_cast< double >( dict["freq"] );
 
@@ -66,6 +100,9 @@ file_source_c::file_source_c(const std::string &args) :
   if (dict.count("throttle"))
     throttle = ("true" == dict["throttle"] ? true : false);
 
+  if (dict.count("format"))
+    format = file_format_from_string( dict["format"] );
+
   if (!filename.length())
     throw std::runtime_error("No file name specified.");
 
@@ -77,18 +114,56 @@ file_source_c::file_source_c(const std::string &args) :
 
   _file_rate = _rate;
 
-  _source = gr::blocks::file_source::make( sizeof(gr_complex),
-                                           filename.c_str(),
-                                           repeat );
+  /* file1=, file2=, ... name the files of the other channels */
+  std::vector< std::string > filenames( 1, filename );
 
-  _throttle = gr::blocks::throttle::make( sizeof(gr_complex), _file_rate );
+  for (size_t chan = 1; chan < _nchan; chan++) {
+    std::string key = "file" + boost::lexical_cast< std::string >( chan );
 
-  if (throttle) {
-    connect( _source, 0, _throttle, 0 );
-    connect( _throttle, 0, self(), 0 );
+    if (dict.count(key))
+      filenames.push_back( dict[key] );
+  }
+
+  if (filenames.size() != 1 && filenames.size() != _nchan)
+    throw std::runtime_error("Either name one interleaved file or a file for every channel.");
+
+  gr::basic_block_sptr source;
+
+  /* compressed recordings identify themselves, format= does not apply */
+  if (!sigmf && iqz_probe( filename )) {
+    if (_nchan > 1)
+      throw std::runtime_error("Compressed recordings hold a single channel.");
+
+    _iqz = make_file_iqz_source( filename, repeat, dict );
+    source = _iqz;
   } else {
-    connect( _source, 0, self(), 0 );
+    if (sigmf && _nchan > 1)
+      throw std::runtime_error("SigMF recordings are read as a single channel.");
+
+    _source = make_file_mmap_source( filenames, format, repeat, _nchan );
+    source = _source;
+
+    if (sigmf)
+      load_sigmf( meta_path );
   }
+
+  /* bursts are sized in bytes of the file, a frame of all channels if interleaved */
+  if (throttle) {
+    size_t frame = file_format_size( format );
+
+    if (filenames.size() < _nchan)
+      frame *= _nchan;
+
+    _pacer = std::make_shared< file_pacer >( dict, _file_rate, frame );
+
+    if (_iqz)
+      _iqz->set_pacer( _pacer );
+    else
+      _source->set_pacer( _pacer );
+  }
+
+  for (size_t chan = 0; chan < _nchan; chan++)
+    connect( source, chan, self(), chan );
 }
 
 file_source_c::~file_source_c()
@@ -107,7 +182,7 @@ std::vector<std::string> file_source_c::get_devices( bool fake )
   if ( fake )
   {
     std::string args = "file='/path/to/your/file'";
-    args += ",rate=1e6,freq=100e6,repeat=true,throttle=true";
+    args += ",rate=1e6,freq=100e6,repeat=true,throttle=true,format=cf32";
     args += ",label='Complex Sampled (IQ) File'";
     devices.push_back( args );
   }
@@ -117,14 +192,83 @@ std::vector<std::string> file_source_c::get_devices( bool fake )
 
 size_t file_source_c::get_num_channels( void )
 {
-  return 1;
+  return _nchan;
 }
 
 bool file_source_c::seek( long seek_point, int whence , size_t chan )
 {
+    if ( _iqz )
+      return _iqz->seek( seek_point, whence );
+
     return _source->seek( seek_point, whence );
 }
 
+/*
+ * Timestamped recordings are searched through their captures index, for
+ * anything else the time counts from the first sample.
+ */
+bool file_source_c::seek_time( const osmosdr::time_spec_t &time, size_t chan )
+{
+  uint64_t sample;
+
+  if ( ! _meta.sample_at( time, sample ) ) {
+    if ( time.get_real_secs() < 0 || _file_rate <= 0 )
+      return false;
+
+    sample = time.get_real_secs() * _file_rate + 0.5;
+  }
+
+  if ( _iqz )
+    return _iqz->seek_to( sample );
+
+  return _source->seek_to( sample );
+}
+
+/* retunes and timestamps of the recording come back as stream tags */
+void file_source_c::load_sigmf( const std::string &meta_path )
+{
+  std::vector< gr::tag_t > tags;
+  gr::tag_t tag;
+
+  for ( size_t i = 0; i < _meta.captures.size(); i++ ) {
+    const sigmf_capture &c = _meta.captures[i];
+
+    tag.offset = c.sample_start;
+
+    if ( c.frequency > 0 ) {
+      tag.key = pmt::string_to_symbol( "rx_freq" );
+      tag.value = pmt::from_double( c.frequency );
+      tags.push_back( tag );
+    }
+
+    if ( c.has_time ) {
+      tag.key = pmt::string_to_symbol( "rx_time" );
+      tag.value = pmt::make_tuple( pmt::from_uint64( c.time.get_full_secs() ),
+                                   pmt::from_double( c.time.get_frac_secs() ) );
+      tags.push_back( tag );
+    }
+  }
+
+  for ( size_t i = 0; i < _meta.annotations.size(); i++ ) {
+    const sigmf_annotation &a = _meta.annotations[i];
+
+    tag.offset = a.sample_start;
+    tag.key = pmt::string_to_symbol( "annotation" );
+    tag.value = pmt::string_to_symbol( a.label.empty() ? a.comment : a.label );
+    tags.push_back( tag );
+  }
+
+  std::stable_sort( tags.begin(), tags.end(),
+                    []( const gr::tag_t &a, const gr::tag_t &b ) {
+                      return a.offset < b.offset;
+                    } );
+
+  _source->set_file_tags( tags );
+
+  std::cerr << "Using SigMF metadata from " << meta_path << ", "
+            << _meta.captures.size() << " captures" << std::endl;
+}
+
 osmosdr::meta_range_t file_source_c::get_sample_rates( void )
 {
   osmosdr::meta_range_t range;
@@ -143,7 +287,8 @@ double file_source_c::set_sample_rate( double rate )
               << std::endl;
   }
 
-  _throttle->set_sample_rate( rate );
+  if ( _pacer )
+    _pacer->set_rate( rate );
 
   _rate = rate;
 
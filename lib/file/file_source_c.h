@@ -21,10 +21,12 @@
 #define FILE_SOURCE_C_H
 
 #include <gnuradio/hier_block2.h>
-#include <gnuradio/blocks/file_source.h>
-#include <gnuradio/blocks/throttle.h>
 
 #include "source_iface.h"
+#include "file_mmap_source.h"
+#include "file_iqz_source.h"
+#include "file_pacer.h"
+#include "sigmf.h"
 
 class file_source_c;
 
@@ -51,6 +53,7 @@ public:
   size_t get_num_channels( void );
 
   bool seek( long seek_point, int whence, size_t chan );
+  bool seek_time( const osmosdr::time_spec_t &time, size_t chan );
 
   osmosdr::meta_range_t get_sample_rates( void );
   double set_sample_rate( double rate );
@@ -75,8 +78,13 @@ public:
   std::string get_antenna( size_t chan = 0 );
 
 private:
-  gr::blocks::file_source::sptr _source;
-  gr::blocks::throttle::sptr _throttle;
+  void load_sigmf( const std::string &meta_path );
+
+  file_mmap_source_sptr _source;
+  file_iqz_source_sptr _iqz;
+  sigmf_meta _meta;
+  file_pacer_sptr _pacer;
+  size_t _nchan;
   double _file_rate;
   double _freq, _rate;
 };
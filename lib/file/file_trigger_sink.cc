@@ -0,0 +1,387 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/lexical_cast.hpp>
+
+#include <gnuradio/io_signature.h>
+
+#include "file_trigger_sink.h"
+
+/* seconds of samples the ring holds beyond the pretrigger window while
+ * the writer thread opens a file or catches up */
+#define TRIGGER_BACKLOG 1.0
+
+/* the writer thread hands ring space back in steps of this fraction */
+#define TRIGGER_WRITE_DIV 8
+
+file_trigger_sink::file_trigger_sink( const std::string &filename,
+                                      file_format_t format,
+                                      float full_scale,
+                                      const dict_t &dict ) :
+  file_raw_sink("file_trigger_sink", filename, format, full_scale, dict),
+  _alloc(dict),
+  _ring(NULL),
+  _ring_items(0),
+  _ring_start(0),
+  _pre_items(0),
+  _post_items(0),
+  _post_left(0),
+  _active(false),
+  _first(0),
+  _trigger_msg(false),
+  _produced(0),
+  _quit(false)
+{
+  dict_t args = dict;
+  double pre = 0, post = 0;
+
+  if ( args.count("pretrigger") )
+    pre = boost::lexical_cast< double >( args["pretrigger"] );
+
+  if ( args.count("posttrigger") )
+    post = boost::lexical_cast< double >( args["posttrigger"] );
+
+  if ( ! (_rate > 0) )
+    throw std::runtime_error("Parameter 'rate' is required for triggered recording.");
+
+  if ( pre < 0 || post < 0 )
+    throw std::runtime_error("Trigger windows may not be negative.");
+
+  _pre_items = uint64_t( pre * _rate + 0.5 );
+  _post_items = uint64_t( post * _rate + 0.5 );
+  _ring_items = _pre_items + std::max< size_t >( size_t( TRIGGER_BACKLOG * _rate ), 8192 );
+  _ring = static_cast< unsigned char * >( _alloc.allocate( _ring_items * _item_size ) );
+
+  _trigger_key = pmt::mp( args.count("trigger_tag") ? args["trigger_tag"] : "trigger" );
+
+  message_port_register_in( pmt::mp("trigger") );
+  set_msg_handler( pmt::mp("trigger"),
+                   [this]( const pmt::pmt_t & ) { _trigger_msg = true; } );
+
+  std::cerr << "Recording " << pre << " s before and " << post
+            << " s after each trigger to " << filename << std::endl;
+}
+
+file_trigger_sink::~file_trigger_sink()
+{
+  stop();
+
+  _alloc.deallocate( _ring, _ring_items * _item_size );
+}
+
+bool file_trigger_sink::start()
+{
+  stop();
+
+  _quit = false;
+  _error.clear();
+  _thread = std::thread( &file_trigger_sink::writer_run, this );
+
+  return true;
+}
+
+/* the current event ends here, the writer thread finishes every file */
+bool file_trigger_sink::stop()
+{
+  if ( _active )
+    finish_event( _produced );
+
+  {
+    std::lock_guard< std::mutex > lock( _lock );
+    _quit = true;
+    _cond.notify_all();
+  }
+
+  if ( _thread.joinable() )
+    _thread.join();
+
+  _events.clear();
+
+  return true;
+}
+
+/* samples that can be pushed without overwriting what an event still needs */
+uint64_t file_trigger_sink::ring_room() const
+{
+  uint64_t oldest = _produced;
+
+  for ( size_t i = 0; i < _events.size(); i++ )
+    oldest = std::min( oldest, _events[i].pos );
+
+  return _ring_items - (_produced - oldest);
+}
+
+/* appends to the ring in the file format, the newest _pre_items samples
+ * are always there for the next trigger */
+void file_trigger_sink::push_ring( const gr_complex *in, size_t count )
+{
+  while ( count ) {
+    size_t n;
+
+    {
+      std::unique_lock< std::mutex > lock( _lock );
+
+      if ( ! ring_room() && _error.empty() ) {
+        std::cerr << "Trigger writer is behind, waiting" << std::endl;
+        _cond.wait( lock, [this] { return ring_room() || ! _error.empty(); } );
+      }
+
+      if ( ! _error.empty() )
+        throw std::runtime_error( _error );
+
+      n = std::min< uint64_t >( count, ring_room() );
+    }
+
+    for ( size_t done = 0; done < n; ) {
+      const size_t slot = (_produced + done) % _ring_items;
+      const size_t m = std::min( n - done, _ring_items - slot );
+
+      convert_from_complex( _format, in + done, _ring + slot * _item_size, m,
+                            _full_scale );
+      done += m;
+    }
+
+    {
+      std::lock_guard< std::mutex > lock( _lock );
+      _produced += n;
+      _cond.notify_all();
+    }
+
+    in += n;
+    count -= n;
+  }
+}
+
+/* queues a file starting up to _pre_items ahead of stream offset \p sample */
+void file_trigger_sink::start_event( uint64_t sample )
+{
+  const uint64_t fill = std::min( _pre_items, sample - _ring_start );
+  const osmosdr::time_spec_t start =
+    sigmf_meta::utc_now() - osmosdr::time_spec_t( fill / _rate );
+
+  event_t e;
+  e.first = e.pos = sample - fill;
+  e.end = UINT64_MAX;
+  e.filename = segment_filename( _filename, start, e.first );
+  e.sigmf = false;
+
+  if ( _sigmf ) {
+    begin_meta( e.filename, start );
+
+    sigmf_annotation a;
+    a.sample_start = fill;
+    a.sample_count = 0;
+    a.label = "trigger";
+    _meta.annotations.push_back( a );
+  }
+
+  _first = e.first;
+  _active = true;
+  _post_left = _post_items;
+
+  std::cerr << "Trigger at sample " << sample << ", writing " << e.filename
+            << std::endl;
+
+  std::lock_guard< std::mutex > lock( _lock );
+  _events.push_back( e );
+  _cond.notify_all();
+}
+
+/* the current event ends before stream offset \p end */
+void file_trigger_sink::finish_event( uint64_t end )
+{
+  _active = false;
+  _post_left = 0;
+
+  std::lock_guard< std::mutex > lock( _lock );
+
+  if ( _events.empty() )
+    return; /* dropped by a write error */
+
+  event_t &e = _events.back();
+  e.end = end;
+  if ( _sigmf ) {
+    e.sigmf = true;
+    e.meta = _meta;
+    e.meta_path = _meta_path;
+  }
+  _cond.notify_all();
+}
+
+void file_trigger_sink::write_ring( uint64_t from, uint64_t to )
+{
+  while ( from < to ) {
+    const size_t slot = from % _ring_items;
+    const size_t n = std::min< uint64_t >( to - from, _ring_items - slot );
+
+    _writer->write( _ring + slot * _item_size, n * _item_size );
+    from += n;
+  }
+}
+
+/*
+ * Writer thread: copies the ring into the file of the oldest event as the
+ * samples arrive, opening it first and closing it once the event ended.
+ */
+void file_trigger_sink::writer_run()
+{
+  const uint64_t step = std::max< uint64_t >( _ring_items / TRIGGER_WRITE_DIV, 1 );
+  std::unique_lock< std::mutex > lock( _lock );
+
+  while ( true ) {
+    if ( _events.empty() || ! _error.empty() ) {
+      if ( _quit )
+        break;
+
+      _cond.wait( lock );
+      continue;
+    }
+
+    event_t &e = _events.front();
+    const uint64_t avail = std::min( std::min( _produced, e.end ), e.pos + step );
+    const bool last = avail == e.end;
+
+    if ( avail == e.pos && ! last ) {
+      _cond.wait( lock );
+      continue;
+    }
+
+    const std::string filename = e.filename;
+    const uint64_t from = e.pos;
+    event_t done;
+
+    if ( last ) {
+      done.sigmf = e.sigmf;
+      done.meta = e.meta;
+      done.meta_path = e.meta_path;
+    }
+
+    lock.unlock();
+
+    std::string error;
+
+    try {
+      if ( ! _writer->is_open() )
+        _writer->open( filename, false );
+
+      write_ring( from, avail );
+
+      if ( last ) {
+        _writer->close();
+        if ( done.sigmf )
+          done.meta.save( done.meta_path );
+      }
+    } catch ( std::exception &ex ) {
+      error = ex.what();
+    }
+
+    lock.lock();
+
+    if ( ! error.empty() ) {
+      std::cerr << error << std::endl;
+      _error = error;
+      _events.clear();
+    } else if ( last ) {
+      _events.pop_front();
+    } else {
+      e.pos = avail;
+    }
+
+    _cond.notify_all();
+  }
+}
+
+int file_trigger_sink::work( int noutput_items,
+                             gr_vector_const_void_star &input_items,
+                             gr_vector_void_star &output_items )
+{
+  if ( _pacer )
+    noutput_items = _pacer->pace( noutput_items );
+
+  const gr_complex *in = (const gr_complex *)input_items[0];
+  const uint64_t read = nitems_read(0);
+  std::vector< gr::tag_t > tags;
+  std::vector< uint64_t > triggers;
+
+  {
+    std::lock_guard< std::mutex > lock( _lock );
+
+    if ( ! _error.empty() )
+      throw std::runtime_error( _error );
+
+    /* a restarted flowgraph counts from wherever it starts */
+    if ( read != _produced && _events.empty() )
+      _ring_start = _produced = read;
+  }
+
+  get_tags_in_range( tags, 0, read, read + noutput_items, _trigger_key );
+
+  for ( size_t i = 0; i < tags.size(); i++ )
+    triggers.push_back( tags[i].offset - read );
+
+  /* a message applies from the first sample we have not seen yet */
+  if ( _trigger_msg.exchange( false ) )
+    triggers.push_back( 0 );
+
+  std::sort( triggers.begin(), triggers.end() );
+
+  size_t next = 0;
+
+  for ( uint64_t pos = 0; pos < uint64_t( noutput_items ); ) {
+    for ( ; next < triggers.size() && triggers[next] <= pos; next++ ) {
+      if ( _active )
+        _post_left = _post_items;
+      else
+        start_event( read + pos );
+    }
+
+    if ( _active && 0 == _post_left )
+      finish_event( read + pos );
+
+    uint64_t end = next < triggers.size() ? triggers[next] : noutput_items;
+
+    if ( _active ) {
+      end = std::min( end, pos + _post_left );
+
+      if ( _sigmf )
+        record_tags( read + pos, end - pos, read + pos - _first );
+
+      _post_left -= end - pos;
+    } else if ( _sigmf ) {
+      follow_tuning( read + pos, end - pos );
+    }
+
+    push_ring( in + pos, end - pos );
+    pos = end;
+
+    if ( _active && 0 == _post_left )
+      finish_event( read + pos );
+  }
+
+  return noutput_items;
+}
@@ -0,0 +1,117 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_FILE_TRIGGER_SINK_H
+#define INCLUDED_FILE_TRIGGER_SINK_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "file_raw_sink.h"
+
+/*!
+ * \brief Raw file sink that only records around triggers.
+ *
+ * Nothing is written until a trigger arrives, either as a message on the
+ * "trigger" port or as a stream tag (trigger_tag=trigger names the key):
+ *
+ *   pretrigger=5     seconds kept in a RAM ring (hugepages=1 / mlock=1
+ *                    apply to it) and written ahead of the trigger
+ *   posttrigger=10   seconds written from the trigger on; a trigger
+ *                    within that window extends it
+ *
+ * Every event goes to a new file named after \p filename with the UTC
+ * start time and stream sample offset of its first sample inserted.
+ *
+ * work() only quantises into the ring, which holds another second of
+ * samples beyond the pretrigger window, and marks where events begin and
+ * end. A writer thread opens each event file, copies the ring into it
+ * and closes it along with its SigMF metadata, so none of that file
+ * system work happens on the streaming thread. work() waits only if the
+ * writer falls behind by more than the extra second.
+ */
+class file_trigger_sink : public file_raw_sink
+{
+private:
+  friend file_raw_sink_sptr make_file_raw_sink( const std::string &filename,
+                                                file_format_t format,
+                                                float full_scale,
+                                                bool append,
+                                                const dict_t &dict );
+
+  file_trigger_sink( const std::string &filename, file_format_t format,
+                     float full_scale, const dict_t &dict );
+
+public:
+  ~file_trigger_sink();
+
+  bool triggered() const { return true; }
+
+  bool start();
+  bool stop();
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+private:
+  struct event_t
+  {
+    std::string filename;
+    uint64_t first;       /* stream offset of the first sample in the file */
+    uint64_t pos;         /* next one the writer thread copies */
+    uint64_t end;         /* one past the last, UINT64_MAX while recording */
+    bool sigmf;
+    sigmf_meta meta;
+    std::string meta_path;
+  };
+
+  void push_ring( const gr_complex *in, size_t count );
+  uint64_t ring_room() const;
+  void start_event( uint64_t sample );
+  void finish_event( uint64_t end );
+
+  void writer_run();
+  void write_ring( uint64_t from, uint64_t to );
+
+  buffer_allocator _alloc;
+  unsigned char *_ring;
+  size_t _ring_items;     /* capacity in samples */
+  uint64_t _ring_start;   /* stream offset of the first sample ever pushed */
+  uint64_t _pre_items;
+  uint64_t _post_items;
+  uint64_t _post_left;    /* samples left in the current event */
+  bool _active;           /* work() is inside an event */
+  uint64_t _first;        /* first sample of the current event */
+  pmt::pmt_t _trigger_key;
+  std::atomic< bool > _trigger_msg;
+
+  std::thread _thread;
+  std::mutex _lock;
+  std::condition_variable _cond;
+  uint64_t _produced;     /* stream offset one past the newest ring sample */
+  std::deque< event_t > _events;
+  bool _quit;
+  std::string _error;
+};
+
+#endif /* INCLUDED_FILE_TRIGGER_SINK_H */
@@ -0,0 +1,671 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/format.hpp>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#include <sys/eventfd.h>
+#endif
+
+#include "file_writer.h"
+
+/* O_DIRECT wants buffer addresses, lengths and offsets in multiples of the
+ * logical block size, 4 KiB covers every device we care about */
+#define IO_ALIGN 4096
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+#define WAKE_TAG ((void *)(intptr_t)-1)
+
+file_writer::file_writer( const dict_t &dict ) :
+  _alloc(dict),
+  _async(false),
+  _direct(false),
+  _use_uring(true),
+  _buffer_size(4 * 1024 * 1024),
+  _prealloc(0),
+  _stats_interval(0),
+  _fd(-1),
+  _is_direct(false),
+  _offset(0),
+  _end(0),
+  _reserved(0),
+  _position(0),
+  _cur(-1),
+  _inflight(0),
+  _quit(false),
+  _ring(NULL),
+  _wake_fd(-1),
+  _wake_val(0)
+{
+  dict_t::const_iterator it;
+  size_t nbufs = 3;
+
+  if ( (it = dict.find( "writer" )) != dict.end() ) {
+    if ( it->second == "async" )
+      _async = true;
+    else if ( it->second != "sync" )
+      throw std::runtime_error("Parameter 'writer' must be sync or async.");
+  }
+
+  if ( (it = dict.find( "io_buffers" )) != dict.end() )
+    nbufs = boost::lexical_cast< size_t >( it->second );
+
+  if ( (it = dict.find( "io_buffer_size" )) != dict.end() )
+    _buffer_size = boost::lexical_cast< double >( it->second );
+
+  if ( (it = dict.find( "direct" )) != dict.end() )
+    _direct = (it->second != "0");
+
+  if ( (it = dict.find( "prealloc" )) != dict.end() )
+    _prealloc = boost::lexical_cast< double >( it->second );
+
+  if ( (it = dict.find( "io_uring" )) != dict.end() )
+    _use_uring = (it->second != "0");
+
+  if ( (it = dict.find( "io_stats" )) != dict.end() )
+    _stats_interval = boost::lexical_cast< double >( it->second );
+
+  nbufs = std::max< size_t >( nbufs, _async ? 2 : 1 );
+  _buffer_size = std::max< size_t >( _buffer_size, IO_ALIGN );
+  _buffer_size = (_buffer_size + IO_ALIGN - 1) & ~size_t(IO_ALIGN - 1);
+  _prealloc = (_prealloc + IO_ALIGN - 1) & ~uint64_t(IO_ALIGN - 1);
+
+  _bufs.resize( nbufs );
+  for ( size_t i = 0; i < nbufs; i++ ) {
+    _bufs[i].data = (unsigned char *)_alloc.allocate( _buffer_size );
+    _bufs[i].len = 0;
+  }
+
+  memset( &_stats, 0, sizeof(_stats) );
+}
+
+file_writer::~file_writer()
+{
+  close();
+
+  for ( size_t i = 0; i < _bufs.size(); i++ )
+    _alloc.deallocate( _bufs[i].data, _buffer_size );
+}
+
+void file_writer::open( const std::string &filename, bool append )
+{
+  close();
+
+  int flags = O_WRONLY | O_CREAT | O_BINARY | (append ? 0 : O_TRUNC);
+
+#ifdef O_DIRECT
+  if ( _direct )
+    flags |= O_DIRECT;
+#endif
+
+  _fd = ::open( filename.c_str(), flags, 0644 );
+
+#ifdef O_DIRECT
+  if ( _fd < 0 && EINVAL == errno && (flags & O_DIRECT) ) {
+    std::cerr << "O_DIRECT is not supported for " << filename
+              << ", writing through the page cache" << std::endl;
+    flags &= ~O_DIRECT;
+    _fd = ::open( filename.c_str(), flags, 0644 );
+  }
+#endif
+
+  if ( _fd < 0 )
+    throw std::runtime_error("Failed to open " + filename + ": " + strerror(errno));
+
+  _filename = filename;
+  _is_direct = false;
+#ifdef O_DIRECT
+  _is_direct = (flags & O_DIRECT);
+#elif defined(F_NOCACHE)
+  if ( _direct )
+    fcntl( _fd, F_NOCACHE, 1 );
+#endif
+
+  struct stat st;
+  _offset = (append && 0 == fstat( _fd, &st )) ? st.st_size : 0;
+
+#ifdef O_DIRECT
+  if ( _is_direct && _offset % IO_ALIGN ) {
+    std::cerr << "Appending to " << filename << " at an unaligned offset, "
+              << "not using O_DIRECT" << std::endl;
+    fcntl( _fd, F_SETFL, fcntl( _fd, F_GETFL ) & ~O_DIRECT );
+    _is_direct = false;
+  }
+#endif
+
+  _end = _reserved = _position = _offset;
+  _cur = -1;
+  _free.clear();
+  _queued.clear();
+  for ( size_t i = 0; i < _bufs.size(); i++ )
+    _free.push_back( i );
+  _inflight = 0;
+  _quit = false;
+  _error.clear();
+  memset( &_stats, 0, sizeof(_stats) );
+  _last_report = clock_t::now();
+
+  reserve( _offset + 1 );
+
+  if ( ! _async )
+    return;
+
+#ifdef HAVE_LIBURING
+  if ( _use_uring ) {
+    _ring = new struct io_uring;
+    _wake_fd = eventfd( 0, EFD_CLOEXEC );
+
+    int ret = _wake_fd < 0 ? -errno :
+              io_uring_queue_init( _bufs.size() + 1, _ring, 0 );
+    if ( ret < 0 ) {
+      std::cerr << "io_uring unavailable (" << strerror(-ret)
+                << "), using pwrite()" << std::endl;
+      if ( _wake_fd >= 0 )
+        ::close( _wake_fd );
+      delete _ring;
+      _ring = NULL;
+      _wake_fd = -1;
+    }
+  }
+#endif
+
+  _thread = std::thread( &file_writer::run, this );
+}
+
+void file_writer::close()
+{
+  if ( _fd < 0 )
+    return;
+
+  try {
+    flush();
+  } catch ( std::exception &ex ) {
+    std::cerr << ex.what() << std::endl;
+  }
+
+  if ( _thread.joinable() ) {
+    {
+      std::lock_guard< std::mutex > lock( _lock );
+      _quit = true;
+    }
+
+    wake();
+    _thread.join();
+  }
+
+#ifdef HAVE_LIBURING
+  if ( _ring ) {
+    io_uring_queue_exit( _ring );
+    ::close( _wake_fd );
+    delete _ring;
+    _ring = NULL;
+    _wake_fd = -1;
+  }
+#endif
+
+  /* give back what fallocate() reserved beyond the data */
+#if !defined(_WIN32)
+  if ( _prealloc && _reserved > _end && ftruncate( _fd, _end ) < 0 )
+    std::cerr << "Failed to truncate " << _filename << ": "
+              << strerror(errno) << std::endl;
+#endif
+
+  ::close( _fd );
+  _fd = -1;
+
+  if ( _async || _stats_interval > 0 ) {
+    std::unique_lock< std::mutex > lock( _lock );
+    report( "closed" );
+  }
+}
+
+size_t file_writer::span( unsigned char *&ptr )
+{
+  if ( _cur < 0 )
+    acquire();
+
+  buffer &b = _bufs[_cur];
+
+  ptr = b.data + b.len;
+  return _buffer_size - b.len;
+}
+
+void file_writer::commit( size_t len )
+{
+  _bufs[_cur].len += len;
+  _position += len;
+
+  if ( _bufs[_cur].len == _buffer_size )
+    submit();
+}
+
+void file_writer::write( const void *buf, size_t len )
+{
+  const unsigned char *src = (const unsigned char *)buf;
+
+  while ( len ) {
+    unsigned char *dst;
+    size_t count = std::min( span( dst ), len );
+
+    memcpy( dst, src, count );
+    commit( count );
+
+    src += count;
+    len -= count;
+  }
+}
+
+/*
+ * With O_DIRECT a partial buffer can only be written padded to the block
+ * size. The padding is cut off again with ftruncate() and the incomplete
+ * last block is carried over into the next buffer, which rewrites it in
+ * full once more samples arrive.
+ */
+void file_writer::flush()
+{
+  std::vector< unsigned char > carry;
+
+  if ( _cur >= 0 && _bufs[_cur].len ) {
+    buffer &b = _bufs[_cur];
+
+    if ( _is_direct ) {
+      size_t tail = b.len % IO_ALIGN;
+      carry.assign( b.data + b.len - tail, b.data + b.len );
+    }
+
+    submit();
+    _offset -= carry.size();
+  }
+
+  {
+    std::unique_lock< std::mutex > lock( _lock );
+    drain( lock );
+  }
+
+  check_error();
+
+#if !defined(_WIN32)
+  if ( _is_direct && _end % IO_ALIGN && ftruncate( _fd, _end ) < 0 )
+    throw std::runtime_error("Failed to truncate " + _filename + ": " + strerror(errno));
+#endif
+
+  if ( ! carry.empty() ) {
+    acquire();
+    memcpy( _bufs[_cur].data, &carry[0], carry.size() );
+    _bufs[_cur].len = carry.size();
+  }
+}
+
+file_writer::stats_t file_writer::stats()
+{
+  std::lock_guard< std::mutex > lock( _lock );
+
+  return _stats;
+}
+
+void file_writer::check_error()
+{
+  std::lock_guard< std::mutex > lock( _lock );
+
+  if ( ! _error.empty() )
+    throw std::runtime_error( _error );
+}
+
+/* makes a free buffer the current one, waiting for the I/O thread if needed */
+void file_writer::acquire()
+{
+  std::unique_lock< std::mutex > lock( _lock );
+
+  if ( _free.empty() && _error.empty() ) {
+    clock_t::time_point start = clock_t::now();
+
+    while ( _free.empty() && _error.empty() )
+      _cond.wait( lock );
+
+    _stats.waits++;
+    _stats.wait_time += std::chrono::duration< double >( clock_t::now() - start ).count();
+  }
+
+  if ( ! _error.empty() )
+    throw std::runtime_error( _error );
+
+  _cur = _free.front();
+  _free.pop_front();
+
+  _bufs[_cur].len = 0;
+  _bufs[_cur].offset = _offset;
+}
+
+void file_writer::submit()
+{
+  const int idx = _cur;
+  buffer &b = _bufs[idx];
+
+  _cur = -1;
+
+  b.io_len = b.len;
+  if ( _is_direct && b.len % IO_ALIGN ) {
+    b.io_len = (b.len + IO_ALIGN - 1) & ~size_t(IO_ALIGN - 1);
+    memset( b.data + b.len, 0, b.io_len - b.len );
+  }
+
+  b.done = 0;
+  b.submitted = clock_t::now();
+
+  _offset = b.offset + b.len;
+  _end = std::max( _end, _offset );
+
+  if ( ! _async ) {
+    try {
+      write_buffer( b );
+    } catch ( ... ) {
+      std::lock_guard< std::mutex > lock( _lock );
+      _free.push_back( idx );
+      throw;
+    }
+
+    std::unique_lock< std::mutex > lock( _lock );
+    completed( idx );
+    return;
+  }
+
+  {
+    std::lock_guard< std::mutex > lock( _lock );
+
+    _queued.push_back( idx );
+    _stats.backlog_max = std::max( _stats.backlog_max, _queued.size() + _inflight );
+  }
+
+  wake();
+}
+
+void file_writer::drain( std::unique_lock< std::mutex > &lock )
+{
+  while ( (! _queued.empty() || _inflight) && _error.empty() )
+    _cond.wait( lock );
+}
+
+void file_writer::wake()
+{
+#ifdef HAVE_LIBURING
+  if ( _ring ) {
+    uint64_t one = 1;
+    if ( ::write( _wake_fd, &one, sizeof(one) ) < 0 )
+      std::cerr << "Failed to wake the file writer thread" << std::endl;
+    return;
+  }
+#endif
+
+  _cond.notify_all();
+}
+
+/* keeps at least half a preallocation step reserved ahead of end */
+void file_writer::reserve( uint64_t end )
+{
+#if defined(__linux__) && defined(FALLOC_FL_KEEP_SIZE)
+  while ( _prealloc && end + _prealloc / 2 > _reserved ) {
+    if ( fallocate( _fd, FALLOC_FL_KEEP_SIZE, _reserved, _prealloc ) < 0 ) {
+      std::cerr << "Failed to preallocate " << _filename << ": "
+                << strerror(errno) << std::endl;
+      _prealloc = 0;
+      break;
+    }
+
+    _reserved += _prealloc;
+  }
+#else
+  (void)end;
+  if ( _prealloc ) {
+    std::cerr << "prealloc= is not supported on this platform" << std::endl;
+    _prealloc = 0;
+  }
+#endif
+}
+
+void file_writer::write_buffer( buffer &b )
+{
+  reserve( b.offset + b.io_len );
+
+  while ( b.done < b.io_len ) {
+#if defined(_WIN32)
+    long ret = -1;
+    if ( _lseeki64( _fd, b.offset + b.done, SEEK_SET ) >= 0 )
+      ret = ::_write( _fd, b.data + b.done, b.io_len - b.done );
+#else
+    ssize_t ret = pwrite( _fd, b.data + b.done, b.io_len - b.done,
+                          b.offset + b.done );
+#endif
+
+    if ( ret < 0 && EINTR == errno )
+      continue;
+
+    if ( ret <= 0 )
+      throw std::runtime_error("Failed to write " + _filename + ": " +
+                               (ret < 0 ? strerror(errno) : "no space left"));
+
+    b.done += ret;
+  }
+}
+
+/* called with the lock held once a buffer is entirely on its way to disk */
+void file_writer::completed( int idx )
+{
+  const buffer &b = _bufs[idx];
+  const clock_t::time_point now = clock_t::now();
+  double latency = std::chrono::duration< double >( now - b.submitted ).count();
+
+  _stats.writes++;
+  _stats.bytes += b.len;
+  _stats.latency_sum += latency;
+  _stats.latency_max = std::max( _stats.latency_max, latency );
+
+  _free.push_back( idx );
+  _cond.notify_all();
+
+  if ( _stats_interval > 0 &&
+       std::chrono::duration< double >( now - _last_report ).count() >= _stats_interval ) {
+    _last_report = now;
+    report( "writing" );
+  }
+}
+
+/* called with the lock held */
+void file_writer::report( const char *what )
+{
+  std::cerr << boost::format( "%s %s: %u writes, %.1f MB, latency avg %.2f ms "
+                              "max %.2f ms, backlog max %u/%u, producer waited "
+                              "%u times (%.1f ms)" )
+               % _filename % what
+               % _stats.writes % (_stats.bytes / 1e6)
+               % (_stats.writes ? 1e3 * _stats.latency_sum / _stats.writes : 0.0)
+               % (1e3 * _stats.latency_max)
+               % _stats.backlog_max % _bufs.size()
+               % _stats.waits % (1e3 * _stats.wait_time)
+            << std::endl;
+}
+
+void file_writer::run()
+{
+  if ( _ring ) {
+    run_uring();
+    return;
+  }
+
+  std::unique_lock< std::mutex > lock( _lock );
+
+  while ( true ) {
+    if ( _queued.empty() ) {
+      if ( _quit )
+        break;
+
+      _cond.wait( lock );
+      continue;
+    }
+
+    int idx = _queued.front();
+    _queued.pop_front();
+    _inflight++;
+
+    lock.unlock();
+
+    std::string error;
+
+    try {
+      write_buffer( _bufs[idx] );
+    } catch ( std::exception &ex ) {
+      error = ex.what();
+    }
+
+    lock.lock();
+    _inflight--;
+
+    if ( error.empty() ) {
+      completed( idx );
+    } else {
+      _error = error;
+      _free.push_back( idx );
+      _free.insert( _free.end(), _queued.begin(), _queued.end() );
+      _queued.clear();
+      _cond.notify_all();
+    }
+  }
+}
+
+#ifdef HAVE_LIBURING
+void file_writer::run_uring()
+{
+  std::vector< int > batch;
+  bool arm = true;
+
+  std::unique_lock< std::mutex > lock( _lock );
+
+  while ( true ) {
+    batch.assign( _queued.begin(), _queued.end() );
+    _queued.clear();
+    _inflight += batch.size();
+
+    if ( _quit && ! _inflight )
+      break;
+
+    lock.unlock();
+
+    /* the eventfd read completes whenever the producer queues a buffer */
+    if ( arm ) {
+      struct io_uring_sqe *sqe = io_uring_get_sqe( _ring );
+      io_uring_prep_read( sqe, _wake_fd, &_wake_val, sizeof(_wake_val), 0 );
+      io_uring_sqe_set_data( sqe, WAKE_TAG );
+      arm = false;
+    }
+
+    for ( size_t i = 0; i < batch.size(); i++ ) {
+      buffer &b = _bufs[batch[i]];
+      struct io_uring_sqe *sqe = io_uring_get_sqe( _ring );
+
+      reserve( b.offset + b.io_len );
+      io_uring_prep_write( sqe, _fd, b.data + b.done, b.io_len - b.done,
+                           b.offset + b.done );
+      io_uring_sqe_set_data( sqe, (void *)(intptr_t)batch[i] );
+    }
+
+    io_uring_submit( _ring );
+
+    struct io_uring_cqe *cqe;
+    int ret = io_uring_wait_cqe( _ring, &cqe );
+
+    lock.lock();
+
+    if ( ret < 0 ) {
+      if ( -EINTR == ret )
+        continue;
+
+      _error = "io_uring_wait_cqe failed: " + std::string( strerror(-ret) );
+      _cond.notify_all();
+      break;
+    }
+
+    unsigned head, seen = 0;
+
+    io_uring_for_each_cqe( _ring, head, cqe ) {
+      void *data = io_uring_cqe_get_data( cqe );
+      seen++;
+
+      if ( WAKE_TAG == data ) {
+        arm = true;
+        continue;
+      }
+
+      int idx = (intptr_t)data;
+      buffer &b = _bufs[idx];
+
+      _inflight--;
+
+      if ( cqe->res <= 0 ) {
+        _error = "Failed to write " + _filename + ": " +
+                 (cqe->res < 0 ? strerror(-cqe->res) : "no space left");
+        _free.push_back( idx );
+        _cond.notify_all();
+        continue;
+      }
+
+      b.done += cqe->res;
+
+      if ( b.done < b.io_len )
+        _queued.push_front( idx );  /* short write, submit the rest */
+      else
+        completed( idx );
+    }
+
+    io_uring_cq_advance( _ring, seen );
+
+    if ( ! _error.empty() ) {
+      _free.insert( _free.end(), _queued.begin(), _queued.end() );
+      _queued.clear();
+    }
+  }
+}
+#else
+void file_writer::run_uring()
+{
+}
+#endif
@@ -0,0 +1,159 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_FILE_WRITER_H
+#define INCLUDED_FILE_WRITER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arg_helpers.h"
+#include "buffer_allocator.h"
+
+struct io_uring;
+
+/*!
+ * \brief Block buffered file writer with an optional I/O thread.
+ *
+ * The producer fills large page aligned buffers in place (span() /
+ * commit()), full buffers are written with pwrite() at their file offset.
+ * Options, from the file sink arguments:
+ *
+ *   writer=sync|async    write from the caller (default) or an I/O thread
+ *   io_buffers=3         number of buffers, at least 2 for async
+ *   io_buffer_size=4e6   bytes per buffer, rounded up to 4 KiB
+ *   direct=1             bypass the page cache with O_DIRECT
+ *   prealloc=1e9         reserve disk space ahead of the write position
+ *   io_uring=0           use the thread's plain pwrite() loop even if
+ *                        built with liburing
+ *   io_stats=10          print write statistics every 10 seconds
+ *
+ * With the I/O thread and liburing every filled buffer is submitted at
+ * once, so up to io_buffers writes are in flight. Without liburing the
+ * thread writes them one after another. The producer only ever waits when
+ * all buffers are queued, which is what the backlog statistics show.
+ * Write errors are raised as std::runtime_error on the producer side.
+ */
+class file_writer
+{
+public:
+  explicit file_writer( const dict_t &dict );
+  ~file_writer();
+
+  void open( const std::string &filename, bool append );
+  void close();
+  bool is_open() const { return _fd >= 0; }
+
+  /* Contiguous space in the current buffer, waits for one if needed */
+  size_t span( unsigned char *&ptr );
+  void commit( size_t len );
+
+  /* Copies len bytes through span() / commit() */
+  void write( const void *buf, size_t len );
+
+  /* Hands over the partial buffer and waits until everything is written */
+  void flush();
+
+  /* bytes accepted since open(), including the append offset */
+  uint64_t position() const { return _position; }
+
+  struct stats_t
+  {
+    uint64_t writes;
+    uint64_t bytes;
+    double latency_sum;     /* seconds from submission to completion */
+    double latency_max;
+    size_t backlog_max;     /* buffers queued or in flight */
+    uint64_t waits;         /* times the producer found no free buffer */
+    double wait_time;       /* seconds the producer spent waiting */
+  };
+
+  stats_t stats();
+
+private:
+  typedef std::chrono::steady_clock clock_t;
+
+  struct buffer
+  {
+    unsigned char *data;
+    size_t len;             /* payload bytes */
+    size_t io_len;          /* bytes to write, len padded for O_DIRECT */
+    size_t done;            /* bytes written so far */
+    uint64_t offset;
+    clock_t::time_point submitted;
+  };
+
+  void acquire();
+  void submit();
+  void drain( std::unique_lock< std::mutex > &lock );
+  void check_error();
+
+  void reserve( uint64_t end );
+  void write_buffer( buffer &b );
+  void completed( int idx );
+  void report( const char *what );
+
+  void run();
+  void run_uring();
+  void wake();
+
+  buffer_allocator _alloc;
+  bool _async;
+  bool _direct;
+  bool _use_uring;
+  size_t _buffer_size;
+  uint64_t _prealloc;
+  double _stats_interval;
+
+  std::string _filename;
+  int _fd;
+  bool _is_direct;        /* O_DIRECT actually in effect for this file */
+  uint64_t _offset;       /* file offset of the next buffer */
+  uint64_t _end;          /* end of the data handed over so far */
+  uint64_t _reserved;     /* end of the preallocated range */
+  uint64_t _position;
+
+  std::vector< buffer > _bufs;
+  int _cur;
+
+  std::mutex _lock;
+  std::condition_variable _cond;
+  std::deque< int > _free;
+  std::deque< int > _queued;
+  size_t _inflight;
+  bool _quit;
+  std::string _error;
+  stats_t _stats;
+  clock_t::time_point _last_report;
+
+  std::thread _thread;
+
+  /* only set up when built with liburing, see file_writer.cc */
+  struct io_uring *_ring;
+  int _wake_fd;
+  uint64_t _wake_val;
+};
+
+#endif /* INCLUDED_FILE_WRITER_H */
@@ -0,0 +1,518 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+
+#include <boost/crc.hpp>
+
+#include <sys/stat.h>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "iqz_codec.h"
+
+#define RICE_PARTITION  4096  /* residuals sharing one Rice parameter */
+#define RICE_MAX_K      20
+#define RICE_ESCAPE     24    /* unary lengths from here on are escaped */
+#define ESCAPE_BITS     20    /* enough for any zigzagged order 3 residual */
+
+namespace {
+
+/* MSB first bit packing into a fixed buffer, at most 32 bits per call */
+class bit_writer
+{
+public:
+  bit_writer( unsigned char *out, size_t capacity ) :
+    _out(out), _cap(capacity), _pos(0), _acc(0), _bits(0) {}
+
+  void put( uint32_t value, int count )
+  {
+    _acc = (_acc << count) | value;
+    _bits += count;
+
+    if ( _bits >= 32 ) {
+      _bits -= 32;
+      uint32_t word = uint32_t( _acc >> _bits );
+
+      if ( _pos + 4 <= _cap ) {
+        _out[_pos + 0] = word >> 24;
+        _out[_pos + 1] = word >> 16;
+        _out[_pos + 2] = word >> 8;
+        _out[_pos + 3] = word;
+      }
+      _pos += 4;
+    }
+  }
+
+  /* pads to a byte boundary, returns the length in bytes */
+  size_t finish()
+  {
+    for ( ; _bits > 0; _bits -= 8, _pos++ )
+      if ( _pos < _cap )
+        _out[_pos] = (unsigned char)(_acc << 8 >> _bits);
+
+    return _pos;
+  }
+
+  bool overflow() const { return _pos > _cap; }
+
+private:
+  unsigned char *_out;
+  size_t _cap;
+  size_t _pos;
+  uint64_t _acc;
+  int _bits;
+};
+
+class bit_reader
+{
+public:
+  bit_reader( const unsigned char *in, size_t len ) :
+    _in(in), _len(len), _pos(0), _acc(0), _bits(0) {}
+
+  /* count is 1 to 32 */
+  uint32_t get( int count )
+  {
+    if ( _bits < count )
+      refill();
+
+    uint32_t value = uint32_t( _acc >> (64 - count) );
+    _acc <<= count;
+    _bits -= count;
+
+    return value;
+  }
+
+  /* zero bits up to the next one, capped at RICE_ESCAPE */
+  int unary()
+  {
+    if ( _bits <= RICE_ESCAPE )
+      refill();
+
+    int zeros = RICE_ESCAPE;
+    if ( _acc >> (64 - RICE_ESCAPE) )
+      zeros = leading_zeros( _acc );
+
+    _acc <<= zeros;
+    _bits -= zeros;
+
+    if ( zeros < RICE_ESCAPE ) {
+      _acc <<= 1;
+      _bits -= 1;
+    }
+
+    return zeros;
+  }
+
+  /* true unless more bits were taken than the payload has */
+  bool ok() const
+  {
+    return uint64_t( _pos ) * 8 - _bits <= uint64_t( _len ) * 8;
+  }
+
+private:
+  /*
+   * Tops the accumulator up to at least 56 valid bits. The word
+   * load also ORs in part of the following byte, which the next refill
+   * ORs in again at the same position, so that is harmless.
+   */
+  void refill()
+  {
+    if ( _pos + 8 <= _len ) {
+      const unsigned char *p = _in + _pos;
+      uint64_t word = 0;
+
+      for ( int i = 0; i < 8; i++ )
+        word = (word << 8) | p[i];
+
+      _acc |= word >> _bits;
+      _pos += (63 - _bits) >> 3;
+      _bits |= 56;
+      return;
+    }
+
+    while ( _bits < 56 ) {
+      _acc |= uint64_t( _pos < _len ? _in[_pos] : 0 ) << (56 - _bits);
+      _pos++;
+      _bits += 8;
+    }
+  }
+
+  static int leading_zeros( uint64_t value )
+  {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64( &index, value );
+    return 63 - index;
+#else
+    return __builtin_clzll( value );
+#endif
+  }
+
+  const unsigned char *_in;
+  size_t _len;
+  size_t _pos;
+  uint64_t _acc;
+  int _bits;
+};
+
+template < typename T >
+void gather( const unsigned char *in, size_t count, int channel, int32_t *x )
+{
+  const T *s = reinterpret_cast< const T * >( in ) + channel;
+
+  for ( size_t i = 0; i < count; i++ )
+    x[i] = s[2 * i];
+}
+
+template < typename T >
+void scatter( const int32_t *x, size_t count, int channel, unsigned char *out )
+{
+  T *s = reinterpret_cast< T * >( out ) + channel;
+
+  for ( size_t i = 0; i < count; i++ )
+    s[2 * i] = T( x[i] );
+}
+
+/* order 0..3 fixed polynomial prediction of x[i] */
+template < int order >
+inline int32_t predict( const int32_t *x, size_t i )
+{
+  switch ( order ) {
+  case 1: return x[i-1];
+  case 2: return 2 * x[i-1] - x[i-2];
+  case 3: return 3 * x[i-1] - 3 * x[i-2] + x[i-3];
+  default: return 0;
+  }
+}
+
+template < int order >
+void residuals( const int32_t *x, size_t count, uint32_t *u )
+{
+  for ( size_t i = order; i < count; i++ ) {
+    int32_t e = x[i] - predict< order >( x, i );
+    u[i - order] = (uint32_t( e ) << 1) ^ uint32_t( e >> 31 );
+  }
+}
+
+template < int order >
+bool decode_residuals( bit_reader &br, size_t count, int32_t *x )
+{
+  for ( size_t start = order; start < count; start += RICE_PARTITION ) {
+    const size_t end = std::min< size_t >( start + RICE_PARTITION, count );
+    const int k = br.get( 5 );
+
+    if ( k > RICE_MAX_K )
+      return false;
+
+    for ( size_t i = start; i < end; i++ ) {
+      uint32_t q = br.unary();
+      uint32_t u;
+
+      if ( q < RICE_ESCAPE )
+        u = (q << k) | (k ? br.get( k ) : 0);
+      else
+        u = br.get( ESCAPE_BITS );
+
+      x[i] = int32_t( (u >> 1) ^ (0 - (u & 1)) ) + predict< order >( x, i );
+    }
+
+    if ( ! br.ok() )
+      return false;
+  }
+
+  return true;
+}
+
+int best_order( const int32_t *x, size_t count )
+{
+  uint64_t sum[4] = { 0, 0, 0, 0 };
+
+  if ( count < 4 )
+    return 0;
+
+  for ( size_t i = 3; i < count; i++ ) {
+    int32_t e0 = x[i];
+    int32_t e1 = e0 - x[i-1];
+    int32_t e2 = e1 - (x[i-1] - x[i-2]);
+    int32_t e3 = e2 - (x[i-1] - 2 * x[i-2] + x[i-3]);
+
+    sum[0] += std::abs( e0 );
+    sum[1] += std::abs( e1 );
+    sum[2] += std::abs( e2 );
+    sum[3] += std::abs( e3 );
+  }
+
+  return int( std::min_element( sum, sum + 4 ) - sum );
+}
+
+void encode_channel( const int32_t *x, size_t count, bit_writer &bw,
+                     std::vector< uint32_t > &u )
+{
+  const int order = best_order( x, count );
+
+  bw.put( order, 2 );
+  for ( int i = 0; i < order; i++ )
+    bw.put( uint32_t( x[i] ) & 0xffff, 16 );
+
+  u.resize( count - order );
+  switch ( order ) {
+  case 0: residuals< 0 >( x, count, u.data() ); break;
+  case 1: residuals< 1 >( x, count, u.data() ); break;
+  case 2: residuals< 2 >( x, count, u.data() ); break;
+  case 3: residuals< 3 >( x, count, u.data() ); break;
+  }
+
+  for ( size_t start = 0; start < u.size(); start += RICE_PARTITION ) {
+    const size_t end = std::min< size_t >( start + RICE_PARTITION, u.size() );
+    uint64_t sum = 0;
+
+    for ( size_t i = start; i < end; i++ )
+      sum += u[i];
+
+    /* about log2 of the mean */
+    int k = 0;
+    while ( k < RICE_MAX_K && (uint64_t( end - start ) << (k + 1)) <= sum )
+      k++;
+
+    bw.put( k, 5 );
+
+    const uint32_t mask = (1u << k) - 1;
+
+    for ( size_t i = start; i < end; i++ ) {
+      uint32_t q = u[i] >> k;
+
+      if ( q < RICE_ESCAPE ) {
+        if ( q + 1 + k <= 32 ) {
+          bw.put( (uint64_t( 1 ) << k) | (u[i] & mask), q + 1 + k );
+        } else {
+          bw.put( 1, q + 1 );
+          bw.put( u[i] & mask, k );
+        }
+      } else {
+        bw.put( 0, RICE_ESCAPE );
+        bw.put( u[i], ESCAPE_BITS );
+      }
+    }
+  }
+}
+
+bool decode_channel( bit_reader &br, size_t count, int32_t *x )
+{
+  const int order = br.get( 2 );
+
+  if ( size_t( order ) > count )
+    return false;
+
+  for ( int i = 0; i < order; i++ )
+    x[i] = int16_t( br.get( 16 ) );
+
+  switch ( order ) {
+  case 0: return decode_residuals< 0 >( br, count, x );
+  case 1: return decode_residuals< 1 >( br, count, x );
+  case 2: return decode_residuals< 2 >( br, count, x );
+  default: return decode_residuals< 3 >( br, count, x );
+  }
+}
+
+uint32_t crc32( const unsigned char *data, size_t len )
+{
+  boost::crc_32_type crc;
+  crc.process_bytes( data, len );
+  return crc.checksum();
+}
+
+} // namespace
+
+uint32_t iqz_encode( file_format_t format, const unsigned char *in, size_t count,
+                     std::vector< unsigned char > &out )
+{
+  const size_t raw = count * file_format_size( format );
+  std::vector< int32_t > x( count );
+  std::vector< uint32_t > u;
+
+  out.resize( raw );
+
+  /* anything that does not get smaller is stored as it is */
+  bit_writer bw( out.data(), raw - 1 );
+
+  for ( int channel = 0; channel < 2 && ! bw.overflow(); channel++ ) {
+    switch ( format ) {
+    case FILE_CU8:  gather< uint8_t >( in, count, channel, x.data() ); break;
+    case FILE_CS8:  gather< int8_t >( in, count, channel, x.data() ); break;
+    case FILE_CS16: gather< int16_t >( in, count, channel, x.data() ); break;
+    default: return 0;
+    }
+
+    encode_channel( x.data(), count, bw, u );
+  }
+
+  size_t len = bw.finish();
+
+  if ( bw.overflow() )
+    std::copy( in, in + raw, out.begin() );
+  else
+    out.resize( len );
+
+  return crc32( out.data(), out.size() );
+}
+
+bool iqz_decode( file_format_t format, const unsigned char *in, size_t len,
+                 uint32_t crc, size_t count, unsigned char *out )
+{
+  if ( crc32( in, len ) != crc )
+    return false;
+
+  if ( len == count * file_format_size( format ) ) {
+    std::copy( in, in + len, out );
+    return true;
+  }
+
+  std::vector< int32_t > x( count );
+  bit_reader br( in, len );
+
+  for ( int channel = 0; channel < 2; channel++ ) {
+    if ( ! decode_channel( br, count, x.data() ) )
+      return false;
+
+    switch ( format ) {
+    case FILE_CU8:  scatter< uint8_t >( x.data(), count, channel, out ); break;
+    case FILE_CS8:  scatter< int8_t >( x.data(), count, channel, out ); break;
+    case FILE_CS16: scatter< int16_t >( x.data(), count, channel, out ); break;
+    default: return false;
+    }
+  }
+
+  return br.ok();
+}
+
+bool iqz_probe( const std::string &filename )
+{
+  std::ifstream f( filename.c_str(), std::ios::binary );
+  char magic[8];
+
+  return f.read( magic, sizeof(magic) ) && 0 == memcmp( magic, IQZ_MAGIC, 8 );
+}
+
+bool iqz_pread( int fd, void *buf, size_t len, uint64_t offset )
+{
+  unsigned char *p = static_cast< unsigned char * >( buf );
+
+#if defined(_WIN32)
+  /* no pread(), the seek and read pair must not interleave */
+  static std::mutex lock;
+  std::lock_guard< std::mutex > guard( lock );
+
+  if ( _lseeki64( fd, offset, SEEK_SET ) < 0 )
+    return false;
+#endif
+
+  while ( len ) {
+#if defined(_WIN32)
+    long ret = ::_read( fd, p, (unsigned int)len );
+#else
+    ssize_t ret = pread( fd, p, len, offset );
+#endif
+
+    if ( ret < 0 && EINTR == errno )
+      continue;
+
+    if ( ret <= 0 )
+      return false;
+
+    p += ret;
+    len -= ret;
+    offset += ret;
+  }
+
+  return true;
+}
+
+void iqz_read_index( int fd, const std::string &filename,
+                     iqz_file_header &header,
+                     std::vector< iqz_index_entry > &index,
+                     uint64_t &end, uint64_t &samples )
+{
+  struct stat st;
+
+  if ( fstat( fd, &st ) < 0 ||
+       ! iqz_pread( fd, &header, sizeof(header), 0 ) ||
+       memcmp( header.magic, IQZ_MAGIC, 8 ) )
+    throw std::runtime_error( filename + " is not an iqz file." );
+
+  if ( header.format > FILE_CS16 || 0 == header.block_samples )
+    throw std::runtime_error( filename + " has an unsupported iqz header." );
+
+  const uint64_t size = st.st_size;
+  iqz_trailer trailer;
+
+  index.clear();
+
+  if ( size >= sizeof(header) + sizeof(trailer) &&
+       iqz_pread( fd, &trailer, sizeof(trailer), size - sizeof(trailer) ) &&
+       0 == memcmp( trailer.magic, IQZ_TRAILER_MAGIC, 8 ) &&
+       trailer.index_offset + trailer.blocks * sizeof(iqz_index_entry) +
+         sizeof(trailer) == size ) {
+    index.resize( trailer.blocks );
+
+    if ( trailer.blocks &&
+         ! iqz_pread( fd, index.data(), trailer.blocks * sizeof(iqz_index_entry),
+                      trailer.index_offset ) )
+      throw std::runtime_error( "Failed to read the index of " + filename );
+
+    end = trailer.index_offset;
+    samples = trailer.samples;
+    return;
+  }
+
+  /* never closed, walk the block headers */
+  iqz_block_header block;
+  iqz_index_entry entry;
+
+  entry.offset = sizeof(header);
+  entry.sample = 0;
+
+  while ( entry.offset + sizeof(block) <= size &&
+          iqz_pread( fd, &block, sizeof(block), entry.offset ) &&
+          IQZ_BLOCK_MAGIC == block.magic &&
+          entry.offset + sizeof(block) + block.bytes <= size ) {
+    index.push_back( entry );
+
+    entry.offset += sizeof(block) + block.bytes;
+    entry.sample += block.samples;
+  }
+
+  end = entry.offset;
+  samples = entry.sample;
+
+  std::cerr << filename << " has no index, recovered " << index.size()
+            << " blocks" << std::endl;
+}
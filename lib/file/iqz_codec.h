@@ -0,0 +1,114 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_FILE_IQZ_CODEC_H
+#define INCLUDED_FILE_IQZ_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "file_convert.h"
+
+/*
+ * Lossless container for cu8/cs8/cs16 recordings ("iqz").
+ *
+ *   file header       iqz_file_header
+ *   block 0..n-1      iqz_block_header + coded payload
+ *   seek index        one iqz_index_entry per block
+ *   trailer           iqz_trailer
+ *
+ * Every block holds block_samples samples (the last one may be shorter)
+ * and decodes on its own. I and Q are coded separately, each with the
+ * best of the fixed polynomial predictors of order 0 to 3 (as in FLAC)
+ * and Rice coded residuals whose parameter adapts per 4096 samples.
+ * A recording that was never closed has no trailer; readers then rebuild
+ * the index from the block headers. Headers, index and trailer are in
+ * host byte order, as are cs16 samples; the coded payload is a byte
+ * stream.
+ */
+
+#define IQZ_MAGIC         "OSMOIQZ1"
+#define IQZ_BLOCK_MAGIC   0x4b4c4251 /* "QBLK" */
+#define IQZ_TRAILER_MAGIC "OSMOIQZX"
+
+struct iqz_file_header
+{
+  char magic[8];
+  uint32_t format;          /* file_format_t of the samples */
+  uint32_t block_samples;
+  uint32_t reserved[4];
+};
+
+struct iqz_block_header
+{
+  uint32_t magic;
+  uint32_t samples;
+  uint32_t bytes;           /* payload following this header */
+  uint32_t crc;             /* CRC-32 of the payload */
+};
+
+struct iqz_index_entry
+{
+  uint64_t offset;          /* of the block header */
+  uint64_t sample;          /* first sample in the block */
+};
+
+struct iqz_trailer
+{
+  uint64_t index_offset;
+  uint64_t blocks;
+  uint64_t samples;
+  char magic[8];
+};
+
+/*!
+ * Codes \p count samples in on-disk \p format (not cf32) into \p out,
+ * which is resized to the payload length. Returns the CRC-32 of it.
+ */
+uint32_t iqz_encode( file_format_t format, const unsigned char *in, size_t count,
+                     std::vector< unsigned char > &out );
+
+/*!
+ * Decodes a payload back into \p count samples in \p format. Returns false
+ * if the payload is damaged: wrong CRC, or it does not decode to exactly
+ * \p count samples.
+ */
+bool iqz_decode( file_format_t format, const unsigned char *in, size_t len,
+                 uint32_t crc, size_t count, unsigned char *out );
+
+/* true if \p filename starts with an iqz file header */
+bool iqz_probe( const std::string &filename );
+
+/* reads exactly \p len bytes at \p offset, may be called from several threads */
+bool iqz_pread( int fd, void *buf, size_t len, uint64_t offset );
+
+/*!
+ * Reads the header and seek index of an open iqz file. Without a trailer
+ * the index is rebuilt from the block headers up to the first incomplete
+ * block. \p end is set to the offset after the last block, \p samples to
+ * the total. Throws std::runtime_error.
+ */
+void iqz_read_index( int fd, const std::string &filename,
+                     iqz_file_header &header,
+                     std::vector< iqz_index_entry > &index,
+                     uint64_t &end, uint64_t &samples );
+
+#endif /* INCLUDED_FILE_IQZ_CODEC_H */
@@ -0,0 +1,393 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include "sigmf.h"
+
+#define META_EXT ".sigmf-meta"
+#define DATA_EXT ".sigmf-data"
+
+static bool ends_with( const std::string &str, const std::string &suffix )
+{
+  return str.size() >= suffix.size() &&
+         0 == str.compare( str.size() - suffix.size(), suffix.size(), suffix );
+}
+
+static bool file_exists( const std::string &path )
+{
+  std::ifstream f( path.c_str() );
+  return f.good();
+}
+
+/* ISO 8601 in UTC, "2026-10-19T12:34:56.123456789Z" */
+static std::string format_datetime( const osmosdr::time_spec_t &time )
+{
+  time_t secs = time.get_full_secs();
+  struct tm tm;
+  char buf[64];
+
+#if defined(_WIN32)
+  gmtime_s( &tm, &secs );
+#else
+  gmtime_r( &secs, &tm );
+#endif
+
+  strftime( buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm );
+
+  long nsecs = std::min( 999999999L, lround( time.get_frac_secs() * 1e9 ) );
+  snprintf( buf + strlen(buf), sizeof(buf) - strlen(buf), ".%09ldZ", nsecs );
+
+  return buf;
+}
+
+static bool parse_datetime( const std::string &str, osmosdr::time_spec_t &time )
+{
+  struct tm tm;
+  int consumed = 0;
+
+  memset( &tm, 0, sizeof(tm) );
+
+  if ( sscanf( str.c_str(), "%d-%d-%dT%d:%d:%d%n", &tm.tm_year, &tm.tm_mon,
+               &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &consumed ) != 6 )
+    return false;
+
+  tm.tm_year -= 1900;
+  tm.tm_mon -= 1;
+
+  double frac = 0;
+  const char *p = str.c_str() + consumed;
+
+  if ( '.' == *p ) {
+    double scale = 0.1;
+    for ( p++; *p >= '0' && *p <= '9'; p++, scale /= 10 )
+      frac += (*p - '0') * scale;
+  }
+
+#if defined(_WIN32)
+  time_t secs = _mkgmtime( &tm );
+#else
+  time_t secs = timegm( &tm );
+#endif
+
+  time = osmosdr::time_spec_t( secs, frac );
+  return true;
+}
+
+static std::string json_string( const std::string &str )
+{
+  std::ostringstream out;
+
+  out << '"';
+  for ( size_t i = 0; i < str.size(); i++ ) {
+    unsigned char c = str[i];
+
+    if ( '"' == c || '\\' == c )
+      out << '\\' << c;
+    else if ( '\n' == c )
+      out << "\\n";
+    else if ( c < 0x20 )
+      out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c)
+          << std::dec;
+    else
+      out << c;
+  }
+  out << '"';
+
+  return out.str();
+}
+
+sigmf_meta::sigmf_meta() :
+  datatype("cf32_le"),
+  sample_rate(0)
+{
+}
+
+bool sigmf_meta::locate( const std::string &filename, bool must_exist,
+                         std::string &meta_path, std::string &data_path )
+{
+  std::string base;
+
+  if ( ends_with( filename, META_EXT ) )
+    base = filename.substr( 0, filename.size() - strlen(META_EXT) );
+  else if ( ends_with( filename, DATA_EXT ) )
+    base = filename.substr( 0, filename.size() - strlen(DATA_EXT) );
+
+  if ( base.empty() ) {
+    /* plain data file name with a sidecar next to it */
+    if ( ! file_exists( filename + META_EXT ) )
+      return false;
+
+    meta_path = filename + META_EXT;
+    data_path = filename;
+    return true;
+  }
+
+  meta_path = base + META_EXT;
+  data_path = base + DATA_EXT;
+
+  return ! must_exist || file_exists( meta_path );
+}
+
+void sigmf_meta::load( const std::string &meta_path )
+{
+  namespace pt = boost::property_tree;
+  pt::ptree root;
+
+  try {
+    pt::read_json( meta_path, root );
+  } catch ( pt::json_parser_error &ex ) {
+    throw std::runtime_error( "Failed to parse " + meta_path + ": " + ex.what() );
+  }
+
+  const pt::ptree &global = root.get_child( "global", pt::ptree() );
+
+  datatype = global.get< std::string >( "core:datatype", "" );
+  sample_rate = global.get< double >( "core:sample_rate", 0 );
+  description = global.get< std::string >( "core:description", "" );
+  recorder = global.get< std::string >( "core:recorder", "" );
+
+  if ( datatype.empty() )
+    throw std::runtime_error( meta_path + " has no core:datatype" );
+
+  format(); /* rejects datatypes we cannot read */
+
+  captures.clear();
+  for ( const pt::ptree::value_type &v : root.get_child( "captures", pt::ptree() ) ) {
+    sigmf_capture c;
+
+    c.sample_start = v.second.get< uint64_t >( "core:sample_start", 0 );
+    c.frequency = v.second.get< double >( "core:frequency", 0 );
+    c.has_time = parse_datetime( v.second.get< std::string >( "core:datetime", "" ),
+                                 c.time );
+    captures.push_back( c );
+  }
+
+  std::sort( captures.begin(), captures.end(),
+             []( const sigmf_capture &a, const sigmf_capture &b ) {
+               return a.sample_start < b.sample_start;
+             } );
+
+  annotations.clear();
+  for ( const pt::ptree::value_type &v : root.get_child( "annotations", pt::ptree() ) ) {
+    sigmf_annotation a;
+
+    a.sample_start = v.second.get< uint64_t >( "core:sample_start", 0 );
+    a.sample_count = v.second.get< uint64_t >( "core:sample_count", 0 );
+    a.label = v.second.get< std::string >( "core:label", "" );
+    a.comment = v.second.get< std::string >( "core:comment", "" );
+    annotations.push_back( a );
+  }
+}
+
+/* written to a temporary file first, so readers never see half of it */
+void sigmf_meta::save( const std::string &meta_path ) const
+{
+  std::ostringstream out;
+
+  out << std::setprecision(15);
+  out << "{\n  \"global\": {\n"
+      << "    \"core:datatype\": " << json_string( datatype ) << ",\n"
+      << "    \"core:version\": \"1.0.0\",\n";
+  if ( sample_rate > 0 )
+    out << "    \"core:sample_rate\": " << sample_rate << ",\n";
+  if ( ! description.empty() )
+    out << "    \"core:description\": " << json_string( description ) << ",\n";
+  out << "    \"core:recorder\": "
+      << json_string( recorder.empty() ? "gr-osmosdr " GR_OSMOSDR_VERSION : recorder )
+      << "\n  },\n";
+
+  out << "  \"captures\": [";
+  for ( size_t i = 0; i < captures.size(); i++ ) {
+    const sigmf_capture &c = captures[i];
+
+    out << (i ? "," : "") << "\n    {\n"
+        << "      \"core:sample_start\": " << c.sample_start;
+    if ( c.frequency > 0 )
+      out << ",\n      \"core:frequency\": " << c.frequency;
+    if ( c.has_time )
+      out << ",\n      \"core:datetime\": " << json_string( format_datetime( c.time ) );
+    out << "\n    }";
+  }
+  out << (captures.empty() ? "]" : "\n  ]") << ",\n";
+
+  out << "  \"annotations\": [";
+  for ( size_t i = 0; i < annotations.size(); i++ ) {
+    const sigmf_annotation &a = annotations[i];
+
+    out << (i ? "," : "") << "\n    {\n"
+        << "      \"core:sample_start\": " << a.sample_start << ",\n"
+        << "      \"core:sample_count\": " << a.sample_count;
+    if ( ! a.label.empty() )
+      out << ",\n      \"core:label\": " << json_string( a.label );
+    if ( ! a.comment.empty() )
+      out << ",\n      \"core:comment\": " << json_string( a.comment );
+    out << "\n    }";
+  }
+  out << (annotations.empty() ? "]" : "\n  ]") << "\n}\n";
+
+  const std::string tmp = meta_path + ".tmp";
+  {
+    std::ofstream f( tmp.c_str(), std::ios::out | std::ios::trunc );
+    f << out.str();
+    if ( ! f.good() )
+      throw std::runtime_error( "Failed to write " + tmp );
+  }
+
+#if defined(_WIN32)
+  remove( meta_path.c_str() );
+#endif
+  if ( rename( tmp.c_str(), meta_path.c_str() ) != 0 )
+    throw std::runtime_error( "Failed to rename " + tmp + " to " + meta_path );
+}
+
+file_format_t sigmf_meta::format() const
+{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+  const std::string host = "_be";
+#else
+  const std::string host = "_le";
+#endif
+
+  if ( datatype == "cu8" || datatype == "cu8" + host )
+    return FILE_CU8;
+  if ( datatype == "ci8" || datatype == "ci8" + host )
+    return FILE_CS8;
+  if ( datatype == "ci16" + host )
+    return FILE_CS16;
+  if ( datatype == "cf32" + host )
+    return FILE_CF32;
+
+  throw std::runtime_error( "Unsupported SigMF datatype " + datatype );
+}
+
+void sigmf_meta::set_format( file_format_t format )
+{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+  const std::string host = "_be";
+#else
+  const std::string host = "_le";
+#endif
+
+  switch ( format ) {
+  case FILE_CU8:  datatype = "cu8"; break;
+  case FILE_CS8:  datatype = "ci8"; break;
+  case FILE_CS16: datatype = "ci16" + host; break;
+  default:        datatype = "cf32" + host; break;
+  }
+}
+
+sigmf_capture &sigmf_meta::capture_at( uint64_t sample )
+{
+  if ( captures.empty() || captures.back().sample_start < sample ) {
+    sigmf_capture c;
+
+    c.sample_start = sample;
+    c.frequency = captures.empty() ? 0 : captures.back().frequency;
+    c.has_time = time_of( sample, c.time );
+    captures.push_back( c );
+  }
+
+  return captures.back();
+}
+
+bool sigmf_meta::time_of( uint64_t sample, osmosdr::time_spec_t &time ) const
+{
+  std::vector< sigmf_capture >::const_iterator it =
+    std::upper_bound( captures.begin(), captures.end(), sample,
+                      []( uint64_t s, const sigmf_capture &c ) {
+                        return s < c.sample_start;
+                      } );
+
+  /* walk back to the last segment that carries a timestamp */
+  while ( it != captures.begin() ) {
+    --it;
+    if ( it->has_time && sample_rate > 0 ) {
+      time = it->time + osmosdr::time_spec_t( (sample - it->sample_start) / sample_rate );
+      return true;
+    }
+  }
+
+  return false;
+}
+
+osmosdr::time_spec_t sigmf_meta::utc_now()
+{
+  using namespace std::chrono;
+
+  int64_t ns = duration_cast< nanoseconds >( system_clock::now().time_since_epoch() ).count();
+
+  return osmosdr::time_spec_t( time_t( ns / 1000000000 ), (ns % 1000000000) / 1e9 );
+}
+
+bool sigmf_meta::sample_at( const osmosdr::time_spec_t &time, uint64_t &sample ) const
+{
+  std::vector< sigmf_capture >::const_iterator first =
+    std::find_if( captures.begin(), captures.end(),
+                  []( const sigmf_capture &c ) { return c.has_time; } );
+
+  if ( first == captures.end() || sample_rate <= 0 )
+    return false;
+
+  /* last capture starting at or before the requested time */
+  std::vector< sigmf_capture >::const_iterator it =
+    std::upper_bound( first, captures.end(), time,
+                      [this]( const osmosdr::time_spec_t &t, const sigmf_capture &c ) {
+                        osmosdr::time_spec_t start;
+                        return time_of( c.sample_start, start ) && t < start;
+                      } );
+
+  if ( it == first ) {
+    sample = first->sample_start;
+    return true;
+  }
+
+  --it;
+
+  osmosdr::time_spec_t start;
+  time_of( it->sample_start, start );
+
+  osmosdr::time_spec_t offset = time;
+  offset -= start;
+  sample = it->sample_start + uint64_t( llround( offset.get_real_secs() * sample_rate ) );
+
+  /* a gap in the recording: land on the first sample after it */
+  std::vector< sigmf_capture >::const_iterator next = it + 1;
+  if ( next != captures.end() && sample > next->sample_start )
+    sample = next->sample_start;
+
+  return true;
+}
@@ -0,0 +1,101 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_FILE_SIGMF_H
+#define INCLUDED_FILE_SIGMF_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <osmosdr/time_spec.h>
+
+#include "file_convert.h"
+
+/*!
+ * \brief The subset of a SigMF .sigmf-meta file the file backend uses.
+ *
+ * Covers core:datatype, core:sample_rate, the captures segments with
+ * their frequency and datetime, and annotations. Everything else in an
+ * existing file is ignored on load and not written back.
+ */
+struct sigmf_capture
+{
+  uint64_t sample_start;
+  double frequency;           /* 0 when not recorded */
+  bool has_time;
+  osmosdr::time_spec_t time;  /* UTC time of sample_start */
+};
+
+struct sigmf_annotation
+{
+  uint64_t sample_start;
+  uint64_t sample_count;
+  std::string label;
+  std::string comment;
+};
+
+class sigmf_meta
+{
+public:
+  sigmf_meta();
+
+  /*!
+   * Works out the .sigmf-meta / .sigmf-data pair for a file argument, which
+   * may name either of them. Returns false if \p filename is not part of a
+   * SigMF recording (no .sigmf-* extension and no <file>.sigmf-meta).
+   */
+  static bool locate( const std::string &filename, bool must_exist,
+                      std::string &meta_path, std::string &data_path );
+
+  /* throws std::runtime_error */
+  void load( const std::string &meta_path );
+  void save( const std::string &meta_path ) const;
+
+  file_format_t format() const;
+  void set_format( file_format_t format );
+
+  /*!
+   * Adds a capture segment at \p sample, or updates the one already
+   * starting there. Captures must be added in sample order.
+   */
+  sigmf_capture &capture_at( uint64_t sample );
+
+  /* UTC time of \p sample, extrapolated from the capture containing it */
+  bool time_of( uint64_t sample, osmosdr::time_spec_t &time ) const;
+
+  /*!
+   * Sample taken at \p time: a binary search over the captures followed by
+   * an offset within the segment, so the cost does not depend on the size
+   * of the recording. Returns false if no capture carries a timestamp.
+   */
+  bool sample_at( const osmosdr::time_spec_t &time, uint64_t &sample ) const;
+
+  /* host wall clock time, UTC */
+  static osmosdr::time_spec_t utc_now();
+
+  std::string datatype;
+  double sample_rate;
+  std::string description;
+  std::string recorder;
+  std::vector< sigmf_capture > captures;
+  std::vector< sigmf_annotation > annotations;
+};
+
+#endif /* INCLUDED_FILE_SIGMF_H */
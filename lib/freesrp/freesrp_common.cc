@@ -16,6 +16,8 @@ freesrp_common::freesrp_common(const string &args)
 {
   dict_t dict = params_to_dict(args);
 
+  _sched = thread_sched(dict);
+
   if(!_srp)
   {
     try
@@ -9,6 +9,8 @@
 
 #include <freesrp.hpp>
 
+#include "thread_sched.h"
+
 class freesrp_common
 {
 protected:
@@ -25,6 +27,7 @@ public:
 protected:
     static std::shared_ptr<::FreeSRP::FreeSRP> _srp;
     bool _ignore_overflow = false;
+    thread_sched _sched;
 };
 
 #endif
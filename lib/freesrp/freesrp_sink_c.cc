@@ -1,8 +1,16 @@
 #include "freesrp_sink_c.h"
 
+#include <algorithm>
+#include <cstring>
+
+#include <volk/volk.h>
+
 using namespace FreeSRP;
 using namespace std;
 
+// The ring is converted with volk as interleaved int16 I/Q
+static_assert(sizeof(sample) == 2 * sizeof(int16_t), "unexpected FreeSRP::sample layout");
+
 freesrp_sink_c_sptr make_freesrp_sink_c (const string &args)
 {
     return gnuradio::get_initial_sptr(new freesrp_sink_c (args));
@@ -31,6 +39,8 @@ freesrp_sink_c::freesrp_sink_c (const string & args) : gr::sync_block("freesrp_s
     {
         throw runtime_error("FreeSRP not initialized!");
     }
+
+    _buf.reset(FREESRP_RX_TX_QUEUE_SIZE, buffer_allocator(params_to_dict(args)));
 }
 
 bool freesrp_sink_c::start()
@@ -40,7 +50,11 @@ bool freesrp_sink_c::start()
     {
         return false;
     }
+    _sched.reset();
     _srp->start_tx(std::bind(&freesrp_sink_c::freesrp_tx_callback, this, std::placeholders::_1));
+
+    _running = true;
+
     return true;
 }
 
@@ -48,26 +62,29 @@ bool freesrp_sink_c::stop()
 {
     _srp->send_cmd({SET_DATAPATH_EN, 0});
     _srp->stop_tx();
+
+    _running = false;
+
+    { lock_guard<std::mutex> lk(_buf_mut); }
+    _buf_cond.notify_one();
+
     return true;
 }
 
 void freesrp_sink_c::freesrp_tx_callback(vector<sample>& samples)
 {
-    unique_lock<std::mutex> lk(_buf_mut);
+    _sched.apply_once("freesrp tx");
+
+    size_t n = _buf.read(samples.data(), samples.size());
 
-    for(sample &s : samples)
+    // Underrun, pad the transfer with zeros
+    if(n < samples.size())
     {
-        if(!_buf_queue.try_dequeue(s))
-        {
-            s.i = 0;
-            s.q = 0;
-        }
-        else
-        {
-            _buf_available_space++;
-        }
+        memset(&samples[n], 0, (samples.size() - n) * sizeof(sample));
     }
 
+    // An empty critical section orders us against a sleeping work()
+    { lock_guard<std::mutex> lk(_buf_mut); }
     _buf_cond.notify_one();
 }
 
@@ -75,31 +92,37 @@ int freesrp_sink_c::work(int noutput_items, gr_vector_const_void_star& input_ite
 {
     const gr_complex *in = (const gr_complex *) input_items[0];
 
-    unique_lock<std::mutex> lk(_buf_mut);
-
-    // Wait until enough space is available
-    while(_buf_available_space < (unsigned int) noutput_items)
+    if(_buf.write_available() == 0)
     {
-        _buf_cond.wait(lk);
+        unique_lock<std::mutex> lk(_buf_mut);
+
+        _buf_cond.wait(lk, [this] { return _buf.write_available() > 0 || !_running; });
     }
 
-    for(int i = 0; i < noutput_items; ++i)
+    if(!_running)
     {
-        sample s;
-        s.i = (int16_t) (real(in[i]) * 2047.0f);
-        s.q = (int16_t) (imag(in[i]) * 2047.0f);
+        return WORK_DONE;
+    }
 
-        if(!_buf_queue.try_enqueue(s))
-        {
-            throw runtime_error("Failed to add sample to buffer. This should never happen. Available space reported to be " + to_string(_buf_available_space) + " samples, noutput_items=" + to_string(noutput_items) + ", i=" + to_string(i));
-        }
-        else
+    int consumed = 0;
+
+    // At most two contiguous runs, converted in place into the ring
+    while(consumed < noutput_items)
+    {
+        sample *out;
+        size_t n = min(_buf.write_span(out), (size_t) (noutput_items - consumed));
+        if(n == 0)
         {
-            _buf_available_space--;
+            break;
         }
+
+        volk_32f_s32f_convert_16i(reinterpret_cast<int16_t *>(out),
+                                  reinterpret_cast<const float *>(in + consumed), 2047.0f, 2 * n);
+        _buf.commit(n);
+        consumed += n;
     }
 
-    return noutput_items;
+    return consumed;
 }
 
 double freesrp_sink_c::set_sample_rate( double rate )
@@ -29,8 +29,9 @@
 #include "sink_iface.h"
 
 #include "freesrp_common.h"
-#include "readerwriterqueue/readerwriterqueue.h"
+#include "spsc_ring.h"
 
+#include <atomic>
 #include <mutex>
 #include <condition_variable>
 
@@ -119,12 +120,12 @@ private:
 
     void freesrp_tx_callback(std::vector<::FreeSRP::sample> &samples);
 
-    bool _running = false;
+    std::atomic<bool> _running{false};
 
+    /* the mutex only serves sleeping in work(), the ring itself is lock-free */
     std::mutex _buf_mut{};
     std::condition_variable _buf_cond{};
-    size_t _buf_available_space = FREESRP_RX_TX_QUEUE_SIZE;
-    moodycamel::ReaderWriterQueue<::FreeSRP::sample> _buf_queue{FREESRP_RX_TX_QUEUE_SIZE};
+    spsc_sample_ring<::FreeSRP::sample> _buf;
 };
 
 #endif /* INCLUDED_FREESRP_SINK_C_H */
@@ -1,8 +1,15 @@
 #include "freesrp_source_c.h"
 
+#include <algorithm>
+
+#include <volk/volk.h>
+
 using namespace FreeSRP;
 using namespace std;
 
+// The ring is converted with volk as interleaved int16 I/Q
+static_assert(sizeof(sample) == 2 * sizeof(int16_t), "unexpected FreeSRP::sample layout");
+
 freesrp_source_c_sptr make_freesrp_source_c (const string &args)
 {
     return gnuradio::get_initial_sptr(new freesrp_source_c (args));
@@ -31,6 +38,8 @@ freesrp_source_c::freesrp_source_c (const string & args) : gr::sync_block ("free
     {
         throw runtime_error("FreeSRP not initialized!");
     }
+
+    _buf.reset(FREESRP_RX_TX_QUEUE_SIZE, buffer_allocator(params_to_dict(args)));
 }
 
 bool freesrp_source_c::start()
@@ -40,6 +49,7 @@ bool freesrp_source_c::start()
     {
         return false;
     }
+    _sched.reset();
     _srp->start_rx(std::bind(&freesrp_source_c::freesrp_rx_callback, this, std::placeholders::_1));
 
     _running = true;
@@ -54,28 +64,26 @@ bool freesrp_source_c::stop()
 
     _running = false;
 
+    { lock_guard<std::mutex> lk(_buf_mut); }
+    _buf_cond.notify_one();
+
     return true;
 }
 
 void freesrp_source_c::freesrp_rx_callback(const vector<sample> &samples)
 {
-    unique_lock<std::mutex> lk(_buf_mut);
+    _sched.apply_once("freesrp rx");
 
-    for(const sample &s : samples)
+    if(_buf.write(samples.data(), samples.size()) < samples.size())
     {
-        if(!_buf_queue.try_enqueue(s))
-        {
-	    if(!_ignore_overflow)
-	    {
-		throw runtime_error("RX buffer overflow");
-	    }
-        }
-        else
+        if(!_ignore_overflow)
         {
-            _buf_num_samples++;
+            throw runtime_error("RX buffer overflow");
         }
     }
 
+    // An empty critical section orders us against a sleeping work()
+    { lock_guard<std::mutex> lk(_buf_mut); }
     _buf_cond.notify_one();
 }
 
@@ -83,36 +91,37 @@ int freesrp_source_c::work(int noutput_items, gr_vector_const_void_star& input_i
 {
     gr_complex *out = static_cast<gr_complex *>(output_items[0]);
 
-    unique_lock<std::mutex> lk(_buf_mut);
-
-    if(!_running)
+    if(_buf.read_available() == 0)
     {
-	return WORK_DONE;
+        unique_lock<std::mutex> lk(_buf_mut);
+
+        _buf_cond.wait(lk, [this] { return _buf.read_available() > 0 || !_running; });
     }
 
-    // Wait until enough samples collected
-    while(_buf_num_samples < (unsigned int) noutput_items)
+    if(!_running)
     {
-        _buf_cond.wait(lk);
+        return WORK_DONE;
     }
 
-    for(int i = 0; i < noutput_items; ++i)
+    int produced = 0;
+
+    // At most two contiguous runs, converted in place out of the ring
+    while(produced < noutput_items)
     {
-        sample s;
-        if(!_buf_queue.try_dequeue(s))
-        {
-            // This should not be happening
-            throw runtime_error("Failed to get sample from buffer. This should never happen. Number of available samples reported to be " + to_string(_buf_num_samples) + ", noutput_items=" + to_string(noutput_items) + ", i=" + to_string(i));
-        }
-        else
+        const sample *in;
+        size_t n = min(_buf.read_span(in), (size_t) (noutput_items - produced));
+        if(n == 0)
         {
-            _buf_num_samples--;
+            break;
         }
 
-        out[i] = gr_complex(((float) s.i) / 2048.0f, ((float) s.q) / 2048.0f);
+        volk_16i_s32f_convert_32f(reinterpret_cast<float *>(out + produced),
+                                  reinterpret_cast<const int16_t *>(in), 2048.0f, 2 * n);
+        _buf.consume(n);
+        produced += n;
     }
 
-    return noutput_items;
+    return produced;
 }
 
 double freesrp_source_c::set_sample_rate( double rate )
@@ -30,10 +30,11 @@
 
 #include "freesrp_common.h"
 
-#include "readerwriterqueue/readerwriterqueue.h"
+#include "spsc_ring.h"
 
 #include <freesrp.hpp>
 
+#include <atomic>
 #include <mutex>
 #include <condition_variable>
 
@@ -120,12 +121,12 @@ private:
 
     void freesrp_rx_callback(const std::vector<FreeSRP::sample> &samples);
 
-    bool _running = false;
+    std::atomic<bool> _running{false};
 
+    /* the mutex only serves sleeping in work(), the ring itself is lock-free */
     std::mutex _buf_mut{};
     std::condition_variable _buf_cond{};
-    size_t _buf_num_samples = 0;
-    moodycamel::ReaderWriterQueue<FreeSRP::sample> _buf_queue{FREESRP_RX_TX_QUEUE_SIZE};
+    spsc_sample_ring<FreeSRP::sample> _buf;
 };
 
 #endif /* INCLUDED_FREESRP_SOURCE_C_H */
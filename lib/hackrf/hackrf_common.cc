@@ -54,6 +54,11 @@ hackrf_common::hackrf_common(const std::string &args) :
     target_serial = dict["hackrf"];
   }
 
+  _sched = thread_sched(dict);
+
+  if (dict.count("replay"))
+    return; /* replaying a capture, no device is opened */
+
   {
     std::lock_guard<std::mutex> guard(_usage_mutex);
 
@@ -102,6 +107,8 @@ hackrf_common::hackrf_common(const std::string &args) :
     final_serial = list->serial_numbers[dev_index];
   }
 
+  _serial = final_serial;
+
   {
     std::lock_guard<std::mutex> guard(_devs_mutex);
 
@@ -413,6 +420,7 @@ bool hackrf_common::get_bias()
 void hackrf_common::start()
 {
   _started = true;
+  _sched.reset();
   set_center_freq(get_center_freq());
   set_sample_rate(get_sample_rate());
   if (_requested_bandwidth != 0)
@@ -425,3 +433,64 @@ void hackrf_common::stop()
 {
   _started = false;
 }
+
+/* Look for our board again after it dropped off the bus and bring it back
+ * to the cached settings. Returns false if it is not there (yet). */
+bool hackrf_common::reopen()
+{
+  int ret;
+  hackrf_device *raw_dev;
+  hackrf_sptr dev;
+
+  if (_serial.empty())
+    return false;
+
+  {
+    std::lock_guard<std::mutex> guard(_devs_mutex);
+
+    hackrf_sptr shared = _devs[_serial].lock();
+
+    if (shared && shared != _dev) {
+      dev = shared; /* the other direction reopened it already */
+    } else {
+      hackrf_device_list_t *list = hackrf_device_list();
+      if (!list)
+        return false;
+
+      int dev_index;
+      for (dev_index = 0; dev_index < list->devicecount; dev_index++) {
+        if (list->serial_numbers[dev_index] &&
+            _serial == list->serial_numbers[dev_index])
+          break;
+      }
+
+      bool found = dev_index < list->devicecount;
+      if (found)
+        ret = hackrf_device_list_open(list, dev_index, &raw_dev);
+
+      hackrf_device_list_free(list);
+
+      if (!found || ret != HACKRF_SUCCESS)
+        return false;
+
+      {
+        std::lock_guard<std::mutex> usage_guard(_usage_mutex);
+        _usage++; /* balanced by close() of the new handle */
+      }
+
+      dev = hackrf_sptr(raw_dev, hackrf_common::close);
+      _devs[_serial] = static_cast<std::weak_ptr<struct hackrf_device>>(dev);
+    }
+  }
+
+  _dev = dev; /* drops our reference to the stale handle */
+
+  try {
+    start();
+  } catch (std::exception &ex) {
+    std::cerr << ex.what() << std::endl;
+    return false;
+  }
+
+  return true;
+}
@@ -31,6 +31,8 @@
 #include <osmosdr/ranges.h>
 #include <libhackrf/hackrf.h>
 
+#include "thread_sched.h"
+
 #define BUF_LEN  (16 * 32 * 512) /* must be multiple of 512 */
 #define BUF_NUM   15
 
@@ -88,7 +90,10 @@ protected:
   void start();
   void stop();
 
+  bool reopen();
+
   hackrf_sptr _dev;
+  thread_sched _sched;
 
 private:
   static void close(void *dev);
@@ -108,6 +113,7 @@ private:
   double _bandwidth;
   bool _bias;
   bool _started;
+  std::string _serial;
 };
 
 #endif /* INCLUDED_HACKRF_COMMON_H */
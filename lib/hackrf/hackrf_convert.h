@@ -0,0 +1,117 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Dimitri Stolnikov <horiz0n@gmx.net>
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_HACKRF_CONVERT_H
+#define INCLUDED_HACKRF_CONVERT_H
+
+/*
+ * Conversion kernels of hackrf_source_c::work() and hackrf_sink_c::work(),
+ * kept apart from the blocks so that bench/ can measure them without
+ * libhackrf.
+ */
+
+#include <stdint.h>
+
+#include <complex>
+#include <vector>
+
+#ifdef USE_AVX
+#include <immintrin.h>
+#elif USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef USE_AVX
+static inline void convert_avx(const float* inbuf, int8_t* outbuf,const unsigned int count)
+{
+  __m256 mulme = _mm256_set_ps(127.0f, 127.0f, 127.0f, 127.0f, 127.0f, 127.0f, 127.0f, 127.0f);
+  for(unsigned int i=0; i<count;i++){
+
+  __m256i itmp3 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(&inbuf[i*16+0]), mulme));
+  __m256i itmp4 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(&inbuf[i*16+8]), mulme));
+
+  __m128i a1 = _mm256_extractf128_si256(itmp3, 1);
+  __m128i a0 = _mm256_castsi256_si128(itmp3);
+  __m128i a3 = _mm256_extractf128_si256(itmp4, 1);
+  __m128i a2 = _mm256_castsi256_si128(itmp4);
+
+  __m128i outshorts1 = _mm_packs_epi32(a0, a1);
+  __m128i outshorts2 = _mm_packs_epi32(a2, a3);
+
+  __m128i outbytes = _mm_packs_epi16(outshorts1, outshorts2);
+
+  _mm_storeu_si128 ((__m128i*)&outbuf[i*16], outbytes);
+  }
+}
+
+#elif USE_SSE2
+static inline void convert_sse2(const float* inbuf, int8_t* outbuf,const unsigned int count)
+{
+  const __m128 mulme = _mm_set_ps( 127.0f, 127.0f, 127.0f, 127.0f );
+  __m128 itmp1,itmp2,itmp3,itmp4;
+  __m128i otmp1,otmp2,otmp3,otmp4;
+
+  __m128i outshorts1,outshorts2;
+  __m128i outbytes;
+
+  for(unsigned int i=0; i<count;i++){
+
+  itmp1 = _mm_mul_ps(_mm_loadu_ps(&inbuf[i*16+0]), mulme);
+  itmp2 = _mm_mul_ps(_mm_loadu_ps(&inbuf[i*16+4]), mulme);
+  itmp3 = _mm_mul_ps(_mm_loadu_ps(&inbuf[i*16+8]), mulme);
+  itmp4 = _mm_mul_ps(_mm_loadu_ps(&inbuf[i*16+12]), mulme);
+
+  otmp1 = _mm_cvtps_epi32(itmp1);
+  otmp2 = _mm_cvtps_epi32(itmp2);
+  otmp3 = _mm_cvtps_epi32(itmp3);
+  otmp4 = _mm_cvtps_epi32(itmp4);
+
+  outshorts1 = _mm_packs_epi32(otmp1, otmp2);
+  outshorts2 = _mm_packs_epi32(otmp3, otmp4);
+
+  outbytes = _mm_packs_epi16(outshorts1, outshorts2);
+
+  _mm_storeu_si128 ((__m128i*)&outbuf[i*16], outbytes);
+  }
+}
+#endif
+
+/* receive side: s8 I/Q through a 256 entry lookup table */
+static inline void hackrf_make_lut(std::vector<float> &lut)
+{
+  lut.clear();
+  for (unsigned int i = 0; i <= 0xff; i++)
+    lut.push_back( float(int8_t(i)) * (1.0f/128.0f) );
+}
+
+static inline void hackrf_lut_convert(const float *lut, const uint8_t *buf,
+                                      std::complex<float> *out, int n)
+{
+  for (int i = 0; i < n; ++i)
+    out[i] = std::complex<float>( lut[buf[i*2]], lut[buf[i*2 + 1]] );
+}
+
+static inline void convert_default(float* inbuf, int8_t* outbuf,const unsigned int count)
+{
+  for(unsigned int i=0; i<count;i++){
+    outbuf[i]= inbuf[i]*127;
+  }
+}
+
+#endif /* INCLUDED_HACKRF_CONVERT_H */
@@ -32,23 +32,23 @@
 #include <stdexcept>
 #include <iostream>
 #include <algorithm>
-#ifdef USE_AVX
-#include <immintrin.h>
-#elif USE_SSE2
-#include <emmintrin.h>
-#endif
 
 #include <gnuradio/io_signature.h>
 
 #include "hackrf_sink_c.h"
+#include "hackrf_convert.h"
 
 #include "arg_helpers.h"
+#include "trace.h"
 
-static inline bool cb_init(circular_buffer_t *cb, size_t capacity, size_t sz)
+static inline bool cb_init(circular_buffer_t *cb, size_t capacity, size_t sz,
+                           const buffer_allocator &alloc)
 {
-  cb->buffer = malloc(capacity * sz);
-  if(cb->buffer == NULL)
+  try {
+    cb->buffer = alloc.allocate(capacity * sz);
+  } catch (std::bad_alloc &) {
     return false; // handle error
+  }
   cb->buffer_end = (int8_t *)cb->buffer + capacity * sz;
   cb->capacity = capacity;
   cb->count = 0;
@@ -58,9 +58,9 @@ static inline bool cb_init(circular_buffer_t *cb, size_t capacity, size_t sz)
   return true;
 }
 
-static inline void cb_free(circular_buffer_t *cb)
+static inline void cb_free(circular_buffer_t *cb, const buffer_allocator &alloc)
 {
-  free(cb->buffer);
+  alloc.deallocate(cb->buffer, cb->capacity * cb->sz);
   cb->buffer = NULL;
   // clear out other fields too, just to be safe
   cb->buffer_end = 0;
@@ -169,7 +169,8 @@ hackrf_sink_c::hackrf_sink_c (const std::string &args)
 
   _buf = (int8_t *) malloc( BUF_LEN );
 
-  cb_init( &_cbuf, _buf_num, BUF_LEN );
+  _buf_alloc = buffer_allocator( dict );
+  cb_init( &_cbuf, _buf_num, BUF_LEN, _buf_alloc );
 }
 
 /*
@@ -180,17 +181,20 @@ hackrf_sink_c::~hackrf_sink_c ()
   free(_buf);
   _buf = NULL;
 
-  cb_free( &_cbuf );
+  cb_free( &_cbuf, _buf_alloc );
 }
 
 int hackrf_sink_c::_hackrf_tx_callback(hackrf_transfer *transfer)
 {
   hackrf_sink_c *obj = (hackrf_sink_c *)transfer->tx_ctx;
+  obj->_sched.apply_once( "hackrf tx" );
   return obj->hackrf_tx_callback(transfer->buffer, transfer->valid_length);
 }
 
 int hackrf_sink_c::hackrf_tx_callback(unsigned char *buffer, uint32_t length)
 {
+  OSMOSDR_TRACE_SCOPE( "hackrf", "tx callback" );
+
 #if 0
   for (unsigned int i = 0; i < length; ++i) /* simulate noise */
     *buffer++ = rand() % 255;
@@ -210,6 +214,8 @@ int hackrf_sink_c::hackrf_tx_callback(unsigned char *buffer, uint32_t length)
 //      std::cerr << "-" << std::flush;
       _buf_cond.notify_one();
     }
+
+    OSMOSDR_TRACE_COUNTER( "hackrf", "tx buffers used", this, _cbuf.count );
   }
 #endif
   return 0; // TODO: return -1 on error/stop
@@ -273,75 +279,15 @@ bool hackrf_sink_c::stop()
   return true;
 }
 
-#ifdef USE_AVX
-void convert_avx(const float* inbuf, int8_t* outbuf,const unsigned int count)
-{
-  __m256 mulme = _mm256_set_ps(127.0f, 127.0f, 127.0f, 127.0f, 127.0f, 127.0f, 127.0f, 127.0f);
-  for(unsigned int i=0; i<count;i++){
-
-  __m256i itmp3 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(&inbuf[i*16+0]), mulme));
-  __m256i itmp4 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(&inbuf[i*16+8]), mulme));
-
-  __m128i a1 = _mm256_extractf128_si256(itmp3, 1);
-  __m128i a0 = _mm256_castsi256_si128(itmp3);
-  __m128i a3 = _mm256_extractf128_si256(itmp4, 1);
-  __m128i a2 = _mm256_castsi256_si128(itmp4);
-
-  __m128i outshorts1 = _mm_packs_epi32(a0, a1);
-  __m128i outshorts2 = _mm_packs_epi32(a2, a3);
-
-  __m128i outbytes = _mm_packs_epi16(outshorts1, outshorts2);
-
-  _mm_storeu_si128 ((__m128i*)&outbuf[i*16], outbytes);
-  }
-}
-
-#elif USE_SSE2
-void convert_sse2(const float* inbuf, int8_t* outbuf,const unsigned int count)
-{
-  const register __m128 mulme = _mm_set_ps( 127.0f, 127.0f, 127.0f, 127.0f );
-  __m128 itmp1,itmp2,itmp3,itmp4;
-  __m128i otmp1,otmp2,otmp3,otmp4;
-
-  __m128i outshorts1,outshorts2;
-  __m128i outbytes;
-
-  for(unsigned int i=0; i<count;i++){
-
-  itmp1 = _mm_mul_ps(_mm_loadu_ps(&inbuf[i*16+0]), mulme);
-  itmp2 = _mm_mul_ps(_mm_loadu_ps(&inbuf[i*16+4]), mulme);
-  itmp3 = _mm_mul_ps(_mm_loadu_ps(&inbuf[i*16+8]), mulme);
-  itmp4 = _mm_mul_ps(_mm_loadu_ps(&inbuf[i*16+12]), mulme);
-
-  otmp1 = _mm_cvtps_epi32(itmp1);
-  otmp2 = _mm_cvtps_epi32(itmp2);
-  otmp3 = _mm_cvtps_epi32(itmp3);
-  otmp4 = _mm_cvtps_epi32(itmp4);
-
-  outshorts1 = _mm_packs_epi32(otmp1, otmp2);
-  outshorts2 = _mm_packs_epi32(otmp3, otmp4);
-
-  outbytes = _mm_packs_epi16(outshorts1, outshorts2);
-
-  _mm_storeu_si128 ((__m128i*)&outbuf[i*16], outbytes);
-  }
-}
-#endif
-
-void convert_default(float* inbuf, int8_t* outbuf,const unsigned int count)
-{
-  for(unsigned int i=0; i<count;i++){
-    outbuf[i]= inbuf[i]*127;
-  }
-}
-
 int hackrf_sink_c::work( int noutput_items,
                          gr_vector_const_void_star &input_items,
                          gr_vector_void_star &output_items )
 {
+  OSMOSDR_TRACE_SCOPE( "hackrf", "tx work" );
   const gr_complex *in = (const gr_complex *) input_items[0];
 
   {
+    OSMOSDR_TRACE_SCOPE( "hackrf", "tx wait" );
     std::unique_lock<std::mutex> lock(_buf_mutex);
 
     while ( ! cb_has_room(&_cbuf) )
@@ -382,6 +328,8 @@ int hackrf_sink_c::work( int noutput_items,
 //        std::cerr << "+" << std::flush;
         _buf_used = 0;
       }
+
+      OSMOSDR_TRACE_COUNTER( "hackrf", "tx buffers used", this, _cbuf.count );
     }
   }
 
@@ -30,6 +30,7 @@
 
 #include "sink_iface.h"
 #include "hackrf_common.h"
+#include "buffer_allocator.h"
 
 class hackrf_sink_c;
 
@@ -128,6 +129,7 @@ private:
   int hackrf_tx_callback(unsigned char *buffer, uint32_t length);
 
   circular_buffer_t _cbuf;
+  buffer_allocator _buf_alloc;
   int8_t *_buf;
   unsigned int _buf_num;
   unsigned int _buf_used;
@@ -35,8 +35,10 @@
 #include <gnuradio/io_signature.h>
 
 #include "hackrf_source_c.h"
+#include "hackrf_convert.h"
 
 #include "arg_helpers.h"
+#include "trace.h"
 
 hackrf_source_c_sptr make_hackrf_source_c (const std::string & args)
 {
@@ -66,6 +68,7 @@ hackrf_source_c::hackrf_source_c (const std::string &args)
         gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof (gr_complex))),
     hackrf_common::hackrf_common(args),
     _buf(NULL),
+    _buf_mem(NULL),
     _lna_gain(0),
     _vga_gain(0)
 {
@@ -88,17 +91,24 @@ hackrf_source_c::hackrf_source_c (const std::string &args)
   _samp_avail = _buf_len / BYTES_PER_SAMPLE;
 
   // create a lookup table for gr_complex values
-  for (unsigned int i = 0; i <= 0xff; i++) {
-    _lut.push_back( float(int8_t(i)) * (1.0f/128.0f) );
-  }
+  hackrf_make_lut( _lut );
 
   if ( BUF_NUM != _buf_num || BUF_LEN != _buf_len ) {
     std::cerr << "Using " << _buf_num << " buffers of size " << _buf_len << "."
               << std::endl;
   }
 
+  if (dict.count("record"))
+    _record_path = dict["record"];
+
+  _watchdog.configure(dict);
+
+  _publisher = shm_publisher::make(args, "hackrf");
+
+  _replay = transfer_player::make(args, "hackrf");
+
   set_center_freq( (get_freq_range().start() + get_freq_range().stop()) / 2.0 );
-  set_sample_rate( get_sample_rates().start() );
+  set_sample_rate( _replay ? _replay->sample_rate() : get_sample_rates().start() );
   set_bandwidth( 0 );
 
   set_gain( 0 ); /* disable AMP gain stage by default to protect full sprectrum pre-amp from physical damage */
@@ -112,11 +122,13 @@ hackrf_source_c::hackrf_source_c (const std::string &args)
     hackrf_common::set_bias(dict["bias"] == "1");
   }
 
+  _buf_alloc = buffer_allocator(dict);
+  _buf_mem = (unsigned char *) _buf_alloc.allocate(_buf_num * _buf_len);
   _buf = (unsigned char **) malloc(_buf_num * sizeof(unsigned char *));
 
   if (_buf) {
     for(unsigned int i = 0; i < _buf_num; ++i)
-      _buf[i] = (unsigned char *) malloc(_buf_len);
+      _buf[i] = _buf_mem + i * _buf_len;
   }
 }
 
@@ -125,24 +137,40 @@ hackrf_source_c::hackrf_source_c (const std::string &args)
  */
 hackrf_source_c::~hackrf_source_c ()
 {
-  if (_buf) {
-    for(unsigned int i = 0; i < _buf_num; ++i) {
-      free(_buf[i]);
-    }
+  if (_replay)
+    _replay->stop();
 
+  if (_buf) {
     free(_buf);
     _buf = NULL;
   }
+
+  _buf_alloc.deallocate(_buf_mem, _buf_num * _buf_len);
+  _buf_mem = NULL;
 }
 
 int hackrf_source_c::_hackrf_rx_callback(hackrf_transfer *transfer)
 {
   hackrf_source_c *obj = (hackrf_source_c *)transfer->rx_ctx;
+
+  obj->_sched.apply_once( "hackrf rx" );
+
+  if (obj->_recorder)
+    obj->_recorder->record(transfer->buffer, transfer->valid_length);
+
+  if (obj->_publisher)
+    obj->_publisher->publish(transfer->buffer, transfer->valid_length,
+                             obj->get_sample_rate(), obj->get_center_freq());
+
   return obj->hackrf_rx_callback(transfer->buffer, transfer->valid_length);
 }
 
 int hackrf_source_c::hackrf_rx_callback(unsigned char *buf, uint32_t len)
 {
+  OSMOSDR_TRACE_SCOPE( "hackrf", "rx callback" );
+
+  _watchdog.transfer( len / BYTES_PER_SAMPLE, get_sample_rate() );
+
   {
     std::lock_guard<std::mutex> lock(_buf_mutex);
 
@@ -155,6 +183,8 @@ int hackrf_source_c::hackrf_rx_callback(unsigned char *buf, uint32_t len)
     } else {
       _buf_used++;
     }
+
+    OSMOSDR_TRACE_COUNTER( "hackrf", "rx buffers used", this, _buf_used );
   }
 
   _buf_cond.notify_one();
@@ -164,9 +194,28 @@ int hackrf_source_c::hackrf_rx_callback(unsigned char *buf, uint32_t len)
 
 bool hackrf_source_c::start()
 {
+  if ( ! _record_path.empty() && ! _recorder )
+    _recorder.reset( new transfer_recorder( _record_path, "hackrf",
+                                            get_sample_rate() ) );
+
+  if ( _replay ) {
+    _watchdog.reset();
+    _replay->start( [this](unsigned char *buf, size_t len) {
+      hackrf_transfer transfer = {};
+      transfer.buffer = buf;
+      transfer.buffer_length = len;
+      transfer.valid_length = len;
+      transfer.rx_ctx = this;
+      _hackrf_rx_callback( &transfer );
+    }, transfer_player::done_t(), _buf_len ); /* work() expects full buffers */
+    return true;
+  }
+
   if ( ! _dev.get() )
     return false;
 
+  _watchdog.reset();
+
   hackrf_common::start();
   int ret = hackrf_start_rx( _dev.get(), _hackrf_rx_callback, (void *)this );
   if ( ret != HACKRF_SUCCESS ) {
@@ -178,6 +227,11 @@ bool hackrf_source_c::start()
 
 bool hackrf_source_c::stop()
 {
+  if ( _replay ) {
+    _replay->stop();
+    return true;
+  }
+
   if ( ! _dev.get() )
     return false;
 
@@ -194,14 +248,18 @@ int hackrf_source_c::work( int noutput_items,
                         gr_vector_const_void_star &input_items,
                         gr_vector_void_star &output_items )
 {
+  OSMOSDR_TRACE_SCOPE( "hackrf", "rx work" );
   gr_complex *out = (gr_complex *)output_items[0];
 
   bool running = false;
 
   if ( _dev.get() )
     running = (hackrf_is_streaming( _dev.get() ) == HACKRF_TRUE);
+  else if ( _replay )
+    running = _replay->running();
 
   {
+    OSMOSDR_TRACE_SCOPE( "hackrf", "rx wait" );
     std::unique_lock<std::mutex> lock(_buf_mutex);
 
     while (_buf_used < 3 && running) { // collect at least 3 buffers
@@ -210,48 +268,108 @@ int hackrf_source_c::work( int noutput_items,
       // Re-check whether the device has closed or stopped streaming
       if ( _dev.get() )
         running = (hackrf_is_streaming( _dev.get() ) == HACKRF_TRUE);
+      else if ( _replay )
+        running = _replay->running();
       else
         running = false;
     }
   }
 
-  if ( ! running )
-    return WORK_DONE;
+  if ( ! running ) {
+    bool lost = _replay ? _replay->unplugged() : _dev.get() != NULL;
+    if ( ! lost || ! reattach() )
+      return WORK_DONE;
+    return 0;
+  }
 
   const uint8_t *buf = _buf[_buf_head] + _buf_offset * BYTES_PER_SAMPLE;
-#define TO_COMPLEX(p) gr_complex( _lut[(p)[0]], _lut[(p)[1]] )
-
   if (noutput_items <= _samp_avail) {
-    for (int i = 0; i < noutput_items; ++i)
-      *out++ = TO_COMPLEX( buf + i*BYTES_PER_SAMPLE );
+    hackrf_lut_convert( _lut.data(), buf, out, noutput_items );
+    out += noutput_items;
 
     _buf_offset += noutput_items;
     _samp_avail -= noutput_items;
   } else {
-    for (int i = 0; i < _samp_avail; ++i)
-      *out++ = TO_COMPLEX( buf + i*BYTES_PER_SAMPLE );
+    hackrf_lut_convert( _lut.data(), buf, out, _samp_avail );
+    out += _samp_avail;
 
     {
       std::lock_guard<std::mutex> lock(_buf_mutex);
 
       _buf_head = (_buf_head + 1) % _buf_num;
       _buf_used--;
+
+      OSMOSDR_TRACE_COUNTER( "hackrf", "rx buffers used", this, _buf_used );
     }
 
     buf = _buf[_buf_head];
 
     int remaining = noutput_items - _samp_avail;
 
-    for (int i = 0; i < remaining; ++i)
-      *out++ = TO_COMPLEX( buf + i*BYTES_PER_SAMPLE );
+    hackrf_lut_convert( _lut.data(), buf, out, remaining );
+    out += remaining;
 
     _buf_offset = remaining;
     _samp_avail = (_buf_len / BYTES_PER_SAMPLE) - remaining;
   }
 
+  int64_t gap = _watchdog.gap_offset( noutput_items );
+  if ( gap >= 0 )
+    add_item_tag( 0, nitems_written(0) + gap, stream_watchdog::gap_key(),
+                  pmt::from_uint64( _watchdog.lost() ) );
+
   return noutput_items;
 }
 
+/* streaming stopped without us asking, most likely the board was unplugged
+ * or re-enumerated; wait for it and carry on where we left off. A replay
+ * with replay_unplug_after= takes the same path. */
+bool hackrf_source_c::reattach()
+{
+  if ( ! _watchdog.may_reattach() )
+    return false;
+
+  std::cerr << "hackrf: device lost, waiting for it to return" << std::endl;
+
+  {
+    std::lock_guard<std::mutex> lock(_buf_mutex);
+
+    uint64_t buffered = 0;
+    if ( _buf_used )
+      buffered = uint64_t(_buf_used) * (_buf_len / BYTES_PER_SAMPLE) - _buf_offset;
+    _watchdog.restarted( buffered );
+  }
+
+  if ( ! _watchdog.reattach( [this]() {
+         return _replay ? _replay->replugged() : hackrf_common::reopen(); } ) ) {
+    std::cerr << "hackrf: device did not return" << std::endl;
+    return false;
+  }
+
+  if ( _replay ) {
+    _replay->resume();
+    std::cerr << "hackrf: device is back" << std::endl;
+    return true;
+  }
+
+  try {
+    set_if_gain( _lna_gain );
+    set_bb_gain( _vga_gain );
+  } catch ( std::exception &ex ) {
+    std::cerr << ex.what() << std::endl;
+  }
+
+  int ret = hackrf_start_rx( _dev.get(), _hackrf_rx_callback, (void *)this );
+  if ( ret != HACKRF_SUCCESS ) {
+    std::cerr << "Failed to restart RX streaming (" << ret << ")" << std::endl;
+    return false;
+  }
+
+  std::cerr << "hackrf: device is back" << std::endl;
+
+  return true;
+}
+
 std::vector<std::string> hackrf_source_c::get_devices()
 {
   return hackrf_common::get_devices();
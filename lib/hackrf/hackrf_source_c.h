@@ -24,12 +24,17 @@
 #include <gnuradio/sync_block.h>
 
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 
 #include <libhackrf/hackrf.h>
 
 #include "source_iface.h"
+#include "buffer_allocator.h"
 #include "hackrf_common.h"
+#include "stream_watchdog.h"
+#include "shm_ring.h"
+#include "transfer_capture.h"
 
 class hackrf_source_c;
 
@@ -122,10 +127,13 @@ public:
 private:
   static int _hackrf_rx_callback(hackrf_transfer* transfer);
   int hackrf_rx_callback(unsigned char *buf, uint32_t len);
+  bool reattach();
 
   std::vector<float> _lut;
 
   unsigned char **_buf;
+  unsigned char *_buf_mem; /* all _buf_num buffers, back to back */
+  buffer_allocator _buf_alloc;
   unsigned int _buf_num;
   unsigned int _buf_len;
   unsigned int _buf_head;
@@ -138,6 +146,12 @@ private:
 
   double _lna_gain;
   double _vga_gain;
+  stream_watchdog _watchdog;
+
+  std::string _record_path;
+  std::unique_ptr<transfer_recorder> _recorder;
+  std::unique_ptr<shm_publisher> _publisher;
+  std::unique_ptr<transfer_player> _replay;
 };
 
 #endif /* INCLUDED_HACKRF_SOURCE_C_H */
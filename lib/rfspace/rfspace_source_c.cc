@@ -103,7 +103,8 @@ rfspace_source_c::rfspace_source_c (const std::string &args)
     _nchan(1),
     _sample_rate(NAN),
     _bandwidth(0.0f),
-    _fifo(NULL)
+    _fifo(NULL),
+    _replay_fd(-1)
 {
   std::string host = "";
   unsigned short port = 0;
@@ -180,10 +181,35 @@ rfspace_source_c::rfspace_source_c (const std::string &args)
   if ( label.length() )
     std::cerr << "Using " + label << " ";
 
+  if ( dict.count("record") )
+    _record_path = dict["record"];
+
+  _sched = thread_sched( dict );
+
+  _replay = transfer_player::make( args, "sdr-iq" );
+
   struct stat sb;
   bzero(&sb, sizeof(sb));
 
-  if ( stat(host.c_str(), &sb) == 0 && (sb.st_mode & S_IFMT) == S_IFCHR ) /* is character device */
+  if ( _replay ) /* feed a recorded SDR-IQ stream through a pipe */
+  {
+    int fds[2];
+
+    if ( pipe( fds ) < 0 )
+      throw std::runtime_error("Could not create replay pipe: " + std::string(strerror(errno)));
+
+    _usb = fds[0];
+    _replay_fd = fds[1];
+
+    _radio = RFSPACE_SDR_IQ;
+
+    _fifo = new fifo_t( 200000, buffer_allocator_adaptor< gr_complex >( buffer_allocator( dict ) ) );
+
+    _run_usb_read_task = true;
+
+    _thread = gr::thread::thread( boost::bind(&rfspace_source_c::usb_read_task, this) );
+  }
+  else if ( stat(host.c_str(), &sb) == 0 && (sb.st_mode & S_IFMT) == S_IFCHR ) /* is character device */
   {
     _usb = open( host.c_str(), O_RDWR | O_NOCTTY );
     if ( _usb < 0 )
@@ -210,7 +236,7 @@ rfspace_source_c::rfspace_source_c (const std::string &args)
 
     _radio = RFSPACE_SDR_IQ; /* legitimate assumption */
 
-    _fifo = new boost::circular_buffer<gr_complex>( 200000 );
+    _fifo = new fifo_t( 200000, buffer_allocator_adaptor< gr_complex >( buffer_allocator( dict ) ) );
     if ( ! _fifo )
       throw std::runtime_error( "Failed to allocate sample FIFO" );
 
@@ -422,7 +448,7 @@ rfspace_source_c::rfspace_source_c (const std::string &args)
 
   if ( RFSPACE_SDR_IQ == _radio )
   {
-    set_sample_rate( 196078 );
+    set_sample_rate( _replay ? _replay->sample_rate() : 196078 );
   }
   else if ( RFSPACE_NETSDR == _radio ||
             RFSPACE_SDR_IP == _radio )
@@ -470,6 +496,12 @@ rfspace_source_c::~rfspace_source_c ()
 
   if ( RFSPACE_SDR_IQ == _radio )
   {
+    if ( _replay )
+    {
+      _replay->stop();
+      close(_replay_fd); /* unblocks the reader */
+    }
+
     _run_usb_read_task = false;
 
     _thread.join();
@@ -542,7 +574,17 @@ bool rfspace_source_c::transaction( const unsigned char *cmd, size_t size,
   printf("\n");
 #endif
 
-  if ( RFSPACE_SDR_IQ == _radio )
+  if ( RFSPACE_SDR_IQ == _radio && _replay )
+  {
+    /* nothing to talk to, acknowledge "set" items by echoing them back
+     * like the radio does and fail all requests */
+    if ( cmd[1] & 0xe0 )
+      return false;
+
+    rx_bytes = size;
+    memcpy( data, cmd, rx_bytes );
+  }
+  else if ( RFSPACE_SDR_IQ == _radio )
   {
     if ( write(_usb, cmd, size) != (int)size )
       return false;
@@ -619,6 +661,8 @@ void rfspace_source_c::usb_read_task()
   if ( -1 == _usb )
     return;
 
+  _sched.apply( "sdr-iq read" );
+
   while ( _run_usb_read_task )
   {
     size_t nbytes = read_bytes( _usb, data, 2, _run_usb_read_task );
@@ -646,6 +690,9 @@ void rfspace_source_c::usb_read_task()
     if ( nbytes != length )
       continue;
 
+    if ( _recorder )
+      _recorder->record( data, length + 2 );
+
     if ( 1024*8 == length )
     {
       /* push samples into the fifo */
@@ -710,6 +757,8 @@ void rfspace_source_c::tcp_keepalive_task()
   if ( -1 == _tcp )
     return;
 
+  _sched.apply( "rfspace keepalive" );
+
   while ( _run_tcp_keepalive_task )
   {
     boost::this_thread::sleep_for(boost::chrono::seconds(60));
@@ -719,10 +768,32 @@ void rfspace_source_c::tcp_keepalive_task()
 
 bool rfspace_source_c::start()
 {
+  if ( ! _record_path.empty() && ! _recorder )
+    _recorder.reset( new transfer_recorder( _record_path, "sdr-iq",
+                                            get_sample_rate() ) );
+
   _sequence = 0;
   _running = true;
   _keep_running = false;
 
+  if ( _replay && ! _replay->running() )
+  {
+    _replay->start(
+      [this](unsigned char *buf, size_t len) {
+        while ( len ) {
+          ssize_t n = write( _replay_fd, buf, len );
+          if ( n <= 0 )
+            break;
+          buf += n;
+          len -= n;
+        }
+      },
+      [this]() {
+        { std::lock_guard<std::mutex> lock( _fifo_lock ); }
+        _samp_avail.notify_one();
+      } );
+  }
+
   /* SDR-IP 4.2.1 Receiver State */
   /* NETSDR 4.2.1 Receiver State */
   unsigned char start[] = { 0x08, 0x00, 0x18, 0x00, 0x80, 0x02, 0x00, 0x00 };
@@ -746,6 +817,9 @@ bool rfspace_source_c::start()
 
 bool rfspace_source_c::stop()
 {
+  if ( _replay && ! _keep_running ) /* keep playing across rate changes */
+    _replay->stop();
+
   if ( ! _keep_running )
     _running = false;
   _keep_running = false;
@@ -787,6 +861,9 @@ int rfspace_source_c::work( int noutput_items,
 
       while ( n_samples_avail < noutput_items )
       {
+        if ( _replay && ! _replay->running() )
+          return WORK_DONE;
+
         _samp_avail.wait(lock);
         n_samples_avail = _fifo->size();
       }
@@ -26,11 +26,15 @@
 
 #include <boost/circular_buffer.hpp>
 
+#include <memory>
 #include <mutex>
 #include <condition_variable>
 
 #include "osmosdr/ranges.h"
 #include "source_iface.h"
+#include "buffer_allocator.h"
+#include "thread_sched.h"
+#include "transfer_capture.h"
 class rfspace_source_c;
 
 #ifndef SOCKET
@@ -151,13 +155,20 @@ private: /* members */
   bool _run_tcp_keepalive_task;
   std::mutex _tcp_lock;
 
-  boost::circular_buffer<gr_complex> *_fifo;
+  typedef boost::circular_buffer< gr_complex, buffer_allocator_adaptor< gr_complex > > fifo_t;
+  fifo_t *_fifo;
   std::mutex _fifo_lock;
   std::condition_variable _samp_avail;
 
   std::vector< unsigned char > _resp;
   std::mutex _resp_lock;
   std::condition_variable _resp_avail;
+
+  thread_sched _sched;
+  std::string _record_path;
+  std::unique_ptr<transfer_recorder> _recorder;
+  std::unique_ptr<transfer_player> _replay;
+  int _replay_fd; /* write end of the pipe standing in for _usb */
 };
 
 #endif /* INCLUDED_RFSPACE_SOURCE_C_H */
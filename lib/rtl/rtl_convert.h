@@ -0,0 +1,46 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_RTL_CONVERT_H
+#define INCLUDED_RTL_CONVERT_H
+
+/*
+ * u8 -> complex conversion of rtl_source_c::work(), kept apart from the
+ * block so that bench/ can measure it without librtlsdr.
+ */
+
+#include <complex>
+#include <vector>
+
+/* the dongle's unsigned samples are centred on 127.4, not 127.5 */
+static inline void rtl_make_lut(std::vector<float> &lut)
+{
+  lut.clear();
+  for (unsigned int i = 0; i < 0x100; i++)
+    lut.push_back((i - 127.4f) / 128.0f);
+}
+
+static inline void rtl_convert(const float *lut, const unsigned char *buf,
+                               std::complex<float> *out, int n)
+{
+  for (int i = 0; i < n; ++i)
+    out[i] = std::complex<float>(lut[buf[i * 2]], lut[buf[i * 2 + 1]]);
+}
+
+#endif /* INCLUDED_RTL_CONVERT_H */
@@ -41,6 +41,7 @@
 #include <rtl-sdr.h>
 
 #include "arg_helpers.h"
+#include "trace.h"
 
 using namespace boost::assign;
 
@@ -83,23 +84,73 @@ rtl_source_c::rtl_source_c (const std::string &args)
         gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof (gr_complex))),
     _dev(NULL),
     _buf(NULL),
+    _buf_mem(NULL),
     _running(false),
     _no_tuner(false),
     _auto_gain(false),
     _if_gain(0),
-    _skipped(0)
+    _skipped(0),
+    _device_lost(false),
+    _rtl_xtal(0),
+    _tuner_xtal(0),
+    _direct_samp(0),
+    _offset_tune(0),
+    _bias_tee(0)
 {
-  int ret;
   int index;
-  int bias_tee = 0;
-  unsigned int dev_index = 0, rtl_freq = 0, tuner_freq = 0, direct_samp = 0;
-  unsigned int offset_tune = 0;
+  unsigned int dev_index = 0;
   char manufact[256];
   char product[256];
   char serial[256];
 
   dict_t dict = params_to_dict(args);
 
+  _buf_num = _buf_len = _buf_head = _buf_used = _buf_offset = 0;
+
+  if (dict.count("buffers"))
+    _buf_num = boost::lexical_cast< unsigned int >( dict["buffers"] );
+
+  if (dict.count("buflen"))
+    _buf_len = boost::lexical_cast< unsigned int >( dict["buflen"] );
+
+  if (0 == _buf_num)
+    _buf_num = BUF_NUM;
+
+  if (0 == _buf_len || _buf_len % 512 != 0) /* len must be multiple of 512 */
+    _buf_len = BUF_LEN;
+
+  if ( BUF_NUM != _buf_num || BUF_LEN != _buf_len ) {
+    std::cerr << "Using " << _buf_num << " buffers of size " << _buf_len << "."
+              << std::endl;
+  }
+
+  _samp_avail = _buf_len / BYTES_PER_SAMPLE;
+
+  // create a lookup table for gr_complex values
+  rtl_make_lut(_lut);
+
+  _buf_alloc = buffer_allocator(dict);
+  _buf_mem = (unsigned char *)_buf_alloc.allocate(_buf_num * _buf_len);
+  _buf = (unsigned char **)malloc(_buf_num * sizeof(unsigned char *));
+
+  if (_buf) {
+    for(unsigned int i = 0; i < _buf_num; ++i)
+      _buf[i] = _buf_mem + i * _buf_len;
+  }
+
+  if (dict.count("record"))
+    _record_path = dict["record"];
+
+  _sched = thread_sched(dict);
+  _watchdog.configure(dict);
+
+  _publisher = shm_publisher::make(args, "rtl");
+
+  /* replay a capture through the callback instead of opening a device */
+  _replay = transfer_player::make(args, "rtl");
+  if (_replay)
+    return;
+
   if (dict.count("rtl")) {
     std::string value = dict["rtl"];
 
@@ -132,6 +183,7 @@ rtl_source_c::rtl_source_c (const std::string &args)
       std::cerr << " " << product;
     if (strlen(serial))
       std::cerr << " SN: " << serial;
+    _serial = serial;
   } else {
     std::cerr << " " << rtlsdr_get_device_name(dev_index);
   }
@@ -139,57 +191,41 @@ rtl_source_c::rtl_source_c (const std::string &args)
   std::cerr << std::endl;
 
   if (dict.count("rtl_xtal"))
-    rtl_freq = (unsigned int)boost::lexical_cast< double >( dict["rtl_xtal"] );
+    _rtl_xtal = (unsigned int)boost::lexical_cast< double >( dict["rtl_xtal"] );
 
   if (dict.count("tuner_xtal"))
-    tuner_freq = (unsigned int)boost::lexical_cast< double >( dict["tuner_xtal"] );
+    _tuner_xtal = (unsigned int)boost::lexical_cast< double >( dict["tuner_xtal"] );
 
   if (dict.count("direct_samp"))
-    direct_samp = boost::lexical_cast< unsigned int >( dict["direct_samp"] );
+    _direct_samp = boost::lexical_cast< unsigned int >( dict["direct_samp"] );
 
   if (dict.count("offset_tune"))
-    offset_tune = boost::lexical_cast< unsigned int >( dict["offset_tune"] );
+    _offset_tune = boost::lexical_cast< unsigned int >( dict["offset_tune"] );
 
   if (dict.count("bias"))
-    bias_tee = boost::lexical_cast<bool>( dict["bias"] );
-
-  _buf_num = _buf_len = _buf_head = _buf_used = _buf_offset = 0;
+    _bias_tee = boost::lexical_cast<bool>( dict["bias"] );
 
-  if (dict.count("buffers"))
-    _buf_num = boost::lexical_cast< unsigned int >( dict["buffers"] );
-
-  if (dict.count("buflen"))
-    _buf_len = boost::lexical_cast< unsigned int >( dict["buflen"] );
-
-  if (0 == _buf_num)
-    _buf_num = BUF_NUM;
-
-  if (0 == _buf_len || _buf_len % 512 != 0) /* len must be multiple of 512 */
-    _buf_len = BUF_LEN;
-
-  if ( BUF_NUM != _buf_num || BUF_LEN != _buf_len ) {
-    std::cerr << "Using " << _buf_num << " buffers of size " << _buf_len << "."
-              << std::endl;
-  }
+  _dev = NULL;
+  if (rtlsdr_open( &_dev, dev_index ) < 0)
+    throw std::runtime_error("Failed to open rtlsdr device.");
 
-  _samp_avail = _buf_len / BYTES_PER_SAMPLE;
+  setup_device();
 
-  // create a lookup table for gr_complex values
-  for (unsigned int i = 0; i < 0x100; i++)
-    _lut.push_back((i - 127.4f) / 128.0f);
+  set_if_gain( 24 ); /* preset to a reasonable default (non-GRC use case) */
+}
 
-  _dev = NULL;
-  ret = rtlsdr_open( &_dev, dev_index );
-  if (ret < 0)
-    throw std::runtime_error("Failed to open rtlsdr device.");
+/* settings given as device arguments, needed again after a reopen */
+void rtl_source_c::setup_device()
+{
+  int ret;
 
-  if (rtl_freq > 0 || tuner_freq > 0) {
-    if (rtl_freq)
-      std::cerr << "Setting rtl clock to " << rtl_freq << " Hz." << std::endl;
-    if (tuner_freq)
-      std::cerr << "Setting tuner clock to " << tuner_freq << " Hz." << std::endl;
+  if (_rtl_xtal > 0 || _tuner_xtal > 0) {
+    if (_rtl_xtal)
+      std::cerr << "Setting rtl clock to " << _rtl_xtal << " Hz." << std::endl;
+    if (_tuner_xtal)
+      std::cerr << "Setting tuner clock to " << _tuner_xtal << " Hz." << std::endl;
 
-    ret = rtlsdr_set_xtal_freq( _dev, rtl_freq, tuner_freq );
+    ret = rtlsdr_set_xtal_freq( _dev, _rtl_xtal, _tuner_xtal );
     if (ret < 0)
       throw std::runtime_error(
         str(boost::format("Failed to set xtal frequencies. Error %d.") % ret ));
@@ -207,35 +243,26 @@ rtl_source_c::rtl_source_c (const std::string &args)
   if (ret < 0)
     throw std::runtime_error("Failed to set agc mode.");
 
-  if (direct_samp) {
-    ret = rtlsdr_set_direct_sampling(_dev, direct_samp);
+  if (_direct_samp) {
+    ret = rtlsdr_set_direct_sampling(_dev, _direct_samp);
     if (ret < 0)
       throw std::runtime_error("Failed to enable direct sampling.");
     _no_tuner = true;
   }
 
-  if (offset_tune) {
-    ret = rtlsdr_set_offset_tuning(_dev, offset_tune);
+  if (_offset_tune) {
+    ret = rtlsdr_set_offset_tuning(_dev, _offset_tune);
     if (ret < 0)
       throw std::runtime_error("Failed to enable offset tuning.");
   }
 
-  ret = rtlsdr_set_bias_tee(_dev, bias_tee);
+  ret = rtlsdr_set_bias_tee(_dev, _bias_tee);
   if (ret < 0)
     throw std::runtime_error("Failed to set bias tee.");
 
   ret = rtlsdr_reset_buffer( _dev );
   if (ret < 0)
     throw std::runtime_error("Failed to reset usb buffers.");
-
-  set_if_gain( 24 ); /* preset to a reasonable default (non-GRC use case) */
-
-  _buf = (unsigned char **)malloc(_buf_num * sizeof(unsigned char *));
-
-  if (_buf) {
-    for(unsigned int i = 0; i < _buf_num; ++i)
-      _buf[i] = (unsigned char *)malloc(_buf_len);
-  }
 }
 
 /*
@@ -255,19 +282,47 @@ rtl_source_c::~rtl_source_c ()
     _dev = NULL;
   }
 
-  if (_buf) {
-    for(unsigned int i = 0; i < _buf_num; ++i) {
-      free(_buf[i]);
-    }
+  if (_replay)
+    _replay->stop();
 
+  if (_buf) {
     free(_buf);
     _buf = NULL;
   }
+
+  _buf_alloc.deallocate(_buf_mem, _buf_num * _buf_len);
+  _buf_mem = NULL;
 }
 
 bool rtl_source_c::start()
 {
+  if (!_record_path.empty() && !_recorder)
+    _recorder.reset(new transfer_recorder(_record_path, "rtl", get_sample_rate()));
+
   _running = true;
+
+  if (_replay) {
+    _watchdog.reset();
+    _sched.reset();
+    _replay->start(
+      [this](unsigned char *buf, size_t len) {
+        _sched.apply_once( "rtl replay" );
+        _rtlsdr_callback(buf, len, this);
+      },
+      [this]() {
+        {
+          std::lock_guard<std::mutex> lock( _buf_mutex );
+          _device_lost = _replay->unplugged();
+          _running = false;
+        }
+        _buf_cond.notify_one();
+      },
+      _buf_len); /* work() expects every buffer full */
+
+    return true;
+  }
+
+  _watchdog.reset();
   _thread = gr::thread::thread(_rtlsdr_wait, this);
 
   return true;
@@ -276,9 +331,16 @@ bool rtl_source_c::start()
 bool rtl_source_c::stop()
 {
   _running = false;
+
+  if (_replay) {
+    _replay->stop();
+    return true;
+  }
+
   if (_dev)
     rtlsdr_cancel_async( _dev );
-  _thread.join();
+  if (_thread.joinable())
+    _thread.join();
 
   return true;
 }
@@ -286,16 +348,29 @@ bool rtl_source_c::stop()
 void rtl_source_c::_rtlsdr_callback(unsigned char *buf, uint32_t len, void *ctx)
 {
   rtl_source_c *obj = (rtl_source_c *)ctx;
+
+  if (obj->_recorder)
+    obj->_recorder->record(buf, len);
+
+  if (obj->_publisher)
+    obj->_publisher->publish(buf, len, obj->get_sample_rate(),
+                             obj->get_center_freq());
+
   obj->rtlsdr_callback(buf, len);
 }
 
 void rtl_source_c::rtlsdr_callback(unsigned char *buf, uint32_t len)
 {
+  OSMOSDR_TRACE_SCOPE( "rtl", "callback" );
+
   if (_skipped < BUF_SKIP) {
+    _watchdog.alive(len / BYTES_PER_SAMPLE);
     _skipped++;
     return;
   }
 
+  _watchdog.transfer(len / BYTES_PER_SAMPLE, get_sample_rate());
+
   {
     std::lock_guard<std::mutex> lock( _buf_mutex );
 
@@ -308,6 +383,8 @@ void rtl_source_c::rtlsdr_callback(unsigned char *buf, uint32_t len)
     } else {
       _buf_used++;
     }
+
+    OSMOSDR_TRACE_COUNTER( "rtl", "buffers used", this, _buf_used );
   }
 
   _buf_cond.notify_one();
@@ -320,9 +397,18 @@ void rtl_source_c::_rtlsdr_wait(rtl_source_c *obj)
 
 void rtl_source_c::rtlsdr_wait()
 {
+  OSMOSDR_TRACE_THREAD_NAME( "rtl async" );
+  _sched.apply( "rtl async" );
+
   int ret = rtlsdr_read_async( _dev, _rtlsdr_callback, (void *)this, _buf_num, _buf_len );
 
-  _running = false;
+  {
+    std::lock_guard<std::mutex> lock( _buf_mutex );
+
+    /* nobody asked us to stop, so the device went away */
+    _device_lost = _running;
+    _running = false;
+  }
 
   if ( ret != 0 )
     std::cerr << "rtlsdr_read_async returned with " << ret << std::endl;
@@ -330,28 +416,177 @@ void rtl_source_c::rtlsdr_wait()
   _buf_cond.notify_one();
 }
 
+/* the async thread is alive but no transfers arrive, start over in place */
+void rtl_source_c::restart_stream()
+{
+  std::cerr << "rtl: no samples for " << _watchdog.stall_seconds()
+            << " s, restarting stream" << std::endl;
+
+  {
+    std::lock_guard<std::mutex> lock( _buf_mutex );
+    _running = false;
+  }
+
+  rtlsdr_cancel_async( _dev );
+  _thread.join();
+
+  rtlsdr_reset_buffer( _dev );
+
+  /* the tuner may have lost its state along with the stream */
+  restore_tuning( get_sample_rate(), get_center_freq(), get_freq_corr(),
+                  get_gain() );
+
+  _watchdog.restarted( buffered_samples() );
+
+  _skipped = 0;
+  _running = true;
+  _thread = gr::thread::thread(_rtlsdr_wait, this);
+}
+
+/* the device dropped off the bus, wait for the same serial to come back.
+ * A replay with replay_unplug_after= takes the same path. */
+bool rtl_source_c::reattach()
+{
+  if (_thread.joinable())
+    _thread.join();
+
+  if ((_serial.empty() && !_replay) || !_watchdog.may_reattach())
+    return false;
+
+  const std::string name = _replay ? "replay" : "SN " + _serial;
+
+  std::cerr << "rtl: device " << name << " lost, waiting for it to return"
+            << std::endl;
+
+  /* the stale handle still knows how the tuner was set up */
+  double rate = get_sample_rate(), freq = get_center_freq();
+  double corr = get_freq_corr(), gain = get_gain();
+
+  if (_dev) {
+    rtlsdr_close( _dev );
+    _dev = NULL;
+  }
+
+  _watchdog.restarted( buffered_samples() );
+
+  bool found = _watchdog.reattach( [this]() {
+    if (_replay)
+      return _replay->replugged();
+
+    int index = rtlsdr_get_index_by_serial( _serial.c_str() );
+    if (index < 0 || rtlsdr_open( &_dev, index ) < 0)
+      return false;
+
+    try {
+      setup_device();
+    } catch ( std::exception &ex ) {
+      std::cerr << "rtl: " << ex.what() << std::endl;
+      rtlsdr_close( _dev );
+      _dev = NULL;
+      return false;
+    }
+
+    return true;
+  } );
+
+  if (!found) {
+    std::cerr << "rtl: device " << name << " did not return" << std::endl;
+    return false;
+  }
+
+  std::cerr << "rtl: device " << name << " is back" << std::endl;
+
+  _device_lost = false;
+  _skipped = 0;
+  _running = true;
+
+  if (_replay) {
+    _replay->resume();
+    return true;
+  }
+
+  restore_tuning( rate, freq, corr, gain );
+
+  _thread = gr::thread::thread(_rtlsdr_wait, this);
+
+  return true;
+}
+
+void rtl_source_c::restore_tuning( double rate, double freq, double corr,
+                                   double gain )
+{
+  try {
+    set_sample_rate( rate );
+    set_freq_corr( corr );
+    set_center_freq( freq );
+    set_gain_mode( _auto_gain );
+    if (!_auto_gain)
+      set_gain( gain );
+    set_if_gain( _if_gain );
+  } catch ( std::exception &ex ) {
+    std::cerr << "rtl: restoring settings failed: " << ex.what() << std::endl;
+  }
+}
+
+/* samples still queued for work(), they predate a stall or unplug */
+uint64_t rtl_source_c::buffered_samples()
+{
+  std::lock_guard<std::mutex> lock( _buf_mutex );
+
+  if (!_buf_used)
+    return 0;
+
+  return uint64_t(_buf_used) * (_buf_len / BYTES_PER_SAMPLE) - _buf_offset;
+}
+
 int rtl_source_c::work( int noutput_items,
                         gr_vector_const_void_star &input_items,
                         gr_vector_void_star &output_items )
 {
+  OSMOSDR_TRACE_SCOPE( "rtl", "work" );
   gr_complex *out = (gr_complex *)output_items[0];
 
   {
+    OSMOSDR_TRACE_SCOPE( "rtl", "wait" );
     std::unique_lock<std::mutex> lock( _buf_mutex );
 
-    while (_buf_used < 3 && _running) // collect at least 3 buffers
-      _buf_cond.wait( lock );
+    while (_buf_used < 3 && _running) { // collect at least 3 buffers
+      if (_replay || !_watchdog.enabled()) {
+        _buf_cond.wait( lock );
+        continue;
+      }
+
+      _buf_cond.wait_for( lock, _watchdog.timeout( get_sample_rate() ) / 4 );
+
+      if (_buf_used < 3 && _running && _watchdog.stalled( get_sample_rate() )) {
+        lock.unlock();
+        restart_stream();
+        lock.lock();
+      }
+    }
+
+    if (_device_lost && !_buf_used) {
+      lock.unlock();
+      if (!reattach())
+        return WORK_DONE;
+      return 0;
+    }
   }
 
-  if (!_running)
+  if (!_running && !_device_lost)
     return WORK_DONE;
 
   while (noutput_items && _buf_used) {
     const int nout = std::min(noutput_items, _samp_avail);
     const unsigned char *buf = _buf[_buf_head] + _buf_offset * 2;
 
-    for (int i = 0; i < nout; ++i)
-      *out++ = gr_complex(_lut[buf[i * 2]], _lut[buf[i * 2 + 1]]);
+    int64_t gap = _watchdog.gap_offset(nout);
+    if (gap >= 0)
+      add_item_tag(0, nitems_written(0) + (out - (gr_complex *)output_items[0]) + gap,
+                   stream_watchdog::gap_key(), pmt::from_uint64(_watchdog.lost()));
+
+    rtl_convert(_lut.data(), buf, out, nout);
+    out += nout;
 
     noutput_items -= nout;
     _samp_avail -= nout;
@@ -362,6 +597,8 @@ int rtl_source_c::work( int noutput_items,
 
         _buf_head = (_buf_head + 1) % _buf_num;
         _buf_used--;
+
+        OSMOSDR_TRACE_COUNTER( "rtl", "buffers used", this, _buf_used );
       }
       _samp_avail = _buf_len / BYTES_PER_SAMPLE;
       _buf_offset = 0;
@@ -449,6 +686,9 @@ double rtl_source_c::get_sample_rate()
   if (_dev)
     return (double)rtlsdr_get_sample_rate( _dev );
 
+  if (_replay)
+    return _replay->sample_rate();
+
   return 0;
 }
 
@@ -26,10 +26,17 @@
 
 #include <gnuradio/thread/thread.h>
 
+#include <memory>
 #include <mutex>
 #include <condition_variable>
 
 #include "source_iface.h"
+#include "buffer_allocator.h"
+#include "rtl_convert.h"
+#include "stream_watchdog.h"
+#include "thread_sched.h"
+#include "shm_ring.h"
+#include "transfer_capture.h"
 
 class rtl_source_c;
 typedef struct rtlsdr_dev rtlsdr_dev_t;
@@ -122,12 +129,19 @@ private:
   void rtlsdr_callback(unsigned char *buf, uint32_t len);
   static void _rtlsdr_wait(rtl_source_c *obj);
   void rtlsdr_wait();
+  void restart_stream();
+  bool reattach();
+  void setup_device();
+  void restore_tuning(double rate, double freq, double corr, double gain);
+  uint64_t buffered_samples();
 
   std::vector<float> _lut;
 
   rtlsdr_dev_t *_dev;
   gr::thread::thread _thread;
   unsigned char **_buf;
+  unsigned char *_buf_mem; /* all _buf_num buffers, back to back */
+  buffer_allocator _buf_alloc;
   unsigned int _buf_num;
   unsigned int _buf_len;
   unsigned int _buf_head;
@@ -143,6 +157,22 @@ private:
   bool _auto_gain;
   double _if_gain;
   unsigned int _skipped;
+  bool _device_lost;
+
+  /* what is needed to find and set up the device again after a replug */
+  std::string _serial;
+  unsigned int _rtl_xtal;
+  unsigned int _tuner_xtal;
+  unsigned int _direct_samp;
+  unsigned int _offset_tune;
+  int _bias_tee;
+
+  thread_sched _sched;
+  stream_watchdog _watchdog;
+  std::string _record_path;
+  std::unique_ptr<transfer_recorder> _recorder;
+  std::unique_ptr<shm_publisher> _publisher;
+  std::unique_ptr<transfer_player> _replay;
 };
 
 #endif /* INCLUDED_RTLSDR_SOURCE_C_H */
@@ -0,0 +1,105 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Stand-in for the vendor's mirsdrapi-rsp.h, declaring just the subset of
+ * the 2.x API used by sdrplay_source_c. Only used with -DSDRPLAY_MOCK=ON,
+ * where sdrplay_mock.cc provides the implementation.
+ */
+#ifndef MIR_SDR_MOCK_H
+#define MIR_SDR_MOCK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+   mir_sdr_Success            = 0,
+   mir_sdr_Fail               = 1,
+   mir_sdr_InvalidParam       = 2,
+   mir_sdr_OutOfRange         = 3,
+   mir_sdr_GainUpdateError    = 4,
+   mir_sdr_RfUpdateError      = 5,
+   mir_sdr_FsUpdateError      = 6,
+   mir_sdr_HwError            = 7,
+   mir_sdr_AliasingError      = 8,
+   mir_sdr_AlreadyInitialised = 9,
+   mir_sdr_NotInitialised     = 10
+} mir_sdr_ErrT;
+
+typedef enum
+{
+   mir_sdr_BW_Undefined = 0,
+   mir_sdr_BW_0_200     = 200,
+   mir_sdr_BW_0_300     = 300,
+   mir_sdr_BW_0_600     = 600,
+   mir_sdr_BW_1_536     = 1536,
+   mir_sdr_BW_5_000     = 5000,
+   mir_sdr_BW_6_000     = 6000,
+   mir_sdr_BW_7_000     = 7000,
+   mir_sdr_BW_8_000     = 8000
+} mir_sdr_Bw_MHzT;
+
+typedef enum
+{
+   mir_sdr_IF_Undefined = -1,
+   mir_sdr_IF_Zero      = 0,
+   mir_sdr_IF_0_450     = 450,
+   mir_sdr_IF_1_620     = 1620,
+   mir_sdr_IF_2_048     = 2048
+} mir_sdr_If_kHzT;
+
+typedef enum
+{
+   mir_sdr_USE_SET_GR          = 0,
+   mir_sdr_USE_SET_GR_ALT_MODE = 1,
+   mir_sdr_USE_RSP_SET_GR      = 2
+} mir_sdr_SetGrModeT;
+
+typedef void (*mir_sdr_StreamCallback_t)(short *xi, short *xq, unsigned int firstSampleNum,
+                                         int grChanged, int rfChanged, int fsChanged,
+                                         unsigned int numSamples, unsigned int reset,
+                                         unsigned int hwRemoved, void *cbContext);
+typedef void (*mir_sdr_GainChangeCallback_t)(unsigned int gRdB, unsigned int lnaGRdB,
+                                             void *cbContext);
+
+mir_sdr_ErrT mir_sdr_Init(int gRdB, double fsMHz, double rfMHz, mir_sdr_Bw_MHzT bwType,
+                          mir_sdr_If_kHzT ifType, int *samplesPerPacket);
+mir_sdr_ErrT mir_sdr_Uninit(void);
+
+mir_sdr_ErrT mir_sdr_StreamInit(int *gRdB, double fsMHz, double rfMHz, mir_sdr_Bw_MHzT bwType,
+                                mir_sdr_If_kHzT ifType, int LNAstate, int *gRdBsystem,
+                                mir_sdr_SetGrModeT setGrMode, int *samplesPerPacket,
+                                mir_sdr_StreamCallback_t StreamCbFn,
+                                mir_sdr_GainChangeCallback_t GainChangeCallbackFn,
+                                void *cbContext);
+mir_sdr_ErrT mir_sdr_StreamUninit(void);
+
+mir_sdr_ErrT mir_sdr_SetRf(double drfHz, int abs, int syncUpdate);
+mir_sdr_ErrT mir_sdr_SetFs(double dfsHz, int abs, int syncUpdate, int reCal);
+mir_sdr_ErrT mir_sdr_SetGr(int gRdB, int abs, int syncUpdate);
+mir_sdr_ErrT mir_sdr_SetDcMode(int dcCal, int speedUp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MIR_SDR_MOCK_H */
@@ -0,0 +1,179 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Minimal software implementation of the streaming part of the SDRplay
+ * API. It runs the stream callback from its own thread at the configured
+ * sample rate, delivering a complex tone at fs/16 with 12 bit full scale,
+ * so that sdrplay_source_c can be exercised without the vendor library or
+ * hardware (configure with -DSDRPLAY_MOCK=ON).
+ */
+
+#include <mirsdrapi-rsp.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <math.h>
+
+#define MOCK_SAMPLES_PER_PACKET 1008
+#define MOCK_AMPLITUDE          1000.0
+
+namespace {
+
+std::mutex               mock_mutex;
+std::atomic<bool>        mock_init(false);
+std::thread              mock_thread;
+std::atomic<bool>        mock_streaming(false);
+std::atomic<double>      mock_fs(2.048e6);
+mir_sdr_StreamCallback_t mock_cb = NULL;
+void                    *mock_ctx = NULL;
+
+void mock_stream()
+{
+   std::vector<short> xi(MOCK_SAMPLES_PER_PACKET);
+   std::vector<short> xq(MOCK_SAMPLES_PER_PACKET);
+   unsigned int sample_num = 0;
+   unsigned int reset = 1;
+   double phase = 0.0;
+   const double step = 2.0 * M_PI / 16.0;
+
+   std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+
+   while (mock_streaming)
+   {
+      for (int i = 0; i < MOCK_SAMPLES_PER_PACKET; i++)
+      {
+         xi[i] = (short)lrint(MOCK_AMPLITUDE * cos(phase));
+         xq[i] = (short)lrint(MOCK_AMPLITUDE * sin(phase));
+         phase = fmod(phase + step, 2.0 * M_PI);
+      }
+
+      mock_cb(xi.data(), xq.data(), sample_num, 0, 0, 0,
+              MOCK_SAMPLES_PER_PACKET, reset, 0, mock_ctx);
+
+      sample_num += MOCK_SAMPLES_PER_PACKET;
+      reset = 0;
+
+      next += std::chrono::nanoseconds((long long)(MOCK_SAMPLES_PER_PACKET * 1e9 / mock_fs));
+      std::this_thread::sleep_until(next);
+   }
+}
+
+} // namespace
+
+mir_sdr_ErrT mir_sdr_Init(int gRdB, double fsMHz, double rfMHz, mir_sdr_Bw_MHzT bwType,
+                          mir_sdr_If_kHzT ifType, int *samplesPerPacket)
+{
+   std::lock_guard<std::mutex> lock(mock_mutex);
+
+   /* a single device, a second Init fails just like the real library */
+   if (mock_init)
+      return mir_sdr_AlreadyInitialised;
+
+   mock_init = true;
+   mock_fs = fsMHz * 1e6;
+   *samplesPerPacket = MOCK_SAMPLES_PER_PACKET;
+
+   return mir_sdr_Success;
+}
+
+mir_sdr_ErrT mir_sdr_Uninit(void)
+{
+   std::lock_guard<std::mutex> lock(mock_mutex);
+
+   if (!mock_init)
+      return mir_sdr_NotInitialised;
+
+   mock_init = false;
+
+   return mir_sdr_Success;
+}
+
+mir_sdr_ErrT mir_sdr_StreamInit(int *gRdB, double fsMHz, double rfMHz, mir_sdr_Bw_MHzT bwType,
+                                mir_sdr_If_kHzT ifType, int LNAstate, int *gRdBsystem,
+                                mir_sdr_SetGrModeT setGrMode, int *samplesPerPacket,
+                                mir_sdr_StreamCallback_t StreamCbFn,
+                                mir_sdr_GainChangeCallback_t GainChangeCallbackFn,
+                                void *cbContext)
+{
+   std::lock_guard<std::mutex> lock(mock_mutex);
+
+   if (mock_init)
+      return mir_sdr_AlreadyInitialised;
+
+   if (fsMHz <= 0.0 || StreamCbFn == NULL)
+      return mir_sdr_InvalidParam;
+
+   mock_init = true;
+   mock_fs = fsMHz * 1e6;
+   mock_cb = StreamCbFn;
+   mock_ctx = cbContext;
+   *gRdBsystem = *gRdB;
+   *samplesPerPacket = MOCK_SAMPLES_PER_PACKET;
+
+   mock_streaming = true;
+   mock_thread = std::thread(mock_stream);
+
+   return mir_sdr_Success;
+}
+
+mir_sdr_ErrT mir_sdr_StreamUninit(void)
+{
+   std::lock_guard<std::mutex> lock(mock_mutex);
+
+   if (!mock_init)
+      return mir_sdr_NotInitialised;
+
+   mock_streaming = false;
+   if (mock_thread.joinable())
+      mock_thread.join();
+
+   mock_init = false;
+
+   return mir_sdr_Success;
+}
+
+mir_sdr_ErrT mir_sdr_SetRf(double drfHz, int abs, int syncUpdate)
+{
+   return mock_init ? mir_sdr_Success : mir_sdr_NotInitialised;
+}
+
+mir_sdr_ErrT mir_sdr_SetFs(double dfsHz, int abs, int syncUpdate, int reCal)
+{
+   if (!mock_init)
+      return mir_sdr_NotInitialised;
+
+   mock_fs = abs ? dfsHz : mock_fs + dfsHz;
+
+   return mir_sdr_Success;
+}
+
+mir_sdr_ErrT mir_sdr_SetGr(int gRdB, int abs, int syncUpdate)
+{
+   return mock_init ? mir_sdr_Success : mir_sdr_NotInitialised;
+}
+
+mir_sdr_ErrT mir_sdr_SetDcMode(int dcCal, int speedUp)
+{
+   return mock_init ? mir_sdr_Success : mir_sdr_NotInitialised;
+}
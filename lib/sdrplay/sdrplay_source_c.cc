@@ -36,11 +36,18 @@
 #include <boost/assign.hpp>
 #include <boost/format.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <stdexcept>
 #include <iostream>
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 
+#if defined(USE_AVX) || defined(USE_SSE2)
+#include <emmintrin.h>
+#endif
+
 #include <mirsdrapi-rsp.h>
 
 #include "arg_helpers.h"
@@ -77,7 +84,52 @@ using namespace boost::assign;
 #define SDRPLAY_L_MIN     1450e6
 #define SDRPLAY_L_MAX     1675e6
 
-#define SDRPLAY_MAX_BUF_SIZE 504
+#define SDRPLAY_BLOCK_SIZE  8192 // samples gathered per ring block
+#define SDRPLAY_NUM_BLOCKS    64 // default ring depth, "buffers=" overrides
+#define SDRPLAY_SCALE (1.0f/2048.0f)
+
+/*
+ * Split I/Q shorts -> interleaved gr_complex. The API hands us separate
+ * I and Q arrays, so this is both the int -> float conversion and the
+ * interleave in a single pass.
+ */
+static void sdrplay_convert(const short *xi, const short *xq,
+                            gr_complex *out, unsigned int count)
+{
+   unsigned int i = 0;
+
+#if defined(USE_AVX) || defined(USE_SSE2)
+   const __m128 scale = _mm_set1_ps(SDRPLAY_SCALE);
+   float *dst = (float *)out;
+
+   for (; i + 8 <= count; i += 8)
+   {
+      __m128i vi = _mm_loadu_si128((const __m128i *)(xi + i));
+      __m128i vq = _mm_loadu_si128((const __m128i *)(xq + i));
+
+      /* sign extend by unpacking into the upper half and shifting back */
+      __m128 ilo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(vi, vi), 16));
+      __m128 ihi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(vi, vi), 16));
+      __m128 qlo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(vq, vq), 16));
+      __m128 qhi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(vq, vq), 16));
+
+      ilo = _mm_mul_ps(ilo, scale);
+      ihi = _mm_mul_ps(ihi, scale);
+      qlo = _mm_mul_ps(qlo, scale);
+      qhi = _mm_mul_ps(qhi, scale);
+
+      _mm_storeu_ps(dst + 2*i +  0, _mm_unpacklo_ps(ilo, qlo));
+      _mm_storeu_ps(dst + 2*i +  4, _mm_unpackhi_ps(ilo, qlo));
+      _mm_storeu_ps(dst + 2*i +  8, _mm_unpacklo_ps(ihi, qhi));
+      _mm_storeu_ps(dst + 2*i + 12, _mm_unpackhi_ps(ihi, qhi));
+   }
+#endif
+
+   for (; i < count; i++)
+   {
+      out[i] = gr_complex( float(xi[i]) * SDRPLAY_SCALE, float(xq[i]) * SDRPLAY_SCALE );
+   }
+}
 
 /*
  * Create a new instance of sdrplay_source_c and return
@@ -110,15 +162,27 @@ sdrplay_source_c::sdrplay_source_c (const std::string &args)
   : gr::sync_block ("sdrplay_source_c",
         gr::io_signature::make(MIN_IN, MAX_IN, sizeof (gr_complex)),
         gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof (gr_complex))),
+    _block_mem(NULL),
+    _block_mem_len(0),
+    _fill_blk(NULL),
+    _cur_blk(NULL),
+    _cur_offset(0),
     _running(false),
-    _uninit(false),
     _auto_gain(false)
 {
+   dict_t dict = params_to_dict(args);
+
+   size_t num_blocks = SDRPLAY_NUM_BLOCKS;
+   if (dict.count("buffers"))
+      num_blocks = std::max(2, boost::lexical_cast< int >( dict["buffers"] ));
+
+   _sched = thread_sched(dict);
+
    _dev = (sdrplay_dev_t *)malloc(sizeof(sdrplay_dev_t));
    if (_dev == NULL)
    {
-      return;
-}
+      throw std::runtime_error("Failed to allocate SDRplay device state.");
+   }
    _dev->fsHz = 2048e3;
    _dev->rfHz = 200e6;
    _dev->bwType = mir_sdr_BW_1_536;
@@ -129,12 +193,20 @@ sdrplay_source_c::sdrplay_source_c (const std::string &args)
    set_gain_limits(_dev->rfHz);
    _dev->gain_dB = _dev->maxGain - _dev->gRdB;
    
-   _bufi.reserve(SDRPLAY_MAX_BUF_SIZE);
-   _bufq.reserve(SDRPLAY_MAX_BUF_SIZE);   
+   /* the sample storage; the rings only pass pointers to its blocks */
+   _buf_alloc = buffer_allocator(dict);
+   _block_mem_len = num_blocks * 2 * SDRPLAY_BLOCK_SIZE * sizeof(short);
+   _block_mem = (short *)_buf_alloc.allocate(_block_mem_len);
 
-   _buf_mutex.lock();
-   _buf_offset = 0;
-   _buf_mutex.unlock();
+   _blocks.resize(num_blocks);
+   for (size_t i = 0; i < _blocks.size(); i++)
+   {
+      _blocks[i].i = _block_mem + (2 * i) * SDRPLAY_BLOCK_SIZE;
+      _blocks[i].q = _block_mem + (2 * i + 1) * SDRPLAY_BLOCK_SIZE;
+      _blocks[i].len = 0;
+   }
+
+   set_output_multiple(8); // keep the SIMD path busy
 }
 
 /*
@@ -142,40 +214,176 @@ sdrplay_source_c::sdrplay_source_c (const std::string &args)
  */
 sdrplay_source_c::~sdrplay_source_c ()
 {
+   stop();
+
    free(_dev);
    _dev = NULL;
-   _buf_mutex.lock();
+
+   _buf_alloc.deallocate(_block_mem, _block_mem_len);
+}
+
+bool sdrplay_source_c::start()
+{
+   std::lock_guard<std::mutex> lock(_dev_mutex);
+
    if (_running)
    {
-      _running = false;
+      return true;
    }
-   _uninit = true;
-   _buf_mutex.unlock();
+
+   /* neither the callback nor work() is active here */
+   _sched.reset();
+   _filled.reset(_blocks.size());
+   _free.reset(_blocks.size());
+   for (size_t i = 0; i < _blocks.size(); i++)
+   {
+      _blocks[i].len = 0;
+      _free.push(&_blocks[i]);
+   }
+   _fill_blk = NULL;
+   _cur_blk = NULL;
+   _cur_offset = 0;
+
+   _running = stream_init();
+
+   return _running;
 }
 
-void sdrplay_source_c::reinit_device()
+bool sdrplay_source_c::stop()
 {
-   std::cerr << "reinit_device started" << std::endl;
-   _buf_mutex.lock();
-   std::cerr << "after mutex.lock" << std::endl;
+   std::lock_guard<std::mutex> lock(_dev_mutex);
+
    if (_running)
    {
-      std::cerr << "mir_sdr_Uninit started" << std::endl;
-      mir_sdr_Uninit();
+      stream_uninit();
    }
 
-   std::cerr << "mir_sdr_Init started" << std::endl;
-   mir_sdr_Init(_dev->gRdB, _dev->fsHz / 1e6, _dev->rfHz / 1e6, _dev->bwType, _dev->ifType, &_dev->samplesPerPacket);
+   _running = false;
+
+   { std::lock_guard<std::mutex> buf_lock(_buf_mutex); }
+   _buf_cond.notify_all();
+
+   return true;
+}
+
+bool sdrplay_source_c::stream_init()
+{
+   int gRdBsystem = 0;
+
+   mir_sdr_ErrT err = mir_sdr_StreamInit(&_dev->gRdB, _dev->fsHz / 1e6, _dev->rfHz / 1e6,
+                                         _dev->bwType, _dev->ifType, 0, &gRdBsystem,
+                                         mir_sdr_USE_SET_GR, &_dev->samplesPerPacket,
+                                         _stream_callback, _gain_change_callback, this);
+   if (err != mir_sdr_Success)
+   {
+      std::cerr << "mir_sdr_StreamInit failed (" << err << ")" << std::endl;
+      return false;
+   }
 
    if (_dev->dcMode)
    {
-      std::cerr << "mir_sdr_SetDcMode started" << std::endl;
       mir_sdr_SetDcMode(4, 1);
    }
 
-   _buf_offset = 0;
-   _buf_mutex.unlock();
-   std::cerr << "reinit_device end" << std::endl;
+   return true;
+}
+
+void sdrplay_source_c::stream_uninit()
+{
+   /* returns once the API's streaming thread has left our callback */
+   mir_sdr_StreamUninit();
+}
+
+void sdrplay_source_c::reinit_device()
+{
+   std::lock_guard<std::mutex> lock(_dev_mutex);
+
+   if (!_running)
+   {
+      return;
+   }
+
+   /* the ring and any block held by work() survive the restart, only a
+    * partially filled block is discarded by the reset flag */
+   stream_uninit();
+   _running = stream_init();
+
+   if (!_running)
+   {
+      { std::lock_guard<std::mutex> buf_lock(_buf_mutex); }
+      _buf_cond.notify_all();
+   }
+}
+
+void sdrplay_source_c::_stream_callback(short *xi, short *xq, unsigned int firstSampleNum,
+                                        int grChanged, int rfChanged, int fsChanged,
+                                        unsigned int numSamples, unsigned int reset,
+                                        unsigned int hwRemoved, void *cbContext)
+{
+   sdrplay_source_c *obj = (sdrplay_source_c *)cbContext;
+
+   if (hwRemoved)
+   {
+      std::cerr << "SDRplay device removed." << std::endl;
+      obj->_running = false;
+      { std::lock_guard<std::mutex> lock(obj->_buf_mutex); }
+      obj->_buf_cond.notify_all();
+      return;
+   }
+
+   obj->_sched.apply_once("sdrplay stream");
+   obj->stream_callback(xi, xq, numSamples, reset);
+}
+
+void sdrplay_source_c::stream_callback(short *xi, short *xq, unsigned int numSamples,
+                                       unsigned int reset)
+{
+   bool notify = false;
+
+   if (reset && _fill_blk)
+   {
+      _fill_blk->len = 0;
+   }
+
+   while (numSamples)
+   {
+      if (!_fill_blk && !_free.pop(_fill_blk))
+      {
+         /* work() is behind and holds every block, drop the rest */
+         std::cerr << "O" << std::flush;
+         break;
+      }
+
+      unsigned int cnt = std::min(numSamples, (unsigned int)SDRPLAY_BLOCK_SIZE - _fill_blk->len);
+
+      memcpy(&_fill_blk->i[_fill_blk->len], xi, cnt * sizeof(short));
+      memcpy(&_fill_blk->q[_fill_blk->len], xq, cnt * sizeof(short));
+      _fill_blk->len += cnt;
+      xi += cnt;
+      xq += cnt;
+      numSamples -= cnt;
+
+      if (_fill_blk->len == SDRPLAY_BLOCK_SIZE)
+      {
+         /* _filled has room for all blocks, so this cannot fail */
+         _filled.push(_fill_blk);
+         _fill_blk = NULL;
+         notify = true;
+      }
+   }
+
+   if (notify)
+   {
+      /* an empty critical section orders us against a sleeping work() */
+      { std::lock_guard<std::mutex> lock(_buf_mutex); }
+      _buf_cond.notify_one();
+   }
+}
+
+void sdrplay_source_c::_gain_change_callback(unsigned int gRdB, unsigned int lnaGRdB,
+                                             void *cbContext)
+{
+   /* AGC is not used, nothing to track */
 }
 
 void sdrplay_source_c::set_gain_limits(double freq)
@@ -212,57 +420,58 @@ int sdrplay_source_c::work( int noutput_items,
                             gr_vector_void_star &output_items )
 {
    gr_complex *out = (gr_complex *)output_items[0];
-   int cnt = noutput_items;
-   unsigned int sampNum;
-   int grChanged;
-   int rfChanged;
-   int fsChanged;
+   int produced = 0;
 
-   if (_uninit)
+   while (produced < noutput_items)
    {
-      return WORK_DONE;
-   }
+      if (_cur_blk == NULL)
+      {
+         if (!_filled.pop(_cur_blk))
+         {
+            if (produced > 0)
+            {
+               break;
+            }
 
-   if (!_running)
-   {
-      reinit_device();
-      _running = true;
-   }
+            std::unique_lock<std::mutex> lock(_buf_mutex);
 
-   _buf_mutex.lock();
+            _buf_cond.wait_for(lock, std::chrono::seconds(1),
+                               [this] { return !_filled.empty() || !_running; });
 
-   if (_buf_offset)
-   {
-      for (int i = _buf_offset; i < _dev->samplesPerPacket; i++)
-      {
-         *out++ = gr_complex( float(_bufi[i]) * (1.0f/2048.0f), float(_bufq[i]) * (1.0f/2048.0f) );
-      }
-      cnt -= (_dev->samplesPerPacket - _buf_offset);
-   }
+            if (!_filled.empty())
+            {
+               continue;
+            }
 
-   while ((cnt - _dev->samplesPerPacket) >= 0)
-   {
-      mir_sdr_ReadPacket(_bufi.data(), _bufq.data(), &sampNum, &grChanged, &rfChanged, &fsChanged);
-      for (int i = 0; i < _dev->samplesPerPacket; i++)
-      {
-         *out++ = gr_complex( float(_bufi[i]) * (1.0f/2048.0f), float(_bufq[i]) * (1.0f/2048.0f) );
+            if (!_running)
+            {
+               return WORK_DONE;
+            }
+
+            return 0;
+         }
+
+         _cur_offset = 0;
       }
-      cnt -= _dev->samplesPerPacket;
-   }
 
-   _buf_offset = 0;
-   if (cnt)
-   {
-      mir_sdr_ReadPacket(_bufi.data(), _bufq.data(), &sampNum, &grChanged, &rfChanged, &fsChanged);
-      for (int i = 0; i < cnt; i++)
+      unsigned int cnt = std::min((unsigned int)(noutput_items - produced),
+                                  _cur_blk->len - _cur_offset);
+
+      sdrplay_convert(&_cur_blk->i[_cur_offset], &_cur_blk->q[_cur_offset],
+                      out + produced, cnt);
+
+      produced += cnt;
+      _cur_offset += cnt;
+
+      if (_cur_offset == _cur_blk->len)
       {
-         *out++ = gr_complex( float(_bufi[i]) * (1.0f/2048.0f), float(_bufq[i]) * (1.0f/2048.0f) );
+         _cur_blk->len = 0;
+         _free.push(_cur_blk);
+         _cur_blk = NULL;
       }
-      _buf_offset = cnt;
    }
-   _buf_mutex.unlock();
 
-   return noutput_items;
+   return produced;
 }
 
 std::vector<std::string> sdrplay_source_c::get_devices()
@@ -25,12 +25,16 @@
 
 #include <gnuradio/thread/thread.h>
 
+#include <atomic>
 #include <mutex>
 #include <condition_variable>
 
 #include "osmosdr/ranges.h"
 
 #include "source_iface.h"
+#include "buffer_allocator.h"
+#include "spsc_ring.h"
+#include "thread_sched.h"
 
 class sdrplay_source_c;
 typedef struct sdrplay_dev sdrplay_dev_t;
@@ -79,6 +83,9 @@ private:
 public:
    ~sdrplay_source_c ();	// public destructor
 
+   bool start();
+   bool stop();
+
    int work( int noutput_items,
             gr_vector_const_void_star &input_items,
             gr_vector_void_star &output_items );
@@ -119,19 +126,46 @@ public:
    osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 );
 
 private:
+   struct sdrplay_block
+   {
+      short *i;                 /* SDRPLAY_BLOCK_SIZE each, in _block_mem */
+      short *q;
+      unsigned int len;
+   };
+
+   static void _stream_callback(short *xi, short *xq, unsigned int firstSampleNum,
+                                int grChanged, int rfChanged, int fsChanged,
+                                unsigned int numSamples, unsigned int reset,
+                                unsigned int hwRemoved, void *cbContext);
+   void stream_callback(short *xi, short *xq, unsigned int numSamples,
+                        unsigned int reset);
+   static void _gain_change_callback(unsigned int gRdB, unsigned int lnaGRdB,
+                                     void *cbContext);
+
+   bool stream_init(void);
+   void stream_uninit(void);
    void reinit_device(void);
    void set_gain_limits(double freq);
 
    sdrplay_dev_t *_dev;
-
-   std::vector< short > _bufi;
-   std::vector< short > _bufq;
-   int _buf_offset;
+   std::mutex _dev_mutex;
+
+   /* blocks travel callback -> _filled -> work() -> _free -> callback */
+   std::vector< sdrplay_block > _blocks;
+   buffer_allocator _buf_alloc;
+   short *_block_mem;
+   size_t _block_mem_len;
+   spsc_ring< sdrplay_block * > _filled;
+   spsc_ring< sdrplay_block * > _free;
+   sdrplay_block *_fill_blk;   /* owned by the stream callback */
+   sdrplay_block *_cur_blk;    /* owned by work() */
+   unsigned int _cur_offset;
    std::mutex _buf_mutex;
+   std::condition_variable _buf_cond;
 
-   bool _running;
-   bool _uninit;
+   std::atomic<bool> _running;
    bool _auto_gain;
+   thread_sched _sched;
 };
 
 #endif /* INCLUDED_SDRPLAY_SOURCE_C_H */
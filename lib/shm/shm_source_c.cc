@@ -0,0 +1,379 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/thread/thread.hpp>
+
+#include <gnuradio/io_signature.h>
+
+#include "shm_source_c.h"
+
+#include "arg_helpers.h"
+#include "stream_watchdog.h"
+#include "trace.h"
+
+#define WAIT_MS  100
+
+shm_source_c_sptr make_shm_source_c(const std::string &args)
+{
+  return gnuradio::get_initial_sptr(new shm_source_c(args));
+}
+
+shm_source_c::shm_source_c(const std::string &args) :
+  gr::sync_block("shm_source_c",
+                 gr::io_signature::make(0, 0, 0),
+                 gr::io_signature::make(1, 1, sizeof(gr_complex))),
+  _reader(NULL),
+  _next(0),
+  _offset(0),
+  _last_samples(0),
+  _lost(0),
+  _sample_rate(0),
+  _center_freq(0),
+  _tag_tuning(true)
+{
+  dict_t dict = params_to_dict(args);
+
+  _name = dict["shm"];
+  if (_name.empty())
+    throw std::runtime_error("shm= needs the name the broker publishes");
+
+  _ring = shm_ring::attach(_name);
+
+  shm_header *header = _ring->header();
+  _bytes_per_sample = shm_ring::bytes_per_sample(header->format);
+
+  _lut.resize(0x100);
+  for (unsigned int i = 0; i < 0x100; i++) {
+    if (header->format == SHM_CU8)
+      _lut[i] = (i - 127.4f) / 128.0f;
+    else
+      _lut[i] = int8_t(i) / 128.0f;
+  }
+
+  /* pick up the current tuning from the newest transfer, if any */
+  uint64_t head = header->head.load(std::memory_order_acquire);
+  if (head) {
+    const shm_slot *slot = _ring->slot(head);
+    _sample_rate = slot->sample_rate;
+    _center_freq = slot->center_freq;
+  }
+
+  std::cerr << "Using shared memory '" << _name << "' published by pid "
+            << header->writer_pid << std::endl;
+}
+
+shm_source_c::~shm_source_c()
+{
+  stop();
+}
+
+bool shm_source_c::start()
+{
+  shm_header *header = _ring->header();
+  uint32_t pid = getpid();
+
+  for (unsigned int i = 0; i < SHM_MAX_READERS && !_reader; i++) {
+    uint32_t expected = 0;
+    if (_ring->reader(i)->pid.compare_exchange_strong(expected, pid))
+      _reader = _ring->reader(i);
+  }
+
+  if (!_reader)
+    std::cerr << "shm: all " << SHM_MAX_READERS << " reader entries are taken, "
+              << "the broker will not see how far behind we are" << std::endl;
+
+  /* only what is published from now on */
+  _next = header->head.load(std::memory_order_acquire) + 1;
+  _offset = 0;
+  _lost = 0;
+  _tag_tuning = true;
+
+  if (_reader) {
+    _reader->seq.store(_next - 1, std::memory_order_relaxed);
+    _reader->skipped.store(0, std::memory_order_relaxed);
+  }
+
+  return true;
+}
+
+bool shm_source_c::stop()
+{
+  if (_reader) {
+    _reader->pid.store(0, std::memory_order_release);
+    _reader = NULL;
+  }
+
+  return true;
+}
+
+void shm_source_c::convert(const unsigned char *src, gr_complex *dst, size_t n)
+{
+  switch (_ring->header()->format) {
+  case SHM_CU8:
+  case SHM_CS8:
+    for (size_t i = 0; i < n; i++)
+      dst[i] = gr_complex(_lut[src[2*i]], _lut[src[2*i+1]]);
+    break;
+  case SHM_CS16: {
+    const int16_t *s = (const int16_t *)src;
+    for (size_t i = 0; i < n; i++)
+      dst[i] = gr_complex(s[2*i] / 32768.0f, s[2*i+1] / 32768.0f);
+    break;
+  }
+  case SHM_CF32:
+    memcpy(dst, src, n * sizeof(gr_complex));
+    break;
+  }
+}
+
+/* we were overtaken, carry on with the newest complete transfer */
+void shm_source_c::skip()
+{
+  uint64_t head = _ring->header()->head.load(std::memory_order_acquire);
+  uint64_t missed = head - _next;
+
+  _lost += missed * _last_samples + (_last_samples - std::min(_offset, _last_samples));
+
+  if (_reader)
+    _reader->skipped.fetch_add(missed, std::memory_order_relaxed);
+
+  std::cerr << "O" << std::flush;
+
+  _next = head;
+  _offset = 0;
+}
+
+void shm_source_c::update_tuning(double rate, double freq)
+{
+  if (rate != _sample_rate || freq != _center_freq)
+    _tag_tuning = true;
+
+  _sample_rate = rate;
+  _center_freq = freq;
+}
+
+int shm_source_c::work( int noutput_items,
+                        gr_vector_const_void_star &input_items,
+                        gr_vector_void_star &output_items )
+{
+  OSMOSDR_TRACE_SCOPE( "shm", "work" );
+  gr_complex *out = (gr_complex *)output_items[0];
+  shm_header *header = _ring->header();
+  int produced = 0;
+
+  while (produced < noutput_items) {
+    uint64_t head = header->head.load(std::memory_order_acquire);
+
+    if (_next > head) {
+      if (produced)
+        break; /* hand out what we have rather than wait */
+
+      if (!_ring->writer_alive()) {
+        std::cerr << "shm: the broker of '" << _name << "' went away" << std::endl;
+        return WORK_DONE;
+      }
+
+      uint32_t wake = header->wake.load(std::memory_order_acquire);
+      if (header->head.load(std::memory_order_acquire) < _next)
+        _ring->wait(wake, std::chrono::milliseconds(WAIT_MS));
+
+      boost::this_thread::interruption_point();
+      continue;
+    }
+
+    if (head - _next >= header->slot_count) {
+      skip();
+      continue;
+    }
+
+    const shm_slot *slot = _ring->slot(_next);
+    if (slot->seq.load(std::memory_order_acquire) != _next) {
+      skip();
+      continue;
+    }
+
+    /* a torn read may pair a new transfer's length with our old offset */
+    const uint32_t len = slot->len;
+    size_t samples = len / _bytes_per_sample;
+    if (len > header->slot_bytes || _offset > samples) {
+      skip();
+      continue;
+    }
+
+    double rate = slot->sample_rate, freq = slot->center_freq;
+    size_t n = std::min(samples - _offset, size_t(noutput_items - produced));
+
+    convert(_ring->payload(slot) + _offset * _bytes_per_sample, out + produced, n);
+
+    /* overwritten while we were reading it? */
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot->seq.load(std::memory_order_relaxed) != _next) {
+      skip();
+      continue;
+    }
+
+    const uint64_t offset = nitems_written(0) + produced;
+
+    if (_offset == 0)
+      update_tuning(rate, freq);
+
+    if (_tag_tuning) {
+      add_item_tag(0, offset, pmt::string_to_symbol("rx_rate"), pmt::from_double(_sample_rate));
+      add_item_tag(0, offset, pmt::string_to_symbol("rx_freq"), pmt::from_double(_center_freq));
+      _tag_tuning = false;
+    }
+
+    if (_lost) {
+      add_item_tag(0, offset, stream_watchdog::gap_key(), pmt::from_uint64(_lost));
+      _lost = 0;
+    }
+
+    produced += n;
+    _offset += n;
+    _last_samples = samples;
+
+    if (_offset == samples) {
+      if (_reader)
+        _reader->seq.store(_next, std::memory_order_relaxed);
+      _next++;
+      _offset = 0;
+    }
+  }
+
+  return produced;
+}
+
+size_t shm_source_c::get_num_channels()
+{
+  return 1;
+}
+
+osmosdr::meta_range_t shm_source_c::get_sample_rates()
+{
+  osmosdr::meta_range_t range;
+
+  range.push_back(osmosdr::range_t(_sample_rate));
+
+  return range;
+}
+
+double shm_source_c::set_sample_rate( double rate )
+{
+  return get_sample_rate();
+}
+
+double shm_source_c::get_sample_rate()
+{
+  return _sample_rate;
+}
+
+osmosdr::freq_range_t shm_source_c::get_freq_range( size_t chan )
+{
+  osmosdr::freq_range_t range;
+
+  range.push_back(osmosdr::range_t(_center_freq));
+
+  return range;
+}
+
+double shm_source_c::set_center_freq( double freq, size_t chan )
+{
+  return get_center_freq( chan );
+}
+
+double shm_source_c::get_center_freq( size_t chan )
+{
+  return _center_freq;
+}
+
+double shm_source_c::set_freq_corr( double ppm, size_t chan )
+{
+  return get_freq_corr( chan );
+}
+
+double shm_source_c::get_freq_corr( size_t chan )
+{
+  return 0;
+}
+
+std::vector<std::string> shm_source_c::get_gain_names( size_t chan )
+{
+  return std::vector<std::string>();
+}
+
+osmosdr::gain_range_t shm_source_c::get_gain_range( size_t chan )
+{
+  return osmosdr::gain_range_t();
+}
+
+osmosdr::gain_range_t shm_source_c::get_gain_range( const std::string & name, size_t chan )
+{
+  return get_gain_range( chan );
+}
+
+double shm_source_c::set_gain( double gain, size_t chan )
+{
+  return get_gain( chan );
+}
+
+double shm_source_c::set_gain( double gain, const std::string & name, size_t chan )
+{
+  return set_gain( gain, chan );
+}
+
+double shm_source_c::get_gain( size_t chan )
+{
+  return 0;
+}
+
+double shm_source_c::get_gain( const std::string & name, size_t chan )
+{
+  return get_gain( chan );
+}
+
+std::vector< std::string > shm_source_c::get_antennas( size_t chan )
+{
+  std::vector< std::string > antennas;
+
+  antennas.push_back( get_antenna( chan ) );
+
+  return antennas;
+}
+
+std::string shm_source_c::set_antenna( const std::string & antenna, size_t chan )
+{
+  return get_antenna( chan );
+}
+
+std::string shm_source_c::get_antenna( size_t chan )
+{
+  return "RX";
+}
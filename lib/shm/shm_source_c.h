@@ -0,0 +1,113 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_SHM_SOURCE_C_H
+#define INCLUDED_SHM_SOURCE_C_H
+
+#include <gnuradio/sync_block.h>
+
+#include <memory>
+
+#include "source_iface.h"
+#include "shm_ring.h"
+
+class shm_source_c;
+
+typedef std::shared_ptr<shm_source_c> shm_source_c_sptr;
+
+shm_source_c_sptr make_shm_source_c (const std::string & args = "");
+
+/*!
+ * \brief Consumes the samples a broker process publishes with publish=.
+ *
+ * The ring is mapped read/write and samples are converted straight out of
+ * shared memory into the output buffer; nothing is copied in between.
+ * Tuning belongs to the broker, so the setters only report what it is
+ * currently using. Changes show up as rx_rate and rx_freq tags.
+ *
+ * A reader that falls more than a ring length behind is overtaken by the
+ * broker. It then resumes at the newest transfer, prints "O" and tags the
+ * first sample after the jump with rx_gap holding the number of samples
+ * lost.
+ */
+class shm_source_c :
+    public gr::sync_block,
+    public source_iface
+{
+private:
+  friend shm_source_c_sptr make_shm_source_c(const std::string &args);
+
+  shm_source_c(const std::string &args);
+
+public:
+  ~shm_source_c();
+
+  bool start();
+  bool stop();
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+  size_t get_num_channels( void );
+
+  osmosdr::meta_range_t get_sample_rates( void );
+  double set_sample_rate( double rate );
+  double get_sample_rate( void );
+
+  osmosdr::freq_range_t get_freq_range( size_t chan = 0 );
+  double set_center_freq( double freq, size_t chan = 0 );
+  double get_center_freq( size_t chan = 0 );
+  double set_freq_corr( double ppm, size_t chan = 0 );
+  double get_freq_corr( size_t chan = 0 );
+
+  std::vector<std::string> get_gain_names( size_t chan = 0 );
+  osmosdr::gain_range_t get_gain_range( size_t chan = 0 );
+  osmosdr::gain_range_t get_gain_range( const std::string & name, size_t chan = 0 );
+  double set_gain( double gain, size_t chan = 0 );
+  double set_gain( double gain, const std::string & name, size_t chan = 0 );
+  double get_gain( size_t chan = 0 );
+  double get_gain( const std::string & name, size_t chan = 0 );
+
+  std::vector< std::string > get_antennas( size_t chan = 0 );
+  std::string set_antenna( const std::string & antenna, size_t chan = 0 );
+  std::string get_antenna( size_t chan = 0 );
+
+private:
+  void convert( const unsigned char *src, gr_complex *dst, size_t n );
+  void skip( void );
+  void update_tuning( double rate, double freq );
+
+  std::string _name;
+  std::unique_ptr<shm_ring> _ring;
+  shm_reader *_reader;
+  size_t _bytes_per_sample;
+  std::vector<float> _lut;
+
+  uint64_t _next;        /* sequence number being consumed */
+  size_t _offset;        /* samples of it already produced */
+  size_t _last_samples;  /* size of the last transfer, to estimate gaps */
+  uint64_t _lost;        /* samples skipped, not yet tagged */
+
+  double _sample_rate;
+  double _center_freq;
+  bool _tag_tuning;
+};
+
+#endif /* INCLUDED_SHM_SOURCE_C_H */
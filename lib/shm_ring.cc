@@ -0,0 +1,390 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include "arg_helpers.h"
+#include "shm_ring.h"
+
+static_assert( sizeof(shm_reader) == 64, "shm_reader must fill a cache line" );
+static_assert( sizeof(shm_slot) == 64, "shm_slot must fill a cache line" );
+
+#define ALIGN_UP(x, a)  (((x) + (a) - 1) / (a) * (a))
+
+#define DEFAULT_SLOTS       64
+#define DEFAULT_SLOT_BYTES  (256 * 1024)
+#define READER_CHECK_SECS   1
+
+size_t shm_ring::bytes_per_sample( uint32_t format )
+{
+  switch ( format ) {
+  case SHM_CU8:
+  case SHM_CS8:
+    return 2;
+  case SHM_CS16:
+    return 4;
+  case SHM_CF32:
+    return 8;
+  }
+
+  return 0;
+}
+
+#ifndef _WIN32
+
+static size_t ring_size( uint32_t slot_count, uint32_t slot_bytes,
+                         size_t *stride )
+{
+  *stride = sizeof(shm_slot) + ALIGN_UP( size_t(slot_bytes), 64 );
+
+  return ALIGN_UP( sizeof(shm_header), 64 ) +
+         SHM_MAX_READERS * sizeof(shm_reader) +
+         slot_count * *stride;
+}
+
+shm_ring::shm_ring( const std::string &name, void *mem, size_t len,
+                    bool owner ) :
+  _name( name ), _mem( mem ), _len( len ), _owner( owner )
+{
+  unsigned char *p = (unsigned char *)mem;
+
+  _header = (shm_header *)p;
+  p += ALIGN_UP( sizeof(shm_header), 64 );
+
+  _readers = (shm_reader *)p;
+  p += SHM_MAX_READERS * sizeof(shm_reader);
+
+  _slots = p;
+  ring_size( _header->slot_count, _header->slot_bytes, &_stride );
+}
+
+shm_ring::~shm_ring()
+{
+  if ( _owner ) {
+    _header->closed.store( 1, std::memory_order_release );
+    notify();
+    shm_unlink( _name.c_str() );
+  }
+
+  munmap( _mem, _len );
+}
+
+std::unique_ptr< shm_ring > shm_ring::create( const std::string &name,
+                                              shm_format format,
+                                              uint32_t slot_count,
+                                              uint32_t slot_bytes )
+{
+  std::string path = "/" + name;
+  size_t stride;
+  size_t len = ring_size( slot_count, slot_bytes, &stride );
+
+  /* a broker that crashed leaves its ring behind, start from scratch */
+  shm_unlink( path.c_str() );
+
+  int fd = shm_open( path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644 );
+  if ( fd < 0 )
+    throw std::runtime_error( "shm_open(" + path + ") failed: " +
+                              strerror( errno ) );
+
+  if ( ftruncate( fd, len ) < 0 ) {
+    int err = errno;
+    close( fd );
+    shm_unlink( path.c_str() );
+    throw std::runtime_error( "Failed to size shared memory " + path + ": " +
+                              strerror( err ) );
+  }
+
+  void *mem = mmap( NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+  close( fd );
+
+  if ( mem == MAP_FAILED ) {
+    shm_unlink( path.c_str() );
+    throw std::runtime_error( "Failed to map shared memory " + path + ": " +
+                              strerror( errno ) );
+  }
+
+  /* ftruncate() zero filled it, which is a valid empty ring */
+  shm_header *header = (shm_header *)mem;
+  header->version = SHM_VERSION;
+  header->format = format;
+  header->slot_count = slot_count;
+  header->slot_bytes = slot_bytes;
+  header->writer_pid = getpid();
+
+  /* readers check the magic last */
+  std::atomic_thread_fence( std::memory_order_release );
+  header->magic = SHM_MAGIC;
+
+  return std::unique_ptr< shm_ring >( new shm_ring( path, mem, len, true ) );
+}
+
+std::unique_ptr< shm_ring > shm_ring::attach( const std::string &name )
+{
+  std::string path = "/" + name;
+
+  int fd = shm_open( path.c_str(), O_RDWR, 0 );
+  if ( fd < 0 )
+    throw std::runtime_error( "No broker is publishing '" + name + "' (" +
+                              strerror( errno ) + ")" );
+
+  struct stat st;
+  if ( fstat( fd, &st ) < 0 || size_t(st.st_size) < sizeof(shm_header) ) {
+    close( fd );
+    throw std::runtime_error( "Shared memory " + path + " is not a sample ring" );
+  }
+
+  void *mem = mmap( NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+  close( fd );
+
+  if ( mem == MAP_FAILED )
+    throw std::runtime_error( "Failed to map shared memory " + path + ": " +
+                              strerror( errno ) );
+
+  shm_header *header = (shm_header *)mem;
+  size_t stride;
+
+  if ( header->magic != SHM_MAGIC || header->version != SHM_VERSION ||
+       ring_size( header->slot_count, header->slot_bytes, &stride ) >
+         size_t(st.st_size) ||
+       ! bytes_per_sample( header->format ) ) {
+    munmap( mem, st.st_size );
+    throw std::runtime_error( "Shared memory " + path + " is not a sample ring" );
+  }
+
+  std::atomic_thread_fence( std::memory_order_acquire );
+
+  return std::unique_ptr< shm_ring >( new shm_ring( path, mem, st.st_size, false ) );
+}
+
+shm_slot *shm_ring::slot( uint64_t seq ) const
+{
+  return (shm_slot *)(_slots + ((seq - 1) % _header->slot_count) * _stride);
+}
+
+void shm_ring::notify()
+{
+  _header->wake.fetch_add( 1, std::memory_order_release );
+#ifdef __linux__
+  syscall( SYS_futex, &_header->wake, FUTEX_WAKE, INT32_MAX, NULL, NULL, 0 );
+#endif
+}
+
+void shm_ring::wait( uint32_t wake, std::chrono::milliseconds timeout )
+{
+#ifdef __linux__
+  struct timespec ts;
+  ts.tv_sec = timeout.count() / 1000;
+  ts.tv_nsec = (timeout.count() % 1000) * 1000000;
+
+  /* returns at once if a publish happened since wake was read */
+  syscall( SYS_futex, &_header->wake, FUTEX_WAIT, wake, &ts, NULL, 0 );
+#else
+  std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::now() + timeout;
+
+  while ( _header->wake.load( std::memory_order_acquire ) == wake &&
+          std::chrono::steady_clock::now() < deadline )
+    std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+#endif
+}
+
+bool shm_ring::writer_alive() const
+{
+  if ( _header->closed.load( std::memory_order_acquire ) )
+    return false;
+
+  return kill( _header->writer_pid, 0 ) == 0 || errno != ESRCH;
+}
+
+shm_publisher::shm_publisher( const std::string &name, shm_format format,
+                              uint32_t slot_count, uint32_t slot_bytes ) :
+  _ring( shm_ring::create( name, format, slot_count, slot_bytes ) ),
+  _seq( 0 ),
+  _next_check( std::chrono::steady_clock::now() ),
+  _lagging( SHM_MAX_READERS, false )
+{
+  std::cerr << "Publishing samples as '" << name << "' ("
+            << slot_count << " slots of " << slot_bytes << " bytes)"
+            << std::endl;
+}
+
+shm_publisher::~shm_publisher()
+{
+}
+
+std::unique_ptr< shm_publisher > shm_publisher::make( const std::string &args,
+                                                      const std::string &device )
+{
+  dict_t dict = params_to_dict( args );
+
+  if ( ! dict.count( "publish" ) )
+    return std::unique_ptr< shm_publisher >();
+
+  shm_format format;
+  if ( device == "rtl" )
+    format = SHM_CU8;
+  else if ( device == "hackrf" )
+    format = SHM_CS8;
+  else if ( device == "airspy" || device == "airspyhf" )
+    format = SHM_CF32;
+  else
+    throw std::runtime_error( "publish= is not supported for " + device );
+
+  uint32_t slots = DEFAULT_SLOTS;
+  uint32_t slot_bytes = DEFAULT_SLOT_BYTES;
+
+  if ( dict.count( "publish_slots" ) )
+    slots = std::max( 4, std::stoi( dict["publish_slots"] ) );
+
+  if ( dict.count( "publish_slot_size" ) )
+    slot_bytes = std::max( 4096, std::stoi( dict["publish_slot_size"] ) );
+
+  /* never split a sample across two slots */
+  slot_bytes -= slot_bytes % shm_ring::bytes_per_sample( format );
+
+  std::string name = dict["publish"];
+  if ( name.empty() )
+    name = "osmosdr-" + device;
+
+  return std::unique_ptr< shm_publisher >(
+        new shm_publisher( name, format, slots, slot_bytes ) );
+}
+
+void shm_publisher::publish( const void *buf, size_t len, double sample_rate,
+                             double center_freq )
+{
+  shm_header *header = _ring->header();
+  const unsigned char *src = (const unsigned char *)buf;
+
+  struct timespec now;
+  clock_gettime( CLOCK_REALTIME, &now );
+  uint64_t time_ns = uint64_t(now.tv_sec) * 1000000000ULL + now.tv_nsec;
+
+  while ( len ) {
+    size_t n = std::min( len, size_t(header->slot_bytes) );
+    shm_slot *slot = _ring->slot( ++_seq );
+
+    slot->seq.store( 0, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+
+    memcpy( (void *)_ring->payload( slot ), src, n );
+    slot->len = n;
+    slot->sample_rate = sample_rate;
+    slot->center_freq = center_freq;
+    slot->time_ns = time_ns;
+
+    slot->seq.store( _seq, std::memory_order_release );
+    header->head.store( _seq, std::memory_order_release );
+
+    src += n;
+    len -= n;
+  }
+
+  _ring->notify();
+
+  if ( std::chrono::steady_clock::now() >= _next_check )
+    check_readers();
+}
+
+/* the writer never waits, but it should be obvious who is losing data */
+void shm_publisher::check_readers()
+{
+  shm_header *header = _ring->header();
+
+  _next_check = std::chrono::steady_clock::now() +
+                std::chrono::seconds( READER_CHECK_SECS );
+
+  for ( unsigned int i = 0; i < SHM_MAX_READERS; i++ ) {
+    shm_reader *reader = _ring->reader( i );
+    uint32_t pid = reader->pid.load( std::memory_order_acquire );
+
+    if ( ! pid ) {
+      _lagging[i] = false;
+      continue;
+    }
+
+    if ( kill( pid, 0 ) < 0 && errno == ESRCH ) {
+      std::cerr << "shm: reader " << pid << " went away" << std::endl;
+      reader->pid.store( 0, std::memory_order_release );
+      _lagging[i] = false;
+      continue;
+    }
+
+    uint64_t behind = _seq - reader->seq.load( std::memory_order_relaxed );
+    bool lagging = behind >= header->slot_count;
+
+    if ( lagging && ! _lagging[i] )
+      std::cerr << "shm: reader " << pid << " is " << behind
+                << " transfers behind and skips data ("
+                << reader->skipped.load( std::memory_order_relaxed )
+                << " transfers lost so far)" << std::endl;
+
+    _lagging[i] = lagging;
+  }
+}
+
+#else /* _WIN32 */
+
+shm_ring::~shm_ring()
+{
+}
+
+shm_publisher::~shm_publisher()
+{
+}
+
+std::unique_ptr< shm_publisher > shm_publisher::make( const std::string &args,
+                                                      const std::string &device )
+{
+  if ( params_to_dict( args ).count( "publish" ) )
+    throw std::runtime_error( "publish= needs POSIX shared memory" );
+
+  return std::unique_ptr< shm_publisher >();
+}
+
+void shm_publisher::publish( const void *buf, size_t len, double sample_rate,
+                             double center_freq )
+{
+}
+
+#endif /* _WIN32 */
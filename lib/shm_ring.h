@@ -0,0 +1,175 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_SHM_RING_H
+#define INCLUDED_OSMOSDR_SHM_RING_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Shared memory layout, host byte order, all offsets 64 byte aligned:
+ *
+ *   shm_header                  format, geometry, publish sequence
+ *   shm_reader[SHM_MAX_READERS] one entry per attached consumer
+ *   slot_count times:
+ *     shm_slot                  sequence number and metadata
+ *     uint8_t[slot_bytes]       raw samples as delivered by the driver
+ *
+ * Slots are published with increasing sequence numbers starting at 1,
+ * number n lives in slot (n - 1) % slot_count. The writer never waits for
+ * anybody: it invalidates a slot (seq = 0), fills it, stores its number
+ * and then advances head. A reader that copied a slot and still finds the
+ * number it expected got consistent data, otherwise it was overtaken and
+ * has to skip ahead.
+ */
+
+#define SHM_MAGIC        0x314d4853524d534fULL /* "OSMRSHM1" */
+#define SHM_VERSION      1
+#define SHM_MAX_READERS  16
+
+enum shm_format
+{
+  SHM_CU8 = 1,  /* rtl */
+  SHM_CS8,      /* hackrf */
+  SHM_CS16,
+  SHM_CF32      /* airspy, airspyhf */
+};
+
+struct shm_header
+{
+  uint64_t magic;
+  uint32_t version;
+  uint32_t format;
+  uint32_t slot_count;
+  uint32_t slot_bytes;
+  uint32_t writer_pid;
+  std::atomic< uint32_t > closed;
+  std::atomic< uint64_t > head;   /* last published sequence number */
+  std::atomic< uint32_t > wake;   /* futex word, bumped on every publish */
+};
+
+struct shm_reader
+{
+  std::atomic< uint32_t > pid;    /* 0 if the entry is free */
+  std::atomic< uint64_t > seq;    /* last sequence number consumed */
+  std::atomic< uint64_t > skipped;/* slots lost to overruns */
+  char _pad[64 - 24];
+};
+
+struct shm_slot
+{
+  std::atomic< uint64_t > seq;
+  uint32_t len;                   /* valid payload bytes */
+  uint32_t _reserved;
+  double sample_rate;
+  double center_freq;
+  uint64_t time_ns;               /* CLOCK_REALTIME at publish */
+  char _pad[64 - 40];
+};
+
+/*!
+ * \brief A mapping of one named ring, either as its writer or as a reader.
+ */
+class shm_ring
+{
+public:
+  /* names are given without the leading slash */
+  static std::unique_ptr< shm_ring > create( const std::string &name,
+                                             shm_format format,
+                                             uint32_t slot_count,
+                                             uint32_t slot_bytes );
+  static std::unique_ptr< shm_ring > attach( const std::string &name );
+
+  ~shm_ring();
+
+  shm_header *header() const { return _header; }
+  shm_reader *reader( unsigned int i ) const { return &_readers[i]; }
+  shm_slot *slot( uint64_t seq ) const;
+  const unsigned char *payload( const shm_slot *slot ) const
+  {
+    return (const unsigned char *)(slot + 1);
+  }
+
+  static size_t bytes_per_sample( uint32_t format );
+
+  /* publish side */
+  void notify();
+
+  /* consumer side, returns early when notified or after timeout */
+  void wait( uint32_t wake, std::chrono::milliseconds timeout );
+
+  bool writer_alive() const;
+
+private:
+  shm_ring( const std::string &name, void *mem, size_t len, bool owner );
+
+  std::string _name;
+  void *_mem;
+  size_t _len;
+  bool _owner;
+
+  shm_header *_header;
+  shm_reader *_readers;
+  unsigned char *_slots;
+  size_t _stride;
+};
+
+/*!
+ * \brief Publishes raw driver transfers of a source for other processes.
+ *
+ * Created from the publish=<name> device argument. publish() is called
+ * from the driver callback next to the transfer recorder and only copies
+ * into the ring. Consumers that do not keep up are overtaken rather than
+ * waited for; the publisher notices and reports them, and clears the
+ * entries of readers whose process went away.
+ */
+class shm_publisher
+{
+public:
+  shm_publisher( const std::string &name, shm_format format,
+                 uint32_t slot_count, uint32_t slot_bytes );
+  ~shm_publisher();
+
+  /*!
+   * Returns a publisher if the device arguments contain publish=<name>,
+   * honoring publish_slots= and publish_slot_size=, or an empty pointer.
+   */
+  static std::unique_ptr< shm_publisher > make( const std::string &args,
+                                                const std::string &device );
+
+  /*! Called from the driver callback, larger transfers span several slots */
+  void publish( const void *buf, size_t len, double sample_rate,
+                double center_freq );
+
+private:
+  void check_readers( void );
+
+  std::unique_ptr< shm_ring > _ring;
+  uint64_t _seq;
+  std::chrono::steady_clock::time_point _next_check;
+  std::vector< bool > _lagging;
+};
+
+#endif /* INCLUDED_OSMOSDR_SHM_RING_H */
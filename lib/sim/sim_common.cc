@@ -0,0 +1,249 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#include <boost/lexical_cast.hpp>
+
+#include "arg_helpers.h"
+#include "sim_common.h"
+
+sim_common::sim_common(const std::string &args) :
+  _format(SIM_FORMAT_U8),
+  _transfer(SIM_TRANSFER),
+  _buf_num(SIM_BUF_NUM),
+  _sample_rate(2.048e6),
+  _center_freq(100e6),
+  _freq_corr(0),
+  _gain(0),
+  _bandwidth(0),
+  _jitter(0),
+  _retune_latency(0),
+  _rng(std::random_device()())
+{
+  dict_t dict = params_to_dict(args);
+
+  _sched = thread_sched(dict);
+  _buf_alloc = buffer_allocator(dict);
+
+  if (dict.count("format")) {
+    std::string format = dict["format"];
+
+    if (format == "u8")
+      _format = SIM_FORMAT_U8;
+    else if (format == "s8")
+      _format = SIM_FORMAT_S8;
+    else if (format == "s16")
+      _format = SIM_FORMAT_S16;
+    else
+      throw std::runtime_error("Unsupported sample format '" + format +
+                               "', use u8, s8 or s16.");
+  }
+
+  if (dict.count("rate"))
+    _sample_rate = boost::lexical_cast< double >( dict["rate"] );
+
+  if (dict.count("transfer"))
+    _transfer = boost::lexical_cast< size_t >( dict["transfer"] );
+
+  if (dict.count("buffers"))
+    _buf_num = boost::lexical_cast< size_t >( dict["buffers"] );
+
+  /* both in microseconds */
+  if (dict.count("jitter"))
+    _jitter = std::chrono::microseconds(
+                boost::lexical_cast< long >( dict["jitter"] ));
+
+  if (dict.count("retune_latency"))
+    _retune_latency = std::chrono::microseconds(
+                boost::lexical_cast< long >( dict["retune_latency"] ));
+
+  if (0 == _transfer)
+    _transfer = SIM_TRANSFER;
+
+  if (_buf_num < 2)
+    _buf_num = SIM_BUF_NUM;
+
+  if (_sample_rate <= 0)
+    throw std::runtime_error("Sample rate must be positive.");
+
+  std::cerr << "Using simulated device, "
+            << _buf_num << " buffers of " << _transfer << " samples";
+  if (_jitter.count())
+    std::cerr << ", " << _jitter.count() << " us jitter";
+  if (_retune_latency.count())
+    std::cerr << ", " << _retune_latency.count() << " us retune latency";
+  std::cerr << std::endl;
+}
+
+std::vector< std::string > sim_common::get_devices( bool fake )
+{
+  std::vector< std::string > devices;
+
+  /* never picked as a default device, only offered when faking */
+  if ( fake )
+    devices.push_back( "sim=0,rate=2.048e6,format=u8,label='Simulated Device'" );
+
+  return devices;
+}
+
+osmosdr::meta_range_t sim_common::get_sample_rates()
+{
+  osmosdr::meta_range_t range;
+
+  range.push_back( osmosdr::range_t( 1e3, 100e6 ) );
+
+  return range;
+}
+
+double sim_common::set_sample_rate( double rate )
+{
+  std::lock_guard<std::mutex> lock(_dev_mutex);
+
+  if (rate > 0)
+    _sample_rate = rate;
+
+  return _sample_rate;
+}
+
+double sim_common::get_sample_rate()
+{
+  return _sample_rate;
+}
+
+osmosdr::freq_range_t sim_common::get_freq_range( size_t chan )
+{
+  osmosdr::freq_range_t range;
+
+  range.push_back( osmosdr::range_t( 1e6, 6e9 ) );
+
+  return range;
+}
+
+double sim_common::set_center_freq( double freq, size_t chan )
+{
+  /* the control call blocks like a PLL being programmed over USB */
+  if (_retune_latency.count())
+    std::this_thread::sleep_for(_retune_latency);
+
+  std::lock_guard<std::mutex> lock(_dev_mutex);
+
+  _center_freq = get_freq_range( chan ).clip( freq );
+
+  return _center_freq;
+}
+
+double sim_common::get_center_freq( size_t chan )
+{
+  return _center_freq;
+}
+
+double sim_common::set_freq_corr( double ppm, size_t chan )
+{
+  _freq_corr = ppm;
+
+  return _freq_corr;
+}
+
+double sim_common::get_freq_corr( size_t chan )
+{
+  return _freq_corr;
+}
+
+std::vector<std::string> sim_common::get_gain_names( size_t chan )
+{
+  std::vector< std::string > names;
+
+  names.push_back( "SIM" );
+
+  return names;
+}
+
+osmosdr::gain_range_t sim_common::get_gain_range( size_t chan )
+{
+  return osmosdr::gain_range_t( 0, 50, 1 );
+}
+
+double sim_common::set_gain( double gain, size_t chan )
+{
+  _gain = get_gain_range( chan ).clip( gain, true );
+
+  return _gain;
+}
+
+double sim_common::get_gain( size_t chan )
+{
+  return _gain;
+}
+
+double sim_common::set_bandwidth( double bandwidth, size_t chan )
+{
+  _bandwidth = bandwidth;
+
+  return get_bandwidth( chan );
+}
+
+double sim_common::get_bandwidth( size_t chan )
+{
+  return _bandwidth > 0 ? _bandwidth : _sample_rate.load();
+}
+
+osmosdr::freq_range_t sim_common::get_bandwidth_range( size_t chan )
+{
+  osmosdr::freq_range_t range;
+
+  range.push_back( osmosdr::range_t( 0, 100e6 ) );
+
+  return range;
+}
+
+size_t sim_common::bytes_per_sample() const
+{
+  return (_format == SIM_FORMAT_S16) ? 4 : 2;
+}
+
+void sim_common::pace_start()
+{
+  _next = std::chrono::steady_clock::now();
+}
+
+void sim_common::pace_wait()
+{
+  /* deadlines advance by the nominal period, jitter only delays wakeup */
+  _next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+             std::chrono::duration<double>(_transfer / _sample_rate));
+
+  std::chrono::steady_clock::time_point wakeup = _next;
+
+  if (_jitter.count()) {
+    std::uniform_int_distribution<long> dist(0, _jitter.count());
+    wakeup += std::chrono::microseconds(dist(_rng));
+  }
+
+  std::this_thread::sleep_until(wakeup);
+
+  /* fell behind by more than a transfer (suspended, overloaded box):
+   * resynchronize instead of bursting to catch up */
+  if (std::chrono::steady_clock::now() - _next >
+      std::chrono::duration<double>(_transfer / _sample_rate) + _jitter)
+    _next = std::chrono::steady_clock::now();
+}
@@ -0,0 +1,100 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_SIM_COMMON_H
+#define INCLUDED_SIM_COMMON_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <osmosdr/ranges.h>
+
+#include "buffer_allocator.h"
+#include "thread_sched.h"
+
+#define SIM_TRANSFER  (16 * 32 * 512 / 2) /* samples, same as an rtl transfer */
+#define SIM_BUF_NUM   15
+
+/*
+ * Device state shared by the simulated source and sink. Besides holding
+ * the settings, it paces the streaming thread: one transfer per
+ * transfer / rate seconds, woken up late by a random amount of jitter
+ * without letting the jitter accumulate.
+ */
+class sim_common
+{
+public:
+  enum sim_format { SIM_FORMAT_U8, SIM_FORMAT_S8, SIM_FORMAT_S16 };
+
+  sim_common(const std::string &args);
+
+protected:
+  static std::vector< std::string > get_devices( bool fake = false );
+
+  osmosdr::meta_range_t get_sample_rates( void );
+  double set_sample_rate( double rate );
+  double get_sample_rate( void );
+
+  osmosdr::freq_range_t get_freq_range( size_t chan = 0 );
+  double set_center_freq( double freq, size_t chan = 0 );
+  double get_center_freq( size_t chan = 0 );
+  double set_freq_corr( double ppm, size_t chan = 0 );
+  double get_freq_corr( size_t chan = 0 );
+
+  std::vector<std::string> get_gain_names( size_t chan = 0 );
+  osmosdr::gain_range_t get_gain_range( size_t chan = 0 );
+  double set_gain( double gain, size_t chan = 0 );
+  double get_gain( size_t chan = 0 );
+
+  double set_bandwidth( double bandwidth, size_t chan = 0 );
+  double get_bandwidth( size_t chan = 0 );
+  osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 );
+
+  size_t bytes_per_sample( void ) const;
+
+  void pace_start( void );
+  void pace_wait( void );
+
+  sim_format _format;
+  size_t _transfer;   /* samples per transfer */
+  size_t _buf_num;
+  thread_sched _sched;
+  buffer_allocator _buf_alloc;
+
+  std::mutex _dev_mutex;
+
+private:
+  std::atomic<double> _sample_rate;
+  std::atomic<double> _center_freq;
+  double _freq_corr;
+  double _gain;
+  double _bandwidth;
+
+  std::chrono::microseconds _jitter;
+  std::chrono::microseconds _retune_latency;
+
+  std::chrono::steady_clock::time_point _next;
+  std::mt19937 _rng;
+};
+
+#endif /* INCLUDED_SIM_COMMON_H */
@@ -0,0 +1,314 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * config.h is generated by configure.  It contains the results
+ * of probing for features, options etc.  It should be the first
+ * file included in your .cc file.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include <gnuradio/io_signature.h>
+
+#include <volk/volk.h>
+
+#include "sim_sink_c.h"
+
+sim_sink_c_sptr make_sim_sink_c (const std::string & args)
+{
+  return gnuradio::get_initial_sptr(new sim_sink_c (args));
+}
+
+static const int MIN_IN = 1;	// mininum number of input streams
+static const int MAX_IN = 1;	// maximum number of input streams
+static const int MIN_OUT = 0;	// minimum number of output streams
+static const int MAX_OUT = 0;	// maximum number of output streams
+
+sim_sink_c::sim_sink_c (const std::string &args)
+  : gr::sync_block ("sim_sink_c",
+        gr::io_signature::make(MIN_IN, MAX_IN, sizeof (gr_complex)),
+        gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof (gr_complex))),
+    sim_common(args),
+    _buf(NULL),
+    _buf_mem(NULL),
+    _buf_head(0),
+    _buf_used(0),
+    _buf_offset(0),
+    _running(false)
+{
+  const size_t len = _transfer * bytes_per_sample();
+
+  _buf = (unsigned char **)malloc(_buf_num * sizeof(unsigned char *));
+  if (!_buf)
+    throw std::runtime_error("Failed to allocate sample buffers.");
+
+  _buf_mem = (unsigned char *)_buf_alloc.allocate(_buf_num * len);
+
+  for (size_t i = 0; i < _buf_num; ++i)
+    _buf[i] = _buf_mem + i * len;
+}
+
+sim_sink_c::~sim_sink_c ()
+{
+  stop();
+
+  if (_buf) {
+    free(_buf);
+    _buf = NULL;
+  }
+
+  _buf_alloc.deallocate(_buf_mem, _buf_num * _transfer * bytes_per_sample());
+  _buf_mem = NULL;
+}
+
+bool sim_sink_c::start()
+{
+  if (_running)
+    return true;
+
+  {
+    std::lock_guard<std::mutex> lock( _buf_mutex );
+    _buf_head = _buf_used = _buf_offset = 0;
+  }
+
+  _running = true;
+  _thread = gr::thread::thread(_sim_wait, this);
+
+  return true;
+}
+
+bool sim_sink_c::stop()
+{
+  _running = false;
+  if (_thread.joinable())
+    _thread.join();
+
+  _buf_cond.notify_one();
+
+  return true;
+}
+
+void sim_sink_c::_sim_wait(sim_sink_c *obj)
+{
+  obj->sim_wait();
+}
+
+/* plays the part of the libusb event thread asking for the next transfer */
+void sim_sink_c::sim_wait()
+{
+  _sched.apply("sim transfer");
+
+  pace_start();
+
+  while (_running) {
+    pace_wait();
+
+    {
+      std::lock_guard<std::mutex> lock( _buf_mutex );
+
+      if (!_buf_used) {
+        std::cerr << "U" << std::flush;
+        continue;
+      }
+
+      /* "transmitted", hand the buffer back to work() */
+      _buf_head = (_buf_head + 1) % _buf_num;
+      _buf_used--;
+    }
+
+    _buf_cond.notify_one();
+  }
+}
+
+int sim_sink_c::work( int noutput_items,
+                      gr_vector_const_void_star &input_items,
+                      gr_vector_void_star &output_items )
+{
+  const gr_complex *in = (const gr_complex *) input_items[0];
+  const size_t bps = bytes_per_sample();
+  size_t tail;
+
+  {
+    std::unique_lock<std::mutex> lock( _buf_mutex );
+
+    while (_buf_used == _buf_num && _running)
+      _buf_cond.wait( lock );
+
+    tail = (_buf_head + _buf_used) % _buf_num;
+  }
+
+  if (!_running)
+    return WORK_DONE;
+
+  /* fill the tail buffer, the streaming thread only drains full ones */
+  const int nin = std::min((size_t)noutput_items, _transfer - _buf_offset);
+  unsigned char *buf = _buf[tail] + _buf_offset * bps;
+
+  switch (_format) {
+  case SIM_FORMAT_U8:
+    for (int i = 0; i < 2 * nin; ++i) {
+      float v = ((const float *)in)[i] * 128.0f + 127.4f;
+      buf[i] = (unsigned char)lrintf(std::max(0.0f, std::min(v, 255.0f)));
+    }
+    break;
+  case SIM_FORMAT_S8:
+    volk_32f_s32f_convert_8i((int8_t *)buf, (const float *)in, 127.0f, 2 * nin);
+    break;
+  case SIM_FORMAT_S16:
+    volk_32f_s32f_convert_16i((int16_t *)buf, (const float *)in, 32767.0f, 2 * nin);
+    break;
+  }
+
+  _buf_offset += nin;
+
+  if (_buf_offset == _transfer) {
+    std::lock_guard<std::mutex> lock( _buf_mutex );
+
+    _buf_used++;
+    _buf_offset = 0;
+  }
+
+  return nin;
+}
+
+std::vector<std::string> sim_sink_c::get_devices( bool fake )
+{
+  return sim_common::get_devices( fake );
+}
+
+size_t sim_sink_c::get_num_channels()
+{
+  return 1;
+}
+
+osmosdr::meta_range_t sim_sink_c::get_sample_rates()
+{
+  return sim_common::get_sample_rates();
+}
+
+double sim_sink_c::set_sample_rate( double rate )
+{
+  return sim_common::set_sample_rate( rate );
+}
+
+double sim_sink_c::get_sample_rate()
+{
+  return sim_common::get_sample_rate();
+}
+
+osmosdr::freq_range_t sim_sink_c::get_freq_range( size_t chan )
+{
+  return sim_common::get_freq_range( chan );
+}
+
+double sim_sink_c::set_center_freq( double freq, size_t chan )
+{
+  return sim_common::set_center_freq( freq, chan );
+}
+
+double sim_sink_c::get_center_freq( size_t chan )
+{
+  return sim_common::get_center_freq( chan );
+}
+
+double sim_sink_c::set_freq_corr( double ppm, size_t chan )
+{
+  return sim_common::set_freq_corr( ppm, chan );
+}
+
+double sim_sink_c::get_freq_corr( size_t chan )
+{
+  return sim_common::get_freq_corr( chan );
+}
+
+std::vector<std::string> sim_sink_c::get_gain_names( size_t chan )
+{
+  return sim_common::get_gain_names( chan );
+}
+
+osmosdr::gain_range_t sim_sink_c::get_gain_range( size_t chan )
+{
+  return sim_common::get_gain_range( chan );
+}
+
+osmosdr::gain_range_t sim_sink_c::get_gain_range( const std::string & name, size_t chan )
+{
+  return get_gain_range( chan );
+}
+
+double sim_sink_c::set_gain( double gain, size_t chan )
+{
+  return sim_common::set_gain( gain, chan );
+}
+
+double sim_sink_c::set_gain( double gain, const std::string & name, size_t chan )
+{
+  return set_gain( gain, chan );
+}
+
+double sim_sink_c::get_gain( size_t chan )
+{
+  return sim_common::get_gain( chan );
+}
+
+double sim_sink_c::get_gain( const std::string & name, size_t chan )
+{
+  return get_gain( chan );
+}
+
+std::vector< std::string > sim_sink_c::get_antennas( size_t chan )
+{
+  std::vector< std::string > antennas;
+
+  antennas.push_back( get_antenna( chan ) );
+
+  return antennas;
+}
+
+std::string sim_sink_c::set_antenna( const std::string & antenna, size_t chan )
+{
+  return get_antenna( chan );
+}
+
+std::string sim_sink_c::get_antenna( size_t chan )
+{
+  return "TX";
+}
+
+double sim_sink_c::set_bandwidth( double bandwidth, size_t chan )
+{
+  return sim_common::set_bandwidth( bandwidth, chan );
+}
+
+double sim_sink_c::get_bandwidth( size_t chan )
+{
+  return sim_common::get_bandwidth( chan );
+}
+
+osmosdr::freq_range_t sim_sink_c::get_bandwidth_range( size_t chan )
+{
+  return sim_common::get_bandwidth_range( chan );
+}
@@ -0,0 +1,442 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * config.h is generated by configure.  It contains the results
+ * of probing for features, options etc.  It should be the first
+ * file included in your .cc file.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+#include <boost/lexical_cast.hpp>
+
+#include <gnuradio/io_signature.h>
+
+#include <volk/volk.h>
+
+#include "arg_helpers.h"
+#include "trace.h"
+#include "sim_source_c.h"
+
+#define SIM_SIG_LEN  (1 << 16) /* samples in one period of the signal */
+
+sim_source_c_sptr make_sim_source_c (const std::string & args)
+{
+  return gnuradio::get_initial_sptr(new sim_source_c (args));
+}
+
+static const int MIN_IN = 0;	// mininum number of input streams
+static const int MAX_IN = 0;	// maximum number of input streams
+static const int MIN_OUT = 1;	// minimum number of output streams
+static const int MAX_OUT = 1;	// maximum number of output streams
+
+sim_source_c::sim_source_c (const std::string &args)
+  : gr::sync_block ("sim_source_c",
+        gr::io_signature::make(MIN_IN, MAX_IN, sizeof (gr_complex)),
+        gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof (gr_complex))),
+    sim_common(args),
+    _sig_pos(0),
+    _tone_freq(0),
+    _tone_level(-20),
+    _noise_level(-50),
+    _buf(NULL),
+    _buf_mem(NULL),
+    _timestamps(false),
+    _buf_head(0),
+    _buf_used(0),
+    _buf_offset(0),
+    _running(false)
+{
+  dict_t dict = params_to_dict(args);
+
+  if (dict.count("tone"))
+    _tone_freq = boost::lexical_cast< double >( dict["tone"] );
+
+  if (dict.count("tone_level"))
+    _tone_level = boost::lexical_cast< double >( dict["tone_level"] );
+
+  if (dict.count("noise"))
+    _noise_level = boost::lexical_cast< double >( dict["noise"] );
+
+  if (dict.count("timestamps"))
+    _timestamps = boost::lexical_cast< bool >( dict["timestamps"] );
+
+  for (unsigned int i = 0; i < 0x100; i++)
+    _lut.push_back((i - 127.4f) / 128.0f);
+
+  const size_t len = _transfer * bytes_per_sample();
+
+  _buf = (unsigned char **)malloc(_buf_num * sizeof(unsigned char *));
+  if (!_buf)
+    throw std::runtime_error("Failed to allocate sample buffers.");
+
+  _buf_mem = (unsigned char *)_buf_alloc.allocate(_buf_num * len);
+
+  for (size_t i = 0; i < _buf_num; ++i)
+    _buf[i] = _buf_mem + i * len;
+
+  _buf_time.resize(_buf_num);
+
+  generate_signal();
+}
+
+sim_source_c::~sim_source_c ()
+{
+  stop();
+
+  if (_buf) {
+    free(_buf);
+    _buf = NULL;
+  }
+
+  _buf_alloc.deallocate(_buf_mem, _buf_num * _transfer * bytes_per_sample());
+  _buf_mem = NULL;
+}
+
+bool sim_source_c::start()
+{
+  if (_running)
+    return true;
+
+  {
+    std::lock_guard<std::mutex> lock( _buf_mutex );
+    _buf_head = _buf_used = _buf_offset = 0;
+  }
+
+  _running = true;
+  _thread = gr::thread::thread(_sim_wait, this);
+
+  return true;
+}
+
+bool sim_source_c::stop()
+{
+  _running = false;
+  if (_thread.joinable())
+    _thread.join();
+
+  _buf_cond.notify_one();
+
+  return true;
+}
+
+void sim_source_c::_sim_wait(sim_source_c *obj)
+{
+  obj->sim_wait();
+}
+
+/* plays the part of the libusb event thread and transfer callback */
+void sim_source_c::sim_wait()
+{
+  const size_t len = _transfer * bytes_per_sample();
+
+  OSMOSDR_TRACE_THREAD_NAME("sim transfer");
+  _sched.apply("sim transfer");
+
+  pace_start();
+
+  while (_running) {
+    pace_wait();
+
+    OSMOSDR_TRACE_SCOPE("sim", "callback");
+    std::lock_guard<std::mutex> sig_lock( _sig_mutex );
+
+    {
+      std::lock_guard<std::mutex> lock( _buf_mutex );
+
+      if (_buf_used == _buf_num) {
+        /* work() is behind, the transfer is lost */
+        std::cerr << "O" << std::flush;
+        continue;
+      }
+
+      size_t tail = (_buf_head + _buf_used) % _buf_num;
+      unsigned char *buf = _buf[tail];
+
+      _buf_time[tail] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now().time_since_epoch()).count();
+
+      for (size_t done = 0; done < len; ) {
+        size_t n = std::min(len - done, _sig.size() - _sig_pos);
+        memcpy(buf + done, &_sig[_sig_pos], n);
+        _sig_pos = (_sig_pos + n) % _sig.size();
+        done += n;
+      }
+
+      _buf_used++;
+
+      OSMOSDR_TRACE_COUNTER("sim", "buffers used", this, _buf_used);
+    }
+
+    _buf_cond.notify_one();
+  }
+}
+
+void sim_source_c::generate_signal()
+{
+  const double rate = get_sample_rate();
+  const size_t bps = bytes_per_sample();
+
+  /* quantize the tone so the table holds a whole number of cycles */
+  double offset = _tone_freq ? _tone_freq - get_center_freq() : rate / 8;
+  long cycles = lround(offset * SIM_SIG_LEN / rate);
+  bool tone = std::fabs(offset) < rate / 2;
+
+  double amp = std::pow(10.0, _tone_level / 20.0);
+  double sigma = std::pow(10.0, _noise_level / 20.0) / std::sqrt(2.0);
+
+  std::mt19937 rng(0);
+  std::normal_distribution<double> noise(0.0, sigma);
+
+  std::vector<unsigned char> sig(SIM_SIG_LEN * bps);
+
+  for (size_t n = 0; n < SIM_SIG_LEN; n++) {
+    double phase = 2.0 * M_PI * double(cycles * (long)n % SIM_SIG_LEN) / SIM_SIG_LEN;
+    double re = noise(rng), im = noise(rng);
+
+    if (tone) {
+      re += amp * std::cos(phase);
+      im += amp * std::sin(phase);
+    }
+
+    re = std::max(-1.0, std::min(re, 1.0));
+    im = std::max(-1.0, std::min(im, 1.0));
+
+    switch (_format) {
+    case SIM_FORMAT_U8:
+      sig[2 * n]     = (unsigned char)lrint(std::min(re * 128.0 + 127.4, 255.0));
+      sig[2 * n + 1] = (unsigned char)lrint(std::min(im * 128.0 + 127.4, 255.0));
+      break;
+    case SIM_FORMAT_S8:
+      ((int8_t *)&sig[0])[2 * n]     = (int8_t)lrint(re * 127.0);
+      ((int8_t *)&sig[0])[2 * n + 1] = (int8_t)lrint(im * 127.0);
+      break;
+    case SIM_FORMAT_S16:
+      ((int16_t *)&sig[0])[2 * n]     = (int16_t)lrint(re * 32767.0);
+      ((int16_t *)&sig[0])[2 * n + 1] = (int16_t)lrint(im * 32767.0);
+      break;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock( _sig_mutex );
+
+  _sig.swap(sig);
+  _sig_pos %= _sig.size();
+}
+
+int sim_source_c::work( int noutput_items,
+                        gr_vector_const_void_star &input_items,
+                        gr_vector_void_star &output_items )
+{
+  OSMOSDR_TRACE_SCOPE("sim", "work");
+  gr_complex *out = (gr_complex *)output_items[0];
+  const size_t bps = bytes_per_sample();
+
+  {
+    OSMOSDR_TRACE_SCOPE("sim", "wait");
+    std::unique_lock<std::mutex> lock( _buf_mutex );
+
+    while (!_buf_used && _running)
+      _buf_cond.wait( lock );
+  }
+
+  if (!_running)
+    return WORK_DONE;
+
+  /* the streaming thread never writes to the buffers we're reading */
+  while (noutput_items && _buf_used) {
+    const int nout = std::min((size_t)noutput_items, _transfer - _buf_offset);
+    const unsigned char *buf = _buf[_buf_head] + _buf_offset * bps;
+
+    if (_timestamps && _buf_offset == 0) {
+      static const pmt::pmt_t SIM_TIME_KEY = pmt::string_to_symbol("sim_time");
+
+      add_item_tag(0, nitems_written(0) + (out - (gr_complex *)output_items[0]),
+                   SIM_TIME_KEY, pmt::from_uint64(_buf_time[_buf_head]));
+    }
+
+    switch (_format) {
+    case SIM_FORMAT_U8:
+      for (int i = 0; i < nout; ++i)
+        out[i] = gr_complex(_lut[buf[i * 2]], _lut[buf[i * 2 + 1]]);
+      break;
+    case SIM_FORMAT_S8:
+      volk_8i_s32f_convert_32f((float *)out, (const int8_t *)buf, 128.0f, 2 * nout);
+      break;
+    case SIM_FORMAT_S16:
+      volk_16i_s32f_convert_32f((float *)out, (const int16_t *)buf, 32768.0f, 2 * nout);
+      break;
+    }
+
+    out += nout;
+    noutput_items -= nout;
+    _buf_offset += nout;
+
+    if (_buf_offset == _transfer) {
+      std::lock_guard<std::mutex> lock( _buf_mutex );
+
+      _buf_head = (_buf_head + 1) % _buf_num;
+      _buf_used--;
+      _buf_offset = 0;
+
+      OSMOSDR_TRACE_COUNTER("sim", "buffers used", this, _buf_used);
+    }
+  }
+
+  return (out - ((gr_complex *)output_items[0]));
+}
+
+std::vector<std::string> sim_source_c::get_devices( bool fake )
+{
+  return sim_common::get_devices( fake );
+}
+
+size_t sim_source_c::get_num_channels()
+{
+  return 1;
+}
+
+osmosdr::meta_range_t sim_source_c::get_sample_rates()
+{
+  return sim_common::get_sample_rates();
+}
+
+double sim_source_c::set_sample_rate( double rate )
+{
+  double ret = sim_common::set_sample_rate( rate );
+
+  generate_signal();
+
+  return ret;
+}
+
+double sim_source_c::get_sample_rate()
+{
+  return sim_common::get_sample_rate();
+}
+
+osmosdr::freq_range_t sim_source_c::get_freq_range( size_t chan )
+{
+  return sim_common::get_freq_range( chan );
+}
+
+double sim_source_c::set_center_freq( double freq, size_t chan )
+{
+  double ret = sim_common::set_center_freq( freq, chan );
+
+  /* a fixed frequency tone moves across the band */
+  if (_tone_freq)
+    generate_signal();
+
+  return ret;
+}
+
+double sim_source_c::get_center_freq( size_t chan )
+{
+  return sim_common::get_center_freq( chan );
+}
+
+double sim_source_c::set_freq_corr( double ppm, size_t chan )
+{
+  return sim_common::set_freq_corr( ppm, chan );
+}
+
+double sim_source_c::get_freq_corr( size_t chan )
+{
+  return sim_common::get_freq_corr( chan );
+}
+
+std::vector<std::string> sim_source_c::get_gain_names( size_t chan )
+{
+  return sim_common::get_gain_names( chan );
+}
+
+osmosdr::gain_range_t sim_source_c::get_gain_range( size_t chan )
+{
+  return sim_common::get_gain_range( chan );
+}
+
+osmosdr::gain_range_t sim_source_c::get_gain_range( const std::string & name, size_t chan )
+{
+  return get_gain_range( chan );
+}
+
+double sim_source_c::set_gain( double gain, size_t chan )
+{
+  return sim_common::set_gain( gain, chan );
+}
+
+double sim_source_c::set_gain( double gain, const std::string & name, size_t chan )
+{
+  return set_gain( gain, chan );
+}
+
+double sim_source_c::get_gain( size_t chan )
+{
+  return sim_common::get_gain( chan );
+}
+
+double sim_source_c::get_gain( const std::string & name, size_t chan )
+{
+  return get_gain( chan );
+}
+
+std::vector< std::string > sim_source_c::get_antennas( size_t chan )
+{
+  std::vector< std::string > antennas;
+
+  antennas.push_back( get_antenna( chan ) );
+
+  return antennas;
+}
+
+std::string sim_source_c::set_antenna( const std::string & antenna, size_t chan )
+{
+  return get_antenna( chan );
+}
+
+std::string sim_source_c::get_antenna( size_t chan )
+{
+  return "RX";
+}
+
+double sim_source_c::set_bandwidth( double bandwidth, size_t chan )
+{
+  return sim_common::set_bandwidth( bandwidth, chan );
+}
+
+double sim_source_c::get_bandwidth( size_t chan )
+{
+  return sim_common::get_bandwidth( chan );
+}
+
+osmosdr::freq_range_t sim_source_c::get_bandwidth_range( size_t chan )
+{
+  return sim_common::get_bandwidth_range( chan );
+}
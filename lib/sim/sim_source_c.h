@@ -0,0 +1,133 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_SIM_SOURCE_C_H
+#define INCLUDED_SIM_SOURCE_C_H
+
+#include <gnuradio/sync_block.h>
+
+#include <gnuradio/thread/thread.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+#include "source_iface.h"
+#include "sim_common.h"
+
+class sim_source_c;
+
+typedef std::shared_ptr<sim_source_c> sim_source_c_sptr;
+
+sim_source_c_sptr make_sim_source_c (const std::string & args = "");
+
+/*!
+ * \brief Simulated receiver.
+ *
+ * A streaming thread hands transfers of native u8, s8 or s16 samples to
+ * work() through a ring of buffers the way a libusb callback does, so the
+ * rest of the receive path can be load tested without hardware. The
+ * signal is a tone plus gaussian noise.
+ *
+ * With timestamps=1 the first sample of every transfer carries a
+ * "sim_time" tag holding the steady clock time (ns) of its "callback",
+ * for measuring latency through a flowgraph.
+ */
+class sim_source_c :
+    public gr::sync_block,
+    public source_iface,
+    protected sim_common
+{
+private:
+  friend sim_source_c_sptr make_sim_source_c(const std::string &args);
+
+  sim_source_c(const std::string &args);
+
+public:
+  ~sim_source_c();
+
+  bool start();
+  bool stop();
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+  static std::vector< std::string > get_devices( bool fake = false );
+
+  size_t get_num_channels( void );
+
+  osmosdr::meta_range_t get_sample_rates( void );
+  double set_sample_rate( double rate );
+  double get_sample_rate( void );
+
+  osmosdr::freq_range_t get_freq_range( size_t chan = 0 );
+  double set_center_freq( double freq, size_t chan = 0 );
+  double get_center_freq( size_t chan = 0 );
+  double set_freq_corr( double ppm, size_t chan = 0 );
+  double get_freq_corr( size_t chan = 0 );
+
+  std::vector<std::string> get_gain_names( size_t chan = 0 );
+  osmosdr::gain_range_t get_gain_range( size_t chan = 0 );
+  osmosdr::gain_range_t get_gain_range( const std::string & name, size_t chan = 0 );
+  double set_gain( double gain, size_t chan = 0 );
+  double set_gain( double gain, const std::string & name, size_t chan = 0 );
+  double get_gain( size_t chan = 0 );
+  double get_gain( const std::string & name, size_t chan = 0 );
+
+  std::vector< std::string > get_antennas( size_t chan = 0 );
+  std::string set_antenna( const std::string & antenna, size_t chan = 0 );
+  std::string get_antenna( size_t chan = 0 );
+
+  double set_bandwidth( double bandwidth, size_t chan = 0 );
+  double get_bandwidth( size_t chan = 0 );
+  osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 );
+
+private:
+  static void _sim_wait(sim_source_c *obj);
+  void sim_wait();
+
+  void generate_signal();
+
+  /* one period of the synthetic signal in the native format */
+  std::vector<unsigned char> _sig;
+  size_t _sig_pos;
+  std::mutex _sig_mutex;
+
+  double _tone_freq;   /* absolute, 0 follows the center frequency */
+  double _tone_level;  /* dBFS */
+  double _noise_level; /* dBFS */
+
+  std::vector<float> _lut;
+
+  unsigned char **_buf;
+  unsigned char *_buf_mem;
+  std::vector<uint64_t> _buf_time;
+  bool _timestamps;
+  size_t _buf_head;
+  size_t _buf_used;
+  size_t _buf_offset;
+  std::mutex _buf_mutex;
+  std::condition_variable _buf_cond;
+
+  gr::thread::thread _thread;
+  std::atomic<bool> _running;
+};
+
+#endif /* INCLUDED_SIM_SOURCE_C_H */
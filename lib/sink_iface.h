@@ -364,6 +364,30 @@ public:
    * \param time_spec the new time
    */
   virtual void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec) { }
+
+  /*!
+   * Tell whether the device schedules timed commands itself. For those
+   * which do not, the commands are applied in the sample stream instead.
+   * \return true if set_command_time() is implemented by the device
+   */
+  virtual bool has_timed_commands( void ) { return false; }
+
+  /*!
+   * Set the time at which subsequent frequency and gain changes take
+   * effect.
+   * \param time_spec the time at which the commands take effect
+   * \param mboard the motherboard index 0 to M-1
+   * \return true if the device schedules the commands itself, false to
+   *         have them applied in the sample stream
+   */
+  virtual bool set_command_time(const ::osmosdr::time_spec_t &time_spec,
+                                size_t mboard = 0) { return false; }
+
+  /*!
+   * Clear the command time so subsequent commands are applied immediately.
+   * \param mboard the motherboard index 0 to M-1
+   */
+  virtual void clear_command_time(size_t mboard = 0) { }
 };
 
 #endif // OSMOSDR_SINK_IFACE_H
@@ -54,8 +54,12 @@
 #ifdef ENABLE_FILE
 #include "file_sink_c.h"
 #endif
+#ifdef ENABLE_SIM
+#include "sim_sink_c.h"
+#endif
 
 #include "arg_helpers.h"
+#include "trace.h"
 #include "sink_impl.h"
 
 /*
@@ -108,6 +112,9 @@ sink_impl::sink_impl( const std::string &args )
 #ifdef ENABLE_FILE
   dev_types.push_back("file");
 #endif
+#ifdef ENABLE_SIM
+  dev_types.push_back("sim");
+#endif
 
   std::cerr << "gr-osmosdr "
             << GR_OSMOSDR_VERSION << " (" << GR_OSMOSDR_LIBVER << ") "
@@ -176,6 +183,8 @@ sink_impl::sink_impl( const std::string &args )
 
     dict_t dict = params_to_dict(arg);
 
+    OSMOSDR_TRACE_START( dict.count("trace") ? dict["trace"] : "" );
+
 //    std::cerr << std::endl;
 //    for (dict_t::value_type &entry : dict)
 //      std::cerr << "'" << entry.first << "' = '" << entry.second << "'" << std::endl;
@@ -231,12 +240,39 @@ sink_impl::sink_impl( const std::string &args )
       block = sink; iface = sink.get();
     }
 #endif
+#ifdef ENABLE_SIM
+    if ( dict.count("sim") ) {
+      sim_sink_c_sptr sink = make_sim_sink_c( arg );
+      block = sink; iface = sink.get();
+    }
+#endif
 
     if ( iface != NULL && long(block.get()) != 0 ) {
       _devs.push_back( iface );
 
-      for (size_t i = 0; i < iface->get_num_channels(); i++) {
-        connect(self(), channel++, block, i);
+      /* on request, timed commands the device cannot schedule are applied
+       * in its stream; the tap costs a copy per work() so it is opt-in */
+      if ( dict.count("timed_cmds") && dict["timed_cmds"] != "0" &&
+           ! iface->has_timed_commands() ) {
+        timed_command_tap_sptr tap = timed_command_tap::make( iface );
+
+        for (size_t i = 0; i < iface->get_num_channels(); i++) {
+          connect(self(), channel++, tap, i);
+          connect(tap, i, block, i);
+        }
+
+        _cmd_taps[ iface ] = tap;
+      } else {
+        for (size_t i = 0; i < iface->get_num_channels(); i++) {
+          connect(self(), channel++, block, i);
+        }
+      }
+
+      /* triggered recording, see the file sink */
+      if ( block->message_port_is_hier_in( pmt::mp("trigger") ) ) {
+        if ( ! message_port_is_hier_in( pmt::mp("trigger") ) )
+          message_port_register_hier_in( pmt::mp("trigger") );
+        msg_connect( self(), pmt::mp("trigger"), block, pmt::mp("trigger") );
       }
     } else if ( (iface != NULL) || (long(block.get()) != 0) )
       throw std::runtime_error("Either iface or block are NULL.");
@@ -272,6 +308,7 @@ osmosdr::meta_range_t sink_impl::get_sample_rates()
 
 double sink_impl::set_sample_rate(double rate)
 {
+  OSMOSDR_TRACE_SCOPE( "ctrl", "set_sample_rate" );
   double sample_rate = 0;
 
   if (_sample_rate != rate) {
@@ -314,12 +351,19 @@ osmosdr::freq_range_t sink_impl::get_freq_range( size_t chan )
 
 double sink_impl::set_center_freq( double freq, size_t chan )
 {
+  OSMOSDR_TRACE_SCOPE( "ctrl", "set_center_freq" );
   size_t channel = 0;
   for (sink_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
       if ( chan == channel++ ) {
         if ( _center_freq[ chan ] != freq ) {
           _center_freq[ chan ] = freq;
+          if ( _cmd_emulated.count( dev ) ) {
+            _cmd_taps[ dev ]->push( [dev, freq, dev_chan]() {
+              dev->set_center_freq( freq, dev_chan );
+            }, dev_chan );
+            return freq;
+          }
           return dev->set_center_freq( freq, dev_chan );
         } else { return _center_freq[ chan ]; }
       }
@@ -340,6 +384,7 @@ double sink_impl::get_center_freq( size_t chan )
 
 double sink_impl::set_freq_corr( double ppm, size_t chan )
 {
+  OSMOSDR_TRACE_SCOPE( "ctrl", "set_freq_corr" );
   size_t channel = 0;
   for (sink_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
@@ -399,6 +444,7 @@ osmosdr::gain_range_t sink_impl::get_gain_range( const std::string & name, size_
 
 bool sink_impl::set_gain_mode( bool automatic, size_t chan )
 {
+  OSMOSDR_TRACE_SCOPE( "ctrl", "set_gain_mode" );
   size_t channel = 0;
   for (sink_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
@@ -428,12 +474,19 @@ bool sink_impl::get_gain_mode( size_t chan )
 
 double sink_impl::set_gain( double gain, size_t chan )
 {
+  OSMOSDR_TRACE_SCOPE( "ctrl", "set_gain" );
   size_t channel = 0;
   for (sink_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
       if ( chan == channel++ ) {
         if ( _gain[ chan ] != gain ) {
           _gain[ chan ] = gain;
+          if ( _cmd_emulated.count( dev ) ) {
+            _cmd_taps[ dev ]->push( [dev, gain, dev_chan]() {
+              dev->set_gain( gain, dev_chan );
+            } );
+            return gain;
+          }
           return dev->set_gain( gain, dev_chan );
         } else { return _gain[ chan ]; }
       }
@@ -443,11 +496,19 @@ double sink_impl::set_gain( double gain, size_t chan )
 
 double sink_impl::set_gain( double gain, const std::string & name, size_t chan)
 {
+  OSMOSDR_TRACE_SCOPE( "ctrl", "set_gain" );
   size_t channel = 0;
   for (sink_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
+      if ( chan == channel++ ) {
+        if ( _cmd_emulated.count( dev ) ) {
+          _cmd_taps[ dev ]->push( [dev, gain, name, dev_chan]() {
+            dev->set_gain( gain, name, dev_chan );
+          } );
+          return gain;
+        }
         return dev->set_gain( gain, name, dev_chan );
+      }
 
   return 0;
 }
@@ -476,6 +537,7 @@ double sink_impl::get_gain( const std::string & name, size_t chan )
 
 double sink_impl::set_if_gain( double gain, size_t chan )
 {
+  OSMOSDR_TRACE_SCOPE( "ctrl", "set_if_gain" );
   size_t channel = 0;
   for (sink_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
@@ -491,6 +553,7 @@ double sink_impl::set_if_gain( double gain, size_t chan )
 
 double sink_impl::set_bb_gain( double gain, size_t chan )
 {
+  OSMOSDR_TRACE_SCOPE( "ctrl", "set_bb_gain" );
   size_t channel = 0;
   for (sink_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
@@ -517,6 +580,7 @@ std::vector< std::string > sink_impl::get_antennas( size_t chan )
 
 std::string sink_impl::set_antenna( const std::string & antenna, size_t chan )
 {
+  OSMOSDR_TRACE_SCOPE( "ctrl", "set_antenna" );
   size_t channel = 0;
   for (sink_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
@@ -561,6 +625,7 @@ void sink_impl::set_iq_balance( const std::complex<double> &balance, size_t chan
 
 double sink_impl::set_bandwidth( double bandwidth, size_t chan )
 {
+  OSMOSDR_TRACE_SCOPE( "ctrl", "set_bandwidth" );
   size_t channel = 0;
   for (sink_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
@@ -694,3 +759,48 @@ void sink_impl::set_time_unknown_pps(const osmosdr::time_spec_t &time_spec)
     dev->set_time_unknown_pps( time_spec );
   }
 }
+
+void sink_impl::set_command_time(const osmosdr::time_spec_t &time_spec, size_t mboard)
+{
+  std::vector< sink_iface * > devs = _devs;
+
+  if (mboard != osmosdr::ALL_MBOARDS)
+    devs.assign( 1, _devs.at(mboard) );
+
+  for (sink_iface *dev : devs) {
+    bool scheduled = (mboard != osmosdr::ALL_MBOARDS) ?
+                     dev->set_command_time( time_spec ) :
+                     dev->set_command_time( time_spec, osmosdr::ALL_MBOARDS );
+
+    if ( scheduled )
+      continue;
+
+    if ( _cmd_taps.count( dev ) ) { /* applied at the sample of that time */
+      _cmd_emulated.insert( dev );
+      _cmd_taps[ dev ]->begin( time_spec );
+    } else {
+      std::cerr << "gr-osmosdr: device cannot time commands, applying them "
+                << "immediately (open it with timed_cmds=1 to emulate)"
+                << std::endl;
+    }
+  }
+}
+
+void sink_impl::clear_command_time(size_t mboard)
+{
+  std::vector< sink_iface * > devs = _devs;
+
+  if (mboard != osmosdr::ALL_MBOARDS)
+    devs.assign( 1, _devs.at(mboard) );
+
+  for (sink_iface *dev : devs) {
+    if ( _cmd_emulated.erase( dev ) ) {
+      _cmd_taps[ dev ]->commit();
+    } else {
+      if (mboard != osmosdr::ALL_MBOARDS)
+        dev->clear_command_time();
+      else
+        dev->clear_command_time( osmosdr::ALL_MBOARDS );
+    }
+  }
+}
@@ -23,8 +23,11 @@
 #include "osmosdr/sink.h"
 
 #include "sink_iface.h"
+#include "timed_command_tap.h"
 
 #include <map>
+#include <memory>
+#include <set>
 
 class sink_impl : public osmosdr::sink
 {
@@ -82,6 +85,10 @@ public:
   void set_time_next_pps(const ::osmosdr::time_spec_t &time_spec);
   void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec);
 
+  void set_command_time(const ::osmosdr::time_spec_t &time_spec,
+                        size_t mboard = osmosdr::ALL_MBOARDS);
+  void clear_command_time(size_t mboard = osmosdr::ALL_MBOARDS);
+
 private:
   std::vector< sink_iface * > _devs;
 
@@ -95,6 +102,10 @@ private:
   std::map< size_t, double > _bb_gain;
   std::map< size_t, std::string > _antenna;
   std::map< size_t, double > _bandwidth;
+
+  /* taps of the devices without timed commands, and those collecting */
+  std::map< sink_iface *, timed_command_tap_sptr > _cmd_taps;
+  std::set< sink_iface * > _cmd_emulated;
 };
 
 #endif /* INCLUDED_OSMOSDR_SINK_IMPL_H */
@@ -48,6 +48,16 @@ public:
    */
   virtual bool seek( long seek_point, int whence, size_t chan = 0 ) { return false; }
 
+  /*!
+   * \brief seek file to the sample taken at \p time
+   *
+   * \param time	absolute time for timestamped recordings, otherwise
+   *		relative to the first sample
+   * \param chan	the channel index 0 to N-1
+   * \return true on success
+   */
+  virtual bool seek_time( const ::osmosdr::time_spec_t &time, size_t chan = 0 ) { return false; }
+
   /*!
    * Get the possible sample rates for the underlying radio hardware.
    * \return a range of rates in Sps
@@ -397,6 +407,30 @@ public:
    * \param time_spec the new time
    */
   virtual void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec) { }
+
+  /*!
+   * Tell whether the device schedules timed commands itself. For those
+   * which do not, the commands are applied in the sample stream instead.
+   * \return true if set_command_time() is implemented by the device
+   */
+  virtual bool has_timed_commands( void ) { return false; }
+
+  /*!
+   * Set the time at which subsequent frequency and gain changes take
+   * effect.
+   * \param time_spec the time at which the commands take effect
+   * \param mboard the motherboard index 0 to M-1
+   * \return true if the device schedules the commands itself, false to
+   *         have them applied in the sample stream
+   */
+  virtual bool set_command_time(const ::osmosdr::time_spec_t &time_spec,
+                                size_t mboard = 0) { return false; }
+
+  /*!
+   * Clear the command time so subsequent commands are applied immediately.
+   * \param mboard the motherboard index 0 to M-1
+   */
+  virtual void clear_command_time(size_t mboard = 0) { }
 };
 
 #endif // OSMOSDR_SOURCE_IFACE_H
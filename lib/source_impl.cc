@@ -92,7 +92,21 @@
 #include <xtrx_source_c.h>
 #endif
 
+#ifdef ENABLE_SIM
+#include <sim_source_c.h>
+#endif
+
+#ifdef ENABLE_SHM
+#include <shm_source_c.h>
+#endif
+
+#ifdef ENABLE_TIMESHIFT
+#include <timeshift_ring.h>
+#include <timeshift_source_c.h>
+#endif
+
 #include "arg_helpers.h"
+#include "trace.h"
 #include "source_impl.h"
 
 /*
@@ -165,6 +179,15 @@ source_impl::source_impl( const std::string &args )
 #endif
 #ifdef ENABLE_XTRX
   dev_types.push_back("xtrx");
+#endif
+#ifdef ENABLE_SIM
+  dev_types.push_back("sim");
+#endif
+#ifdef ENABLE_SHM
+  dev_types.push_back("shm");
+#endif
+#ifdef ENABLE_TIMESHIFT
+  dev_types.push_back("rewind");
 #endif
   std::cerr << "gr-osmosdr "
             << GR_OSMOSDR_VERSION << " (" << GR_OSMOSDR_LIBVER << ") "
@@ -260,6 +283,8 @@ source_impl::source_impl( const std::string &args )
 
     dict_t dict = params_to_dict(arg);
 
+    OSMOSDR_TRACE_START( dict.count("trace") ? dict["trace"] : "" );
+
 //    std::cerr << std::endl;
 //    for (dict_t::value_type &entry : dict)
 //      std::cerr << "'" << entry.first << "' = '" << entry.second << "'" << std::endl;
@@ -376,9 +401,43 @@ source_impl::source_impl( const std::string &args )
     }
 #endif
 
+#ifdef ENABLE_SIM
+    if ( dict.count("sim") ) {
+      sim_source_c_sptr src = make_sim_source_c( arg );
+      block = src; iface = src.get();
+    }
+#endif
+
+#ifdef ENABLE_SHM
+    if ( dict.count("shm") ) {
+      shm_source_c_sptr src = make_shm_source_c( arg );
+      block = src; iface = src.get();
+    }
+#endif
+
+#ifdef ENABLE_TIMESHIFT
+    if ( dict.count("rewind") ) {
+      timeshift_source_c_sptr src = make_timeshift_source_c( arg );
+      block = src; iface = src.get();
+    }
+#endif
+
     if ( iface != NULL && long(block.get()) != 0 ) {
       _devs.push_back( iface );
 
+      /* on request, timed commands the device cannot schedule are applied
+       * in its stream; the tap costs a copy per work() so it is opt-in */
+      if ( dict.count("timed_cmds") && dict["timed_cmds"] != "0" &&
+           ! iface->has_timed_commands() ) {
+        timed_command_tap_sptr tap = timed_command_tap::make( iface );
+
+        for (size_t i = 0; i < iface->get_num_channels(); i++)
+          connect(block, i, tap, i);
+
+        _cmd_taps[ iface ] = tap;
+        block = tap;
+      }
+
       for (size_t i = 0; i < iface->get_num_channels(); i++) {
 #ifdef HAVE_IQBALANCE
         gr::iqbalance::optimize_c::sptr iq_opt = gr::iqbalance::optimize_c::make( 0 );
@@ -396,6 +455,19 @@ source_impl::source_impl( const std::string &args )
         connect(block, i, self(), channel++);
 #endif
       }
+
+#ifdef ENABLE_TIMESHIFT
+      /* taps the device before any correction, like a recording would;
+       * behind a command tap it follows the rx_freq tags of timed retunes */
+      if ( timeshift_sink::requested( arg ) ) {
+        timeshift_sink_sptr ring = timeshift_sink::make( arg, iface );
+
+        for (size_t i = 0; i < iface->get_num_channels(); i++)
+          connect(block, i, ring, i);
+
+        _timeshift[ iface ] = ring;
+      }
+#endif
     } else if ( (iface != NULL) || (long(block.get()) != 0) )
       throw std::runtime_error("Either iface or block are NULL.");
 
@@ -426,6 +498,17 @@ bool source_impl::seek( long seek_point, int whence, size_t chan )
   return false;
 }
 
+bool source_impl::seek_time( const ::osmosdr::time_spec_t &time, size_t chan )
+{
+  size_t channel = 0;
+  for (source_iface *dev : _devs)
+    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
+      if ( chan == channel++ )
+        return dev->seek_time( time, dev_chan );
+
+  return false;
+}
+
 #define NO_DEVICES_MSG  "FATAL: No device(s) available to work with."
 
 osmosdr::meta_range_t source_impl::get_sample_rates()
@@ -441,6 +524,7 @@ osmosdr::meta_range_t source_impl::get_sample_rates()
 
 double source_impl::set_sample_rate(double rate)
 {
+  OSMOSDR_TRACE_SCOPE( "ctrl", "set_sample_rate" );
   double sample_rate = 0;
 
   if (_sample_rate != rate) {
@@ -448,8 +532,13 @@ double source_impl::set_sample_rate(double rate)
     if (_devs.empty())
       throw std::runtime_error(NO_DEVICES_MSG);
 #endif
-    for (source_iface *dev : _devs)
+    for (source_iface *dev : _devs) {
       sample_rate = dev->set_sample_rate(rate);
+#ifdef ENABLE_TIMESHIFT
+      if ( _timeshift.count( dev ) )
+        _timeshift[ dev ]->set_sample_rate( dev->get_sample_rate() );
+#endif
+    }
 
 #ifdef HAVE_IQBALANCE
     size_t channel = 0;
@@ -501,12 +590,23 @@ osmosdr::freq_range_t source_impl::get_freq_range( size_t chan )
 
 double source_impl::set_center_freq( double freq, size_t chan )
 {
+  OSMOSDR_TRACE_SCOPE( "ctrl", "set_center_freq" );
   size_t channel = 0;
   for (source_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
       if ( chan == channel++ ) {
         if ( _center_freq[ chan ] != freq ) {
           _center_freq[ chan ] = freq;
+          if ( _cmd_emulated.count( dev ) ) {
+            _cmd_taps[ dev ]->push( [dev, freq, dev_chan]() {
+              dev->set_center_freq( freq, dev_chan );
+            }, dev_chan );
+            return freq;
+          }
+#ifdef ENABLE_TIMESHIFT
+          if ( dev_chan == 0 && _timeshift.count( dev ) )
+            _timeshift[ dev ]->set_center_freq( freq );
+#endif
           return dev->set_center_freq( freq, dev_chan );
         } else { return _center_freq[ chan ]; }
       }
@@ -527,6 +627,7 @@ double source_impl::get_center_freq( size_t chan )
 
 double source_impl::set_freq_corr( double ppm, size_t chan )
 {
+  OSMOSDR_TRACE_SCOPE( "ctrl", "set_freq_corr" );
   size_t channel = 0;
   for (source_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
@@ -586,6 +687,7 @@ osmosdr::gain_range_t source_impl::get_gain_range( const std::string & name, siz
 
 bool source_impl::set_gain_mode( bool automatic, size_t chan )
 {
+  OSMOSDR_TRACE_SCOPE( "ctrl", "set_gain_mode" );
   size_t channel = 0;
   for (source_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
@@ -615,12 +717,19 @@ bool source_impl::get_gain_mode( size_t chan )
 
 double source_impl::set_gain( double gain, size_t chan )
 {
+  OSMOSDR_TRACE_SCOPE( "ctrl", "set_gain" );
   size_t channel = 0;
   for (source_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
       if ( chan == channel++ ) {
         if ( _gain[ chan ] != gain ) {
           _gain[ chan ] = gain;
+          if ( _cmd_emulated.count( dev ) ) {
+            _cmd_taps[ dev ]->push( [dev, gain, dev_chan]() {
+              dev->set_gain( gain, dev_chan );
+            } );
+            return gain;
+          }
           return dev->set_gain( gain, dev_chan );
         } else { return _gain[ chan ]; }
       }
@@ -630,11 +739,19 @@ double source_impl::set_gain( double gain, size_t chan )
 
 double source_impl::set_gain( double gain, const std::string & name, size_t chan)
 {
+  OSMOSDR_TRACE_SCOPE( "ctrl", "set_gain" );
   size_t channel = 0;
   for (source_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
+      if ( chan == channel++ ) {
+        if ( _cmd_emulated.count( dev ) ) {
+          _cmd_taps[ dev ]->push( [dev, gain, name, dev_chan]() {
+            dev->set_gain( gain, name, dev_chan );
+          } );
+          return gain;
+        }
         return dev->set_gain( gain, name, dev_chan );
+      }
 
   return 0;
 }
@@ -663,6 +780,7 @@ double source_impl::get_gain( const std::string & name, size_t chan )
 
 double source_impl::set_if_gain( double gain, size_t chan )
 {
+  OSMOSDR_TRACE_SCOPE( "ctrl", "set_if_gain" );
   size_t channel = 0;
   for (source_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
@@ -678,6 +796,7 @@ double source_impl::set_if_gain( double gain, size_t chan )
 
 double source_impl::set_bb_gain( double gain, size_t chan )
 {
+  OSMOSDR_TRACE_SCOPE( "ctrl", "set_bb_gain" );
   size_t channel = 0;
   for (source_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
@@ -704,6 +823,7 @@ std::vector< std::string > source_impl::get_antennas( size_t chan )
 
 std::string source_impl::set_antenna( const std::string & antenna, size_t chan )
 {
+  OSMOSDR_TRACE_SCOPE( "ctrl", "set_antenna" );
   size_t channel = 0;
   for (source_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
@@ -816,6 +936,7 @@ void source_impl::set_iq_balance( const std::complex<double> &balance, size_t ch
 
 double source_impl::set_bandwidth( double bandwidth, size_t chan )
 {
+  OSMOSDR_TRACE_SCOPE( "ctrl", "set_bandwidth" );
   size_t channel = 0;
   for (source_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
@@ -949,3 +1070,67 @@ void source_impl::set_time_unknown_pps(const osmosdr::time_spec_t &time_spec)
     dev->set_time_unknown_pps( time_spec );
   }
 }
+
+void source_impl::set_command_time(const osmosdr::time_spec_t &time_spec, size_t mboard)
+{
+  std::vector< source_iface * > devs = _devs;
+
+  if (mboard != osmosdr::ALL_MBOARDS)
+    devs.assign( 1, _devs.at(mboard) );
+
+  for (source_iface *dev : devs) {
+    bool scheduled = (mboard != osmosdr::ALL_MBOARDS) ?
+                     dev->set_command_time( time_spec ) :
+                     dev->set_command_time( time_spec, osmosdr::ALL_MBOARDS );
+
+    if ( scheduled )
+      continue;
+
+    if ( _cmd_taps.count( dev ) ) { /* applied at the sample of that time */
+      _cmd_emulated.insert( dev );
+      _cmd_taps[ dev ]->begin( time_spec );
+    } else {
+      std::cerr << "gr-osmosdr: device cannot time commands, applying them "
+                << "immediately (open it with timed_cmds=1 to emulate)"
+                << std::endl;
+    }
+  }
+}
+
+void source_impl::clear_command_time(size_t mboard)
+{
+  std::vector< source_iface * > devs = _devs;
+
+  if (mboard != osmosdr::ALL_MBOARDS)
+    devs.assign( 1, _devs.at(mboard) );
+
+  for (source_iface *dev : devs) {
+    if ( _cmd_emulated.erase( dev ) ) {
+      _cmd_taps[ dev ]->commit();
+    } else {
+      if (mboard != osmosdr::ALL_MBOARDS)
+        dev->clear_command_time();
+      else
+        dev->clear_command_time( osmosdr::ALL_MBOARDS );
+    }
+  }
+}
+
+osmosdr::source::sptr source_impl::time_shift( const ::osmosdr::time_spec_t &time, size_t chan )
+{
+#ifdef ENABLE_TIMESHIFT
+  size_t channel = 0;
+  for (source_iface *dev : _devs)
+    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
+      if ( chan == channel++ ) {
+        if ( ! _timeshift.count( dev ) )
+          throw std::runtime_error("The device was opened without timeshift=.");
+
+        return osmosdr::source::make( _timeshift[ dev ]->playback_args( time ) );
+      }
+
+  throw std::runtime_error("No such channel.");
+#else
+  throw std::runtime_error("Built without time-shift support.");
+#endif
+}
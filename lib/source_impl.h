@@ -29,7 +29,15 @@
 
 #include <source_iface.h>
 
+#include "timed_command_tap.h"
+
+#ifdef ENABLE_TIMESHIFT
+#include "timeshift_ring.h"
+#endif
+
 #include <map>
+#include <memory>
+#include <set>
 
 class source_impl : public osmosdr::source
 {
@@ -39,6 +47,7 @@ public:
   size_t get_num_channels( void );
 
   bool seek( long seek_point, int whence, size_t chan );
+  bool seek_time( const ::osmosdr::time_spec_t &time, size_t chan );
 
   osmosdr::meta_range_t get_sample_rates( void );
   double set_sample_rate( double rate );
@@ -91,6 +100,12 @@ public:
   void set_time_next_pps(const ::osmosdr::time_spec_t &time_spec);
   void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec);
 
+  void set_command_time(const ::osmosdr::time_spec_t &time_spec,
+                        size_t mboard = osmosdr::ALL_MBOARDS);
+  void clear_command_time(size_t mboard = osmosdr::ALL_MBOARDS);
+
+  osmosdr::source::sptr time_shift( const ::osmosdr::time_spec_t &time, size_t chan = 0 );
+
 private:
   std::vector< source_iface * > _devs;
 
@@ -109,6 +124,15 @@ private:
   std::map< size_t, std::pair<float, float> > _vals;
 #endif
   std::map< size_t, double > _bandwidth;
+
+  /* taps of the devices without timed commands, and those collecting */
+  std::map< source_iface *, timed_command_tap_sptr > _cmd_taps;
+  std::set< source_iface * > _cmd_emulated;
+
+#ifdef ENABLE_TIMESHIFT
+  /* rings of the devices opened with timeshift= */
+  std::map< source_iface *, timeshift_sink_sptr > _timeshift;
+#endif
 };
 
 #endif /* INCLUDED_OSMOSDR_SOURCE_IMPL_H */
@@ -0,0 +1,252 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_SPSC_RING_H
+#define INCLUDED_OSMOSDR_SPSC_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "buffer_allocator.h"
+
+/*!
+ * \brief Bounded, lock-free single producer / single consumer ring.
+ *
+ * Intended to hand whole transfer buffers (or pointers to them) from a
+ * driver callback thread to work() without taking a lock. Exactly one
+ * thread may call push() and exactly one other thread may call pop().
+ * The slots come from \p alloc, so a ring of samples honours the
+ * device's hugepages=, mlock= and numa= options.
+ */
+template <typename T>
+class spsc_ring
+{
+public:
+  explicit spsc_ring(size_t capacity = 0,
+                     const buffer_allocator &alloc = buffer_allocator()) :
+    _slots(capacity + 1, T(), buffer_allocator_adaptor<T>(alloc)),
+    _head(0), _tail(0)
+  {
+  }
+
+  /* Must not be called while either side is active */
+  void reset(size_t capacity)
+  {
+    _slots.assign(capacity + 1, T());
+    _head.store(0, std::memory_order_relaxed);
+    _tail.store(0, std::memory_order_relaxed);
+  }
+
+  void reset(size_t capacity, const buffer_allocator &alloc)
+  {
+    _slots = slots_t(buffer_allocator_adaptor<T>(alloc));
+    reset(capacity);
+  }
+
+  size_t capacity() const { return _slots.size() - 1; }
+
+  /* Producer side: returns false if the ring is full */
+  bool push(const T &item)
+  {
+    const size_t head = _head.load(std::memory_order_relaxed);
+    const size_t next = (head + 1) % _slots.size();
+
+    if (next == _tail.load(std::memory_order_acquire))
+      return false;
+
+    _slots[head] = item;
+    _head.store(next, std::memory_order_release);
+
+    return true;
+  }
+
+  /* Consumer side: returns false if the ring is empty */
+  bool pop(T &item)
+  {
+    const size_t tail = _tail.load(std::memory_order_relaxed);
+
+    if (tail == _head.load(std::memory_order_acquire))
+      return false;
+
+    item = _slots[tail];
+    _tail.store((tail + 1) % _slots.size(), std::memory_order_release);
+
+    return true;
+  }
+
+  /* Approximate occupancy, exact when called from either side */
+  size_t size() const
+  {
+    const size_t head = _head.load(std::memory_order_acquire);
+    const size_t tail = _tail.load(std::memory_order_acquire);
+
+    return (head + _slots.size() - tail) % _slots.size();
+  }
+
+  bool empty() const { return size() == 0; }
+
+private:
+  typedef std::vector< T, buffer_allocator_adaptor<T> > slots_t;
+
+  slots_t _slots;
+
+  /* keep producer and consumer indices on separate cache lines; plain
+   * padding rather than alignas() since we build as C++11 */
+  char _pad0[64];
+  std::atomic<size_t> _head;
+  char _pad1[64 - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> _tail;
+};
+
+/*!
+ * \brief Lock-free single producer / single consumer ring of plain samples.
+ *
+ * Unlike spsc_ring, which passes one element per call, this exposes the
+ * contiguous free / filled regions so that either side can convert or
+ * copy whole blocks straight into or out of the ring. T must be trivially
+ * copyable. The capacity is rounded up to a power of two, the storage
+ * comes from a buffer_allocator like spsc_ring's.
+ */
+template <typename T>
+class spsc_sample_ring
+{
+public:
+  explicit spsc_sample_ring(size_t capacity = 0,
+                            const buffer_allocator &alloc = buffer_allocator()) :
+    _buf(buffer_allocator_adaptor<T>(alloc)), _head(0), _tail(0)
+  {
+    reset(capacity);
+  }
+
+  void reset(size_t capacity, const buffer_allocator &alloc)
+  {
+    _buf = buf_t(buffer_allocator_adaptor<T>(alloc));
+    reset(capacity);
+  }
+
+  /* Must not be called while either side is active */
+  void reset(size_t capacity)
+  {
+    size_t size = 1;
+    while (size < capacity)
+      size <<= 1;
+
+    _buf.assign(size, T());
+    _mask = size - 1;
+    _head.store(0, std::memory_order_relaxed);
+    _tail.store(0, std::memory_order_relaxed);
+  }
+
+  size_t capacity() const { return _buf.size(); }
+
+  /* Producer side */
+  size_t write_available() const
+  {
+    return _buf.size() - (_head.load(std::memory_order_relaxed) -
+                          _tail.load(std::memory_order_acquire));
+  }
+
+  /* Contiguous writable region, may be shorter than write_available() */
+  size_t write_span(T *&ptr)
+  {
+    const size_t head = _head.load(std::memory_order_relaxed);
+    const size_t avail = write_available();
+
+    ptr = &_buf[head & _mask];
+    return std::min(avail, _buf.size() - (head & _mask));
+  }
+
+  void commit(size_t n)
+  {
+    _head.store(_head.load(std::memory_order_relaxed) + n,
+                std::memory_order_release);
+  }
+
+  /* Copies as much of src as fits, returns the number of items written */
+  size_t write(const T *src, size_t n)
+  {
+    size_t done = 0;
+    T *dst;
+
+    for (int part = 0; part < 2 && done < n; ++part) {
+      size_t cnt = std::min(write_span(dst), n - done);
+      std::memcpy(dst, src + done, cnt * sizeof(T));
+      commit(cnt);
+      done += cnt;
+    }
+
+    return done;
+  }
+
+  /* Consumer side */
+  size_t read_available() const
+  {
+    return _head.load(std::memory_order_acquire) -
+           _tail.load(std::memory_order_relaxed);
+  }
+
+  /* Contiguous readable region, may be shorter than read_available() */
+  size_t read_span(const T *&ptr) const
+  {
+    const size_t tail = _tail.load(std::memory_order_relaxed);
+    const size_t avail = read_available();
+
+    ptr = &_buf[tail & _mask];
+    return std::min(avail, _buf.size() - (tail & _mask));
+  }
+
+  void consume(size_t n)
+  {
+    _tail.store(_tail.load(std::memory_order_relaxed) + n,
+                std::memory_order_release);
+  }
+
+  /* Copies up to n items into dst, returns the number of items read */
+  size_t read(T *dst, size_t n)
+  {
+    size_t done = 0;
+    const T *src;
+
+    for (int part = 0; part < 2 && done < n; ++part) {
+      size_t cnt = std::min(read_span(src), n - done);
+      std::memcpy(dst + done, src, cnt * sizeof(T));
+      consume(cnt);
+      done += cnt;
+    }
+
+    return done;
+  }
+
+private:
+  typedef std::vector< T, buffer_allocator_adaptor<T> > buf_t;
+
+  buf_t _buf;
+  size_t _mask;
+
+  /* free running counters, see spsc_ring for the padding */
+  char _pad0[64];
+  std::atomic<size_t> _head;
+  char _pad1[64 - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> _tail;
+};
+
+#endif /* INCLUDED_OSMOSDR_SPSC_RING_H */
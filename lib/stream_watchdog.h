@@ -0,0 +1,195 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_STREAM_WATCHDOG_H
+#define INCLUDED_OSMOSDR_STREAM_WATCHDOG_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+#include <boost/thread/thread.hpp>
+
+#include <pmt/pmt.h>
+
+#include "arg_helpers.h"
+
+/*!
+ * \brief Detects a receive stream that silently stopped delivering.
+ *
+ * The transfer callback reports every transfer, work() asks stalled()
+ * while it waits for data. A stream is stalled when no transfer arrived
+ * for watchdog=N (default 10) expected transfer intervals, but never
+ * less than 100 ms; watchdog=0 disables the check.
+ *
+ * After the backend restarted streaming it calls restarted() with the
+ * number of samples still buffered from before the stall. work() then
+ * asks gap_offset() where to put the rx_gap tag, whose value is the
+ * estimated number of samples lost.
+ *
+ * A device that disappeared from the bus altogether is waited for with
+ * reattach() for up to reconnect=S seconds (default 30, 0 gives up right
+ * away); the backend reopens it by serial number and tags the gap the
+ * same way.
+ */
+class stream_watchdog
+{
+public:
+  stream_watchdog() : _multiple(10), _reconnect(30) { reset(); }
+
+  void configure( const dict_t &dict )
+  {
+    dict_t::const_iterator it = dict.find( "watchdog" );
+    if ( it != dict.end() )
+      _multiple = std::max( 0.0, atof( it->second.c_str() ) );
+
+    it = dict.find( "reconnect" );
+    if ( it != dict.end() )
+      _reconnect = std::max( 0.0, atof( it->second.c_str() ) );
+  }
+
+  bool enabled() const { return _multiple > 0; }
+
+  bool may_reattach() const { return _reconnect > 0; }
+
+  /* call from start() */
+  void reset()
+  {
+    _last = _last_data = _since = now();
+    _samples = 0;
+    _measure = false;
+    _lost = 0;
+    _gap_pending = false;
+  }
+
+  /* transfer callback, for every transfer that is passed on */
+  void transfer( size_t samples, double rate )
+  {
+    int64_t t = now();
+
+    if ( _measure.exchange( false ) ) {
+      double missing = (t - _last_data) * 1e-9 * rate - double(samples);
+      _lost = uint64_t( std::max( 0.0, missing ) );
+    }
+
+    _samples = samples;
+    _last = _last_data = t;
+  }
+
+  /* transfer callback, for transfers that are dropped on purpose */
+  void alive( size_t samples )
+  {
+    _samples = samples;
+    _last = now();
+  }
+
+  /* work() */
+  std::chrono::milliseconds timeout( double rate ) const
+  {
+    double interval = (rate > 0 && _samples) ? _samples / rate : 0.1;
+    return std::chrono::milliseconds(
+          std::max( int64_t( 100 ), int64_t( _multiple * interval * 1e3 ) ) );
+  }
+
+  bool stalled( double rate ) const
+  {
+    int64_t quiet = now() - std::max( _last.load(), _since );
+    return enabled() && std::chrono::nanoseconds( quiet ) > timeout( rate );
+  }
+
+  double stall_seconds() const { return (now() - _last) * 1e-9; }
+
+  /* call before streaming is started again */
+  void restarted( uint64_t buffered )
+  {
+    _since = now();
+    _measure = true;
+    _gap_pending = true;
+    _gap_countdown = buffered;
+  }
+
+  /* Offset of the gap within the next n output samples, or -1 if it
+   * does not fall into them. Advances past those samples. */
+  int64_t gap_offset( uint64_t n )
+  {
+    if ( ! _gap_pending )
+      return -1;
+
+    if ( _gap_countdown < n ) {
+      _gap_pending = false;
+      return int64_t( _gap_countdown );
+    }
+
+    _gap_countdown -= n;
+    return -1;
+  }
+
+  /* Calls open() until it returns true or reconnect= seconds passed.
+   * The sleeps in between are interruption points, so stopping the
+   * flowgraph does not have to wait for the device. */
+  template < typename Open >
+  bool reattach( Open open )
+  {
+    const int64_t deadline = now() + int64_t( _reconnect * 1e9 );
+
+    while ( ! open() ) {
+      if ( now() >= deadline )
+        return false;
+
+      boost::this_thread::sleep_for( boost::chrono::milliseconds( 250 ) );
+    }
+
+    return true;
+  }
+
+  /* only meaningful once the first transfer after the restart arrived */
+  uint64_t lost() const { return _lost; }
+
+  static const pmt::pmt_t &gap_key()
+  {
+    static const pmt::pmt_t key = pmt::string_to_symbol( "rx_gap" );
+    return key;
+  }
+
+private:
+  static int64_t now()
+  {
+    return std::chrono::duration_cast< std::chrono::nanoseconds >(
+          std::chrono::steady_clock::now().time_since_epoch() ).count();
+  }
+
+  double _multiple;
+  double _reconnect;
+
+  /* written by the transfer callback, read by work() */
+  std::atomic< int64_t > _last;
+  std::atomic< int64_t > _last_data;
+  std::atomic< size_t > _samples;
+  std::atomic< bool > _measure;
+  std::atomic< uint64_t > _lost;
+
+  /* work() only */
+  int64_t _since;
+  bool _gap_pending;
+  uint64_t _gap_countdown;
+};
+
+#endif /* INCLUDED_OSMOSDR_STREAM_WATCHDOG_H */
@@ -0,0 +1,139 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/algorithm/string.hpp>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "thread_sched.h"
+
+thread_sched::thread_sched() :
+  _policy(-1), _prio(0)
+{
+}
+
+thread_sched::thread_sched( const dict_t &dict ) :
+  _policy(-1), _prio(0)
+{
+  dict_t::const_iterator it;
+
+  if ( (it = dict.find( "cpu" )) != dict.end() ) {
+    std::vector< std::string > parts;
+    boost::algorithm::split( parts, it->second, boost::is_any_of( ":" ) );
+
+    for ( const std::string &part : parts ) {
+      size_t dash = part.find( '-' );
+      char *end;
+
+      long first = strtol( part.c_str(), &end, 10 );
+      long last = first;
+      if ( dash != std::string::npos )
+        last = strtol( part.c_str() + dash + 1, &end, 10 );
+
+      if ( part.empty() || *end || first < 0 || last < first )
+        throw std::runtime_error( "Invalid cpu= argument: " + it->second );
+
+#ifdef __linux__
+      if ( last >= CPU_SETSIZE )
+        throw std::runtime_error( "cpu= values must be below " +
+                                  std::to_string( CPU_SETSIZE ) );
+#endif
+
+      for ( long cpu = first; cpu <= last; cpu++ )
+        _cpus.push_back( cpu );
+    }
+  }
+
+  if ( (it = dict.find( "rt_prio" )) != dict.end() ) {
+    _prio = atoi( it->second.c_str() );
+    if ( _prio < 1 || _prio > 99 )
+      throw std::runtime_error( "rt_prio= must be between 1 and 99" );
+  }
+
+#ifdef __linux__
+  if ( (it = dict.find( "sched" )) != dict.end() ) {
+    if ( it->second == "fifo" )
+      _policy = SCHED_FIFO;
+    else if ( it->second == "rr" )
+      _policy = SCHED_RR;
+    else if ( it->second == "other" )
+      _policy = SCHED_OTHER;
+    else
+      throw std::runtime_error( "Invalid sched= argument: " + it->second );
+  } else if ( _prio ) {
+    _policy = SCHED_FIFO;
+  }
+
+  if ( SCHED_OTHER == _policy )
+    _prio = 0;
+  else if ( _policy >= 0 && ! _prio )
+    _prio = 1;
+#else
+  if ( _prio || dict.count( "sched" ) || ! _cpus.empty() ) {
+    std::cerr << "Thread affinity and priority are not supported on this platform"
+              << std::endl;
+    _cpus.clear();
+    _prio = 0;
+  }
+#endif
+}
+
+void thread_sched::apply( const char *who ) const
+{
+#ifdef __linux__
+  if ( ! _cpus.empty() ) {
+    cpu_set_t set;
+    CPU_ZERO( &set );
+    for ( int cpu : _cpus )
+      CPU_SET( cpu, &set );
+
+    int ret = pthread_setaffinity_np( pthread_self(), sizeof(set), &set );
+    if ( ret )
+      std::cerr << "Failed to set CPU affinity of " << who << " thread: "
+                << strerror( ret ) << std::endl;
+  }
+
+  if ( _policy >= 0 ) {
+    struct sched_param param;
+    memset( &param, 0, sizeof(param) );
+    param.sched_priority = _prio;
+
+    int ret = pthread_setschedparam( pthread_self(), _policy, &param );
+    if ( ret )
+      std::cerr << "Failed to set scheduling of " << who << " thread: "
+                << strerror( ret )
+                << (EPERM == ret ? " (needs CAP_SYS_NICE or an rtprio limit)" : "")
+                << std::endl;
+  }
+#endif
+}
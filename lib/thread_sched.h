@@ -0,0 +1,72 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_THREAD_SCHED_H
+#define INCLUDED_OSMOSDR_THREAD_SCHED_H
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arg_helpers.h"
+
+/*!
+ * \brief CPU affinity and scheduling policy for streaming threads.
+ *
+ * Built from the common device arguments
+ *
+ *   cpu=2 | cpu=2-3 | cpu=1:5:7    CPUs the thread may run on
+ *   rt_prio=N                      real-time priority, 1 to 99
+ *   sched=fifo|rr|other            policy, fifo when only rt_prio is given
+ *
+ * Threads the backend spawns itself call apply() when they start. Threads
+ * owned by a driver library call apply_once() from every transfer callback,
+ * which does the work on the first callback of each new thread only.
+ * Failing to apply a setting (missing CAP_SYS_NICE, offline CPU) is
+ * reported and otherwise ignored.
+ */
+class thread_sched
+{
+public:
+  thread_sched();
+  explicit thread_sched( const dict_t &dict );
+
+  bool empty() const { return _cpus.empty() && _policy < 0; }
+
+  void apply( const char *who ) const;
+
+  void apply_once( const char *who )
+  {
+    if ( ! empty() && _applied != std::this_thread::get_id() ) {
+      _applied = std::this_thread::get_id();
+      apply( who );
+    }
+  }
+
+  /* call from start(), the next streaming thread may reuse an old id */
+  void reset() { _applied = std::thread::id(); }
+
+private:
+  std::vector< int > _cpus;
+  int _policy;
+  int _prio;
+  std::thread::id _applied;
+};
+
+#endif /* INCLUDED_OSMOSDR_THREAD_SCHED_H */
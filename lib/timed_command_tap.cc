@@ -0,0 +1,243 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <set>
+
+#include <gnuradio/io_signature.h>
+
+#include "timed_command_tap.h"
+
+timed_command_tap_sptr timed_command_tap::make( source_iface *dev )
+{
+  return gnuradio::get_initial_sptr( new timed_command_tap(
+           dev->get_num_channels(), true,
+           [dev]() { return dev->get_time_now(); },
+           [dev]() { return dev->get_sample_rate(); },
+           [dev]( size_t chan ) { return dev->get_center_freq( chan ); } ) );
+}
+
+timed_command_tap_sptr timed_command_tap::make( sink_iface *dev )
+{
+  return gnuradio::get_initial_sptr( new timed_command_tap(
+           dev->get_num_channels(), false,
+           [dev]() { return dev->get_time_now(); },
+           [dev]() { return dev->get_sample_rate(); },
+           [dev]( size_t chan ) { return dev->get_center_freq( chan ); } ) );
+}
+
+timed_command_tap::timed_command_tap( size_t nchan, bool rx,
+                                      const clock_fn_t &now,
+                                      const rate_fn_t &rate,
+                                      const freq_fn_t &freq ) :
+  gr::sync_block("timed_command_tap",
+                 gr::io_signature::make(nchan, nchan, sizeof (gr_complex)),
+                 gr::io_signature::make(nchan, nchan, sizeof (gr_complex))),
+  _nchan(nchan),
+  _rx(rx),
+  _now(now),
+  _get_rate(rate),
+  _get_freq(freq),
+  _anchored(false),
+  _anchor_sample(0),
+  _rate(0),
+  _collecting(false)
+{
+  /* the device's own tags stay on their channel */
+  set_tag_propagation_policy( TPP_ONE_TO_ONE );
+}
+
+void timed_command_tap::begin( const ::osmosdr::time_spec_t &when )
+{
+  commit();
+
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  _batch = batch_t();
+  _batch.when = when;
+  _collecting = true;
+}
+
+void timed_command_tap::push( const command_t &cmd, int retune )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  _batch.commands.push_back( cmd );
+  if ( retune >= 0 )
+    _batch.retuned.push_back( retune );
+}
+
+void timed_command_tap::commit()
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  if ( ! _collecting )
+    return;
+
+  _collecting = false;
+
+  if ( _batch.commands.empty() )
+    return;
+
+  std::vector< batch_t >::iterator it = _pending.begin();
+  while ( it != _pending.end() && ! (_batch.when < it->when) )
+    ++it;
+
+  _pending.insert( it, std::move( _batch ) );
+  _batch = batch_t();
+}
+
+bool timed_command_tap::start()
+{
+  _anchored = false;
+  return true;
+}
+
+void timed_command_tap::anchor( uint64_t sample,
+                                const ::osmosdr::time_spec_t &time,
+                                double rate )
+{
+  _anchor_sample = sample;
+  _anchor_time = time;
+  _rate = rate;
+  _anchored = true;
+}
+
+/* a receiver's own timestamps beat our estimate */
+void timed_command_tap::follow_tags( uint64_t first, int noutput_items )
+{
+  static const pmt::pmt_t rx_time = pmt::string_to_symbol( "rx_time" );
+  std::vector< gr::tag_t > tags;
+
+  get_tags_in_range( tags, 0, first, first + noutput_items, rx_time );
+
+  for ( size_t i = 0; i < tags.size(); i++ ) {
+    const pmt::pmt_t &value = tags[i].value;
+    ::osmosdr::time_spec_t time( time_t( pmt::to_uint64( pmt::tuple_ref( value, 0 ) ) ),
+                                 pmt::to_double( pmt::tuple_ref( value, 1 ) ) );
+
+    anchor( tags[i].offset, time, _rate );
+  }
+}
+
+/* the first sample at or after \p time */
+uint64_t timed_command_tap::sample_at( const ::osmosdr::time_spec_t &time ) const
+{
+  double offset = std::ceil( (time - _anchor_time).get_real_secs() * _rate - 1e-6 );
+
+  if ( offset < -double( _anchor_sample ) )
+    return 0;
+
+  return uint64_t( int64_t( _anchor_sample ) + int64_t( offset ) );
+}
+
+::osmosdr::time_spec_t timed_command_tap::time_at( uint64_t sample ) const
+{
+  return _anchor_time +
+    ::osmosdr::time_spec_t( (double( sample ) - double( _anchor_sample )) / _rate );
+}
+
+void timed_command_tap::apply( batch_t &batch, size_t offset )
+{
+  for ( command_t &cmd : batch.commands ) {
+    try {
+      cmd();
+    } catch ( std::exception &ex ) {
+      std::cerr << "timed command failed: " << ex.what() << std::endl;
+    }
+  }
+
+  if ( ! _rx )
+    return;
+
+  const ::osmosdr::time_spec_t time = time_at( nitems_read(0) + offset );
+  const pmt::pmt_t time_tag = pmt::make_tuple( pmt::from_uint64( time.get_full_secs() ),
+                                               pmt::from_double( time.get_frac_secs() ) );
+  const std::set< size_t > retuned( batch.retuned.begin(), batch.retuned.end() );
+
+  for ( size_t c = 0; c < _nchan; c++ ) {
+    const uint64_t item = nitems_written(c) + offset;
+
+    add_item_tag( c, item, pmt::string_to_symbol("rx_time"), time_tag );
+
+    if ( retuned.count( c ) )
+      add_item_tag( c, item, pmt::string_to_symbol("rx_freq"),
+                    pmt::from_double( _get_freq( c ) ) );
+  }
+}
+
+int timed_command_tap::work( int noutput_items,
+                             gr_vector_const_void_star &input_items,
+                             gr_vector_void_star &output_items )
+{
+  const uint64_t first = nitems_read(0);
+  const double rate = _get_rate();
+
+  if ( rate > 0 && ! _anchored ) {
+    /* the newest sample received is about now, the next one sent is */
+    anchor( _rx ? first + noutput_items : first, _now(), rate );
+  } else if ( rate > 0 && rate != _rate ) {
+    anchor( first, time_at( first ), rate );
+  }
+
+  if ( _rx && _anchored )
+    follow_tags( first, noutput_items );
+
+  size_t done = 0;
+
+  while ( _anchored ) {
+    batch_t batch;
+    size_t offset;
+
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+
+      if ( _pending.empty() )
+        break;
+
+      uint64_t sample = std::max< uint64_t >( sample_at( _pending.front().when ),
+                                              first + done );
+      if ( sample >= first + noutput_items )
+        break;
+
+      batch = std::move( _pending.front() );
+      _pending.erase( _pending.begin() );
+      offset = sample - first;
+    }
+
+    for ( size_t c = 0; c < _nchan; c++ )
+      memcpy( (gr_complex *)output_items[c] + done,
+              (const gr_complex *)input_items[c] + done,
+              (offset - done) * sizeof(gr_complex) );
+    done = offset;
+
+    apply( batch, offset );
+  }
+
+  for ( size_t c = 0; c < _nchan; c++ )
+    memcpy( (gr_complex *)output_items[c] + done,
+            (const gr_complex *)input_items[c] + done,
+            (noutput_items - done) * sizeof(gr_complex) );
+
+  return noutput_items;
+}
@@ -0,0 +1,120 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef OSMOSDR_TIMED_COMMAND_TAP_H
+#define OSMOSDR_TIMED_COMMAND_TAP_H
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <gnuradio/sync_block.h>
+
+#include <osmosdr/time_spec.h>
+
+#include "source_iface.h"
+#include "sink_iface.h"
+
+class timed_command_tap;
+
+typedef std::shared_ptr< timed_command_tap > timed_command_tap_sptr;
+
+/*!
+ * \brief Applies timed commands in the sample stream, for devices which
+ * cannot schedule them in hardware.
+ *
+ * For such devices opened with timed_cmds=1, source_impl puts one behind
+ * and sink_impl one in front; the samples pass through unchanged.
+ * Commands issued between begin() and commit() form one batch. work()
+ * maps the command time to a sample index through the device clock and
+ * sample rate, following the rx_time tags of the device where it has
+ * them, and applies the batch back to back when it reaches the first
+ * sample at or after that time.
+ * On the receive side that sample is tagged with rx_time and, on every
+ * channel the batch retuned, rx_freq.
+ *
+ * The driver calls are made from work(), so the stream waits for them
+ * as it would for a hardware command queue to be loaded.
+ */
+class timed_command_tap : public gr::sync_block
+{
+public:
+  typedef std::function< void( void ) > command_t;
+
+  static timed_command_tap_sptr make( source_iface *dev );
+  static timed_command_tap_sptr make( sink_iface *dev );
+
+  /*! Start collecting a batch for \p when, in the time base of the device */
+  void begin( const ::osmosdr::time_spec_t &when );
+
+  /*! Add a command to the batch; \p retune is the channel whose center
+   *  frequency it sets, or -1 */
+  void push( const command_t &cmd, int retune = -1 );
+
+  /*! Queue the collected batch */
+  void commit( void );
+
+  bool start();
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+private:
+  typedef std::function< ::osmosdr::time_spec_t( void ) > clock_fn_t;
+  typedef std::function< double( void ) > rate_fn_t;
+  typedef std::function< double( size_t ) > freq_fn_t;
+
+  struct batch_t
+  {
+    ::osmosdr::time_spec_t when;
+    std::vector< command_t > commands;
+    std::vector< size_t > retuned;
+  };
+
+  timed_command_tap( size_t nchan, bool rx, const clock_fn_t &now,
+                     const rate_fn_t &rate, const freq_fn_t &freq );
+
+  void anchor( uint64_t sample, const ::osmosdr::time_spec_t &time,
+               double rate );
+  void follow_tags( uint64_t first, int noutput_items );
+  uint64_t sample_at( const ::osmosdr::time_spec_t &time ) const;
+  ::osmosdr::time_spec_t time_at( uint64_t sample ) const;
+  void apply( batch_t &batch, size_t offset );
+
+  size_t _nchan;
+  bool _rx;
+  clock_fn_t _now;
+  rate_fn_t _get_rate;
+  freq_fn_t _get_freq;
+
+  /* work() only: the device time of one sample, and the rate from there */
+  bool _anchored;
+  uint64_t _anchor_sample;
+  ::osmosdr::time_spec_t _anchor_time;
+  double _rate;
+
+  std::mutex _mutex;
+  bool _collecting;
+  batch_t _batch;
+  std::vector< batch_t > _pending;  /* by time */
+};
+
+#endif // OSMOSDR_TIMED_COMMAND_TAP_H
@@ -0,0 +1,502 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/format.hpp>
+
+#include <gnuradio/io_signature.h>
+
+#include "arg_helpers.h"
+#include "sigmf.h"
+#include "timeshift_ring.h"
+
+/* frames start on a page boundary after the header */
+#define DATA_OFFSET 4096
+
+/* granularity at which pages behind the current position are dropped */
+#define RELEASE_BYTES (16 * 1024 * 1024)
+
+/* interleaved frames are assembled in chunks this size */
+#define INTERLEAVE_SAMPLES 8192
+
+static_assert( sizeof(timeshift_header) <= DATA_OFFSET,
+               "timeshift_header must fit in front of the data" );
+
+timeshift_ring::timeshift_ring( const std::string &path, void *mem, size_t len ) :
+  _path(path),
+  _mem(mem),
+  _len(len),
+  _header((timeshift_header *)mem),
+  _data((unsigned char *)mem + DATA_OFFSET),
+  _frame_size(file_format_size( file_format_t( _header->format ) ) * _header->nchan),
+  _released(UINT64_MAX)
+{
+}
+
+timeshift_ring::~timeshift_ring()
+{
+  munmap( _mem, _len );
+}
+
+std::unique_ptr< timeshift_ring > timeshift_ring::create( const std::string &path,
+                                                          file_format_t format,
+                                                          size_t nchan,
+                                                          uint64_t capacity )
+{
+  const size_t len = DATA_OFFSET + capacity * file_format_size( format ) * nchan;
+
+  int fd = ::open( path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+  if ( fd < 0 )
+    throw std::runtime_error( "Failed to create " + path + ": " + strerror(errno) );
+
+  /*
+   * A store into a hole the file system cannot fill raises SIGBUS, so
+   * the blocks are reserved up front where that is possible.
+   */
+  int err = 0;
+#if defined(__linux__)
+  err = posix_fallocate( fd, 0, len );
+#else
+  if ( ftruncate( fd, len ) < 0 )
+    err = errno;
+#endif
+
+  void *mem = MAP_FAILED;
+  if ( ! err ) {
+    mem = mmap( NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    if ( MAP_FAILED == mem )
+      err = errno;
+  }
+
+  ::close( fd );
+
+  if ( err ) {
+    unlink( path.c_str() );
+    throw std::runtime_error( boost::str( boost::format( "Failed to set up %s (%.1f MB): %s" )
+                                          % path % (len / 1e6) % strerror(err) ) );
+  }
+
+  timeshift_header *h = (timeshift_header *)mem;
+
+  memset( (void *)h, 0, DATA_OFFSET );
+  h->version = TIMESHIFT_VERSION;
+  h->format = format;
+  h->nchan = nchan;
+  h->writer_pid = getpid();
+  h->capacity = capacity;
+  h->head.store( 0 );
+  h->closed.store( 0 );
+  h->anchor_seq.store( 0 );
+
+  std::atomic_thread_fence( std::memory_order_release );
+  h->magic = TIMESHIFT_MAGIC;
+
+  return std::unique_ptr< timeshift_ring >( new timeshift_ring( path, mem, len ) );
+}
+
+std::unique_ptr< timeshift_ring > timeshift_ring::attach( const std::string &path )
+{
+  int fd = ::open( path.c_str(), O_RDONLY );
+  if ( fd < 0 )
+    throw std::runtime_error( "Failed to open time-shift buffer " + path + ": " + strerror(errno) );
+
+  struct stat st;
+  void *mem = MAP_FAILED;
+
+  if ( fstat( fd, &st ) == 0 && size_t(st.st_size) >= DATA_OFFSET )
+    mem = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+
+  ::close( fd );
+
+  if ( MAP_FAILED == mem )
+    throw std::runtime_error( "Failed to map time-shift buffer " + path );
+
+  const timeshift_header *h = (const timeshift_header *)mem;
+  size_t frame_size = file_format_size( file_format_t( h->format ) ) * h->nchan;
+
+  if ( h->magic != TIMESHIFT_MAGIC || h->version != TIMESHIFT_VERSION ||
+       size_t(st.st_size) < DATA_OFFSET + h->capacity * frame_size ||
+       0 == h->capacity || 0 == h->nchan ) {
+    munmap( mem, st.st_size );
+    throw std::runtime_error( path + " is not a time-shift buffer." );
+  }
+
+  return std::unique_ptr< timeshift_ring >( new timeshift_ring( path, mem, st.st_size ) );
+}
+
+uint64_t timeshift_ring::readable( uint64_t head ) const
+{
+  const uint64_t capacity = _header->capacity;
+  const uint64_t margin = std::max< uint64_t >( 1, capacity / 8 );
+
+  return head + margin > capacity ? head + margin - capacity : 0;
+}
+
+void timeshift_ring::set_anchor( uint64_t frame, const osmosdr::time_spec_t &time,
+                                 double rate )
+{
+  const uint32_t seq = _header->anchor_seq.load( std::memory_order_relaxed );
+
+  _header->anchor_seq.store( seq + 1, std::memory_order_relaxed );
+  std::atomic_thread_fence( std::memory_order_release );
+
+  _header->anchor_frame.store( frame, std::memory_order_relaxed );
+  _header->anchor_secs.store( time.get_full_secs(), std::memory_order_relaxed );
+  _header->anchor_frac.store( time.get_frac_secs(), std::memory_order_relaxed );
+  _header->sample_rate.store( rate, std::memory_order_relaxed );
+
+  _header->anchor_seq.store( seq + 2, std::memory_order_release );
+}
+
+bool timeshift_ring::anchor( uint64_t &frame, osmosdr::time_spec_t &time,
+                             double &rate ) const
+{
+  for ( ;; ) {
+    const uint32_t seq = _header->anchor_seq.load( std::memory_order_acquire );
+
+    if ( 0 == seq )
+      return false;
+
+    if ( seq & 1 )
+      continue;
+
+    frame = _header->anchor_frame.load( std::memory_order_relaxed );
+    time = osmosdr::time_spec_t( time_t( _header->anchor_secs.load( std::memory_order_relaxed ) ),
+                                 _header->anchor_frac.load( std::memory_order_relaxed ) );
+    rate = _header->sample_rate.load( std::memory_order_relaxed );
+
+    std::atomic_thread_fence( std::memory_order_acquire );
+    if ( _header->anchor_seq.load( std::memory_order_relaxed ) == seq )
+      return rate > 0;
+  }
+}
+
+osmosdr::time_spec_t timeshift_ring::time_of( uint64_t frame ) const
+{
+  uint64_t anchor_frame;
+  osmosdr::time_spec_t time;
+  double rate;
+
+  if ( ! anchor( anchor_frame, time, rate ) )
+    return osmosdr::time_spec_t();
+
+  return time + osmosdr::time_spec_t( (double(frame) - double(anchor_frame)) / rate );
+}
+
+bool timeshift_ring::frame_at( const osmosdr::time_spec_t &time, uint64_t &frame ) const
+{
+  uint64_t anchor_frame;
+  osmosdr::time_spec_t anchor_time;
+  double rate;
+
+  if ( ! anchor( anchor_frame, anchor_time, rate ) )
+    return false;
+
+  const double offset = std::floor( (time - anchor_time).get_real_secs() * rate + 0.5 );
+
+  if ( offset < -double(anchor_frame) )
+    return false;
+
+  frame = anchor_frame + int64_t( offset );
+
+  return true;
+}
+
+/*
+ * Pages of a shared file mapping keep their contents in the page cache
+ * when unmapped, so this only bounds our resident size.
+ */
+void timeshift_ring::release( uint64_t frame )
+{
+  const uint64_t data_len = _header->capacity * _frame_size;
+  const uint64_t offset = (frame % _header->capacity) * _frame_size;
+  const uint64_t start = offset - offset % RELEASE_BYTES;
+
+  if ( start == _released )
+    return;
+
+  if ( _released < data_len )
+    madvise( _data + _released,
+             std::min< uint64_t >( RELEASE_BYTES, data_len - _released ),
+             MADV_DONTNEED );
+
+  _released = start;
+}
+
+bool timeshift_ring::writer_alive() const
+{
+  if ( _header->closed.load( std::memory_order_acquire ) )
+    return false;
+
+  return kill( _header->writer_pid, 0 ) == 0 || errno != ESRCH;
+}
+
+/* the width the hardware delivers, so that nothing is lost or padded */
+static file_format_t native_format( const dict_t &dict )
+{
+  if ( dict.count("rtl") || dict.count("rtl_tcp") )
+    return FILE_CU8;
+
+  if ( dict.count("hackrf") )
+    return FILE_CS8;
+
+  return FILE_CS16;
+}
+
+bool timeshift_sink::requested( const std::string &args )
+{
+  return params_to_dict( args ).count("timeshift") > 0;
+}
+
+timeshift_sink_sptr timeshift_sink::make( const std::string &args, source_iface *dev )
+{
+  return gnuradio::get_initial_sptr( new timeshift_sink( args, dev ) );
+}
+
+timeshift_sink::timeshift_sink( const std::string &args, source_iface *dev ) :
+  gr::sync_block("timeshift_sink",
+                 gr::io_signature::make(dev->get_num_channels(),
+                                        dev->get_num_channels(),
+                                        sizeof (gr_complex)),
+                 gr::io_signature::make(0, 0, 0)),
+  _dev(dev),
+  _nchan(dev->get_num_channels()),
+  _seconds(0),
+  _temporary(false),
+  _anchored(false),
+  _rate(0),
+  _rate_change(0)
+{
+  static std::atomic< unsigned int > count( 0 );
+
+  dict_t dict = params_to_dict( args );
+
+  _seconds = boost::lexical_cast< double >( dict["timeshift"] );
+  if ( ! (_seconds > 0) )
+    throw std::runtime_error("Parameter 'timeshift' must be a positive number of seconds.");
+
+  _format = native_format( dict );
+  if ( dict.count("timeshift_format") )
+    _format = file_format_from_string( dict["timeshift_format"] );
+
+  if ( dict.count("timeshift_file") ) {
+    _path = dict["timeshift_file"];
+  } else {
+    const char *dir = getenv( "TMPDIR" );
+
+    _path = boost::str( boost::format( "%s/osmosdr-timeshift-%d-%u.ring" )
+                        % (dir ? dir : "/var/tmp") % getpid() % count++ );
+    _temporary = true;
+  }
+
+  if ( _nchan > 1 )
+    _frames.resize( std::max< size_t >( 1, INTERLEAVE_SAMPLES / _nchan ) * _nchan );
+}
+
+timeshift_sink::~timeshift_sink()
+{
+  if ( ! _ring )
+    return;
+
+  _ring->header()->closed.store( 1, std::memory_order_release );
+  _ring.reset();
+
+  if ( _temporary )
+    unlink( _path.c_str() );
+}
+
+std::string timeshift_sink::playback_args( const osmosdr::time_spec_t &time )
+{
+  if ( ! _ring )
+    throw std::runtime_error("The time-shift buffer starts with the flowgraph.");
+
+  return boost::str( boost::format( "rewind='%s',nchan=%u,start=%.6f" )
+                     % _path % _nchan % time.get_real_secs() );
+}
+
+void timeshift_sink::set_sample_rate( double rate )
+{
+  _rate_change = rate;
+}
+
+void timeshift_sink::set_center_freq( double freq )
+{
+  if ( _ring )
+    _ring->header()->center_freq.store( freq, std::memory_order_relaxed );
+}
+
+bool timeshift_sink::start()
+{
+  _rate = _dev->get_sample_rate();
+  _rate_change = 0;
+  _anchored = false;
+
+  if ( _ring )
+    return true;
+
+  if ( ! (_rate > 0) )
+    throw std::runtime_error("The time-shift buffer needs a sample rate.");
+
+  /* an eighth on top keeps the requested span clear of the writer */
+  const uint64_t capacity = uint64_t( std::ceil( _seconds * _rate * 8 / 7 ) );
+
+  _ring = timeshift_ring::create( _path, _format, _nchan, capacity );
+  _ring->header()->center_freq.store( _dev->get_center_freq( 0 ) );
+
+  std::cerr << boost::format( "Keeping %g s of %u channel(s) in %s (%.1f MB)" )
+               % _seconds % _nchan % _path
+               % (capacity * _ring->frame_size() / 1e6)
+            << std::endl;
+
+  return true;
+}
+
+bool timeshift_sink::stop()
+{
+  return true;
+}
+
+/*
+ * The first samples after a start are dated by the host clock, later
+ * ones by extrapolation at the sample rate. Device timestamps (rx_time),
+ * dropouts (rx_gap) and rate changes move the anchor.
+ */
+void timeshift_sink::follow_tags( int noutput_items )
+{
+  const uint64_t head = _ring->header()->head.load( std::memory_order_relaxed );
+  const uint64_t from = nitems_read( 0 );
+  std::vector< gr::tag_t > tags;
+
+  if ( ! _anchored ) {
+    osmosdr::time_spec_t span( noutput_items / _rate );
+
+    _ring->set_anchor( head, sigmf_meta::utc_now() - span, _rate );
+    _anchored = true;
+  }
+
+  double rate = _rate_change.exchange( 0 );
+  if ( rate > 0 && rate != _rate ) {
+    _ring->set_anchor( head, _ring->time_of( head ), rate );
+    _rate = rate;
+  }
+
+  get_tags_in_range( tags, 0, from, from + noutput_items );
+
+  std::stable_sort( tags.begin(), tags.end(),
+                    []( const gr::tag_t &a, const gr::tag_t &b ) {
+                      return a.offset < b.offset;
+                    } );
+
+  for ( size_t i = 0; i < tags.size(); i++ ) {
+    const uint64_t frame = head + (tags[i].offset - from);
+    const std::string key = pmt::symbol_to_string( tags[i].key );
+    const pmt::pmt_t &value = tags[i].value;
+
+    if ( "rx_time" == key ) {
+      osmosdr::time_spec_t time( time_t( pmt::to_uint64( pmt::tuple_ref( value, 0 ) ) ),
+                                 pmt::to_double( pmt::tuple_ref( value, 1 ) ) );
+
+      _ring->set_anchor( frame, time, _rate );
+    } else if ( "rx_gap" == key ) {
+      osmosdr::time_spec_t lost( pmt::to_uint64( value ) / _rate );
+
+      _ring->set_anchor( frame, _ring->time_of( frame ) + lost, _rate );
+    } else if ( "rx_rate" == key ) {
+      double rate = pmt::to_double( value );
+
+      if ( rate > 0 && rate != _rate ) {
+        _ring->set_anchor( frame, _ring->time_of( frame ), rate );
+        _rate = rate;
+      }
+    } else if ( "rx_freq" == key ) {
+      _ring->header()->center_freq.store( pmt::to_double( value ),
+                                          std::memory_order_relaxed );
+    }
+  }
+}
+
+void timeshift_sink::write( gr_vector_const_void_star &input_items,
+                            size_t offset, size_t count, uint64_t frame )
+{
+  if ( 1 == _nchan ) {
+    convert_from_complex( _format, (const gr_complex *)input_items[0] + offset,
+                          _ring->frame( frame ), count, 1.0f );
+    return;
+  }
+
+  const size_t chunk = _frames.size() / _nchan;
+  std::vector< const gr_complex * > src( _nchan );
+
+  for ( size_t done = 0; done < count; ) {
+    const size_t n = std::min( count - done, chunk );
+
+    for ( size_t c = 0; c < _nchan; c++ )
+      src[c] = (const gr_complex *)input_items[c] + offset + done;
+
+    interleave_complex( &src[0], &_frames[0], _nchan, n );
+    convert_from_complex( _format, &_frames[0], _ring->frame( frame + done ),
+                          n * _nchan, 1.0f );
+
+    done += n;
+  }
+}
+
+int timeshift_sink::work( int noutput_items,
+                          gr_vector_const_void_star &input_items,
+                          gr_vector_void_star &output_items )
+{
+  timeshift_header *h = _ring->header();
+  const uint64_t head = h->head.load( std::memory_order_relaxed );
+  const uint64_t capacity = _ring->capacity();
+
+  follow_tags( noutput_items );
+
+  /* split where the ring wraps */
+  for ( size_t done = 0; done < size_t(noutput_items); ) {
+    const uint64_t frame = head + done;
+    const size_t n = std::min< uint64_t >( noutput_items - done,
+                                           capacity - frame % capacity );
+
+    write( input_items, done, n, frame );
+    done += n;
+  }
+
+  h->head.store( head + noutput_items, std::memory_order_release );
+  _ring->release( head + noutput_items );
+
+  return noutput_items;
+}
@@ -0,0 +1,196 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_TIMESHIFT_RING_H
+#define INCLUDED_TIMESHIFT_RING_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gnuradio/sync_block.h>
+
+#include <osmosdr/time_spec.h>
+
+#include "file_convert.h"
+#include "source_iface.h"
+
+/*
+ * Ring file layout, host byte order:
+ *
+ *   timeshift_header            geometry, write position, time anchor
+ *   (padding up to 4 KiB)
+ *   capacity frames             nchan samples each, in the file format
+ *
+ * head counts the frames written since the ring was created, frame n
+ * lives at n % capacity. The writer fills frames and then advances head,
+ * it never waits for readers. Readers keep clear of the oldest eighth of
+ * the ring, which is what the writer overwrites next.
+ *
+ * The anchor ties a frame to the UTC time it was captured at; other
+ * frames are extrapolated at sample_rate. It changes under a sequence
+ * count, odd while an update is in progress.
+ */
+
+#define TIMESHIFT_MAGIC    0x315253544f4d534fULL /* "OSMOTSR1" */
+#define TIMESHIFT_VERSION  1
+
+struct timeshift_header
+{
+  uint64_t magic;
+  uint32_t version;
+  uint32_t format;                  /* file_format_t */
+  uint32_t nchan;
+  uint32_t writer_pid;
+  uint64_t capacity;                /* frames */
+  std::atomic< uint64_t > head;     /* frames written so far */
+  std::atomic< uint32_t > closed;
+  std::atomic< uint32_t > anchor_seq;
+  std::atomic< uint64_t > anchor_frame;
+  std::atomic< int64_t > anchor_secs;
+  std::atomic< double > anchor_frac;
+  std::atomic< double > sample_rate;
+  std::atomic< double > center_freq;
+};
+
+/*!
+ * \brief A mapping of a time-shift ring file, as its writer or a reader.
+ */
+class timeshift_ring
+{
+public:
+  static std::unique_ptr< timeshift_ring > create( const std::string &path,
+                                                   file_format_t format,
+                                                   size_t nchan,
+                                                   uint64_t capacity );
+  static std::unique_ptr< timeshift_ring > attach( const std::string &path );
+
+  ~timeshift_ring();
+
+  timeshift_header *header() const { return _header; }
+  const std::string &path() const { return _path; }
+
+  file_format_t format() const { return file_format_t( _header->format ); }
+  size_t nchan() const { return _header->nchan; }
+  size_t frame_size() const { return _frame_size; }
+  uint64_t capacity() const { return _header->capacity; }
+
+  unsigned char *frame( uint64_t n ) const
+  {
+    return _data + (n % _header->capacity) * _frame_size;
+  }
+
+  /*
+   * Oldest frame a reader may still use: frames closer than a margin to
+   * being overwritten are left alone, so that a copy in progress is not
+   * overtaken by the writer.
+   */
+  uint64_t readable( uint64_t head ) const;
+
+  void set_anchor( uint64_t frame, const osmosdr::time_spec_t &time, double rate );
+  /* false until the writer has set one */
+  bool anchor( uint64_t &frame, osmosdr::time_spec_t &time, double &rate ) const;
+
+  osmosdr::time_spec_t time_of( uint64_t frame ) const;
+  bool frame_at( const osmosdr::time_spec_t &time, uint64_t &frame ) const;
+
+  /*! Gives the pages behind \p frame back, they stay in the page cache */
+  void release( uint64_t frame );
+
+  bool writer_alive() const;
+
+private:
+  timeshift_ring( const std::string &path, void *mem, size_t len );
+
+  std::string _path;
+  void *_mem;
+  size_t _len;
+  timeshift_header *_header;
+  unsigned char *_data;
+  size_t _frame_size;
+  uint64_t _released;       /* byte offset up to which pages were dropped */
+};
+
+class timeshift_sink;
+
+typedef std::shared_ptr< timeshift_sink > timeshift_sink_sptr;
+
+/*!
+ * \brief Keeps the last seconds of a device in a time-shift ring.
+ *
+ * source_impl connects one to the channels of every device opened with
+ * timeshift=<seconds>:
+ *
+ *   timeshift=300              seconds to keep
+ *   timeshift_file=/path       ring file, a temporary one by default
+ *   timeshift_format=cs16      width to store the samples at, cu8 / cs8 /
+ *                              cs16 / cf32; the device's own by default
+ *
+ * The ring is sized when the flowgraph starts, from the sample rate the
+ * device runs at then, and stays the same size afterwards, so disk space,
+ * memory and the per sample cost do not depend on its length. Samples are
+ * written straight into the mapping, pages behind the write position are
+ * dropped again to keep the resident size bounded.
+ */
+class timeshift_sink : public gr::sync_block
+{
+public:
+  static timeshift_sink_sptr make( const std::string &args, source_iface *dev );
+  ~timeshift_sink();
+
+  /* the device arguments ask for a ring */
+  static bool requested( const std::string &args );
+
+  /*! Device arguments of a rewind= source playing from \p time on */
+  std::string playback_args( const osmosdr::time_spec_t &time );
+
+  void set_sample_rate( double rate );
+  void set_center_freq( double freq );
+
+  bool start();
+  bool stop();
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+private:
+  timeshift_sink( const std::string &args, source_iface *dev );
+
+  void write( gr_vector_const_void_star &input_items, size_t offset,
+              size_t count, uint64_t frame );
+  void follow_tags( int noutput_items );
+
+  source_iface *_dev;
+  size_t _nchan;
+  double _seconds;
+  std::string _path;
+  bool _temporary;
+  file_format_t _format;
+  std::unique_ptr< timeshift_ring > _ring;
+
+  bool _anchored;
+  double _rate;
+  std::atomic< double > _rate_change;  /* 0 if none pending */
+  std::vector< gr_complex > _frames;
+};
+
+#endif /* INCLUDED_TIMESHIFT_RING_H */
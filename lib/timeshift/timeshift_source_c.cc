@@ -0,0 +1,375 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <gnuradio/io_signature.h>
+
+#include "timeshift_source_c.h"
+
+#include "arg_helpers.h"
+#include "sigmf.h"
+#include "stream_watchdog.h"
+#include "trace.h"
+
+/* interleaved frames are converted in chunks this size */
+#define DEINTERLEAVE_SAMPLES 8192
+
+#define POLL_MS 1
+
+timeshift_source_c_sptr make_timeshift_source_c(const std::string &args)
+{
+  return gnuradio::get_initial_sptr(new timeshift_source_c(args));
+}
+
+/* channels of the ring; the io signature has to know before attaching */
+static size_t ring_channels(const std::string &args)
+{
+  dict_t dict = params_to_dict(args);
+
+  if (dict.count("nchan"))
+    return boost::lexical_cast<size_t>(dict["nchan"]);
+
+  return 1;
+}
+
+timeshift_source_c::timeshift_source_c(const std::string &args) :
+  gr::sync_block("timeshift_source_c",
+                 gr::io_signature::make(0, 0, 0),
+                 gr::io_signature::make(ring_channels(args), ring_channels(args),
+                                        sizeof(gr_complex))),
+  _nchan(ring_channels(args)),
+  _has_start(false),
+  _start(0),
+  _next(0),
+  _lost(0),
+  _tag_position(true)
+{
+  dict_t dict = params_to_dict(args);
+  bool throttle = true;
+
+  _path = dict["rewind"];
+  if (_path.empty())
+    throw std::runtime_error("rewind= needs the path of a time-shift buffer");
+
+  _ring = timeshift_ring::attach(_path);
+
+  if (_ring->nchan() != _nchan)
+    throw std::runtime_error(boost::str(boost::format("%s holds %u channel(s), not %u")
+                                        % _path % _ring->nchan() % _nchan));
+
+  if (dict.count("start")) {
+    _start = boost::lexical_cast<double>(dict["start"]);
+    _has_start = true;
+  }
+
+  if (dict.count("throttle"))
+    throttle = ("true" == dict["throttle"] ? true : false);
+
+  if (throttle && !(get_sample_rate() > 0))
+    throw std::runtime_error(_path + " holds no samples yet");
+
+  if (throttle)
+    _pacer = std::make_shared<file_pacer>(dict, get_sample_rate(), _ring->frame_size());
+
+  if (_nchan > 1)
+    _frames.resize(std::max<size_t>(1, DEINTERLEAVE_SAMPLES / _nchan) * _nchan);
+
+  std::cerr << "Playing back " << _path << " written by pid "
+            << _ring->header()->writer_pid << std::endl;
+}
+
+timeshift_source_c::~timeshift_source_c()
+{
+}
+
+/* where start= points to, clipped to what the ring still holds */
+uint64_t timeshift_source_c::start_frame(uint64_t head)
+{
+  const uint64_t oldest = _ring->readable(head);
+  uint64_t frame = oldest;
+
+  if (_has_start) {
+    osmosdr::time_spec_t time(_start);
+
+    if (_start < 0)
+      time = sigmf_meta::utc_now() + time;
+
+    if (!_ring->frame_at(time, frame))
+      frame = oldest;
+  }
+
+  if (frame < oldest) {
+    std::cerr << "timeshift: " << (oldest - frame) / get_sample_rate()
+              << " s before the start of the buffer asked for" << std::endl;
+    frame = oldest;
+  }
+
+  return std::min(frame, head);
+}
+
+bool timeshift_source_c::start()
+{
+  _next = start_frame(_ring->header()->head.load(std::memory_order_acquire));
+  _lost = 0;
+  _tag_position = true;
+
+  if (_pacer)
+    _pacer->set_rate(get_sample_rate());
+
+  return true;
+}
+
+bool timeshift_source_c::stop()
+{
+  return true;
+}
+
+void timeshift_source_c::convert(uint64_t frame, gr_vector_void_star &output_items,
+                                 size_t offset, size_t n)
+{
+  const file_format_t format = _ring->format();
+  const uint64_t capacity = _ring->capacity();
+
+  for (size_t done = 0; done < n; ) {
+    /* up to where the ring wraps, and for interleaved frames a chunk */
+    size_t count = std::min<uint64_t>(n - done, capacity - (frame + done) % capacity);
+
+    if (1 == _nchan) {
+      convert_to_complex(format, _ring->frame(frame + done),
+                         (gr_complex *)output_items[0] + offset + done, count);
+    } else {
+      std::vector<gr_complex *> dst(_nchan);
+
+      count = std::min(count, _frames.size() / _nchan);
+
+      for (size_t c = 0; c < _nchan; c++)
+        dst[c] = (gr_complex *)output_items[c] + offset + done;
+
+      convert_to_complex(format, _ring->frame(frame + done), &_frames[0], count * _nchan);
+      deinterleave_complex(&_frames[0], &dst[0], _nchan, count);
+    }
+
+    done += count;
+  }
+}
+
+/* time and tuning of the next sample, after a start or a jump */
+void timeshift_source_c::tag_position(size_t offset)
+{
+  const timeshift_header *header = _ring->header();
+  const osmosdr::time_spec_t time = _ring->time_of(_next);
+  const uint64_t item = nitems_written(0) + offset;
+
+  for (size_t c = 0; c < _nchan; c++) {
+    add_item_tag(c, item, pmt::string_to_symbol("rx_time"),
+                 pmt::make_tuple(pmt::from_uint64(time.get_full_secs()),
+                                 pmt::from_double(time.get_frac_secs())));
+    add_item_tag(c, item, pmt::string_to_symbol("rx_rate"),
+                 pmt::from_double(get_sample_rate()));
+    add_item_tag(c, item, pmt::string_to_symbol("rx_freq"),
+                 pmt::from_double(header->center_freq.load(std::memory_order_relaxed)));
+  }
+}
+
+int timeshift_source_c::work( int noutput_items,
+                              gr_vector_const_void_star &input_items,
+                              gr_vector_void_star &output_items )
+{
+  OSMOSDR_TRACE_SCOPE( "timeshift", "work" );
+  timeshift_header *header = _ring->header();
+  int produced = 0;
+
+  if (_pacer)
+    noutput_items = _pacer->pace(noutput_items);
+
+  while (produced < noutput_items) {
+    uint64_t head = header->head.load(std::memory_order_acquire);
+    uint64_t oldest = _ring->readable(head);
+
+    if (_next < oldest) {
+      _lost += oldest - _next;
+      _next = oldest;
+      _tag_position = true;
+
+      std::cerr << "O" << std::flush;
+    }
+
+    if (_next >= head) {
+      if (produced)
+        break; /* hand out what we have rather than wait */
+
+      if (!_ring->writer_alive()) {
+        std::cerr << "timeshift: the writer of " << _path << " went away" << std::endl;
+        return WORK_DONE;
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(POLL_MS));
+      boost::this_thread::interruption_point();
+      continue;
+    }
+
+    size_t n = std::min<uint64_t>(head - _next, noutput_items - produced);
+
+    convert(_next, output_items, produced, n);
+
+    /* overwritten while we were reading it? */
+    std::atomic_thread_fence(std::memory_order_acquire);
+    head = header->head.load(std::memory_order_relaxed);
+    if (_ring->readable(head) > _next)
+      continue;
+
+    if (_tag_position) {
+      tag_position(produced);
+      _tag_position = false;
+    }
+
+    if (_lost) {
+      for (size_t c = 0; c < _nchan; c++)
+        add_item_tag(c, nitems_written(0) + produced,
+                     stream_watchdog::gap_key(), pmt::from_uint64(_lost));
+      _lost = 0;
+    }
+
+    produced += n;
+    _next += n;
+  }
+
+  return produced;
+}
+
+size_t timeshift_source_c::get_num_channels()
+{
+  return _nchan;
+}
+
+osmosdr::meta_range_t timeshift_source_c::get_sample_rates()
+{
+  osmosdr::meta_range_t range;
+
+  range.push_back(osmosdr::range_t(get_sample_rate()));
+
+  return range;
+}
+
+double timeshift_source_c::set_sample_rate( double rate )
+{
+  return get_sample_rate();
+}
+
+double timeshift_source_c::get_sample_rate()
+{
+  return _ring->header()->sample_rate.load(std::memory_order_relaxed);
+}
+
+osmosdr::freq_range_t timeshift_source_c::get_freq_range( size_t chan )
+{
+  osmosdr::freq_range_t range;
+
+  range.push_back(osmosdr::range_t(get_center_freq( chan )));
+
+  return range;
+}
+
+double timeshift_source_c::set_center_freq( double freq, size_t chan )
+{
+  return get_center_freq( chan );
+}
+
+double timeshift_source_c::get_center_freq( size_t chan )
+{
+  return _ring->header()->center_freq.load(std::memory_order_relaxed);
+}
+
+double timeshift_source_c::set_freq_corr( double ppm, size_t chan )
+{
+  return get_freq_corr( chan );
+}
+
+double timeshift_source_c::get_freq_corr( size_t chan )
+{
+  return 0;
+}
+
+std::vector<std::string> timeshift_source_c::get_gain_names( size_t chan )
+{
+  return std::vector<std::string>();
+}
+
+osmosdr::gain_range_t timeshift_source_c::get_gain_range( size_t chan )
+{
+  return osmosdr::gain_range_t();
+}
+
+osmosdr::gain_range_t timeshift_source_c::get_gain_range( const std::string & name, size_t chan )
+{
+  return get_gain_range( chan );
+}
+
+double timeshift_source_c::set_gain( double gain, size_t chan )
+{
+  return get_gain( chan );
+}
+
+double timeshift_source_c::set_gain( double gain, const std::string & name, size_t chan )
+{
+  return set_gain( gain, chan );
+}
+
+double timeshift_source_c::get_gain( size_t chan )
+{
+  return 0;
+}
+
+double timeshift_source_c::get_gain( const std::string & name, size_t chan )
+{
+  return get_gain( chan );
+}
+
+std::vector< std::string > timeshift_source_c::get_antennas( size_t chan )
+{
+  std::vector< std::string > antennas;
+
+  antennas.push_back( get_antenna( chan ) );
+
+  return antennas;
+}
+
+std::string timeshift_source_c::set_antenna( const std::string & antenna, size_t chan )
+{
+  return get_antenna( chan );
+}
+
+std::string timeshift_source_c::get_antenna( size_t chan )
+{
+  return "RX";
+}
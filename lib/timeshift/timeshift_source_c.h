@@ -0,0 +1,117 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_TIMESHIFT_SOURCE_C_H
+#define INCLUDED_TIMESHIFT_SOURCE_C_H
+
+#include <gnuradio/sync_block.h>
+
+#include <memory>
+#include <vector>
+
+#include "source_iface.h"
+#include "file_pacer.h"
+#include "timeshift_ring.h"
+
+class timeshift_source_c;
+
+typedef std::shared_ptr<timeshift_source_c> timeshift_source_c_sptr;
+
+timeshift_source_c_sptr make_timeshift_source_c (const std::string & args = "");
+
+/*!
+ * \brief Plays a time-shift ring back while the device keeps filling it.
+ *
+ *   rewind='/path/ring'   the ring, as returned by source::time_shift()
+ *   start=-30             UTC seconds of the first sample, or if negative
+ *                         seconds before now; the oldest one by default
+ *   throttle=true         real time at the capture rate (file_pacer, so
+ *                         transfer= applies), otherwise as fast as the
+ *                         flowgraph takes samples until live is reached
+ *
+ * Each channel of the device gets an output. Once playback has caught up
+ * with the writer it waits for new frames, so an unthrottled reader ends
+ * up following live. A reader that falls behind the readable part of the
+ * ring resumes at its oldest frame, prints "O" and tags the first sample
+ * after the jump with rx_gap holding the number of samples lost.
+ */
+class timeshift_source_c :
+    public gr::sync_block,
+    public source_iface
+{
+private:
+  friend timeshift_source_c_sptr make_timeshift_source_c(const std::string &args);
+
+  timeshift_source_c(const std::string &args);
+
+public:
+  ~timeshift_source_c();
+
+  bool start();
+  bool stop();
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+  size_t get_num_channels( void );
+
+  osmosdr::meta_range_t get_sample_rates( void );
+  double set_sample_rate( double rate );
+  double get_sample_rate( void );
+
+  osmosdr::freq_range_t get_freq_range( size_t chan = 0 );
+  double set_center_freq( double freq, size_t chan = 0 );
+  double get_center_freq( size_t chan = 0 );
+  double set_freq_corr( double ppm, size_t chan = 0 );
+  double get_freq_corr( size_t chan = 0 );
+
+  std::vector<std::string> get_gain_names( size_t chan = 0 );
+  osmosdr::gain_range_t get_gain_range( size_t chan = 0 );
+  osmosdr::gain_range_t get_gain_range( const std::string & name, size_t chan = 0 );
+  double set_gain( double gain, size_t chan = 0 );
+  double set_gain( double gain, const std::string & name, size_t chan = 0 );
+  double get_gain( size_t chan = 0 );
+  double get_gain( const std::string & name, size_t chan = 0 );
+
+  std::vector< std::string > get_antennas( size_t chan = 0 );
+  std::string set_antenna( const std::string & antenna, size_t chan = 0 );
+  std::string get_antenna( size_t chan = 0 );
+
+private:
+  uint64_t start_frame( uint64_t head );
+  void convert( uint64_t frame, gr_vector_void_star &output_items,
+                size_t offset, size_t n );
+  void tag_position( size_t offset );
+
+  std::string _path;
+  std::unique_ptr<timeshift_ring> _ring;
+  size_t _nchan;
+
+  bool _has_start;
+  double _start;         /* as given, negative counts back from now */
+  uint64_t _next;        /* frame to produce next */
+  uint64_t _lost;        /* frames skipped, not yet tagged */
+  bool _tag_position;
+
+  file_pacer_sptr _pacer;
+  std::vector<gr_complex> _frames;
+};
+
+#endif /* INCLUDED_TIMESHIFT_SOURCE_C_H */
@@ -0,0 +1,293 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "trace.h"
+
+#ifdef ENABLE_TRACE
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "spsc_ring.h"
+
+#define THREAD_RING_EVENTS (1 << 15)
+#define FLUSH_INTERVAL_MS 50
+
+namespace osmosdr {
+namespace trace {
+
+std::atomic<bool> enabled(false);
+
+namespace {
+
+struct thread_buffer
+{
+  thread_buffer( unsigned id ) : ring(THREAD_RING_EVENTS), tid(id),
+    dropped(0), name_written(true), released(false) {}
+
+  spsc_ring< event > ring;
+  unsigned tid;
+  std::atomic< uint64_t > dropped;
+  std::string name;   /* guarded by the writer mutex, as is the rest */
+  bool name_written;
+  bool released;      /* its thread exited, reuse once drained */
+};
+
+class writer
+{
+public:
+  writer() : _file(NULL), _first(true), _last_tid(0), _stop(false) {}
+
+  ~writer()
+  {
+    finish();
+  }
+
+  void open( const std::string &path )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    if ( _file )
+      return;
+
+    if ( ! (_file = fopen( path.c_str(), "w" )) ) {
+      std::cerr << "Could not open trace file " << path << std::endl;
+      return;
+    }
+
+    std::cerr << "Writing trace events to " << path << std::endl;
+
+    fputs( "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", _file );
+    _epoch = now();
+    _thread = std::thread( &writer::run, this );
+    enabled = true;
+  }
+
+  thread_buffer *add_thread()
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    /* buffers of exited threads are reused rather than freed, so threads
+     * restarted by the watchdog or on reattach do not add up */
+    if ( ! _free.empty() ) {
+      thread_buffer *buf = _free.back();
+      _free.pop_back();
+
+      buf->tid = ++_last_tid;
+      buf->name.clear();
+      buf->name_written = true;
+      buf->released = false;
+      return buf;
+    }
+
+    _threads.push_back( new thread_buffer( ++_last_tid ) );
+    return _threads.back();
+  }
+
+  void release( thread_buffer *buf )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    buf->released = true;
+  }
+
+  void set_name( thread_buffer *buf, const char *name )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    buf->name = name;
+    buf->name_written = false;
+  }
+
+private:
+  void run()
+  {
+    while ( ! _stop ) {
+      std::this_thread::sleep_for( std::chrono::milliseconds( FLUSH_INTERVAL_MS ) );
+      drain();
+    }
+  }
+
+  void finish()
+  {
+    if ( ! _file )
+      return;
+
+    enabled = false;
+    _stop = true;
+    _thread.join();
+
+    drain();
+
+    uint64_t dropped = 0;
+    for ( thread_buffer *buf : _threads )
+      dropped += buf->dropped;
+
+    fputs( "\n]}\n", _file );
+    fclose( _file );
+    _file = NULL;
+
+    if ( dropped )
+      std::cerr << "Trace lost " << dropped << " events" << std::endl;
+  }
+
+  void begin_event()
+  {
+    fputs( _first ? "" : ",\n", _file );
+    _first = false;
+  }
+
+  void drain()
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    event ev;
+
+    for ( thread_buffer *buf : _threads ) {
+      if ( ! buf->name_written ) {
+        begin_event();
+        fprintf( _file, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,"
+                        "\"args\":{\"name\":\"%s\"}}", buf->tid, buf->name.c_str() );
+        buf->name_written = true;
+      }
+
+      while ( buf->ring.pop( ev ) ) {
+        /* microseconds with ns resolution as the format expects */
+        double ts = int64_t( ev.ts - _epoch ) / 1e3;
+
+        begin_event();
+        fprintf( _file, "{\"ph\":\"%c\",\"cat\":\"%s\",\"name\":\"%s\",\"pid\":1,"
+                        "\"tid\":%u,\"ts\":%.3f", ev.phase, ev.cat, ev.name,
+                 buf->tid, ts );
+
+        if ( 'X' == ev.phase )
+          fprintf( _file, ",\"dur\":%.3f}", ev.arg / 1e3 );
+        else if ( 'C' == ev.phase )
+          fprintf( _file, ",\"id\":\"%p\",\"args\":{\"value\":%" PRId64 "}}",
+                   ev.id, ev.arg );
+        else
+          fputs( ",\"s\":\"t\"}", _file );
+      }
+
+      if ( buf->released ) {
+        buf->released = false;
+        _free.push_back( buf );
+      }
+    }
+
+    fflush( _file );
+  }
+
+  std::mutex _mutex;
+  std::vector< thread_buffer * > _threads;
+  std::vector< thread_buffer * > _free;
+  FILE *_file;
+  bool _first;
+  unsigned _last_tid;
+  uint64_t _epoch;
+  std::atomic< bool > _stop;
+  std::thread _thread;
+};
+
+writer &get_writer()
+{
+  static writer w;
+  return w;
+}
+
+/* trivially destructible, so still readable while the thread exits */
+thread_local bool exited = false;
+
+/* hands the buffer back when its thread exits */
+struct thread_slot
+{
+  thread_slot() : buf(NULL) {}
+
+  ~thread_slot()
+  {
+    exited = true;
+    if ( buf )
+      get_writer().release( buf );
+  }
+
+  thread_buffer *buf;
+};
+
+thread_local thread_slot slot;
+
+thread_buffer *this_thread_buffer()
+{
+  if ( exited )
+    return NULL;  /* events from later thread_local destructors are lost */
+
+  if ( ! slot.buf )
+    slot.buf = get_writer().add_thread();
+
+  return slot.buf;
+}
+
+} // anonymous namespace
+
+void start( const std::string &path )
+{
+  std::string file = path;
+
+  if ( file.empty() ) {
+    const char *env = getenv( "OSMOSDR_TRACE" );
+    if ( ! env || ! *env )
+      return;
+    file = env;
+  }
+
+  get_writer().open( file );
+}
+
+void record( const event &ev )
+{
+  thread_buffer *buf = this_thread_buffer();
+
+  if ( buf && ! buf->ring.push( ev ) )
+    buf->dropped++;
+}
+
+void set_thread_name( const char *name )
+{
+  if ( ! enabled.load( std::memory_order_relaxed ) )
+    return;
+
+  thread_buffer *buf = this_thread_buffer();
+
+  if ( buf )
+    get_writer().set_name( buf, name );
+}
+
+} // namespace trace
+} // namespace osmosdr
+
+#endif /* ENABLE_TRACE */
@@ -0,0 +1,140 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_TRACE_H
+#define INCLUDED_OSMOSDR_TRACE_H
+
+/*
+ * Hot path trace points
+ *
+ * Built only when configured with -DENABLE_TRACE=ON, otherwise every
+ * OSMOSDR_TRACE_* macro expands to nothing. When built, recording starts
+ * once a device is created with trace=<file> or when the OSMOSDR_TRACE
+ * environment variable names an output file. Each thread records into
+ * its own lock-free ring, a background thread drains the rings into a
+ * Chrome trace event JSON file that can be opened in chrome://tracing
+ * or https://ui.perfetto.dev.
+ *
+ * Category and event names must be string literals, only the pointers
+ * are recorded.
+ */
+
+#ifdef ENABLE_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace osmosdr {
+namespace trace {
+
+struct event
+{
+  const char *cat;
+  const char *name;
+  const void *id;   /* separates counters of multiple devices */
+  uint64_t ts;      /* ns */
+  int64_t arg;      /* duration in ns for 'X', value for 'C' */
+  char phase;
+};
+
+extern std::atomic<bool> enabled;
+
+/* Starts recording into path, or into $OSMOSDR_TRACE when path is empty.
+ * Later calls are ignored while a trace is being written. */
+void start( const std::string &path = "" );
+
+void record( const event &ev );
+void set_thread_name( const char *name );
+
+inline uint64_t now()
+{
+  return std::chrono::duration_cast< std::chrono::nanoseconds >(
+        std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+inline void counter( const char *cat, const char *name, const void *id, int64_t value )
+{
+  if ( enabled.load( std::memory_order_relaxed ) ) {
+    event ev = { cat, name, id, now(), value, 'C' };
+    record( ev );
+  }
+}
+
+inline void instant( const char *cat, const char *name )
+{
+  if ( enabled.load( std::memory_order_relaxed ) ) {
+    event ev = { cat, name, NULL, now(), 0, 'i' };
+    record( ev );
+  }
+}
+
+/* Records a single complete event spanning its lifetime */
+class scope
+{
+public:
+  scope( const char *cat, const char *name ) :
+    _cat(cat), _name(name),
+    _start(enabled.load( std::memory_order_relaxed ) ? now() : 0)
+  {
+  }
+
+  ~scope()
+  {
+    if ( _start && enabled.load( std::memory_order_relaxed ) ) {
+      event ev = { _cat, _name, NULL, _start, int64_t( now() - _start ), 'X' };
+      record( ev );
+    }
+  }
+
+private:
+  const char *_cat;
+  const char *_name;
+  uint64_t _start;
+};
+
+} // namespace trace
+} // namespace osmosdr
+
+#define OSMOSDR_TRACE_CONCAT_(a, b) a##b
+#define OSMOSDR_TRACE_CONCAT(a, b) OSMOSDR_TRACE_CONCAT_(a, b)
+
+#define OSMOSDR_TRACE_START(path) \
+  osmosdr::trace::start( path )
+#define OSMOSDR_TRACE_SCOPE(cat, name) \
+  osmosdr::trace::scope OSMOSDR_TRACE_CONCAT(_trace_scope_, __LINE__)( cat, name )
+#define OSMOSDR_TRACE_COUNTER(cat, name, id, value) \
+  osmosdr::trace::counter( cat, name, id, value )
+#define OSMOSDR_TRACE_INSTANT(cat, name) \
+  osmosdr::trace::instant( cat, name )
+#define OSMOSDR_TRACE_THREAD_NAME(name) \
+  osmosdr::trace::set_thread_name( name )
+
+#else
+
+#define OSMOSDR_TRACE_START(path) do {} while (0)
+#define OSMOSDR_TRACE_SCOPE(cat, name) do {} while (0)
+#define OSMOSDR_TRACE_COUNTER(cat, name, id, value) do {} while (0)
+#define OSMOSDR_TRACE_INSTANT(cat, name) do {} while (0)
+#define OSMOSDR_TRACE_THREAD_NAME(name) do {} while (0)
+
+#endif /* ENABLE_TRACE */
+
+#endif /* INCLUDED_OSMOSDR_TRACE_H */
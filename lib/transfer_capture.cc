@@ -0,0 +1,410 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include "arg_helpers.h"
+#include "transfer_capture.h"
+
+static const char CAPTURE_MAGIC[8] = { 'O', 'S', 'M', 'O', 'C', 'A', 'P', '1' };
+
+/* beyond this much unwritten data transfers are dropped instead of queued */
+#define RECORDER_MAX_QUEUED  (256 * 1024 * 1024)
+
+/* no driver hands over more than this at once, longer records are corrupt */
+#define PLAYER_MAX_TRANSFER  (64 * 1024 * 1024)
+
+transfer_recorder::transfer_recorder( const std::string &path,
+                                      const std::string &device,
+                                      double sample_rate )
+  : _path(path),
+    _quit(false),
+    _queued_bytes(0),
+    _dropped(0),
+    _started(false)
+{
+  _file = fopen( path.c_str(), "wb" );
+  if ( ! _file )
+    throw std::runtime_error( "Failed to open capture file " + path +
+                              ": " + strerror(errno) );
+
+  uint32_t name_len = device.length();
+
+  fwrite( CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC), 1, _file );
+  fwrite( &name_len, sizeof(name_len), 1, _file );
+  fwrite( device.data(), name_len, 1, _file );
+  fwrite( &sample_rate, sizeof(sample_rate), 1, _file );
+
+  std::cerr << "Recording " << device << " transfers to " << path << std::endl;
+
+  _thread = std::thread( &transfer_recorder::run, this );
+}
+
+transfer_recorder::~transfer_recorder()
+{
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    _quit = true;
+  }
+
+  _cond.notify_one();
+  _thread.join();
+
+  fclose( _file );
+
+  if ( _dropped )
+    std::cerr << "Dropped " << _dropped << " transfers while recording to "
+              << _path << std::endl;
+}
+
+void transfer_recorder::record( const void *buf, size_t len )
+{
+  clock_t::time_point now = clock_t::now();
+
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    if ( ! _started ) {
+      _first = now;
+      _started = true;
+    }
+
+    if ( _queued_bytes + len > RECORDER_MAX_QUEUED ) {
+      _dropped++;
+      return;
+    }
+
+    transfer t;
+    t.time = std::chrono::duration_cast< std::chrono::nanoseconds >(
+               now - _first ).count();
+    t.data.assign( (const unsigned char *)buf,
+                   (const unsigned char *)buf + len );
+
+    _queue.push_back( std::move( t ) );
+    _queued_bytes += len;
+  }
+
+  _cond.notify_one();
+}
+
+void transfer_recorder::run()
+{
+  std::unique_lock< std::mutex > lock( _mutex );
+
+  while ( true ) {
+    if ( _queue.empty() ) {
+      if ( _quit )
+        break;
+
+      _cond.wait( lock );
+      continue;
+    }
+
+    transfer t = std::move( _queue.front() );
+    _queue.pop_front();
+
+    lock.unlock();
+
+    uint32_t len = t.data.size();
+
+    if ( fwrite( &t.time, sizeof(t.time), 1, _file ) != 1 ||
+         fwrite( &len, sizeof(len), 1, _file ) != 1 ||
+         fwrite( t.data.data(), 1, len, _file ) != len )
+      std::cerr << "Failed to write capture file " << _path << std::endl;
+
+    lock.lock();
+    _queued_bytes -= len;
+  }
+}
+
+transfer_player::transfer_player( const std::string &path,
+                                  const std::string &device,
+                                  double speed, bool loop,
+                                  double unplug_after, double unplug_for )
+  : _speed(speed),
+    _loop(loop),
+    _unplug_after(unplug_after),
+    _unplug_for(unplug_for),
+    _transfer_size(0),
+    _cancel(false),
+    _running(false),
+    _unplugged(false)
+{
+  char magic[sizeof(CAPTURE_MAGIC)];
+  uint32_t name_len = 0;
+
+  _file = fopen( path.c_str(), "rb" );
+  if ( ! _file )
+    throw std::runtime_error( "Failed to open capture file " + path +
+                              ": " + strerror(errno) );
+
+  if ( fread( magic, sizeof(magic), 1, _file ) != 1 ||
+       memcmp( magic, CAPTURE_MAGIC, sizeof(magic) ) != 0 ||
+       fread( &name_len, sizeof(name_len), 1, _file ) != 1 ||
+       name_len > 64 ) {
+    fclose( _file );
+    throw std::runtime_error( path + " is not a capture file" );
+  }
+
+  std::string name( name_len, '\0' );
+
+  if ( fread( &name[0], 1, name_len, _file ) != name_len ||
+       fread( &_sample_rate, sizeof(_sample_rate), 1, _file ) != 1 ) {
+    fclose( _file );
+    throw std::runtime_error( path + " is truncated" );
+  }
+
+  if ( name != device ) {
+    fclose( _file );
+    throw std::runtime_error( path + " was recorded from " + name +
+                              ", not " + device );
+  }
+
+  _data_start = ftell( _file );
+
+  std::cerr << "Replaying " << device << " transfers from " << path;
+  if ( _speed > 0 && _speed != 1.0 )
+    std::cerr << " at " << _speed << "x";
+  else if ( _speed <= 0 )
+    std::cerr << " unthrottled";
+  if ( _unplug_after > 0 )
+    std::cerr << ", unplugging every " << _unplug_after << " s for "
+              << _unplug_for << " s";
+  std::cerr << std::endl;
+}
+
+transfer_player::~transfer_player()
+{
+  stop();
+  fclose( _file );
+}
+
+std::unique_ptr< transfer_player >
+transfer_player::make( const std::string &args, const std::string &device )
+{
+  dict_t dict = params_to_dict( args );
+  double speed = 1.0;
+  bool loop = false;
+  double unplug_after = 0, unplug_for = 1.0;
+
+  if ( ! dict.count("replay") )
+    return std::unique_ptr< transfer_player >();
+
+  if ( dict.count("replay_speed") )
+    speed = boost::lexical_cast< double >( dict["replay_speed"] );
+
+  if ( dict.count("replay_loop") )
+    loop = boost::lexical_cast< bool >( dict["replay_loop"] );
+
+  if ( dict.count("replay_unplug_after") )
+    unplug_after = boost::lexical_cast< double >( dict["replay_unplug_after"] );
+
+  if ( dict.count("replay_unplug_for") )
+    unplug_for = boost::lexical_cast< double >( dict["replay_unplug_for"] );
+
+  return std::unique_ptr< transfer_player >(
+           new transfer_player( dict["replay"], device, speed, loop,
+                                unplug_after, unplug_for ) );
+}
+
+void transfer_player::start( const callback_t &cb, const done_t &done,
+                             size_t transfer_size )
+{
+  stop();
+
+  _cb = cb;
+  _done = done;
+  _transfer_size = transfer_size;
+
+  launch( true );
+}
+
+void transfer_player::resume()
+{
+  stop();
+  launch( false );
+}
+
+void transfer_player::launch( bool rewind )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  _cancel = false;
+  _running = true;
+  _unplugged = false;
+  _thread = std::thread( &transfer_player::run, this, rewind );
+}
+
+void transfer_player::stop()
+{
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    _cancel = true;
+  }
+
+  _cond.notify_one();
+
+  if ( _thread.joinable() )
+    _thread.join();
+}
+
+bool transfer_player::running()
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  return _running;
+}
+
+bool transfer_player::unplugged()
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  return _unplugged;
+}
+
+bool transfer_player::replugged()
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  return _unplugged && clock_t::now() >= _replug_at;
+}
+
+/* returns false if cancelled while waiting */
+bool transfer_player::wait_until( const clock_t::time_point &deadline )
+{
+  std::unique_lock< std::mutex > lock( _mutex );
+
+  while ( ! _cancel && clock_t::now() < deadline )
+    _cond.wait_until( lock, deadline );
+
+  return ! _cancel;
+}
+
+void transfer_player::run( bool rewind )
+{
+  const callback_t &cb = _cb;
+  const size_t transfer_size = _transfer_size;
+  std::vector< unsigned char > buf;
+  size_t fill = 0;     /* bytes of a partial block kept at the front of buf */
+  clock_t::time_point base = clock_t::now();
+  uint64_t last = 0;
+  uint64_t played = 0; /* ns of recording since start or the last replug */
+  bool anchor = ! rewind;
+  bool finished = false;
+  bool unplugged = false;
+
+  if ( rewind )
+    fseek( _file, _data_start, SEEK_SET );
+
+  while ( true ) {
+    uint64_t time;
+    uint32_t len;
+
+    if ( fread( &time, sizeof(time), 1, _file ) != 1 ||
+         fread( &len, sizeof(len), 1, _file ) != 1 ) {
+      if ( ! _loop || ftell( _file ) == _data_start ) {
+        finished = true;
+        break;
+      }
+
+      /* start over, continuing the timeline where the last pass ended */
+      fseek( _file, _data_start, SEEK_SET );
+      if ( _speed > 0 )
+        base += std::chrono::duration_cast< clock_t::duration >(
+                  std::chrono::nanoseconds( uint64_t( last / _speed ) ) );
+      last = 0;
+      continue;
+    }
+
+    if ( len > PLAYER_MAX_TRANSFER ) {
+      std::cerr << "Capture file is corrupt: transfer of " << len
+                << " bytes" << std::endl;
+      finished = true;
+      break;
+    }
+
+    buf.resize( fill + len );
+    if ( fread( buf.data() + fill, 1, len, _file ) != len ) {
+      finished = true;
+      break;
+    }
+
+    /* after a replug the timeline carries on from the first transfer */
+    if ( anchor ) {
+      if ( _speed > 0 )
+        base = clock_t::now() -
+          std::chrono::duration_cast< clock_t::duration >(
+            std::chrono::nanoseconds( uint64_t( time / _speed ) ) );
+      last = time;
+      anchor = false;
+    }
+
+    played += time - last;
+    last = time;
+
+    if ( _speed > 0 ) {
+      clock_t::time_point deadline = base +
+        std::chrono::duration_cast< clock_t::duration >(
+          std::chrono::nanoseconds( uint64_t( time / _speed ) ) );
+
+      if ( ! wait_until( deadline ) )
+        break;
+    } else {
+      std::lock_guard< std::mutex > lock( _mutex );
+      if ( _cancel )
+        break;
+    }
+
+    if ( ! transfer_size ) {
+      cb( buf.data(), len );
+    } else {
+      /* re-block into what the consumer's buffers hold */
+      size_t done_bytes = 0;
+
+      fill += len;
+      for ( ; fill - done_bytes >= transfer_size; done_bytes += transfer_size )
+        cb( buf.data() + done_bytes, transfer_size );
+
+      fill -= done_bytes;
+      memmove( buf.data(), buf.data() + done_bytes, fill );
+    }
+
+    /* pretend the device dropped off the bus, a partial block goes with it */
+    if ( _unplug_after > 0 && played >= uint64_t( _unplug_after * 1e9 ) ) {
+      std::cerr << "Replay: simulating unplug for " << _unplug_for << " s"
+                << std::endl;
+      unplugged = finished = true;
+      break;
+    }
+  }
+
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    _running = false;
+    _unplugged = unplugged;
+    if ( unplugged )
+      _replug_at = clock_t::now() +
+        std::chrono::duration_cast< clock_t::duration >(
+          std::chrono::duration< double >( _unplug_for ) );
+  }
+
+  if ( finished && _done )
+    _done();
+}
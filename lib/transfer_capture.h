@@ -0,0 +1,176 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef OSMOSDR_TRANSFER_CAPTURE_H
+#define OSMOSDR_TRANSFER_CAPTURE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Capture file layout, host byte order:
+ *
+ *   "OSMOCAP1"                  magic
+ *   uint32_t                    length of the device name
+ *   char[]                      device name ("rtl", "hackrf", ...)
+ *   double                      sample rate at the time recording started
+ *
+ * followed by one record per driver transfer:
+ *
+ *   uint64_t                    arrival time in ns, relative to the first
+ *   uint32_t                    payload length in bytes
+ *   uint8_t[]                   payload exactly as handed to the callback
+ */
+
+/*!
+ * Records the raw buffers a driver passes to its streaming callback along
+ * with their arrival time. record() only copies the buffer into a queue,
+ * a background thread writes it out so the callback is not held up by
+ * the disk. If the queue grows beyond its limit transfers are dropped and
+ * counted rather than blocking the driver.
+ */
+class transfer_recorder
+{
+public:
+  transfer_recorder( const std::string &path, const std::string &device,
+                     double sample_rate );
+  ~transfer_recorder();
+
+  /*! Called from the driver callback */
+  void record( const void *buf, size_t len );
+
+private:
+  typedef std::chrono::steady_clock clock_t;
+
+  struct transfer
+  {
+    uint64_t time;
+    std::vector< unsigned char > data;
+  };
+
+  void run( void );
+
+  FILE *_file;
+  std::string _path;
+
+  std::mutex _mutex;
+  std::condition_variable _cond;
+  std::thread _thread;
+  bool _quit;
+
+  std::deque< transfer > _queue;
+  size_t _queued_bytes;
+  size_t _dropped;
+
+  bool _started;
+  clock_t::time_point _first;
+};
+
+/*!
+ * Plays a capture back into a driver callback from its own thread, either
+ * at the recorded pace (scaled by speed) or as fast as the consumer allows
+ * when speed is 0.
+ *
+ * To exercise a backend's reattach path the player can pretend the device
+ * was unplugged: after every unplug_after seconds of recording it ends the
+ * stream through the done callback with unplugged() set, and replugged()
+ * turns true once unplug_for seconds passed. resume() then carries on
+ * where playback stopped.
+ */
+class transfer_player
+{
+public:
+  typedef std::function< void( unsigned char *buf, size_t len ) > callback_t;
+  typedef std::function< void( void ) > done_t;
+
+  transfer_player( const std::string &path, const std::string &device,
+                   double speed = 1.0, bool loop = false,
+                   double unplug_after = 0, double unplug_for = 1.0 );
+  ~transfer_player();
+
+  /*!
+   * Returns a player if the device arguments contain replay=<file>, honoring
+   * replay_speed=, replay_loop=, replay_unplug_after= and replay_unplug_for=,
+   * or an empty pointer otherwise.
+   */
+  static std::unique_ptr< transfer_player > make( const std::string &args,
+                                                  const std::string &device );
+
+  double sample_rate( void ) const { return _sample_rate; }
+
+  /*!
+   * Feed the recording into \p cb from the start. \p done is called from
+   * the player thread when the end of a non looping recording is reached.
+   *
+   * With a \p transfer_size the payload is handed over in blocks of
+   * exactly that many bytes, whatever size the recorded transfers were;
+   * a partial block left at the end of the recording is dropped.
+   */
+  void start( const callback_t &cb, const done_t &done = done_t(),
+              size_t transfer_size = 0 );
+  void stop( void );
+  bool running( void );
+
+  /*! The last end of playback was a simulated unplug */
+  bool unplugged( void );
+
+  /*! The simulated device is back, poll this while waiting to reattach */
+  bool replugged( void );
+
+  /*! Continue an unplugged playback with the arguments of start() */
+  void resume( void );
+
+private:
+  typedef std::chrono::steady_clock clock_t;
+
+  void launch( bool rewind );
+  void run( bool rewind );
+  bool wait_until( const clock_t::time_point &deadline );
+
+  FILE *_file;
+  long _data_start;
+  double _sample_rate;
+  double _speed;
+  bool _loop;
+  double _unplug_after;
+  double _unplug_for;
+
+  callback_t _cb;
+  done_t _done;
+  size_t _transfer_size;
+
+  std::mutex _mutex;
+  std::condition_variable _cond;
+  std::thread _thread;
+  bool _cancel;
+  bool _running;
+  bool _unplugged;
+  clock_t::time_point _replug_at;
+};
+
+#endif // OSMOSDR_TRANSFER_CAPTURE_H
@@ -95,6 +95,10 @@ public:
   void set_time_next_pps(const ::osmosdr::time_spec_t &time_spec);
   void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec);
 
+  bool has_timed_commands();
+  bool set_command_time(const ::osmosdr::time_spec_t &time_spec, size_t mboard = 0);
+  void clear_command_time(size_t mboard = 0);
+
 private:
   double _center_freq;
   double _freq_corr;
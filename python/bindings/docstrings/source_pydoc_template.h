@@ -34,6 +34,9 @@
  static const char *__doc_osmosdr_source_seek = R"doc()doc";
 
 
+ static const char *__doc_osmosdr_source_seek_time = R"doc()doc";
+
+
  static const char *__doc_osmosdr_source_get_sample_rates = R"doc()doc";
 
 
@@ -159,4 +162,13 @@
 
  static const char *__doc_osmosdr_source_set_time_unknown_pps = R"doc()doc";
 
+
+ static const char *__doc_osmosdr_source_set_command_time = R"doc()doc";
+
+
+ static const char *__doc_osmosdr_source_clear_command_time = R"doc()doc";
+
+
+ static const char *__doc_osmosdr_source_time_shift = R"doc()doc";
+
   
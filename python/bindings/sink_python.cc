@@ -14,7 +14,7 @@
 /* BINDTOOL_GEN_AUTOMATIC(1)                                                       */
 /* BINDTOOL_USE_PYGCCXML(0)                                                        */
 /* BINDTOOL_HEADER_FILE(sink.h)                                        */
-/* BINDTOOL_HEADER_FILE_HASH(d4331eb8a19b7a2aa4ed0100039f7a0e)                     */
+/* BINDTOOL_HEADER_FILE_HASH(418d90ffe1a3917d7a88402e7044351e)                     */
 /***********************************************************************************/
 
 #include <pybind11/complex.h>
@@ -305,6 +305,19 @@ void bind_sink(py::module& m)
             D(sink,set_time_unknown_pps)
         )
 
+
+        .def("set_command_time",&sink::set_command_time,
+            py::arg("time_spec"),
+            py::arg("mboard") = ::osmosdr::ALL_MBOARDS,
+            D(sink,set_command_time)
+        )
+
+
+        .def("clear_command_time",&sink::clear_command_time,
+            py::arg("mboard") = ::osmosdr::ALL_MBOARDS,
+            D(sink,clear_command_time)
+        )
+
         ;
 
 
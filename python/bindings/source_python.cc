@@ -14,7 +14,7 @@
 /* BINDTOOL_GEN_AUTOMATIC(1)                                                       */
 /* BINDTOOL_USE_PYGCCXML(0)                                                        */
 /* BINDTOOL_HEADER_FILE(source.h)                                        */
-/* BINDTOOL_HEADER_FILE_HASH(d1a3d9ea3d815fe4f18acc3eef21f1b6)                     */
+/* BINDTOOL_HEADER_FILE_HASH(2738eba83fc2f9fed92b2549fde4b873)                     */
 /***********************************************************************************/
 
 #include <pybind11/complex.h>
@@ -58,6 +58,13 @@ void bind_source(py::module& m)
         )
 
 
+        .def("seek_time",&source::seek_time,
+            py::arg("time"),
+            py::arg("chan") = 0,
+            D(source,seek_time)
+        )
+
+
         .def("get_sample_rates",&source::get_sample_rates,
             D(source,get_sample_rates)
         )
@@ -327,6 +334,26 @@ void bind_source(py::module& m)
             D(source,set_time_unknown_pps)
         )
 
+
+        .def("set_command_time",&source::set_command_time,
+            py::arg("time_spec"),
+            py::arg("mboard") = ::osmosdr::ALL_MBOARDS,
+            D(source,set_command_time)
+        )
+
+
+        .def("clear_command_time",&source::clear_command_time,
+            py::arg("mboard") = ::osmosdr::ALL_MBOARDS,
+            D(source,clear_command_time)
+        )
+
+
+        .def("time_shift",&source::time_shift,
+            py::arg("time"),
+            py::arg("chan") = 0,
+            D(source,time_shift)
+        )
+
         ;
 
 
@@ -0,0 +1,306 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "emu_common.h"
+
+/* long enough that the tone and noise do not visibly repeat */
+#define TABLE_LEN  (1 << 18)
+
+iq_generator::iq_generator( double tone, double tone_dbfs, double noise_dbfs )
+  : _tone(tone),
+    _tone_level(pow(10.0, tone_dbfs / 20.0)),
+    _noise_level(pow(10.0, noise_dbfs / 20.0)),
+    _rate(2.048e6),
+    _pos(0)
+{
+  fill_table();
+}
+
+void iq_generator::set_sample_rate( double rate )
+{
+  if ( rate > 0 && rate != _rate ) {
+    _rate = rate;
+    fill_table();
+  }
+}
+
+void iq_generator::fill_table()
+{
+  std::mt19937 rng( 1 );
+  std::normal_distribution< float > noise( 0.0f, _noise_level / sqrt(2.0) );
+
+  /* round the tone to a whole number of cycles per table so it is
+   * continuous across the wrap */
+  double cycles = round( _tone / _rate * TABLE_LEN );
+
+  _table.resize( 2 * TABLE_LEN );
+
+  for ( size_t i = 0; i < TABLE_LEN; i++ ) {
+    double phase = 2 * M_PI * cycles * i / TABLE_LEN;
+
+    _table[2 * i + 0] = _tone_level * cos( phase ) + noise( rng );
+    _table[2 * i + 1] = _tone_level * sin( phase ) + noise( rng );
+  }
+
+  _pos = 0;
+}
+
+void iq_generator::fill_u8( uint8_t *out, size_t n )
+{
+  for ( size_t i = 0; i < 2 * n; i++ ) {
+    float v = _table[_pos] * 128.0f + 127.4f;
+    out[i] = uint8_t( std::min( 255.0f, std::max( 0.0f, roundf( v ) ) ) );
+    _pos = (_pos + 1) % _table.size();
+  }
+}
+
+void iq_generator::fill_s16( int16_t *out, size_t n )
+{
+  for ( size_t i = 0; i < 2 * n; i++ ) {
+    float v = _table[_pos] * 32767.0f;
+    out[i] = int16_t( std::min( 32767.0f, std::max( -32768.0f, roundf( v ) ) ) );
+    _pos = (_pos + 1) % _table.size();
+  }
+}
+
+sample_pacer::sample_pacer( double rate )
+  : _rate(rate)
+{
+  reset();
+}
+
+void sample_pacer::reset()
+{
+  _current_rate = _rate;
+  _start = clock_t::now();
+  _sent = 0;
+}
+
+void sample_pacer::wait( size_t samples )
+{
+  if ( _rate != _current_rate ) /* restart the timeline at the new rate */
+    reset();
+
+  _sent += samples;
+
+  clock_t::time_point deadline = _start +
+    std::chrono::duration_cast< clock_t::duration >(
+      std::chrono::duration< double >( _sent / _current_rate ) );
+
+  std::this_thread::sleep_until( deadline );
+}
+
+impairments::impairments()
+  : loss(0),
+    reorder(0),
+    stall(0),
+    stall_ms(100),
+    disconnect_after(0),
+    rng(std::random_device()())
+{
+}
+
+bool impairments::roll( double p )
+{
+  if ( p <= 0 )
+    return false;
+
+  return std::uniform_real_distribution< double >( 0, 1 )( rng ) < p;
+}
+
+enum
+{
+  OPT_BIND = 0x100,
+  OPT_PORT,
+  OPT_RATE,
+  OPT_TONE,
+  OPT_TONE_LEVEL,
+  OPT_NOISE,
+  OPT_LOSS,
+  OPT_REORDER,
+  OPT_STALL,
+  OPT_STALL_MS,
+  OPT_DISCONNECT,
+  OPT_SEED,
+  OPT_VERBOSE
+};
+
+static const struct option common_options[] =
+{
+  { "bind",             required_argument, NULL, OPT_BIND },
+  { "port",             required_argument, NULL, OPT_PORT },
+  { "rate",             required_argument, NULL, OPT_RATE },
+  { "tone",             required_argument, NULL, OPT_TONE },
+  { "tone-level",       required_argument, NULL, OPT_TONE_LEVEL },
+  { "noise",            required_argument, NULL, OPT_NOISE },
+  { "loss",             required_argument, NULL, OPT_LOSS },
+  { "reorder",          required_argument, NULL, OPT_REORDER },
+  { "stall",            required_argument, NULL, OPT_STALL },
+  { "stall-ms",         required_argument, NULL, OPT_STALL_MS },
+  { "disconnect-after", required_argument, NULL, OPT_DISCONNECT },
+  { "seed",             required_argument, NULL, OPT_SEED },
+  { "verbose",          no_argument,       NULL, OPT_VERBOSE },
+  { "help",             no_argument,       NULL, 'h' },
+};
+
+emu_options::emu_options( unsigned short port, double rate )
+  : bind("0.0.0.0"),
+    port(port),
+    rate(rate),
+    tone(100e3),
+    tone_dbfs(-20),
+    noise_dbfs(-50),
+    verbose(false)
+{
+}
+
+std::vector< struct option > emu_options::long_options( const struct option *extra )
+{
+  std::vector< struct option > opts( common_options, common_options +
+                                     sizeof(common_options) / sizeof(common_options[0]) );
+
+  for ( ; extra && extra->name; extra++ )
+    opts.push_back( *extra );
+
+  struct option end = { NULL, 0, NULL, 0 };
+  opts.push_back( end );
+
+  return opts;
+}
+
+void emu_options::usage( const char *name, const char *extra )
+{
+  fprintf( stderr,
+    "Usage: %s [options]\n"
+    "  --bind=ADDR              listen address (0.0.0.0)\n"
+    "  --port=N                 listen port\n"
+    "  --rate=SPS               initial sample rate\n"
+    "  --tone=HZ                tone offset from center (100e3)\n"
+    "  --tone-level=DBFS        tone level (-20)\n"
+    "  --noise=DBFS             noise level (-50)\n"
+    "  --loss=P                 drop probability per chunk/packet\n"
+    "  --reorder=P              probability a packet swaps with the next\n"
+    "  --stall=P                probability the sender pauses\n"
+    "  --stall-ms=MS            length of a pause (100)\n"
+    "  --disconnect-after=SEC   drop each client after SEC seconds\n"
+    "  --seed=N                 seed for the impairment generator\n"
+    "  --verbose                also log every data chunk impairment\n"
+    "%s", name, extra );
+}
+
+bool emu_options::handle( int opt, const char *arg )
+{
+  switch ( opt ) {
+  case OPT_BIND:       bind = arg; break;
+  case OPT_PORT:       port = atoi( arg ); break;
+  case OPT_RATE:       rate = atof( arg ); break;
+  case OPT_TONE:       tone = atof( arg ); break;
+  case OPT_TONE_LEVEL: tone_dbfs = atof( arg ); break;
+  case OPT_NOISE:      noise_dbfs = atof( arg ); break;
+  case OPT_LOSS:       imp.loss = atof( arg ); break;
+  case OPT_REORDER:    imp.reorder = atof( arg ); break;
+  case OPT_STALL:      imp.stall = atof( arg ); break;
+  case OPT_STALL_MS:   imp.stall_ms = atoi( arg ); break;
+  case OPT_DISCONNECT: imp.disconnect_after = atof( arg ); break;
+  case OPT_SEED:       imp.rng.seed( strtoul( arg, NULL, 0 ) ); break;
+  case OPT_VERBOSE:    verbose = true; break;
+  default:
+    return false;
+  }
+
+  return true;
+}
+
+void emu_log( const char *fmt, ... )
+{
+  struct timespec ts;
+  struct tm tm;
+  char stamp[32];
+  va_list ap;
+
+  clock_gettime( CLOCK_REALTIME, &ts );
+  localtime_r( &ts.tv_sec, &tm );
+  strftime( stamp, sizeof(stamp), "%H:%M:%S", &tm );
+
+  va_start( ap, fmt );
+  fprintf( stderr, "%s.%03ld ", stamp, ts.tv_nsec / 1000000 );
+  vfprintf( stderr, fmt, ap );
+  fputc( '\n', stderr );
+  va_end( ap );
+}
+
+int emu_listen( const std::string &bind, unsigned short port )
+{
+  struct sockaddr_in sa;
+  int fd, one = 1;
+
+  memset( &sa, 0, sizeof(sa) );
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons( port );
+
+  if ( inet_pton( AF_INET, bind.c_str(), &sa.sin_addr ) != 1 )
+    throw std::runtime_error( "Invalid bind address " + bind );
+
+  if ( (fd = socket( AF_INET, SOCK_STREAM, 0 )) < 0 )
+    throw std::runtime_error( "Could not create TCP socket" );
+
+  setsockopt( fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one) );
+
+  if ( ::bind( fd, (struct sockaddr *)&sa, sizeof(sa) ) < 0 ||
+       listen( fd, 1 ) < 0 ) {
+    close( fd );
+    throw std::runtime_error( "Could not listen on " + bind + ":" +
+                              std::to_string( port ) + ": " + strerror( errno ) );
+  }
+
+  return fd;
+}
+
+bool emu_read_full( int fd, void *buf, size_t len )
+{
+  uint8_t *p = (uint8_t *)buf;
+
+  while ( len ) {
+    ssize_t n = recv( fd, p, len, 0 );
+    if ( n <= 0 )
+      return false;
+    p += n;
+    len -= n;
+  }
+
+  return true;
+}
@@ -0,0 +1,134 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef OSMOSDR_EMU_COMMON_H
+#define OSMOSDR_EMU_COMMON_H
+
+/*
+ * Shared pieces of the rtl_tcp and NetSDR protocol emulators: a synthetic
+ * IQ source, sample clock pacing and the impairment settings used to
+ * exercise the network clients.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <getopt.h>
+
+/* Tone plus white noise, precomputed and played back cyclically */
+class iq_generator
+{
+public:
+  /* tone is the offset from the center frequency in Hz, levels in dBFS */
+  iq_generator( double tone = 100e3, double tone_dbfs = -20,
+                double noise_dbfs = -50 );
+
+  void set_sample_rate( double rate );
+
+  void fill_u8( uint8_t *out, size_t n );  /* rtl_tcp, 127.4 centered */
+  void fill_s16( int16_t *out, size_t n ); /* NetSDR, little endian */
+
+private:
+  void fill_table( void );
+
+  double _tone;
+  double _tone_level;
+  double _noise_level;
+  double _rate;
+
+  std::vector< float > _table; /* interleaved I/Q */
+  size_t _pos;
+};
+
+/* Paces a sender to a sample clock using absolute deadlines */
+class sample_pacer
+{
+public:
+  explicit sample_pacer( double rate );
+
+  /* may be called from another thread, takes effect at the next wait() */
+  void set_rate( double rate ) { _rate = rate; }
+  void reset( void );
+
+  /* sleep until \p samples more samples are due */
+  void wait( size_t samples );
+
+private:
+  typedef std::chrono::steady_clock clock_t;
+
+  std::atomic< double > _rate;
+  double _current_rate;
+  clock_t::time_point _start;
+  double _sent;
+};
+
+struct impairments
+{
+  impairments();
+
+  double loss;             /* probability a chunk / packet is dropped */
+  double reorder;          /* probability a packet is held back by one */
+  double stall;            /* probability the sender pauses for stall_ms */
+  unsigned stall_ms;
+  double disconnect_after; /* seconds after which the client is dropped */
+
+  bool roll( double p );
+
+  std::mt19937 rng;
+};
+
+/*
+ * Command line options shared by the emulators. Tools append their own
+ * entries to long_options() and pass every option to handle() first.
+ */
+struct emu_options
+{
+  emu_options( unsigned short port, double rate );
+
+  static std::vector< struct option > long_options( const struct option *extra );
+  static void usage( const char *name, const char *extra );
+
+  /* returns false if \p opt is not a common option */
+  bool handle( int opt, const char *arg );
+
+  std::string bind;
+  unsigned short port;
+  double rate;
+  double tone;
+  double tone_dbfs;
+  double noise_dbfs;
+  bool verbose;
+  impairments imp;
+};
+
+/* Timestamped line to stderr */
+void emu_log( const char *fmt, ... )
+  __attribute__ (( format (printf, 1, 2) ));
+
+/* Listening TCP socket bound to bind:port, throws on failure */
+int emu_listen( const std::string &bind, unsigned short port );
+
+/* Read exactly \p len bytes, false on EOF or error */
+bool emu_read_full( int fd, void *buf, size_t len );
+
+#endif /* OSMOSDR_EMU_COMMON_H */
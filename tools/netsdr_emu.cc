@@ -0,0 +1,465 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * RFSPACE NetSDR protocol emulator
+ *
+ * Answers the TCP control items used by rfspace_source_c and, while the
+ * receiver is running, streams 16 bit IQ data items over UDP to the
+ * client address with the usual 16 bit sequence numbers. Every control
+ * message is logged.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "emu_common.h"
+
+/* NETSDR 3.2 message header: 13 bit length, 3 bit type */
+#define TYPE_SET        0
+#define TYPE_REQUEST    1
+#define TYPE_RANGE      2
+#define TYPE_DATA0      4
+
+#define ADC_CLOCK       80e6
+#define PACKET_SAMPLES  256 /* 16 bit complex samples per data item */
+
+static void put_header( std::vector< uint8_t > &msg, unsigned type )
+{
+  uint16_t hdr = (msg.size() & 0x1fff) | (type << 13);
+  msg[0] = hdr & 0xff;
+  msg[1] = hdr >> 8;
+}
+
+static uint64_t get_le( const uint8_t *p, size_t n )
+{
+  uint64_t v = 0;
+  for ( size_t i = 0; i < n; i++ )
+    v |= uint64_t( p[i] ) << (8 * i);
+  return v;
+}
+
+static void put_le( std::vector< uint8_t > &msg, uint64_t v, size_t n )
+{
+  for ( size_t i = 0; i < n; i++ )
+    msg.push_back( (v >> (8 * i)) & 0xff );
+}
+
+class netsdr_emulator
+{
+public:
+  netsdr_emulator( emu_options &opts, unsigned short udp_port, bool x2 ) :
+    _opts(opts), _udp_port(udp_port), _x2(x2), _udp(-1),
+    _rate(opts.rate), _nchan(1), _running(false)
+  {
+    _freq[0] = _freq[1] = 14e6;
+    _atten[0] = _atten[1] = 0;
+
+    if ( (_udp = socket( AF_INET, SOCK_DGRAM, 0 )) < 0 )
+      throw std::runtime_error( "Could not create UDP socket" );
+  }
+
+  ~netsdr_emulator()
+  {
+    close( _udp );
+  }
+
+  void serve( int fd, const struct sockaddr_in &peer );
+
+private:
+  std::vector< uint8_t > handle( const std::vector< uint8_t > &msg );
+  void start_stream( void );
+  void stop_stream( void );
+  void sender( void );
+
+  emu_options &_opts;
+  unsigned short _udp_port;
+  bool _x2;
+  int _udp;
+  struct sockaddr_in _data_addr;
+
+  std::atomic< double > _rate;
+  std::atomic< int > _nchan;
+  double _freq[2];
+  int8_t _atten[2];
+
+  std::thread _thread;
+  std::atomic< bool > _running;
+  uint64_t _sent;
+  uint64_t _dropped;
+};
+
+std::vector< uint8_t > netsdr_emulator::handle( const std::vector< uint8_t > &msg )
+{
+  unsigned type = msg[1] >> 5;
+  unsigned item = get_le( &msg[2], 2 );
+  const uint8_t *param = &msg[4];
+  size_t nparam = msg.size() - 4;
+
+  std::vector< uint8_t > resp( 2 );
+  put_le( resp, item, 2 );
+
+  if ( TYPE_SET == type ) {
+    switch ( item ) {
+    case 0x0018: /* 4.2.1 Receiver State */
+      if ( nparam >= 2 ) {
+        if ( 0x02 == param[1] )
+          start_stream();
+        else
+          stop_stream();
+      }
+      break;
+    case 0x0019: /* 4.2.2 Receiver Channel Setup */
+      if ( nparam >= 1 )
+        _nchan = (param[0] >= 4) ? 2 : 1;
+      break;
+    case 0x0020: /* 4.2.3 Receiver Frequency */
+      if ( nparam >= 6 )
+        _freq[param[0] ? 1 : 0] = get_le( param + 1, 5 );
+      break;
+    case 0x0038: /* 4.2.6 RF Gain */
+      if ( nparam >= 2 )
+        _atten[param[0] ? 1 : 0] = param[1];
+      break;
+    case 0x0044: /* 4.2.7 RF Filter Selection */
+      break;
+    case 0x00B8: /* 4.2.9 I/Q Output Data Sample Rate */
+      if ( nparam >= 5 ) {
+        /* round to what the decimating DDC can actually produce */
+        uint32_t rate = get_le( param + 1, 4 );
+        uint32_t decim = rate ? uint32_t( ADC_CLOCK / rate + 0.5 ) : 400;
+        _rate = ADC_CLOCK / std::max( 40u, decim );
+
+        resp.push_back( param[0] );
+        put_le( resp, uint32_t( _rate ), 4 );
+        put_header( resp, TYPE_SET );
+        return resp;
+      }
+      break;
+    default:
+      resp.clear();
+      break;
+    }
+
+    if ( resp.empty() ) /* NAK */
+      return std::vector< uint8_t >{ 0x02, 0x00 };
+
+    return msg; /* settings are acknowledged by echo */
+  }
+
+  if ( TYPE_REQUEST == type ) {
+    switch ( item ) {
+    case 0x0001: /* 4.1.1 Target Name */
+      for ( const char *p = "NetSDR"; ; p++ ) {
+        resp.push_back( *p );
+        if ( ! *p )
+          break;
+      }
+      break;
+    case 0x0002: /* 4.1.2 Target Serial Number */
+      for ( const char *p = "EMU00001"; ; p++ ) {
+        resp.push_back( *p );
+        if ( ! *p )
+          break;
+      }
+      break;
+    case 0x0004: /* 4.1.4 Hardware/Firmware Versions */
+      resp.push_back( nparam ? param[0] : 0 );
+      put_le( resp, 100, 2 );
+      break;
+    case 0x0005: /* 4.1.5 Status/Error Code */
+      resp.push_back( _running ? 0x0C : 0x0B );
+      break;
+    case 0x0009: /* 4.1.6 Product ID */
+      resp.push_back( 'S' );
+      resp.push_back( 'D' );
+      resp.push_back( 'R' );
+      resp.push_back( 0x04 );
+      break;
+    case 0x000A: /* 4.1.7 Options */
+      resp.push_back( _x2 ? 0x10 : 0x00 );
+      break;
+    case 0x0020: /* 4.2.3 Receiver Frequency */
+      resp.push_back( nparam ? param[0] : 0 );
+      put_le( resp, uint64_t( _freq[nparam && param[0] ? 1 : 0] ), 5 );
+      break;
+    case 0x0038: /* 4.2.6 RF Gain */
+      resp.push_back( nparam ? param[0] : 0 );
+      resp.push_back( _atten[nparam && param[0] ? 1 : 0] );
+      break;
+    default:
+      return std::vector< uint8_t >{ 0x02, 0x00 };
+    }
+
+    put_header( resp, 0 );
+    return resp;
+  }
+
+  if ( TYPE_RANGE == type && 0x0020 == item ) {
+    resp.push_back( nparam ? param[0] : 0 );
+    resp.push_back( 1 );                   /* one range */
+    put_le( resp, 0, 5 );                  /* min */
+    put_le( resp, uint64_t( 40e6 ), 5 );   /* max */
+    put_le( resp, 0, 5 );                  /* VCO down converter */
+    put_header( resp, TYPE_RANGE );
+    return resp;
+  }
+
+  return std::vector< uint8_t >{ 0x02, 0x00 };
+}
+
+void netsdr_emulator::start_stream()
+{
+  if ( _running )
+    return;
+
+  _running = true;
+  _thread = std::thread( &netsdr_emulator::sender, this );
+}
+
+void netsdr_emulator::stop_stream()
+{
+  _running = false;
+
+  if ( _thread.joinable() )
+    _thread.join();
+}
+
+void netsdr_emulator::sender()
+{
+  iq_generator gen( _opts.tone, _opts.tone_dbfs, _opts.noise_dbfs );
+  sample_pacer pacer( _rate );
+  std::vector< uint8_t > pkt( 4 + PACKET_SAMPLES * 4 ), held;
+  std::vector< int16_t > iq( PACKET_SAMPLES * 2 );
+  uint16_t sequence = 0;
+
+  gen.set_sample_rate( _rate );
+  _sent = _dropped = 0;
+
+  pkt[0] = pkt.size() & 0xff;
+  pkt[1] = ((pkt.size() >> 8) & 0x1f) | (TYPE_DATA0 << 5);
+
+  while ( _running ) {
+    size_t frames = PACKET_SAMPLES / _nchan;
+
+    if ( 1 == _nchan ) {
+      gen.fill_s16( iq.data(), frames );
+    } else {
+      /* both channels carry the same signal, interleaved per sample */
+      gen.fill_s16( iq.data(), frames );
+      for ( size_t i = frames; i-- > 0; ) {
+        iq[4 * i + 2] = iq[4 * i + 0] = iq[2 * i + 0];
+        iq[4 * i + 3] = iq[4 * i + 1] = iq[2 * i + 1];
+      }
+    }
+
+    pacer.wait( frames );
+
+    pkt[2] = sequence & 0xff;
+    pkt[3] = sequence >> 8;
+    memcpy( &pkt[4], iq.data(), PACKET_SAMPLES * 4 );
+
+    sequence = (0xffff == sequence) ? 1 : sequence + 1; /* 0 only once */
+
+    if ( _opts.imp.roll( _opts.imp.stall ) ) {
+      if ( _opts.verbose )
+        emu_log( "stalling for %u ms", _opts.imp.stall_ms );
+      std::this_thread::sleep_for( std::chrono::milliseconds( _opts.imp.stall_ms ) );
+    }
+
+    if ( _opts.imp.roll( _opts.imp.loss ) ) {
+      if ( _opts.verbose )
+        emu_log( "dropping packet %u", pkt[2] | (pkt[3] << 8) );
+      _dropped++;
+      continue;
+    }
+
+    if ( held.empty() && _opts.imp.roll( _opts.imp.reorder ) ) {
+      if ( _opts.verbose )
+        emu_log( "holding back packet %u", pkt[2] | (pkt[3] << 8) );
+      held = pkt;
+      continue;
+    }
+
+    sendto( _udp, pkt.data(), pkt.size(), 0,
+            (struct sockaddr *)&_data_addr, sizeof(_data_addr) );
+
+    if ( ! held.empty() ) {
+      sendto( _udp, held.data(), held.size(), 0,
+              (struct sockaddr *)&_data_addr, sizeof(_data_addr) );
+      held.clear();
+    }
+
+    _sent++;
+  }
+
+  emu_log( "stream stopped, sent %llu packets, dropped %llu",
+           (unsigned long long)_sent, (unsigned long long)_dropped );
+}
+
+void netsdr_emulator::serve( int fd, const struct sockaddr_in &peer )
+{
+  std::atomic< bool > connected( true );
+  std::mutex wake_lock;
+  std::condition_variable wake;
+
+  _data_addr = peer;
+  _data_addr.sin_port = htons( _udp_port );
+  _nchan = 1;
+
+  /* drops the control connection, taking the stream down with it */
+  std::thread watchdog( [&]() {
+    if ( _opts.imp.disconnect_after <= 0 )
+      return;
+
+    std::unique_lock< std::mutex > lock( wake_lock );
+    if ( ! wake.wait_for( lock, std::chrono::duration< double >( _opts.imp.disconnect_after ),
+                          [&]() { return ! connected; } ) ) {
+      emu_log( "injecting disconnect" );
+      shutdown( fd, SHUT_RDWR );
+    }
+  } );
+
+  while ( true ) {
+    std::vector< uint8_t > msg( 2 );
+
+    if ( ! emu_read_full( fd, msg.data(), 2 ) )
+      break;
+
+    size_t len = get_le( msg.data(), 2 ) & 0x1fff;
+    if ( len < 4 ) { /* nothing we answer is shorter than header + item */
+      emu_log( "malformed message, length %zu", len );
+      break;
+    }
+
+    msg.resize( len );
+    if ( ! emu_read_full( fd, msg.data() + 2, len - 2 ) )
+      break;
+
+    std::string hex;
+    for ( uint8_t b : msg ) {
+      char tmp[4];
+      snprintf( tmp, sizeof(tmp), "%02x ", b );
+      hex += tmp;
+    }
+
+    emu_log( "ctl type %u item 0x%04x: %s", msg[1] >> 5,
+             unsigned( get_le( &msg[2], 2 ) ), hex.c_str() );
+
+    std::vector< uint8_t > resp = handle( msg );
+
+    if ( send( fd, resp.data(), resp.size(), MSG_NOSIGNAL ) != (ssize_t)resp.size() )
+      break;
+  }
+
+  stop_stream();
+
+  {
+    std::lock_guard< std::mutex > lock( wake_lock );
+    connected = false;
+  }
+  wake.notify_one();
+  watchdog.join();
+
+  emu_log( "client gone" );
+}
+
+enum { OPT_UDP_PORT = 0x200, OPT_X2 };
+
+int main( int argc, char **argv )
+{
+  emu_options opts( 50000, 200e3 );
+  unsigned short udp_port = 50000;
+  bool x2 = false;
+
+  static const struct option extra[] =
+  {
+    { "udp-port", required_argument, NULL, OPT_UDP_PORT },
+    { "x2",       no_argument,       NULL, OPT_X2 },
+    { NULL, 0, NULL, 0 }
+  };
+  static const char *extra_usage =
+    "  --udp-port=N             client port the data is sent to (50000)\n"
+    "  --x2                     report the X2 dual channel option\n";
+
+  std::vector< struct option > long_opts = emu_options::long_options( extra );
+  int opt;
+
+  while ( (opt = getopt_long( argc, argv, "h", long_opts.data(), NULL )) != -1 ) {
+    if ( opts.handle( opt, optarg ) )
+      continue;
+
+    switch ( opt ) {
+    case OPT_UDP_PORT: udp_port = atoi( optarg ); break;
+    case OPT_X2:       x2 = true; break;
+    default:
+      emu_options::usage( argv[0], extra_usage );
+      return opt == 'h' ? 0 : 1;
+    }
+  }
+
+  int lfd;
+
+  try {
+    lfd = emu_listen( opts.bind, opts.port );
+  } catch ( std::exception &ex ) {
+    fprintf( stderr, "%s\n", ex.what() );
+    return 1;
+  }
+
+  netsdr_emulator emu( opts, udp_port, x2 );
+
+  emu_log( "NetSDR emulator listening on %s:%u", opts.bind.c_str(), opts.port );
+
+  while ( true ) {
+    struct sockaddr_in peer;
+    socklen_t len = sizeof(peer);
+    int fd = accept( lfd, (struct sockaddr *)&peer, &len );
+
+    if ( fd < 0 )
+      continue;
+
+    int one = 1;
+    setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one) );
+
+    emu_log( "client %s:%u connected, data to port %u", inet_ntoa( peer.sin_addr ),
+             ntohs( peer.sin_port ), udp_port );
+
+    emu.serve( fd, peer );
+    close( fd );
+  }
+
+  return 0;
+}
@@ -0,0 +1,264 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 gr-osmosdr contributors
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * rtl_tcp protocol emulator
+ *
+ * Sends the "RTL0" dongle_info header followed by an endless stream of
+ * 8 bit unsigned IQ paced to the requested sample rate, and logs every
+ * 5 byte command the client sends. One client is served at a time, like
+ * the original rtl_tcp.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "emu_common.h"
+
+struct dongle_info_t
+{
+  char magic[4];
+  uint32_t tuner_type;
+  uint32_t tuner_gain_count;
+};
+
+static const char *command_name( uint8_t cmd )
+{
+  switch ( cmd ) {
+  case 0x01: return "set_freq";
+  case 0x02: return "set_sample_rate";
+  case 0x03: return "set_gain_mode";
+  case 0x04: return "set_gain";
+  case 0x05: return "set_freq_correction";
+  case 0x06: return "set_if_gain";
+  case 0x07: return "set_test_mode";
+  case 0x08: return "set_agc_mode";
+  case 0x09: return "set_direct_sampling";
+  case 0x0a: return "set_offset_tuning";
+  case 0x0b: return "set_rtl_xtal";
+  case 0x0c: return "set_tuner_xtal";
+  case 0x0d: return "set_gain_by_index";
+  case 0x0e: return "set_bias_tee";
+  default:   return "unknown";
+  }
+}
+
+struct session
+{
+  session( int fd, emu_options &opts, size_t chunk ) :
+    fd(fd), opts(opts), chunk(chunk), alive(true), rate(opts.rate),
+    sent(0), dropped(0)
+  {
+  }
+
+  void sender();
+
+  int fd;
+  emu_options &opts;
+  size_t chunk;
+
+  std::atomic< bool > alive;
+  std::atomic< double > rate;
+
+  uint64_t sent;
+  uint64_t dropped;
+};
+
+void session::sender()
+{
+  iq_generator gen( opts.tone, opts.tone_dbfs, opts.noise_dbfs );
+  sample_pacer pacer( rate );
+  std::vector< uint8_t > buf( chunk ), held;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  double gen_rate = 0;
+
+  while ( alive ) {
+    if ( opts.imp.disconnect_after > 0 &&
+         std::chrono::steady_clock::now() - start >
+           std::chrono::duration< double >( opts.imp.disconnect_after ) ) {
+      emu_log( "injecting disconnect" );
+      break;
+    }
+
+    if ( rate != gen_rate ) {
+      gen_rate = rate;
+      gen.set_sample_rate( gen_rate );
+      pacer.set_rate( gen_rate );
+    }
+
+    gen.fill_u8( buf.data(), chunk / 2 );
+    pacer.wait( chunk / 2 );
+
+    if ( opts.imp.roll( opts.imp.stall ) ) {
+      if ( opts.verbose )
+        emu_log( "stalling for %u ms", opts.imp.stall_ms );
+      std::this_thread::sleep_for( std::chrono::milliseconds( opts.imp.stall_ms ) );
+    }
+
+    if ( opts.imp.roll( opts.imp.loss ) ) {
+      if ( opts.verbose )
+        emu_log( "dropping %zu bytes", chunk );
+      dropped++;
+      continue;
+    }
+
+    /* TCP cannot reorder, but a server juggling buffers can */
+    if ( held.empty() && opts.imp.roll( opts.imp.reorder ) ) {
+      if ( opts.verbose )
+        emu_log( "holding back %zu bytes", chunk );
+      held = buf;
+      continue;
+    }
+
+    if ( send( fd, buf.data(), buf.size(), MSG_NOSIGNAL ) != (ssize_t)buf.size() )
+      break;
+
+    if ( ! held.empty() ) {
+      if ( send( fd, held.data(), held.size(), MSG_NOSIGNAL ) != (ssize_t)held.size() )
+        break;
+      held.clear();
+    }
+
+    sent += chunk;
+  }
+
+  alive = false;
+  shutdown( fd, SHUT_RDWR ); /* wakes the command reader */
+}
+
+static void serve( int fd, emu_options &opts, uint32_t tuner, uint32_t gains,
+                   size_t chunk )
+{
+  dongle_info_t info;
+
+  memcpy( info.magic, "RTL0", 4 );
+  info.tuner_type = htonl( tuner );
+  info.tuner_gain_count = htonl( gains );
+
+  if ( send( fd, &info, sizeof(info), MSG_NOSIGNAL ) != sizeof(info) )
+    return;
+
+  session s( fd, opts, chunk );
+  std::thread sender( &session::sender, &s );
+
+  uint8_t cmd[5];
+
+  while ( s.alive && emu_read_full( fd, cmd, sizeof(cmd) ) ) {
+    uint32_t param;
+    memcpy( &param, cmd + 1, sizeof(param) );
+    param = ntohl( param );
+
+    emu_log( "cmd 0x%02x %-20s %u (0x%08x)", cmd[0], command_name( cmd[0] ),
+             param, param );
+
+    if ( 0x02 == cmd[0] && param > 0 )
+      s.rate = param;
+  }
+
+  s.alive = false;
+  sender.join();
+
+  emu_log( "client gone, sent %llu bytes, dropped %llu chunks",
+           (unsigned long long)s.sent, (unsigned long long)s.dropped );
+}
+
+enum { OPT_TUNER = 0x200, OPT_GAINS, OPT_CHUNK };
+
+int main( int argc, char **argv )
+{
+  emu_options opts( 1234, 2.048e6 );
+  uint32_t tuner = 5; /* R820T */
+  uint32_t gains = 29;
+  size_t chunk = 16384;
+
+  static const struct option extra[] =
+  {
+    { "tuner", required_argument, NULL, OPT_TUNER },
+    { "gains", required_argument, NULL, OPT_GAINS },
+    { "chunk", required_argument, NULL, OPT_CHUNK },
+    { NULL, 0, NULL, 0 }
+  };
+  static const char *extra_usage =
+    "  --tuner=N                tuner type reported in dongle_info (5 = R820T)\n"
+    "  --gains=N                tuner gain count reported (29)\n"
+    "  --chunk=BYTES            bytes per send (16384)\n";
+
+  std::vector< struct option > long_opts = emu_options::long_options( extra );
+  int opt;
+
+  while ( (opt = getopt_long( argc, argv, "h", long_opts.data(), NULL )) != -1 ) {
+    if ( opts.handle( opt, optarg ) )
+      continue;
+
+    switch ( opt ) {
+    case OPT_TUNER: tuner = atoi( optarg ); break;
+    case OPT_GAINS: gains = atoi( optarg ); break;
+    case OPT_CHUNK: chunk = strtoul( optarg, NULL, 0 ) & ~size_t(1); break;
+    default:
+      emu_options::usage( argv[0], extra_usage );
+      return opt == 'h' ? 0 : 1;
+    }
+  }
+
+  if ( chunk < 2 )
+    chunk = 16384;
+
+  int lfd;
+
+  try {
+    lfd = emu_listen( opts.bind, opts.port );
+  } catch ( std::exception &ex ) {
+    fprintf( stderr, "%s\n", ex.what() );
+    return 1;
+  }
+
+  emu_log( "rtl_tcp emulator listening on %s:%u", opts.bind.c_str(), opts.port );
+
+  while ( true ) {
+    struct sockaddr_in peer;
+    socklen_t len = sizeof(peer);
+    int fd = accept( lfd, (struct sockaddr *)&peer, &len );
+
+    if ( fd < 0 )
+      continue;
+
+    int one = 1;
+    setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one) );
+
+    emu_log( "client %s:%u connected", inet_ntoa( peer.sin_addr ),
+             ntohs( peer.sin_port ) );
+
+    serve( fd, opts, tuner, gains, chunk );
+    close( fd );
+  }
+
+  return 0;
+}